@@ -15,11 +15,11 @@ echo Compilando o Compilador Fortall...
 echo.
 
 :: Define os arquivos fonte (na pasta src/)
-set "SOURCES=src/main.cpp src/lexer.cpp src/parser.cpp src/semantic.cpp src/interpreter.cpp src/symbol_table.cpp"
+set "SOURCES=src/main.cpp src/source_buffer.cpp src/lexer.cpp src/lexer_kernels.cpp src/reference_lexer.cpp src/reference_walkers.cpp src/string_pool.cpp src/utf8.cpp src/token_buffer.cpp src/streaming_lexer.cpp src/token_pipeline.cpp src/ast.cpp src/parser.cpp src/semantic.cpp src/interpreter.cpp src/symbol_table.cpp src/slot_resolver.cpp src/flow_graph.cpp src/range_analysis.cpp src/optimizer.cpp src/loop_optimizer.cpp src/common_subexpressions.cpp src/ir.cpp src/ir_builder.cpp src/ir_passes.cpp src/pass_manager.cpp src/ir_interpreter.cpp src/definite_assignment.cpp src/program_cache.cpp src/bench.cpp"
 :: Define o caminho para o executavel de saida (na pasta bin/)
 set "OUTPUT_EXE=bin\fortall.exe"
 :: Define as flags do compilador
-set "COMPILER_FLAGS=-std=c++17 -O2 -Wall -Wextra"
+set "COMPILER_FLAGS=-std=c++17 -O2 -Wall -Wextra -pthread"
 
 :: Cria a pasta bin/ se nao existir
 if not exist bin\ (
@@ -0,0 +1,102 @@
+#include "ast.h"
+#include <string>
+#include <utility>
+
+const char* nodeTypeToString(NodeType type) {
+    switch (type) {
+        case NodeType::PROGRAMA: return "PROGRAMA";
+        case NodeType::DECLARACAO: return "DECLARACAO";
+        case NodeType::LISTA_VAR: return "LISTA_VAR";
+        case NodeType::TIPO: return "TIPO";
+        case NodeType::LISTA_COMANDOS: return "LISTA_COMANDOS";
+        case NodeType::COMANDO: return "COMANDO";
+        case NodeType::ATRIBUICAO: return "ATRIBUICAO";
+        case NodeType::SE: return "SE";
+        case NodeType::ENQUANTO: return "ENQUANTO";
+        case NodeType::LER: return "LER";
+        case NodeType::ESCREVER: return "ESCREVER";
+        case NodeType::EXPRESSAO: return "EXPRESSAO";
+        case NodeType::BINARIO: return "BINARIO";
+        case NodeType::UNARIO: return "UNARIO";
+        case NodeType::LITERAL: return "LITERAL";
+        case NodeType::IDENTIFICADOR: return "IDENTIFICADOR";
+        case NodeType::NUMERO: return "NUMERO";
+        case NodeType::STRING_LITERAL: return "STRING_LITERAL";
+        default: return "DESCONHECIDO";
+    }
+}
+
+NodeId AST::addNode(NodeType type, const Token& token, const NodeId* children, size_t count) {
+    ASTNode node;
+    node.token = token;
+    node.type = type;
+    node.firstChild = static_cast<uint32_t>(childIds.size());
+    node.childCount = static_cast<uint32_t>(count);
+    childIds.insert(childIds.end(), children, children + count);
+    nodes.push_back(node);
+    return static_cast<NodeId>(nodes.size() - 1);
+}
+
+size_t AST::memoryUsed() const {
+    return nodes.size() * sizeof(ASTNode) + childIds.size() * sizeof(NodeId);
+}
+
+size_t AST::memoryReserved() const {
+    return nodes.capacity() * sizeof(ASTNode) + childIds.capacity() * sizeof(NodeId);
+}
+
+// Pré-ordem com pilha explícita, para que árvores muito profundas nao
+// estourem a pilha do C++
+void printAST(const AST& ast, std::ostream& out) {
+    if (ast.empty()) {
+        out << "(vazia)\n";
+        return;
+    }
+
+    std::vector<std::pair<NodeId, int>> stack = {{ast.root, 0}};
+    while (!stack.empty()) {
+        auto [id, depth] = stack.back();
+        stack.pop_back();
+
+        out << std::string(depth * 2, ' ');
+        const ASTNode& node = ast[id];
+        out << nodeTypeToString(node.type);
+        if (node.token.type != TokenType::ERRO) {
+            out << " " << tokenTypeToString(node.token.type) << " '" << node.token.value << "' "
+                << node.token.line << ":" << node.token.column;
+        }
+        out << "\n";
+
+        ChildRange children = ast.children(id);
+        for (size_t i = children.size(); i-- > 0;) {
+            stack.push_back({children[i], depth + 1});
+        }
+    }
+}
+
+bool sameAST(const AST& a, const AST& b) {
+    if (a.empty() || b.empty()) {
+        return a.empty() == b.empty();
+    }
+
+    // Percurso com pilha explícita: expressões longas geram árvores profundas
+    std::vector<std::pair<NodeId, NodeId>> pending = {{a.root, b.root}};
+
+    while (!pending.empty()) {
+        auto [x, y] = pending.back();
+        pending.pop_back();
+
+        const ASTNode& p = a[x];
+        const ASTNode& q = b[y];
+        if (p.type != q.type || p.token.type != q.token.type || p.token.value != q.token.value ||
+            p.token.line != q.token.line || p.token.column != q.token.column ||
+            p.token.symbol != q.token.symbol || p.valueType != q.valueType || p.assigned != q.assigned ||
+            p.childCount != q.childCount) {
+            return false;
+        }
+        for (size_t i = 0; i < p.childCount; i++) {
+            pending.push_back({a.child(x, i), b.child(y, i)});
+        }
+    }
+    return true;
+}
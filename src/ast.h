@@ -3,10 +3,13 @@
 #define AST_H
 
 #include "token.h"
+#include "symbol_table.h"
+#include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <memory>
+#include <ostream>
 
-enum class NodeType {
+enum class NodeType : uint8_t {
     PROGRAMA, DECLARACAO, LISTA_VAR, TIPO,
     LISTA_COMANDOS, COMANDO, ATRIBUICAO,
     SE, ENQUANTO, LER, ESCREVER,
@@ -14,19 +17,181 @@ enum class NodeType {
     IDENTIFICADOR, NUMERO, STRING_LITERAL
 };
 
+// Índice de um nó em AST::nodes
+using NodeId = uint32_t;
+constexpr NodeId NO_NODE = UINT32_MAX;
+
+// Slot de uma variável no vetor de valores do interpretador (SlotResolver)
+constexpr uint32_t NO_SLOT = UINT32_MAX;
+
 struct ASTNode {
-    NodeType type;
     Token token;
-    std::vector<std::shared_ptr<ASTNode>> children;
-    
-    ASTNode(NodeType t, const Token& tok = Token())
-        : type(t), token(tok) {}
-    
-    void addChild(std::shared_ptr<ASTNode> child) {
-        children.push_back(child);
+    NodeType type;
+    SymbolType valueType = SymbolType::INTEIRO; // tipo da expressão, gravado pela análise semântica
+    bool assigned = false; // IDENTIFICADOR lido sempre depois de uma atribuição (DefiniteAssignment)
+    bool proven = false;   // operador que nunca estoura nem divide por zero (RangeAnalysis): roda sem testes
+    uint32_t firstChild; // início dos filhos em AST::childIds
+    uint32_t childCount;
+    // IDENTIFICADOR: slot da variável (SlotResolver); NUMERO e LITERAL: valor
+    // decodificado pelo parser (lógicos valem 1 ou 0). Ocupa o preenchimento do nó.
+    union {
+        uint32_t slot = NO_SLOT;
+        int32_t value;
+    };
+};
+
+// Filhos de um nó: um trecho contíguo de AST::childIds
+class ChildRange {
+private:
+    const NodeId* first;
+    const NodeId* last;
+
+public:
+    ChildRange(const NodeId* first, const NodeId* last) : first(first), last(last) {}
+    const NodeId* begin() const { return first; }
+    const NodeId* end() const { return last; }
+    size_t size() const { return static_cast<size_t>(last - first); }
+    bool empty() const { return first == last; }
+    NodeId operator[](size_t i) const { return first[i]; }
+};
+
+// Árvore sintática em arena: todos os nós ficam em um único vetor e se
+// referem aos filhos por índice. Um nó é criado depois dos seus filhos,
+// entao os filhos sempre têm índices menores que o pai.
+class AST {
+public:
+    std::vector<ASTNode> nodes;
+    std::vector<NodeId> childIds;
+    NodeId root = NO_NODE;
+
+    NodeId addNode(NodeType type, const Token& token = Token(), const NodeId* children = nullptr, size_t count = 0);
+
+    const ASTNode& operator[](NodeId id) const { return nodes[id]; }
+    ASTNode& operator[](NodeId id) { return nodes[id]; }
+    ChildRange children(NodeId id) const {
+        const NodeId* first = childIds.data() + nodes[id].firstChild;
+        return ChildRange(first, first + nodes[id].childCount);
     }
+    NodeId child(NodeId id, size_t i) const { return childIds[nodes[id].firstChild + i]; }
+
+    bool empty() const { return root == NO_NODE; }
+    size_t size() const { return nodes.size(); }
+    // Bytes usados pelos nós e listas de filhos, e bytes reservados pelos vetores
+    size_t memoryUsed() const;
+    size_t memoryReserved() const;
 };
 
-using ASTNodePtr = std::shared_ptr<ASTNode>;
+const char* nodeTypeToString(NodeType type);
+
+// Imprime a árvore, um nó por linha, indentada pela profundidade
+void printAST(const AST& ast, std::ostream& out);
+
+// Compara duas árvores nó a nó (tipo, token, tipo do valor e filhos)
+bool sameAST(const AST& a, const AST& b);
+
+// Operandos que um nó de expressão avalia antes de si (0 = folha)
+inline uint32_t expressionOperands(const ASTNode& node) {
+    if (node.type == NodeType::BINARIO) return node.childCount >= 2 ? 2 : 0;
+    if (node.type == NodeType::UNARIO) return node.childCount > 0 ? 1 : 0;
+    return 0;
+}
+
+// Conta que pode estourar o inteiro: +, - e * binários e a negação
+inline bool mayOverflow(const ASTNode& node) {
+    if (node.type == NodeType::UNARIO) return node.token.type == TokenType::MENOS;
+    return node.type == NodeType::BINARIO &&
+           (node.token.type == TokenType::MAIS || node.token.type == TokenType::MENOS ||
+            node.token.type == TokenType::MULTIPLICACAO);
+}
+
+// Operador de foldExpression à espera dos seus operandos (no máximo dois)
+template <typename Value>
+struct PendingOperator {
+    NodeId node;
+    uint32_t next;     // próximo operando a avaliar
+    uint32_t operands;
+    Value left;        // primeiro operando, já avaliado
+};
+
+// Pilha de foldExpression, reaproveitada entre chamadas. O vetor só cresce:
+// o topo fica numa variável local durante a avaliação.
+template <typename Value>
+using ExpressionStack = std::vector<PendingOperator<Value>>;
+
+// Avalia uma expressão em pós-ordem sem recursão, da esquerda para a direita:
+// evaluate(node, nullptr) para as folhas e evaluate(node, operandos) para os
+// operadores. Desce pelo primeiro operando até uma folha e, na volta, passa
+// ao operando seguinte ou aplica o operador. Folhas nunca vao para a pilha:
+// um operador cujos operandos sao todos folhas é aplicado direto, e um
+// operando direito folha é avaliado na subida. 'evaluate' nao pode usar a
+// mesma pilha.
+template <typename Value, typename Evaluate>
+Value foldExpression(const AST& ast, NodeId root, ExpressionStack<Value>& stack, Evaluate evaluate) {
+    // A árvore nao muda durante a avaliação: os vetores ficam em locais
+    const ASTNode* nodes = ast.nodes.data();
+    const NodeId* childIds = ast.childIds.data();
+    PendingOperator<Value>* frames = stack.data();
+    size_t capacity = stack.size();
+    size_t depth = 0;
+    Value operands[2];
+    Value value;
+    NodeId id = root;
+
+    for (;;) {
+        for (;;) {
+            const ASTNode& node = nodes[id];
+            uint32_t count = expressionOperands(node);
+            if (count == 0) {
+                value = evaluate(node, nullptr);
+                break;
+            }
+            const NodeId* children = childIds + node.firstChild;
+            bool leaves = true;
+            for (uint32_t i = 0; i < count && leaves; i++) {
+                leaves = expressionOperands(nodes[children[i]]) == 0;
+            }
+            if (leaves) {
+                for (uint32_t i = 0; i < count; i++) {
+                    operands[i] = evaluate(nodes[children[i]], nullptr);
+                }
+                value = evaluate(node, operands);
+                break;
+            }
+            if (depth == capacity) {
+                capacity = depth * 2 + 16;
+                stack.resize(capacity);
+                frames = stack.data();
+            }
+            frames[depth++] = {id, 1, count, Value()};
+            id = children[0];
+        }
+
+        for (;;) {
+            if (depth == 0) {
+                return value;
+            }
+            PendingOperator<Value>& top = frames[depth - 1];
+            const ASTNode& node = nodes[top.node];
+            if (top.next < top.operands) {
+                top.left = value;
+                id = childIds[node.firstChild + top.next++];
+                if (expressionOperands(nodes[id]) != 0) {
+                    break; // desce pelo operando
+                }
+                value = evaluate(nodes[id], nullptr);
+                continue;
+            }
+            // O último operando está em 'value'
+            if (top.operands == 2) {
+                operands[0] = top.left;
+                operands[1] = value;
+            } else {
+                operands[0] = value;
+            }
+            depth--;
+            value = evaluate(node, operands);
+        }
+    }
+}
 
 #endif
@@ -0,0 +1,571 @@
+#include "bench.h"
+#include "source_buffer.h"
+#include "lexer.h"
+#include "parser.h"
+#include "semantic.h"
+#include "interpreter.h"
+#include "symbol_table.h"
+#include "token_buffer.h"
+#include "token_pipeline.h"
+#include "streaming_lexer.h"
+#include "program_cache.h"
+#include "slot_resolver.h"
+#include "definite_assignment.h"
+#include "range_analysis.h"
+#include "reference_walkers.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+static const int BENCH_REPETITIONS = 3;
+
+using BenchClock = std::chrono::steady_clock;
+
+static double secondsSince(BenchClock::time_point start) {
+    return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+// Vazão da pré-tokenização paralela (TokenBuffer) por número de threads
+bool benchmarkLexer(const std::string& filename) {
+    SourceBuffer source;
+    if (!source.open(filename) || source.empty()) {
+        std::cout << "Erro: Nao foi possível ler o arquivo '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts;
+    for (unsigned t = 1; t < maxThreads; t *= 2) {
+        threadCounts.push_back(t);
+    }
+    threadCounts.push_back(maxThreads);
+
+    double megabytes = static_cast<double>(source.view().size()) / (1024.0 * 1024.0);
+    std::cout << "Arquivo: " << filename << " (" << std::fixed << std::setprecision(1)
+              << megabytes << " MB)" << std::endl;
+    std::cout << "threads      tokens    tempo (s)     MB/s" << std::endl;
+
+    for (unsigned threads : threadCounts) {
+        double best = 0;
+        size_t tokens = 0;
+        for (int i = 0; i < BENCH_REPETITIONS; i++) {
+            TokenBuffer buffer;
+            StringPool pool;
+            auto start = BenchClock::now();
+            buffer.tokenize(source.view(), pool, threads);
+            double elapsed = secondsSince(start);
+            if (i == 0 || elapsed < best) best = elapsed;
+            tokens = buffer.size();
+        }
+        std::cout << std::setw(7) << threads << std::setw(12) << tokens
+                  << std::setw(13) << std::setprecision(3) << best
+                  << std::setw(9) << std::setprecision(1) << megabytes / best << std::endl;
+    }
+
+    // Lexer de janela fixa: memória constante, independente do arquivo
+    int fd = openSourceFile(filename);
+    if (fd >= 0) {
+        StringPool pool;
+        StreamingLexer lexer(fd, pool, StreamingLexer::DEFAULT_WINDOW_SIZE, false);
+        size_t tokens = 0;
+        auto start = BenchClock::now();
+        while (lexer.nextToken().type != TokenType::FIM_ARQUIVO) {
+            tokens++;
+        }
+        double elapsed = secondsSince(start);
+        closeSourceFile(fd);
+        std::cout << "streaming (janela de " << StreamingLexer::DEFAULT_WINDOW_SIZE / 1024 << " KB): "
+                  << tokens + 1 << " tokens, " << std::setprecision(3) << elapsed << " s, "
+                  << std::setprecision(1) << megabytes / elapsed << " MB/s" << std::endl;
+    }
+    return true;
+}
+
+// Latência do front end (fonte mapeada até a AST pronta), com lexer e parser
+// na mesma thread ou em pipeline. As duas ASTs precisam ser idênticas.
+bool benchmarkFrontEnd(const std::string& filename) {
+    SourceBuffer source;
+    if (!source.open(filename) || source.empty()) {
+        std::cout << "Erro: Nao foi possível ler o arquivo '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    auto parseFile = [&source](bool pipelined, double& elapsed) {
+        auto start = BenchClock::now();
+        StringPool pool(pipelined);
+        Lexer lexer(source.view(), pool);
+        AST ast;
+        if (pipelined) {
+            PipelinedTokenStream pipeline(lexer);
+            Parser parser(pipeline);
+            ast = parser.parse();
+        } else {
+            Parser parser(lexer);
+            ast = parser.parse();
+        }
+        elapsed = secondsSince(start);
+        return ast;
+    };
+
+    double megabytes = static_cast<double>(source.view().size()) / (1024.0 * 1024.0);
+    std::cout << "Arquivo: " << filename << " (" << std::fixed << std::setprecision(1)
+              << megabytes << " MB)" << std::endl;
+    std::cout << "modo          tempo (s)     MB/s" << std::endl;
+
+    // As árvores das medições sao descartadas logo em seguida, para que os
+    // dois modos encontrem o alocador no mesmo estado
+    const char* names[2] = {"serial", "pipeline"};
+    for (int mode = 0; mode < 2; mode++) {
+        double best = 0;
+        for (int i = 0; i < BENCH_REPETITIONS; i++) {
+            double elapsed = 0;
+            parseFile(mode == 1, elapsed);
+            if (i == 0 || elapsed < best) best = elapsed;
+        }
+        std::cout << std::left << std::setw(10) << names[mode] << std::right
+                  << std::setw(13) << std::setprecision(3) << best
+                  << std::setw(9) << std::setprecision(1) << megabytes / best << std::endl;
+    }
+
+    double elapsed = 0;
+    AST serial = parseFile(false, elapsed);
+    AST pipelined = parseFile(true, elapsed);
+    if (!sameAST(serial, pipelined)) {
+        std::cout << "ERRO: as ASTs serial e em pipeline diferem" << std::endl;
+        return false;
+    }
+    std::cout << "ASTs identicas" << std::endl;
+    if (serial.empty()) {
+        return true;
+    }
+
+    // Custo da árvore em arena e de um percurso completo da análise semântica
+    double nodes = static_cast<double>(serial.size());
+    std::cout << "AST: " << serial.size() << " nos, " << std::setprecision(1)
+              << static_cast<double>(serial.memoryUsed()) / nodes << " bytes/no usados, "
+              << static_cast<double>(serial.memoryReserved()) / nodes << " bytes/no reservados" << std::endl;
+
+    // Só o parser, sobre tokens já lidos, e só a arena: a mesma quantidade de
+    // nós criados sem parsing, na arena reservada como o parser faz. A
+    // diferença é o custo das regras do parser.
+    StringPool bufferPool;
+    TokenBuffer tokens;
+    tokens.tokenize(source.view(), bufferPool, 1);
+    double bestParser = 0, bestArena = 0;
+    for (int i = 0; i < BENCH_REPETITIONS; i++) {
+        TokenBufferStream stream(tokens);
+        auto start = BenchClock::now();
+        Parser parser(stream);
+        AST ast = parser.parse();
+        double elapsed = secondsSince(start);
+        if (i == 0 || elapsed < bestParser) bestParser = elapsed;
+    }
+    for (int i = 0; i < BENCH_REPETITIONS; i++) {
+        auto start = BenchClock::now();
+        AST arena;
+        arena.nodes.reserve(tokens.size());
+        arena.childIds.reserve(tokens.size());
+        for (size_t n = 0; n < serial.size(); n++) {
+            arena.addNode(NodeType::NUMERO);
+        }
+        double elapsed = secondsSince(start);
+        if (i == 0 || elapsed < bestArena) bestArena = elapsed;
+    }
+    std::cout << "parser sobre tokens ja lidos: " << std::setprecision(3) << bestParser << " s ("
+              << std::setprecision(1) << bestParser * 1e9 / nodes << " ns/no), so a arena: "
+              << std::setprecision(3) << bestArena << " s" << std::endl;
+
+    double bestSemantic = 0;
+    for (int i = 0; i < BENCH_REPETITIONS; i++) {
+        SymbolTable symbols;
+        SemanticAnalyzer semantic(symbols);
+        auto start = BenchClock::now();
+        semantic.analyze(serial);
+        double elapsed = secondsSince(start);
+        if (i == 0 || elapsed < bestSemantic) bestSemantic = elapsed;
+    }
+    std::cout << "analise semantica: " << std::setprecision(3) << bestSemantic << " s" << std::endl;
+
+    // Parser + análise semântica em duas passadas e em uma só
+    double passes[2] = {0, 0};
+    AST singlePass;
+    std::string errors[2];
+    for (int mode = 0; mode < 2; mode++) {
+        for (int i = 0; i < BENCH_REPETITIONS; i++) {
+            SymbolTable symbols;
+            SemanticAnalyzer semantic(symbols);
+            auto start = BenchClock::now();
+            StringPool pool;
+            Lexer lexer(source.view(), pool);
+            Parser parser(lexer, mode == 1 ? &semantic : nullptr);
+            AST ast = parser.parse();
+            if (mode == 0 && !ast.empty()) {
+                semantic.analyze(ast);
+            }
+            double elapsed = secondsSince(start);
+            if (i == 0 || elapsed < passes[mode]) passes[mode] = elapsed;
+            errors[mode] = parser.hasError() ? parser.getError() : semantic.getError();
+            if (mode == 1) singlePass = std::move(ast);
+        }
+    }
+    std::cout << "duas passadas: " << passes[0] << " s, uma passada: " << passes[1] << " s" << std::endl;
+    if (!sameAST(serial, singlePass) || errors[0] != errors[1]) {
+        std::cout << "ERRO: a analise em uma passada difere da em duas passadas" << std::endl;
+        return false;
+    }
+
+    // Uma passada com hash-consing: memória poupada e os mesmos erros
+    double bestSharing = 0;
+    AST shared;
+    Parser::SharingStats sharing;
+    std::string sharedError;
+    for (int i = 0; i < BENCH_REPETITIONS; i++) {
+        SymbolTable symbols;
+        SemanticAnalyzer semantic(symbols);
+        auto start = BenchClock::now();
+        StringPool pool;
+        Lexer lexer(source.view(), pool);
+        Parser parser(lexer, &semantic, true);
+        AST ast = parser.parse();
+        double elapsed = secondsSince(start);
+        if (i == 0 || elapsed < bestSharing) bestSharing = elapsed;
+        sharing = parser.sharingStats();
+        sharedError = parser.hasError() ? parser.getError() : semantic.getError();
+        shared = std::move(ast);
+    }
+    std::cout << "hash-consing: " << bestSharing << " s, " << sharing.reusedNodes << " de "
+              << sharing.expressionNodes << " nos de expressao compartilhados" << std::endl;
+    if (!shared.empty()) {
+        std::cout << "AST com hash-consing: " << shared.size() << " nos, " << shared.memoryUsed() << " bytes usados ("
+                  << serial.memoryUsed() - shared.memoryUsed() << " bytes a menos)" << std::endl;
+    }
+    if (sharedError != errors[1]) {
+        std::cout << "ERRO: o hash-consing mudou o resultado da analise" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Programa com 'copies' cópias de 'depth' níveis de aninhamento do tipo
+// pedido, gerado em memória. Cada cópia recomeça com x = 0.
+static std::string nestedProgram(const std::string& kind, int depth, int copies = 1) {
+    std::string body;
+    if (kind == "parenteses") {
+        body = "x := " + std::string(depth, '(') + "1" + std::string(depth, ')') + ";\n";
+    } else if (kind == "unario") {
+        for (int i = 0; i < depth; i++) body += "- ";
+        body = "x := " + body + "1;\n";
+    } else if (kind == "soma") { // árvore degenerada à esquerda
+        body = "x := 1";
+        for (int i = 1; i < depth; i++) body += " + 1";
+        body += ";\n";
+    } else if (kind == "se") {
+        for (int i = 0; i < depth; i++) body += "se (x < 1) entao\n";
+        body += "x := 1;\n";
+        for (int i = 0; i < depth; i++) body += "fim_se\n";
+    } else { // enquanto: cada nível roda o corpo uma vez
+        for (int i = 0; i < depth; i++) body += "enquanto (x < 1) faca\n";
+        body += "x := 1;\n";
+        for (int i = 1; i < depth; i++) body += "fim_enquanto;\n"; // ';' obrigatório dentro do laço
+        body += "fim_enquanto\n";
+    }
+    std::string program = "programa aninhado;\nvar x : inteiro;\ninicio\n";
+    for (int i = 0; i < copies; i++) {
+        program += "x := 0;\n" + body;
+    }
+    return program + "fim.\n";
+}
+
+// Melhor tempo de cada fase de um programa aninhado e a AST analisada
+struct NestingRun {
+    double parse = 0, semantic = 0, execution = 0;
+    AST ast;
+    std::string error;
+};
+
+// Lexer + parser, análise de tipos e execução com os percursos dados: os
+// de pilha explícita (Parser, SemanticAnalyzer, Interpreter) ou os
+// recursivos de referência. DefiniteAssignment e SlotResolver rodam fora da
+// medida, iguais para os dois.
+template <typename ParserType, typename Checker, typename Evaluator>
+static bool timeNesting(const std::string& program, NestingRun& run) {
+    for (int i = 0; i < BENCH_REPETITIONS; i++) {
+        auto start = BenchClock::now();
+        StringPool pool;
+        Lexer lexer(program, pool);
+        ParserType parser(lexer);
+        AST ast = parser.parse();
+        double parsed = secondsSince(start);
+        if (ast.empty()) {
+            run.error = parser.getError();
+            return false;
+        }
+
+        SymbolTable symbols;
+        Checker checker(symbols);
+        start = BenchClock::now();
+        bool valid = checker.analyze(ast);
+        double analyzed = secondsSince(start);
+
+        DefiniteAssignment initialization;
+        valid = valid && initialization.analyze(ast);
+        SlotResolver resolver;
+        if (valid) resolver.resolve(ast, symbols);
+        Evaluator evaluator(resolver.slotTypes());
+        start = BenchClock::now();
+        bool executed = valid && evaluator.execute(ast);
+        double ran = secondsSince(start);
+        if (!executed) {
+            run.error = valid ? evaluator.getError()
+                        : checker.hasError() ? checker.getError() : initialization.getError();
+            return false;
+        }
+
+        if (i == 0 || parsed < run.parse) run.parse = parsed;
+        if (i == 0 || analyzed < run.semantic) run.semantic = analyzed;
+        if (i == 0 || ran < run.execution) run.execution = ran;
+        run.ast = std::move(ast);
+    }
+    return true;
+}
+
+// Profundidade em que os percursos recursivos ainda cabem na pilha do C++
+static const int REFERENCE_DEPTH = 1000;
+
+// Parser, análise semântica e interpretador em programas muito aninhados:
+// todos usam pilhas explícitas, então a profundidade só é limitada pelo heap.
+// Depois compara com os percursos recursivos de referência
+// (reference_walkers.cpp) em programas do mesmo tamanho feitos de cópias
+// rasas o bastante para a recursão.
+bool benchmarkNesting(int depth) {
+    const char* kinds[] = {"parenteses", "unario", "soma", "se", "enquanto"};
+
+    std::cout << "Profundidade: " << depth << std::endl;
+    std::cout << "aninhamento        nos   parser (s)  semantica (s)  execucao (s)" << std::endl;
+
+    for (const char* kind : kinds) {
+        NestingRun run;
+        if (!timeNesting<Parser, SemanticAnalyzer, Interpreter>(nestedProgram(kind, depth), run)) {
+            std::cout << "ERRO (" << kind << "): " << run.error << std::endl;
+            return false;
+        }
+        std::cout << std::left << std::setw(12) << kind << std::right << std::setw(11) << run.ast.size()
+                  << std::fixed << std::setprecision(4) << std::setw(13) << run.parse
+                  << std::setw(15) << run.semantic << std::setw(14) << run.execution << std::endl;
+    }
+
+    int shallow = std::min(depth, REFERENCE_DEPTH);
+    int copies = std::max(depth / shallow, 1);
+    std::cout << std::endl << "Pilha explicita x recursao (referencia): profundidade " << shallow << ", "
+              << copies << " copias" << std::endl;
+    std::cout << "aninhamento        nos  parser (s)      recursivo  semantica (s)   recursivo  execucao (s)    recursivo"
+              << std::endl;
+
+    for (const char* kind : kinds) {
+        std::string program = nestedProgram(kind, shallow, copies);
+        NestingRun iterative, recursive;
+        if (!timeNesting<Parser, SemanticAnalyzer, Interpreter>(program, iterative)) {
+            std::cout << "ERRO (" << kind << "): " << iterative.error << std::endl;
+            return false;
+        }
+        if (!timeNesting<ReferenceParser, ReferenceChecker, ReferenceEvaluator>(program, recursive)) {
+            std::cout << "ERRO (" << kind << ", recursivo): " << recursive.error << std::endl;
+            return false;
+        }
+        if (!sameAST(iterative.ast, recursive.ast)) {
+            std::cout << "ERRO (" << kind << "): os percursos recursivos produziram outra AST" << std::endl;
+            return false;
+        }
+        std::cout << std::left << std::setw(12) << kind << std::right << std::setw(11) << iterative.ast.size()
+                  << std::fixed << std::setprecision(4) << std::setw(12) << iterative.parse
+                  << std::setw(15) << recursive.parse << std::setw(15) << iterative.semantic
+                  << std::setw(12) << recursive.semantic << std::setw(14) << iterative.execution
+                  << std::setw(13) << recursive.execution << std::endl;
+    }
+    return true;
+}
+
+// Partida a frio de um programa: compilar do zero contra carregar o cache.
+// O tempo de referência é só abrir a fonte e calcular o hash do conteúdo,
+// que o cache precisa fazer de qualquer jeito.
+bool benchmarkCache(const std::string& filename) {
+    std::string cacheFile = ProgramCache::pathFor(filename);
+    SourceBuffer source; // a AST compilada aponta para este buffer
+    if (!source.open(filename) || source.empty()) {
+        std::cout << "Erro: Nao foi possível ler o arquivo '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    double openTime = 0, compileTime = 0, storeTime = 0, loadTime = 0;
+    AST compiled;
+    for (int i = 0; i < BENCH_REPETITIONS; i++) {
+        auto start = BenchClock::now();
+        SourceBuffer reopened;
+        if (!reopened.open(filename)) {
+            return false;
+        }
+        volatile uint64_t hash = ProgramCache::hashSource(reopened.view());
+        (void)hash;
+        double opened = secondsSince(start);
+
+        start = BenchClock::now();
+        StringPool pool;
+        Lexer lexer(source.view(), pool);
+        Parser parser(lexer);
+        compiled = parser.parse();
+        SymbolTable symbols;
+        SemanticAnalyzer semantic(symbols);
+        DefiniteAssignment initialization;
+        if (parser.hasError() || compiled.empty() || !semantic.analyze(compiled) ||
+            !initialization.analyze(compiled)) {
+            std::cout << "ERRO: "
+                      << (parser.hasError() ? parser.getError()
+                          : semantic.hasError() ? semantic.getError() : initialization.getError())
+                      << std::endl;
+            return false;
+        }
+        double compiledTime = secondsSince(start);
+
+        start = BenchClock::now();
+        if (!ProgramCache::store(cacheFile, source.view(), compiled, symbols, pool)) {
+            std::cout << "Erro: Nao foi possível gravar '" << cacheFile << "'" << std::endl;
+            return false;
+        }
+        double stored = secondsSince(start);
+
+        if (i == 0 || opened < openTime) openTime = opened;
+        if (i == 0 || compiledTime < compileTime) compileTime = compiledTime;
+        if (i == 0 || stored < storeTime) storeTime = stored;
+    }
+
+    // Carga completa, como em compileAndRun: abrir a fonte, conferir o hash e
+    // reconstruir a AST e a tabela de símbolos
+    for (int i = 0; i < BENCH_REPETITIONS; i++) {
+        auto start = BenchClock::now();
+        SourceBuffer reopened;
+        AST ast;
+        SymbolTable symbols;
+        StringPool pool;
+        bool loaded = reopened.open(filename) && ProgramCache::load(cacheFile, reopened.view(), ast, symbols, pool);
+        double elapsed = secondsSince(start);
+        if (!loaded || !sameAST(ast, compiled)) {
+            std::cout << "ERRO: o programa carregado do cache difere do compilado" << std::endl;
+            return false;
+        }
+        if (i == 0 || elapsed < loadTime) loadTime = elapsed;
+    }
+
+    SourceBuffer cached;
+    double cacheSize = cached.open(cacheFile) ? static_cast<double>(cached.view().size()) : 0;
+    std::cout << "Arquivo: " << filename << " (" << compiled.size() << " nos)" << std::endl;
+    std::cout << std::fixed << std::setprecision(1) << "cache: " << cacheSize / (1024 * 1024) << " MB, "
+              << cacheSize / static_cast<double>(source.view().size()) << " vezes a fonte" << std::endl;
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "abrir a fonte + hash:            " << openTime << " s" << std::endl;
+    std::cout << "compilar (lexer+parser+semantica): " << compileTime << " s" << std::endl;
+    std::cout << "gravar o cache:                  " << storeTime << " s" << std::endl;
+    std::cout << "carregar do cache:               " << loadTime << " s" << std::endl;
+    return true;
+}
+
+// Laço com 'iterations' voltas ao todo: cada 'enquanto' roda no máximo
+// LOOP_CHUNK vezes, abaixo da proteção contra loop infinito do interpretador
+static const int LOOP_CHUNK = 50000;
+
+static std::string loopProgram(const std::string& kind, int iterations) {
+    int outer = std::max(1, iterations / LOOP_CHUNK);
+    int inner = std::min(iterations, LOOP_CHUNK);
+    std::string body;
+    if (kind == "aritmetica") {
+        // a metade a cada volta: 's' nunca estoura, com qualquer número de voltas
+        body = "      s := (s + i * 3 - i / 7 + (i - j) * 2) / 2;\n";
+    } else if (kind == "condicoes") {
+        body = "      se (i / 2 * 2 = i) entao s := s + 1; senao s := s - 1; fim_se;\n";
+    } else { // logicos
+        body = "      p := i < j + 100;\n"
+               "      se p entao s := s + 1; fim_se;\n";
+    }
+    return "programa laco;\n"
+           "var i, j, s : inteiro; p : logico;\n"
+           "inicio\n"
+           "  s := 0;\n"
+           "  j := 0;\n"
+           "  enquanto (j < " + std::to_string(outer) + ") faca\n"
+           "    i := 0;\n"
+           "    enquanto (i < " + std::to_string(inner) + ") faca\n" +
+           body +
+           "      i := i + 1;\n"
+           "    fim_enquanto;\n"
+           "    j := j + 1;\n"
+           "  fim_enquanto\n"
+           "  escrever(s);\n"
+           "fim.\n";
+}
+
+// Melhor tempo de BENCH_REPETITIONS execuções de 'ast'; negativo com erro
+static double timeExecution(const AST& ast, const std::vector<SymbolType>& slotTypes, const char* kind) {
+    double best = 0;
+    for (int i = 0; i < BENCH_REPETITIONS; i++) {
+        Interpreter interpreter(slotTypes);
+        std::ostringstream output; // o 'escrever' do programa nao entra na tabela
+        std::streambuf* saved = std::cout.rdbuf(output.rdbuf());
+        auto start = BenchClock::now();
+        bool executed = interpreter.execute(ast);
+        double elapsed = secondsSince(start);
+        std::cout.rdbuf(saved);
+        if (!executed) {
+            std::cout << "ERRO (" << kind << "): " << interpreter.getError() << std::endl;
+            return -1;
+        }
+        if (i == 0 || elapsed < best) best = elapsed;
+    }
+    return best;
+}
+
+// Tempo de execução (sem o front end) de laços dominados por expressões
+// aritméticas, condições e variáveis lógicas: com todas as contas testadas e
+// depois da RangeAnalysis, que tira os testes das contas provadas
+bool benchmarkExecution(int iterations) {
+    const char* kinds[] = {"aritmetica", "condicoes", "logicos"};
+
+    std::cout << "Iteracoes: " << iterations << std::endl;
+    std::cout << "laco          execucao (s)  ns/iteracao  com faixas (s)  ns/iteracao" << std::endl;
+
+    for (const char* kind : kinds) {
+        std::string program = loopProgram(kind, iterations);
+        StringPool pool;
+        Lexer lexer(program, pool);
+        Parser parser(lexer);
+        AST ast = parser.parse();
+        SymbolTable symbols;
+        SemanticAnalyzer semantic(symbols);
+        DefiniteAssignment initialization;
+        if (ast.empty() || !semantic.analyze(ast) || !initialization.analyze(ast)) {
+            std::cout << "ERRO (" << kind << "): "
+                      << (parser.hasError() ? parser.getError()
+                          : semantic.hasError() ? semantic.getError() : initialization.getError())
+                      << std::endl;
+            return false;
+        }
+        SlotResolver resolver;
+        resolver.resolve(ast, symbols);
+
+        double checked = timeExecution(ast, resolver.slotTypes(), kind);
+        RangeAnalysis ranges;
+        ranges.analyze(ast, resolver.slotTypes());
+        double proven = checked < 0 ? -1 : timeExecution(ast, resolver.slotTypes(), kind);
+        if (proven < 0) {
+            return false;
+        }
+        int loops = std::max(1, iterations / LOOP_CHUNK) * std::min(iterations, LOOP_CHUNK);
+        std::cout << std::left << std::setw(12) << kind << std::right << std::fixed
+                  << std::setprecision(3) << std::setw(14) << checked << std::setprecision(1)
+                  << std::setw(13) << checked * 1e9 / loops << std::setprecision(3) << std::setw(16) << proven
+                  << std::setprecision(1) << std::setw(13) << proven * 1e9 / loops << std::endl;
+    }
+    return true;
+}
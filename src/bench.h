@@ -0,0 +1,13 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <string>
+
+// Medições de desempenho usadas pelos comandos 'bench-*' do fortall
+bool benchmarkLexer(const std::string& filename);
+bool benchmarkFrontEnd(const std::string& filename);
+bool benchmarkNesting(int depth);
+bool benchmarkCache(const std::string& filename);
+bool benchmarkExecution(int iterations);
+
+#endif
@@ -0,0 +1,545 @@
+#include "common_subexpressions.h"
+#include <algorithm>
+
+// Acima disso as listas de variáveis gravadas por 'se'/'enquanto' nao cabem
+// com folga na memória (aninhamentos enormes que gravam muitas variáveis):
+// a árvore fica como está
+static const size_t MAX_WRITTEN_ENTRIES = size_t(1) << 24;
+
+static const uint32_t NO_VALUE = UINT32_MAX;
+
+// Tipos de chave; cada versão de variável e cada folha desconhecida ganham
+// um número sem passar pela tabela
+enum : uint32_t { KEY_CONSTANT, KEY_OPERATOR };
+
+static bool isExpression(NodeType type) {
+    return type == NodeType::BINARIO || type == NodeType::UNARIO || type == NodeType::IDENTIFICADOR ||
+           type == NodeType::NUMERO || type == NodeType::LITERAL || type == NodeType::STRING_LITERAL;
+}
+
+static bool isCommutative(TokenType op) {
+    return op == TokenType::MAIS || op == TokenType::MULTIPLICACAO || op == TokenType::IGUAL ||
+           op == TokenType::DIFERENTE;
+}
+
+bool CommonSubexpressions::ValueKey::operator==(const ValueKey& other) const {
+    return kind == other.kind && left == other.left && right == other.right;
+}
+
+size_t CommonSubexpressions::ValueKeyHash::operator()(const ValueKey& key) const {
+    size_t h = key.kind;
+    h = h * 0x9e3779b97f4a7c15ULL + key.left;
+    h = h * 0x9e3779b97f4a7c15ULL + key.right;
+    return h ^ (h >> 29);
+}
+
+AST CommonSubexpressions::optimize(const AST& ast, const std::vector<SymbolType>& slotTypes,
+                                   size_t programVariables) {
+    types = slotTypes;
+    variables = programVariables;
+    firstTemporary = slotTypes.size();
+    stats = Stats();
+    if (ast.empty()) {
+        return AST();
+    }
+
+    source = &ast;
+    AST optimized = collectWrites() ? (analyze(), rebuild()) : ast;
+
+    writtenBegin.clear();
+    writtenEnd.clear();
+    written.clear();
+    values.clear();
+    operatorCounts.clear();
+    safe.clear();
+    sourceOf.clear();
+    uses.clear();
+    temporaryOf.clear();
+    numbers.clear();
+    holders.clear();
+    undo.clear();
+    versions.clear();
+    versionValues.clear();
+    saved.clear();
+    return optimized;
+}
+
+// Variáveis gravadas em cada 'se' e 'enquanto', blocos de dentro inclusive.
+// Os slots gravados vao para um registro; ao fechar um bloco o trecho dele
+// perde as repetições e fica como a lista do bloco, e o bloco de fora percorre
+// só a lista resumida. False se as listas passarem do limite.
+bool CommonSubexpressions::collectWrites() {
+    const AST& tree = *source;
+    writtenBegin.assign(tree.size(), 0);
+    writtenEnd.assign(tree.size(), 0);
+    written.clear();
+
+    struct Pending {
+        NodeId node;
+        uint32_t mark;
+        bool leave;
+    };
+    std::vector<Pending> stack{{tree.root, 0, false}};
+    std::vector<uint32_t> log;
+    std::vector<NodeId> stamp(types.size(), NO_NODE); // último bloco que listou o slot
+    while (!stack.empty()) {
+        Pending visit = stack.back();
+        stack.pop_back();
+        if (visit.leave) {
+            size_t end = visit.mark;
+            for (size_t i = visit.mark; i < log.size(); i++) {
+                if (stamp[log[i]] != visit.node) {
+                    stamp[log[i]] = visit.node;
+                    log[end++] = log[i];
+                }
+            }
+            log.resize(end);
+            writtenBegin[visit.node] = static_cast<uint32_t>(written.size());
+            written.insert(written.end(), log.begin() + visit.mark, log.end());
+            writtenEnd[visit.node] = static_cast<uint32_t>(written.size());
+            if (written.size() > MAX_WRITTEN_ENTRIES) {
+                return false;
+            }
+            continue;
+        }
+
+        const ASTNode& node = tree[visit.node];
+        ChildRange children = tree.children(visit.node);
+        switch (node.type) {
+            case NodeType::PROGRAMA:
+            case NodeType::LISTA_COMANDOS:
+                for (size_t i = children.size(); i-- > 0;) {
+                    stack.push_back({children[i], 0, false});
+                }
+                break;
+            case NodeType::ATRIBUICAO:
+                if (!children.empty() && tree[children[0]].slot != NO_SLOT) {
+                    log.push_back(tree[children[0]].slot);
+                }
+                break;
+            case NodeType::LER:
+                for (NodeId target : children) {
+                    if (tree[target].slot != NO_SLOT) log.push_back(tree[target].slot);
+                }
+                break;
+            case NodeType::SE:
+            case NodeType::ENQUANTO:
+                stack.push_back({visit.node, static_cast<uint32_t>(log.size()), true});
+                for (size_t i = children.size(); i-- > 1;) {
+                    stack.push_back({children[i], 0, false});
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+// Percorre os comandos na ordem de execução, numerando as expressões e
+// anotando cada ocorrência cujo valor já está disponível
+void CommonSubexpressions::analyze() {
+    const AST& tree = *source;
+    values.assign(tree.size(), NO_VALUE);
+    operatorCounts.assign(tree.size(), 0);
+    safe.assign(tree.size(), 0);
+    sourceOf.assign(tree.size(), NO_NODE);
+    uses.assign(tree.size(), 0);
+    // Versões distintas para os valores iniciais de cada variável
+    versions.resize(types.size());
+    for (uint32_t slot = 0; slot < versions.size(); slot++) {
+        versions[slot] = slot;
+    }
+    nextVersion = static_cast<uint32_t>(types.size());
+    versionValues.clear();
+    numbers.clear();
+    numbers.reserve(tree.size() / 2);
+    holders.clear();
+    undo.clear();
+    saved.clear();
+
+    visits.clear();
+    visits.push_back({tree.root, Step::ENTER, 0, 0});
+    while (!visits.empty()) {
+        Visit visit = visits.back();
+        visits.pop_back();
+        const ASTNode& node = tree[visit.node];
+        ChildRange children = tree.children(visit.node);
+
+        switch (visit.step) {
+            case Step::THEN_DONE: {
+                closeScope(visit.scope);
+                const uint32_t* slot = written.data() + writtenBegin[visit.node];
+                for (size_t i = visit.saved; i < saved.size(); i++) {
+                    versions[*slot++] = saved[i];
+                }
+                continue;
+            }
+            case Step::IF_DONE:
+                closeScope(visit.scope);
+                saved.resize(visit.saved);
+                renew(visit.node);
+                continue;
+            case Step::LOOP_DONE:
+                closeScope(visit.scope);
+                renew(visit.node); // a saída vem da cabeça, de qualquer volta
+                continue;
+            case Step::ENTER:
+                break;
+        }
+
+        switch (node.type) {
+            case NodeType::PROGRAMA:
+            case NodeType::LISTA_COMANDOS:
+                for (size_t i = children.size(); i-- > 0;) {
+                    visits.push_back({children[i], Step::ENTER, 0, 0});
+                }
+                break;
+            case NodeType::ATRIBUICAO: {
+                if (children.size() < 2) break;
+                uint32_t slot = tree[children[0]].slot;
+                bool program = slot == NO_SLOT || slot < variables;
+                NodeId value = children[1];
+                analyzeExpression(value, program);
+                if (slot == NO_SLOT) break;
+                versions[slot] = nextVersion++;
+                // Se o comando terminou, a expressão nao falhou: 'v' guarda o
+                // valor dela, sem temporária
+                if (program && expressionOperands(tree[value]) > 0 && sourceOf[value] == NO_NODE) {
+                    setHolder(values[value], {visit.node, slot, versions[slot]});
+                }
+                break;
+            }
+            case NodeType::LER:
+                for (NodeId target : children) {
+                    if (tree[target].slot != NO_SLOT) versions[tree[target].slot] = nextVersion++;
+                }
+                break;
+            case NodeType::ESCREVER:
+                for (NodeId child : children) {
+                    if (tree[child].type != NodeType::STRING_LITERAL) analyzeExpression(child, true);
+                }
+                break;
+            case NodeType::SE: {
+                if (children.empty()) break;
+                analyzeExpression(children[0], false);
+                uint32_t scope = static_cast<uint32_t>(undo.size());
+                uint32_t mark = static_cast<uint32_t>(saved.size());
+                for (uint32_t i = writtenBegin[visit.node]; i < writtenEnd[visit.node]; i++) {
+                    saved.push_back(versions[written[i]]);
+                }
+                visits.push_back({visit.node, Step::IF_DONE, scope, mark});
+                if (children.size() > 2) {
+                    visits.push_back({children[2], Step::ENTER, 0, 0});
+                    visits.push_back({visit.node, Step::THEN_DONE, scope, mark});
+                }
+                if (children.size() > 1) visits.push_back({children[1], Step::ENTER, 0, 0});
+                break;
+            }
+            case NodeType::ENQUANTO:
+                if (children.empty()) break;
+                renew(visit.node); // a cabeça junta a entrada e a volta anterior
+                analyzeExpression(children[0], false);
+                visits.push_back({visit.node, Step::LOOP_DONE, static_cast<uint32_t>(undo.size()), 0});
+                if (children.size() > 1) visits.push_back({children[1], Step::ENTER, 0, 0});
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// Numera a expressão e procura, de cima para baixo, as maiores subexpressões
+// com valor disponível; com 'define', as que nao podem falhar passam a ser a
+// origem do valor delas para os comandos seguintes (na ordem de avaliação,
+// entao o operando direito já vê o esquerdo)
+void CommonSubexpressions::analyzeExpression(NodeId root, bool define) {
+    const AST& tree = *source;
+    if (expressionOperands(tree[root]) == 0) {
+        return;
+    }
+    foldExpression(tree, root, numbering, [this](const ASTNode& node, const Numbered* operands) {
+        return number(node, operands);
+    });
+
+    search.clear();
+    search.push_back({root, false});
+    while (!search.empty()) {
+        auto [id, leave] = search.back();
+        search.pop_back();
+        if (leave) {
+            if (define && safe[id] && !available(values[id])) {
+                setHolder(values[id], {id, NO_SLOT, 0});
+            }
+            continue;
+        }
+        const ASTNode& node = tree[id];
+        uint32_t count = expressionOperands(node);
+        if (count == 0) continue;
+        uint32_t value = values[id];
+        if (available(value)) {
+            const Holder& holder = holders[value];
+            sourceOf[id] = holder.node;
+            if (holder.slot == NO_SLOT) uses[holder.node]++;
+            continue;
+        }
+        search.push_back({id, true});
+        for (uint32_t i = count; i-- > 0;) {
+            search.push_back({tree.child(id, i), false});
+        }
+    }
+}
+
+CommonSubexpressions::Numbered CommonSubexpressions::number(const ASTNode& node, const Numbered* operands) {
+    NodeId id = static_cast<NodeId>(&node - source->nodes.data());
+    Numbered result;
+    if (!operands) {
+        switch (node.type) {
+            case NodeType::NUMERO:
+            case NodeType::LITERAL:
+                result = {valueOf({KEY_CONSTANT, static_cast<uint32_t>(node.value), 0}), 0, true};
+                break;
+            case NodeType::IDENTIFICADOR:
+                if (node.slot != NO_SLOT) {
+                    uint32_t version = versions[node.slot];
+                    if (version >= versionValues.size()) {
+                        versionValues.resize(std::max<size_t>(version + 1, versionValues.size() * 2), NO_VALUE);
+                    }
+                    if (versionValues[version] == NO_VALUE) {
+                        versionValues[version] = newValue();
+                    }
+                    result = {versionValues[version], 0, node.assigned};
+                    break;
+                }
+                result = {newValue(), 0, false};
+                break;
+            default:
+                result = {newValue(), 0, false};
+                break;
+        }
+    } else {
+        uint32_t left = operands[0].value;
+        uint32_t right = NO_VALUE;
+        result.operators = operands[0].operators + 1;
+        result.safe = operands[0].safe;
+        if (expressionOperands(node) > 1) {
+            right = operands[1].value;
+            result.operators += operands[1].operators;
+            result.safe = result.safe && operands[1].safe;
+            if (isCommutative(node.token.type) && right < left) {
+                std::swap(left, right);
+            }
+        }
+        if ((mayOverflow(node) || node.token.type == TokenType::DIVISAO) && !node.proven) {
+            result.safe = false; // a RangeAnalysis nao descartou o estouro ou o divisor
+        }
+        uint32_t kind = KEY_OPERATOR + (static_cast<uint32_t>(node.type) << 8 | static_cast<uint32_t>(node.token.type));
+        result.value = valueOf({kind, left, right});
+    }
+    values[id] = result.value;
+    operatorCounts[id] = result.operators;
+    safe[id] = result.safe;
+    return result;
+}
+
+uint32_t CommonSubexpressions::valueOf(const ValueKey& key) {
+    auto inserted = numbers.emplace(key, static_cast<uint32_t>(holders.size()));
+    if (inserted.second) {
+        holders.push_back({NO_NODE, NO_SLOT, 0});
+    }
+    return inserted.first->second;
+}
+
+uint32_t CommonSubexpressions::newValue() {
+    holders.push_back({NO_NODE, NO_SLOT, 0});
+    return static_cast<uint32_t>(holders.size() - 1);
+}
+
+bool CommonSubexpressions::available(uint32_t value) const {
+    const Holder& holder = holders[value];
+    return holder.node != NO_NODE && (holder.slot == NO_SLOT || versions[holder.slot] == holder.version);
+}
+
+void CommonSubexpressions::setHolder(uint32_t value, const Holder& holder) {
+    undo.push_back({value, holders[value]});
+    holders[value] = holder;
+}
+
+// Fecha um bloco: os valores calculados nele deixam de estar disponíveis
+void CommonSubexpressions::closeScope(uint32_t scope) {
+    while (undo.size() > scope) {
+        holders[undo.back().first] = undo.back().second;
+        undo.pop_back();
+    }
+}
+
+// Versões novas para as variáveis gravadas no 'se'/'enquanto'
+void CommonSubexpressions::renew(NodeId compound) {
+    for (uint32_t i = writtenBegin[compound]; i < writtenEnd[compound]; i++) {
+        versions[written[i]] = nextVersion++;
+    }
+}
+
+// Reconstrói a árvore em pós-ordem, com pilha explícita, trocando as
+// ocorrências repetidas por leituras
+AST CommonSubexpressions::rebuild() {
+    const AST& tree = *source;
+    result = AST();
+    result.nodes.reserve(tree.nodes.size());
+    result.childIds.reserve(tree.childIds.size());
+    temporaryOf.assign(tree.size(), NO_SLOT);
+    frames.clear();
+    pending.clear();
+
+    frames.push_back({tree.root, 0, tree[tree.root].childCount, 0});
+    while (!frames.empty()) {
+        Frame& frame = frames.back();
+        if (frame.next < frame.end) {
+            NodeId child = tree.child(frame.node, frame.next++);
+            enter(child, frame.node); // pode empilhar um quadro
+            continue;
+        }
+        Frame done = frame;
+        frames.pop_back();
+        NodeId copy = copyNode(tree[done.node], pending.data() + done.mark, pending.size() - done.mark);
+        pending.resize(done.mark);
+        pending.push_back(copy);
+    }
+    result.root = pending.back();
+    return std::move(result);
+}
+
+void CommonSubexpressions::enter(NodeId id, NodeId owner) {
+    const AST& tree = *source;
+    const ASTNode& node = tree[id];
+    if (isExpression(node.type)) {
+        pending.push_back(copyExpression(id)); // condição: só leituras, nada antes
+        return;
+    }
+
+    switch (node.type) {
+        case NodeType::ATRIBUICAO:
+        case NodeType::LER:
+        case NodeType::ESCREVER: {
+            size_t mark = pending.size();
+            for (NodeId child : tree.children(id)) {
+                pending.push_back(copyExpression(child));
+            }
+            NodeId copy = copyNode(node, pending.data() + mark, pending.size() - mark);
+            pending.resize(mark);
+            if (before.empty()) {
+                pending.push_back(copy);
+                return;
+            }
+            // As temporárias do comando sao calculadas logo antes dele; no
+            // lugar de um bloco do 'se'/'enquanto' fica uma lista
+            pending.insert(pending.end(), before.begin(), before.end());
+            pending.push_back(copy);
+            before.clear();
+            NodeType context = tree[owner].type;
+            if (context == NodeType::SE || context == NodeType::ENQUANTO) {
+                NodeId list = result.addNode(NodeType::LISTA_COMANDOS, Token(), pending.data() + mark,
+                                             pending.size() - mark);
+                pending.resize(mark);
+                pending.push_back(list);
+            }
+            return;
+        }
+        default:
+            break;
+    }
+    frames.push_back({id, 0, node.childCount, pending.size()});
+}
+
+// Copia uma expressão trocando cada ocorrência repetida pela variável ou
+// temporária que já tem o valor. A primeira ocorrência de um valor lido pelo
+// menos uma vez (e que poupa pelo menos dois operadores) vai para uma
+// temporária nova, calculada em 'before'.
+NodeId CommonSubexpressions::copyExpression(NodeId root) {
+    const AST& tree = *source;
+    size_t base = operands.size();
+    auto enterExpression = [&](NodeId id) {
+        const ASTNode& node = tree[id];
+        NodeId from = sourceOf[id];
+        if (from != NO_NODE && tree[from].type == NodeType::ATRIBUICAO) {
+            const ASTNode& target = tree[tree.child(from, 0)];
+            operands.push_back(read(target.slot, target.token.value, node.token));
+            stats.variableReads++;
+            stats.savedOperators += operatorCounts[id];
+            return;
+        }
+        if (from != NO_NODE && temporaryOf[from] != NO_SLOT) {
+            uint32_t slot = temporaryOf[from];
+            operands.push_back(read(slot, names[slot - firstTemporary], node.token));
+            stats.temporaryReads++;
+            stats.savedOperators += operatorCounts[id];
+            return;
+        }
+        if (expressionOperands(node) == 0) {
+            operands.push_back(copyNode(node));
+            return;
+        }
+        expressionFrames.push_back({id, 0, operands.size()});
+    };
+
+    enterExpression(root);
+    while (!expressionFrames.empty()) {
+        ExpressionFrame& frame = expressionFrames.back();
+        if (frame.next < expressionOperands(tree[frame.node])) {
+            NodeId child = tree.child(frame.node, frame.next++);
+            enterExpression(child);
+            continue;
+        }
+        ExpressionFrame done = frame;
+        expressionFrames.pop_back();
+        const ASTNode& node = tree[done.node];
+        NodeId copy = copyNode(node, operands.data() + done.mark, operands.size() - done.mark);
+        operands.resize(done.mark);
+        if (uses[done.node] > 0 && uses[done.node] * operatorCounts[done.node] >= 2) {
+            uint32_t slot = newTemporary(node.valueType);
+            NodeId children[2] = {read(slot, names.back(), node.token), copy};
+            result[children[0]].assigned = false;
+            before.push_back(result.addNode(NodeType::ATRIBUICAO, Token(), children, 2));
+            temporaryOf[done.node] = slot;
+            copy = read(slot, names.back(), node.token);
+            stats.temporaries++;
+        }
+        operands.push_back(copy);
+    }
+    NodeId copy = operands.back();
+    operands.resize(base);
+    return copy;
+}
+
+// Temporárias continuam a numeração das do LoopOptimizer ($t0, $t1, ...)
+uint32_t CommonSubexpressions::newTemporary(SymbolType type) {
+    uint32_t slot = static_cast<uint32_t>(types.size());
+    types.push_back(type);
+    names.push_back("$t" + std::to_string(slot - variables));
+    return slot;
+}
+
+// Leitura da variável 'slot', gravada em todos os caminhos até aqui, na linha
+// e coluna de 'position'
+NodeId CommonSubexpressions::read(uint32_t slot, std::string_view name, const Token& position) {
+    Token token(TokenType::IDENTIFICADOR, name, position.line, position.column);
+    NodeId id = result.addNode(NodeType::IDENTIFICADOR, token);
+    result[id].valueType = types[slot];
+    result[id].slot = slot;
+    result[id].assigned = true;
+    return id;
+}
+
+NodeId CommonSubexpressions::copyNode(const ASTNode& node, const NodeId* children, size_t count) {
+    NodeId id = result.addNode(node.type, node.token, children, count);
+    ASTNode& copy = result[id];
+    copy.valueType = node.valueType;
+    copy.assigned = node.assigned;
+    copy.proven = node.proven;
+    if (node.type == NodeType::IDENTIFICADOR) {
+        copy.slot = node.slot;
+    } else {
+        copy.value = node.value;
+    }
+    return id;
+}
@@ -0,0 +1,162 @@
+#ifndef COMMON_SUBEXPRESSIONS_H
+#define COMMON_SUBEXPRESSIONS_H
+
+#include "ast.h"
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Eliminação de subexpressões comuns por numeração de valores, depois do
+// LoopOptimizer. Cada subexpressão recebe um número de valor: o mesmo para o
+// mesmo operador sobre os mesmos números (+, *, = e <> em qualquer ordem), e
+// cada gravação de uma variável (atribuição, ler) dá a ela uma versão nova.
+// Os números seguem a ordem de execução: os dois lados de um 'se' partem das
+// versões de antes dele, e as variáveis gravadas num 'enquanto' ganham versões
+// novas na cabeça do laço (o valor pode vir da volta anterior) e na saída.
+//
+// Um valor calculado num comando que sempre roda antes (no mesmo bloco ou num
+// bloco de fora) nao é calculado de novo:
+// - depois de 'v := expressão', enquanto 'v' nao mudar, a expressão vira uma
+//   leitura de 'v';
+// - senao a primeira ocorrência é calculada numa temporária ($t...) logo antes
+//   do comando dela, e as seguintes leem a temporária. A temporária custa uma
+//   atribuição: ela só é criada quando poupa pelo menos dois operadores.
+//
+// A temporária roda antes do resto do comando, entao só a recebe o que nao
+// pode falhar: contas e divisões provadas pela RangeAnalysis e variáveis
+// inicializadas em todos os caminhos. A primeira ocorrência fica numa
+// atribuição ou num 'escrever' do programa: as contas que o LoopOptimizer
+// calcula antes de um laço (temporárias dele e condições desdobradas) podem
+// dar a volta do inteiro fora do laço, e só leem valores já calculados. A
+// condição de um 'enquanto' roda a cada volta e também só lê.
+class CommonSubexpressions {
+public:
+    struct Stats {
+        size_t temporaries = 0;    // subexpressões calculadas uma vez numa temporária
+        size_t temporaryReads = 0; // ocorrências trocadas pela leitura de uma temporária
+        size_t variableReads = 0;  // ocorrências trocadas pela variável que já tem o valor
+        size_t savedOperators = 0; // operadores que saíram dessas ocorrências
+    };
+
+private:
+    // Chave de um número de valor na tabela: constante ou operador sobre os
+    // números dos operandos (as versões de variável sao numeradas à parte)
+    struct ValueKey {
+        uint32_t kind;
+        uint32_t left;
+        uint32_t right;
+        bool operator==(const ValueKey& other) const;
+    };
+    struct ValueKeyHash {
+        size_t operator()(const ValueKey& key) const;
+    };
+
+    // Onde um valor já calculado está: na ocorrência 'node' (que vira
+    // temporária), ou na variável 'slot' gravada pela atribuição 'node'
+    // enquanto ela tiver a versão 'version'
+    struct Holder {
+        NodeId node;
+        uint32_t slot;
+        uint32_t version;
+    };
+
+    // Resultado da numeração de baixo para cima
+    struct Numbered {
+        uint32_t value;
+        uint32_t operators;
+        bool safe; // nao pode falhar na execução
+    };
+
+    enum class Step : uint8_t {
+        ENTER,     // comando a analisar
+        THEN_DONE, // fim do 'entao': o 'senao' parte das versões de antes do 'se'
+        IF_DONE,   // fim do 'se'
+        LOOP_DONE  // fim do corpo do 'enquanto'
+    };
+    struct Visit {
+        NodeId node;
+        Step step;
+        uint32_t scope; // tamanho de 'undo' na abertura do bloco
+        uint32_t saved; // início das versões guardadas em 'saved'
+    };
+
+    struct Frame {
+        NodeId node;
+        uint32_t next;
+        uint32_t end;
+        size_t mark;
+    };
+    struct ExpressionFrame {
+        NodeId node;
+        uint32_t next;
+        size_t mark;
+    };
+
+    const AST* source;
+    AST result;
+    std::vector<SymbolType> types;
+    size_t variables = 0;      // slots do programa; depois vêm as temporárias
+    size_t firstTemporary = 0; // primeira temporária desta passada
+    Stats stats;
+    std::deque<std::string> names; // nomes das temporárias desta passada, por slot
+
+    // Variáveis gravadas em cada 'se'/'enquanto' (sem repetição), em 'written'
+    std::vector<uint32_t> writtenBegin;
+    std::vector<uint32_t> writtenEnd;
+    std::vector<uint32_t> written;
+
+    // Numeração, por nó de expressão analisado
+    std::vector<uint32_t> values;
+    std::vector<uint32_t> operatorCounts;
+    std::vector<uint8_t> safe;
+    std::vector<NodeId> sourceOf;  // ocorrência repetida -> onde o valor está
+    std::vector<uint32_t> uses;    // primeira ocorrência -> leituras dela
+    std::vector<uint32_t> temporaryOf;
+
+    std::unordered_map<ValueKey, uint32_t, ValueKeyHash> numbers;
+    std::vector<Holder> holders;                           // por número de valor
+    std::vector<std::pair<uint32_t, Holder>> undo;         // para fechar os blocos
+    std::vector<uint32_t> versions;                        // por slot
+    std::vector<uint32_t> versionValues;                   // por versão: o número do valor
+    std::vector<uint32_t> saved;                           // versões de antes de cada 'se' aberto
+    uint32_t nextVersion = 0;
+
+    std::vector<Visit> visits;
+    std::vector<std::pair<NodeId, bool>> search; // (nó, volta depois dos operandos)
+    ExpressionStack<Numbered> numbering;
+    std::vector<Frame> frames;
+    std::vector<NodeId> pending;
+    std::vector<NodeId> before; // temporárias a calcular antes do comando em cópia
+    std::vector<ExpressionFrame> expressionFrames;
+    std::vector<NodeId> operands;
+
+    bool collectWrites();
+    void analyze();
+    void analyzeExpression(NodeId root, bool define);
+    Numbered number(const ASTNode& node, const Numbered* operands);
+    uint32_t valueOf(const ValueKey& key);
+    uint32_t newValue();
+    bool available(uint32_t value) const;
+    void setHolder(uint32_t value, const Holder& holder);
+    void closeScope(uint32_t scope);
+    void renew(NodeId compound);
+    AST rebuild();
+    void enter(NodeId id, NodeId owner);
+    NodeId copyExpression(NodeId root);
+    uint32_t newTemporary(SymbolType type);
+    NodeId read(uint32_t slot, std::string_view name, const Token& position);
+    NodeId copyNode(const ASTNode& node, const NodeId* children = nullptr, size_t count = 0);
+
+public:
+    // 'ast' é uma árvore do LoopOptimizer com os slots 'slotTypes'; os
+    // primeiros 'programVariables' sao as variáveis do programa e os outros
+    // temporárias dele. A árvore devolvida usa também os slots das
+    // temporárias novas (slotTypes()) e só vale enquanto este objeto existir.
+    AST optimize(const AST& ast, const std::vector<SymbolType>& slotTypes, size_t programVariables);
+
+    const std::vector<SymbolType>& slotTypes() const { return types; }
+    const Stats& eliminationStats() const { return stats; }
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "definite_assignment.h"
+#include <algorithm>
+
+bool DefiniteAssignment::analyze(AST& tree) {
+    ast = &tree;
+    errorMessage.clear();
+    firstError = {NO_NODE, 0};
+    if (tree.empty()) return true;
+
+    // Variáveis pelo id no StringPool, como na tabela de símbolos
+    uint32_t variables = 0;
+    for (const ASTNode& node : tree.nodes) {
+        if (node.type == NodeType::IDENTIFICADOR && node.token.symbol != NO_SYMBOL) {
+            variables = std::max(variables, node.token.symbol + 1);
+        }
+    }
+    assigned.assign(variables, 0);
+    possible.assign(variables, 0);
+    lastAssignment.assign(variables, 0);
+    merged.assign(variables, 0);
+    assignedLog.clear();
+    possibleLog.clear();
+    pending.clear();
+    frames.clear();
+    assignments = merges = loops = expressions = 0;
+    verdicts.assign(tree.size(), UNSEEN);
+    visited.assign(tree.size(), 0);
+
+    ChildRange parts = tree.children(tree.root);
+    for (const NodeId* slot = parts.begin(); slot != parts.end(); slot++) {
+        if (tree[*slot].type == NodeType::LISTA_COMANDOS) {
+            pushSequence(tree.root, slot, Part::LIST);
+            break;
+        }
+    }
+
+    // Pilha de sequências no lugar da recursão, como no interpretador
+    while (!frames.empty()) {
+        Frame& frame = frames.back();
+        if (frame.next < frame.count) {
+            analyzeCommand(frame.commands + frame.next++); // pode empilhar uma sequência
+            continue;
+        }
+        Frame done = frame;
+        frames.pop_back();
+        finishSequence(done);
+    }
+
+    // Um nó compartilhado (hash-consing) só dispensa o teste se todas as
+    // leituras dele dispensam
+    for (ASTNode& node : tree.nodes) {
+        if (node.type == NodeType::IDENTIFICADOR) {
+            node.assigned = verdicts[&node - tree.nodes.data()] == ALWAYS_ASSIGNED;
+        }
+    }
+
+    if (firstError.node != NO_NODE) {
+        errorMessage = "Erro semantico na linha " + std::to_string(firstError.line) + ": Variavel '" +
+                       std::string(tree[firstError.node].token.value) + "' nunca e inicializada antes de ser lida";
+        return false;
+    }
+    return true;
+}
+
+// Comandos de uma lista, ou o próprio comando em 'slot' se ele nao for lista
+// (como Interpreter::pushBlock). Os registros e as leituras adiadas até aqui
+// pertencem ao que veio antes.
+void DefiniteAssignment::pushSequence(NodeId owner, const NodeId* slot, Part part) {
+    const ASTNode& block = (*ast)[*slot];
+    Frame frame{slot, 0, 1, owner, part, assignedLog.size(), possibleLog.size(), 0, 0, assignments, pending.size()};
+    if (block.type == NodeType::LISTA_COMANDOS) {
+        frame.commands = ast->children(*slot).begin();
+        frame.count = block.childCount;
+    }
+    frames.push_back(frame);
+}
+
+void DefiniteAssignment::analyzeCommand(const NodeId* slot) {
+    NodeId command = *slot;
+    const ASTNode& node = (*ast)[command];
+    switch (node.type) {
+        case NodeType::ATRIBUICAO: {
+            if (node.childCount < 2) break;
+            const ASTNode& target = (*ast)[ast->child(command, 0)];
+            readExpression(ast->child(command, 1), target.token.line);
+            assign(target.token.symbol);
+            break;
+        }
+        case NodeType::LER:
+            for (NodeId target : ast->children(command)) {
+                assign((*ast)[target].token.symbol);
+            }
+            break;
+        case NodeType::ESCREVER:
+            for (NodeId value : ast->children(command)) {
+                if ((*ast)[value].type != NodeType::STRING_LITERAL) {
+                    readExpression(value, node.token.line);
+                }
+            }
+            break;
+        case NodeType::SE:
+            if (node.childCount < 2) break;
+            readExpression(ast->child(command, 0), node.token.line);
+            pushSequence(command, ast->children(command).begin() + 1, Part::THEN);
+            break;
+        case NodeType::ENQUANTO:
+            if (node.childCount < 2) break;
+            // A condição é lida de novo depois de cada volta: ela já é do laço
+            loops++;
+            pushSequence(command, ast->children(command).begin() + 1, Part::BODY);
+            readExpression(ast->child(command, 0), node.token.line);
+            break;
+        case NodeType::LISTA_COMANDOS:
+            pushSequence(command, slot, Part::LIST);
+            break;
+        default:
+            break;
+    }
+}
+
+void DefiniteAssignment::finishSequence(const Frame& done) {
+    switch (done.part) {
+        case Part::THEN: {
+            // O bloco 'senao' (ou o caminho sem ele) parte do estado de antes
+            // do 'se'; os registros do 'entao' ficam para a junção
+            for (size_t i = done.assignedMark; i < assignedLog.size(); i++) {
+                assigned[assignedLog[i]] = 0;
+            }
+            for (size_t i = done.possibleMark; i < possibleLog.size(); i++) {
+                possible[possibleLog[i]] = 0;
+            }
+            Frame branches = done;
+            branches.thenAssigned = assignedLog.size();
+            branches.thenPossible = possibleLog.size();
+            if ((*ast)[done.owner].childCount > 2) {
+                pushSequence(done.owner, ast->children(done.owner).begin() + 2, Part::ELSE);
+                Frame& elseFrame = frames.back();
+                elseFrame.assignedMark = branches.assignedMark;
+                elseFrame.possibleMark = branches.possibleMark;
+                elseFrame.thenAssigned = branches.thenAssigned;
+                elseFrame.thenPossible = branches.thenPossible;
+            } else {
+                mergeBranches(branches);
+            }
+            break;
+        }
+        case Part::ELSE:
+            mergeBranches(done);
+            break;
+        case Part::BODY:
+            finishLoop(done);
+            break;
+        case Part::LIST:
+            break;
+    }
+}
+
+// Depois do 'se': inicializada em todos os caminhos só se os dois blocos
+// inicializam, em algum caminho se um deles inicializa. Os registros ficam só
+// com as variáveis marcadas em relação a antes do 'se'.
+void DefiniteAssignment::mergeBranches(const Frame& frame) {
+    uint32_t stamp = ++merges;
+    for (size_t i = frame.assignedMark; i < frame.thenAssigned; i++) {
+        merged[assignedLog[i]] = stamp;
+    }
+    size_t kept = frame.assignedMark;
+    for (size_t i = frame.thenAssigned; i < assignedLog.size(); i++) {
+        uint32_t variable = assignedLog[i];
+        if (merged[variable] == stamp) {
+            assignedLog[kept++] = variable;
+        } else {
+            assigned[variable] = 0;
+        }
+    }
+    assignedLog.resize(kept);
+
+    kept = frame.possibleMark;
+    for (size_t i = frame.possibleMark; i < frame.thenPossible; i++) {
+        uint32_t variable = possibleLog[i];
+        if (!possible[variable]) { // o 'senao' ainda nao marcou
+            possible[variable] = 1;
+            possibleLog[kept++] = variable;
+        }
+    }
+    for (size_t i = frame.thenPossible; i < possibleLog.size(); i++) {
+        possibleLog[kept++] = possibleLog[i];
+    }
+    possibleLog.resize(kept);
+}
+
+// O corpo pode nao rodar: nada que ele inicializa vale em todos os caminhos
+// depois do laço. Uma leitura adiada se resolve se o corpo atribui à
+// variável (a volta seguinte passa pela atribuição); senão ela continua
+// adiada para o laço de fora, ou vira erro.
+void DefiniteAssignment::finishLoop(const Frame& frame) {
+    for (size_t i = frame.assignedMark; i < assignedLog.size(); i++) {
+        assigned[assignedLog[i]] = 0;
+    }
+    assignedLog.resize(frame.assignedMark);
+
+    size_t kept = frame.pendingMark;
+    for (size_t i = frame.pendingMark; i < pending.size(); i++) {
+        if (lastAssignment[(*ast)[pending[i].node].token.symbol] <= frame.loopStart) {
+            pending[kept++] = pending[i];
+        }
+    }
+    pending.resize(kept);
+
+    if (--loops == 0) {
+        for (const Read& read : pending) {
+            report(read);
+        }
+        pending.clear();
+    }
+}
+
+// Leituras de variáveis na expressão; um nó compartilhado é visto uma vez
+void DefiniteAssignment::readExpression(NodeId root, int line) {
+    uint32_t stamp = ++expressions;
+    expression.clear();
+    expression.push_back(root);
+    while (!expression.empty()) {
+        NodeId id = expression.back();
+        expression.pop_back();
+        if (visited[id] == stamp) continue;
+        visited[id] = stamp;
+
+        const ASTNode& node = (*ast)[id];
+        if (node.type != NodeType::IDENTIFICADOR) {
+            for (NodeId child : ast->children(id)) {
+                expression.push_back(child);
+            }
+            continue;
+        }
+        uint32_t variable = node.token.symbol;
+        if (variable >= assigned.size()) continue;
+        if (!assigned[variable]) {
+            verdicts[id] = CHECKED;
+        } else if (verdicts[id] == UNSEEN) {
+            verdicts[id] = ALWAYS_ASSIGNED;
+        }
+        if (!possible[variable]) {
+            Read read{id, line};
+            if (loops > 0) {
+                pending.push_back(read);
+            } else {
+                report(read);
+            }
+        }
+    }
+}
+
+void DefiniteAssignment::assign(uint32_t variable) {
+    if (variable >= assigned.size()) return;
+    lastAssignment[variable] = ++assignments;
+    if (!assigned[variable]) {
+        assigned[variable] = 1;
+        assignedLog.push_back(variable);
+    }
+    if (!possible[variable]) {
+        possible[variable] = 1;
+        possibleLog.push_back(variable);
+    }
+}
+
+// Guarda o erro da linha mais cedo: as leituras adiadas chegam depois
+void DefiniteAssignment::report(const Read& read) {
+    if (firstError.node == NO_NODE || read.line < firstError.line) {
+        firstError = read;
+    }
+}
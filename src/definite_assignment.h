@@ -0,0 +1,88 @@
+#ifndef DEFINITE_ASSIGNMENT_H
+#define DEFINITE_ASSIGNMENT_H
+
+#include "ast.h"
+#include <string>
+#include <vector>
+
+// Análise de atribuição definida, depois da análise semântica (que nao
+// conhece o fluxo do programa). Os comandos sao percorridos na ordem do
+// fluxo, com os dois lados de cada 'se' e o corpo de cada 'enquanto' rodando
+// zero ou mais vezes, e cada leitura de variável cai em um de três casos:
+//
+// - vem sempre depois de uma atribuição ou 'ler', em todos os caminhos: o nó
+//   IDENTIFICADOR é marcado ('assigned') e o interpretador lê o valor sem
+//   testar a inicialização;
+// - nenhum caminho inicializa a variável antes dela: erro de compilação;
+// - algum caminho inicializa e outro nao: o teste fica para a execução.
+//
+// A análise nao avalia condições: um 'se' constante conta com os dois lados.
+class DefiniteAssignment {
+private:
+    enum class Part : uint8_t { LIST, THEN, ELSE, BODY };
+
+    // Sequência de comandos em análise. Os estados nao sao copiados a cada
+    // bloco: as variáveis marcadas desde o início do comando dono ficam nos
+    // registros ('assignedLog', 'possibleLog') e sao desfeitas ou juntadas
+    // quando a sequência termina.
+    struct Frame {
+        const NodeId* commands;
+        uint32_t next;
+        uint32_t count;
+        NodeId owner;
+        Part part;
+        size_t assignedMark;   // registros anteriores ao 'se'/'enquanto'
+        size_t possibleMark;
+        size_t thenAssigned;   // ELSE: fim dos registros do bloco 'entao'
+        size_t thenPossible;
+        uint32_t loopStart;    // BODY: atribuições feitas antes do laço
+        size_t pendingMark;    // BODY: primeira leitura adiada deste laço
+    };
+
+    // Leitura sem nenhuma atribuição antes dela; dentro de um laço, uma
+    // atribuição mais adiante no corpo ainda pode alcançá-la na volta seguinte
+    struct Read {
+        NodeId node;
+        int line; // linha do comando: com hash-consing o nó é compartilhado
+    };
+
+    enum Verdict : uint8_t { UNSEEN, ALWAYS_ASSIGNED, CHECKED };
+
+    AST* ast;
+    std::string errorMessage;
+    std::vector<Frame> frames;
+    std::vector<uint8_t> assigned;       // por variável (id no StringPool): inicializada em todos os caminhos
+    std::vector<uint8_t> possible;       // ... em algum caminho
+    std::vector<uint32_t> assignedLog;   // variáveis marcadas em 'assigned', em ordem
+    std::vector<uint32_t> possibleLog;
+    std::vector<uint32_t> lastAssignment; // número da última atribuição a cada variável
+    std::vector<uint32_t> merged;        // carimbo da junção de um 'se', por variável
+    uint32_t assignments = 0;
+    uint32_t merges = 0;
+    uint32_t loops = 0;                  // laços abertos
+    std::vector<Read> pending;
+    Read firstError{NO_NODE, 0};
+    std::vector<uint8_t> verdicts;       // por nó IDENTIFICADOR lido
+    std::vector<uint32_t> visited;       // carimbo por nó: já visto nesta expressão
+    uint32_t expressions = 0;
+    std::vector<NodeId> expression;      // pilha do percurso das expressões
+
+    void pushSequence(NodeId owner, const NodeId* slot, Part part);
+    void analyzeCommand(const NodeId* slot);
+    void finishSequence(const Frame& frame);
+    void mergeBranches(const Frame& frame);
+    void finishLoop(const Frame& frame);
+    void readExpression(NodeId root, int line);
+    void assign(uint32_t variable);
+    void report(const Read& read);
+
+public:
+    // 'ast' já passou pela análise semântica; as leituras de variáveis
+    // sempre inicializadas ficam marcadas. false se alguma variável é lida
+    // sem ser inicializada em nenhum caminho.
+    bool analyze(AST& tree);
+    bool hasError() const { return !errorMessage.empty(); }
+    const std::string& getError() const { return errorMessage; }
+};
+
+#endif
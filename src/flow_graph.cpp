@@ -0,0 +1,118 @@
+#include "flow_graph.h"
+
+// Sequência de comandos durante a construção do grafo
+enum class FlowPart : uint8_t { LIST, THEN, ELSE, BODY };
+struct FlowFrame {
+    const NodeId* commands;
+    uint32_t next;
+    uint32_t count;
+    NodeId owner;
+    FlowPart part;
+    uint32_t join;  // bloco depois do 'se' (ou a saída do 'enquanto')
+    uint32_t other; // bloco do 'senao' (ou a cabeça do 'enquanto')
+};
+
+static uint32_t newBlock(std::vector<FlowBlock>& blocks) {
+    blocks.emplace_back();
+    return static_cast<uint32_t>(blocks.size() - 1);
+}
+
+// Comandos de um bloco do 'se' ou do corpo do 'enquanto': os da lista, ou o
+// próprio comando se ele nao for lista (como Interpreter::pushBlock)
+static void pushSequence(const AST& tree, std::vector<FlowFrame>& frames, NodeId block, NodeId owner, FlowPart part,
+                         uint32_t join, uint32_t other) {
+    if (block == NO_NODE) {
+        frames.push_back({nullptr, 0, 0, owner, part, join, other});
+    } else if (tree[block].type == NodeType::LISTA_COMANDOS) {
+        frames.push_back({tree.children(block).begin(), 0, tree[block].childCount, owner, part, join, other});
+    } else {
+        const NodeId* slot = tree.children(owner).begin() + (part == FlowPart::ELSE ? 2 : 1);
+        frames.push_back({slot, 0, 1, owner, part, join, other});
+    }
+}
+
+std::vector<FlowBlock> buildFlowGraph(const AST& tree) {
+    std::vector<FlowBlock> blocks;
+    std::vector<FlowFrame> frames;
+    uint32_t current = newBlock(blocks);
+
+    for (NodeId child : tree.children(tree.root)) {
+        if (tree[child].type == NodeType::LISTA_COMANDOS) {
+            pushSequence(tree, frames, child, NO_NODE, FlowPart::LIST, NO_BLOCK, NO_BLOCK);
+            break;
+        }
+    }
+
+    while (!frames.empty()) {
+        FlowFrame& frame = frames.back();
+        if (frame.next < frame.count) {
+            NodeId command = frame.commands[frame.next++];
+            const ASTNode& node = tree[command];
+            switch (node.type) {
+                case NodeType::ATRIBUICAO:
+                case NodeType::LER:
+                case NodeType::ESCREVER:
+                    blocks[current].commands.push_back(command);
+                    break;
+                case NodeType::LISTA_COMANDOS:
+                    pushSequence(tree, frames, command, NO_NODE, FlowPart::LIST, NO_BLOCK, NO_BLOCK);
+                    break;
+                case NodeType::SE: {
+                    if (node.childCount == 0) break;
+                    uint32_t thenBlock = newBlock(blocks);
+                    uint32_t elseBlock = node.childCount > 2 ? newBlock(blocks) : NO_BLOCK;
+                    uint32_t join = newBlock(blocks);
+                    blocks[current].branch = command;
+                    blocks[current].successors[0] = thenBlock;
+                    blocks[current].successors[1] = elseBlock != NO_BLOCK ? elseBlock : join;
+                    pushSequence(tree, frames, node.childCount > 1 ? tree.child(command, 1) : NO_NODE, command,
+                                 FlowPart::THEN, join, elseBlock);
+                    current = thenBlock;
+                    break;
+                }
+                case NodeType::ENQUANTO: {
+                    if (node.childCount < 2) break;
+                    uint32_t head = newBlock(blocks);
+                    uint32_t body = newBlock(blocks);
+                    uint32_t exit = newBlock(blocks);
+                    blocks[current].successors[0] = head;
+                    blocks[head].branch = command;
+                    blocks[head].successors[0] = body;
+                    blocks[head].successors[1] = exit;
+                    pushSequence(tree, frames, tree.child(command, 1), command, FlowPart::BODY, exit, head);
+                    current = body;
+                    break;
+                }
+                default:
+                    break;
+            }
+            continue;
+        }
+
+        FlowFrame done = frame;
+        frames.pop_back();
+        switch (done.part) {
+            case FlowPart::THEN:
+                blocks[current].successors[0] = done.join;
+                if (done.other != NO_BLOCK) {
+                    pushSequence(tree, frames, tree.child(done.owner, 2), done.owner, FlowPart::ELSE, done.join,
+                                 NO_BLOCK);
+                    current = done.other;
+                } else {
+                    current = done.join;
+                }
+                break;
+            case FlowPart::ELSE:
+                blocks[current].successors[0] = done.join;
+                current = done.join;
+                break;
+            case FlowPart::BODY:
+                blocks[current].successors[0] = done.other;
+                current = done.join;
+                break;
+            case FlowPart::LIST:
+                break;
+        }
+    }
+    return blocks;
+}
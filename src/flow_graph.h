@@ -0,0 +1,24 @@
+#ifndef FLOW_GRAPH_H
+#define FLOW_GRAPH_H
+
+#include "ast.h"
+#include <vector>
+
+constexpr uint32_t NO_BLOCK = UINT32_MAX;
+
+// Bloco do grafo de fluxo: comandos simples (atribuição, ler, escrever)
+// terminados pela condição de um 'se' ou 'enquanto' ou pela passagem ao
+// bloco seguinte
+struct FlowBlock {
+    std::vector<NodeId> commands; // ATRIBUICAO, LER e ESCREVER, em ordem
+    NodeId branch = NO_NODE;      // 'se' ou 'enquanto' cuja condição encerra o bloco
+    uint32_t successors[2] = {NO_BLOCK, NO_BLOCK}; // com 'branch': verdadeiro, falso
+};
+
+// Grafo de fluxo com os mesmos caminhos do interpretador, montado com pilha
+// explícita: o 'se' desvia para o bloco 'entao' ou 'senao' e os dois voltam
+// ao bloco seguinte; a cabeça do 'enquanto' testa a condição, e o fim do
+// corpo volta para ela. O bloco 0 é a entrada do programa.
+std::vector<FlowBlock> buildFlowGraph(const AST& tree);
+
+#endif
@@ -3,21 +3,54 @@
 #include <iostream>
 #include <sstream>
 #include <limits>
+#include <climits>
 
-Interpreter::Interpreter(SymbolTable& table) : symbolTable(table) {}
+static const int MAX_ITERATIONS = 100000; // Proteção contra loop infinito
+
+static bool compare(TokenType op, int left, int right) {
+    switch (op) {
+        case TokenType::IGUAL:
+            return left == right;
+        case TokenType::DIFERENTE:
+            return left != right;
+        case TokenType::MENOR:
+            return left < right;
+        case TokenType::MENOR_IGUAL:
+            return left <= right;
+        case TokenType::MAIOR:
+            return left > right;
+        case TokenType::MAIOR_IGUAL:
+            return left >= right;
+        default:
+            return false;
+    }
+}
+
+static bool isRelational(TokenType op) {
+    return op == TokenType::IGUAL || op == TokenType::DIFERENTE || op == TokenType::MENOR ||
+           op == TokenType::MENOR_IGUAL || op == TokenType::MAIOR || op == TokenType::MAIOR_IGUAL;
+}
+
+Interpreter::Interpreter(const std::vector<SymbolType>& slotTypes) : ast(nullptr) {
+    slots.reserve(slotTypes.size());
+    for (SymbolType type : slotTypes) {
+        slots.push_back({0, false, false, type});
+    }
+}
 
 void Interpreter::error(const std::string& message) {
     errorMessage = "Erro de execucao: " + message;
 }
 
-bool Interpreter::execute(ASTNodePtr root) {
-    if (!root) return false;
+bool Interpreter::execute(const AST& tree) {
+    if (tree.empty()) return false;
     
+    ast = &tree;
     errorMessage.clear();
     
     // Executa os comandos do programa
-    for (auto child : root->children) {
-        if (child->type == NodeType::LISTA_COMANDOS) {
+    for (NodeId child : tree.children(tree.root)) {
+        if (tree[child].type == NodeType::LISTA_COMANDOS) {
             executeCommands(child);
             break;
         }
@@ -26,19 +59,40 @@ bool Interpreter::execute(ASTNodePtr root) {
     return !hasError();
 }
 
-void Interpreter::executeCommands(ASTNodePtr node) {
-    if (!node) return;
-    
-    for (auto cmd : node->children) {
-        executeCommand(cmd);
-        if (hasError()) return;
+// Executa os comandos com uma pilha de quadros em vez de recursão: um 'se'
+// empilha o bloco escolhido e um 'enquanto' empilha o corpo, que fica na
+// pilha enquanto o laço durar. Depois de um erro nenhum comando roda mais:
+// os quadros só sao desempilhados.
+void Interpreter::executeCommands(NodeId node) {
+    size_t base = frames.size();
+    pushList(node);
+
+    while (frames.size() > base) {
+        Frame& frame = frames.back();
+        if (frame.next < frame.count && !hasError()) {
+            executeCommand(frame.commands[frame.next++]); // pode empilhar um quadro
+        } else if (frame.loop == NO_NODE || !repeatLoop(frame)) {
+            frames.pop_back();
+        }
     }
 }
 
-void Interpreter::executeCommand(ASTNodePtr node) {
-    if (!node) return;
-    
-    switch (node->type) {
+void Interpreter::pushList(NodeId list, NodeId loop) {
+    frames.push_back({ast->children(list).begin(), 0, (*ast)[list].childCount, loop, 0});
+}
+
+// Bloco do 'se' ou corpo do 'enquanto': os comandos da lista cujo id está em
+// 'slot' (dentro de AST::childIds), ou o próprio comando se ele nao for lista
+void Interpreter::pushBlock(const NodeId* slot, NodeId loop) {
+    if ((*ast)[*slot].type == NodeType::LISTA_COMANDOS) {
+        pushList(*slot, loop);
+    } else {
+        frames.push_back({slot, 0, 1, loop, 0});
+    }
+}
+
+void Interpreter::executeCommand(NodeId node) {
+    switch ((*ast)[node].type) {
         case NodeType::ATRIBUICAO:
             executeAssignment(node);
             break;
@@ -55,106 +109,100 @@ void Interpreter::executeCommand(ASTNodePtr node) {
             executeWrite(node);
             break;
         case NodeType::LISTA_COMANDOS:
-            executeCommands(node);
+            pushList(node);
             break;
         default:
             break;
     }
 }
-
-void Interpreter::executeAssignment(ASTNodePtr node) {
-    if (!node || node->children.size() < 2) return;
+void Interpreter::executeAssignment(NodeId node) {
+    if ((*ast)[node].childCount < 2) return;
     
-    auto var = node->children[0];
-    auto expr = node->children[1];
+    NodeId var = ast->child(node, 0);
+    NodeId expr = ast->child(node, 1);
     
-    auto value = evaluateExpression(expr);
-    symbolTable.assign(var->token.value, value);
+    int value = evaluateInt(expr);
+    bool logical = writesLogical((*ast)[expr]);
+    uint32_t slot = (*ast)[var].slot;
+    if (slot != NO_SLOT) {
+        slots[slot].value = value;
+        slots[slot].initialized = true;
+        slots[slot].logical = logical;
+    }
 }
 
-void Interpreter::executeIf(ASTNodePtr node) {
-    if (!node || node->children.empty()) return;
+void Interpreter::executeIf(NodeId node) {
+    size_t childCount = (*ast)[node].childCount;
+    if (childCount == 0) return;
     
-    auto condition = node->children[0];
-    auto condValue = evaluateExpression(condition);
+    NodeId condition = ast->child(node, 0);
+    bool taken = evaluateCondition(condition);
+    if (hasError()) return; // a condição falhou: nenhum bloco roda
     
-    int condInt = std::holds_alternative<int>(condValue) ? 
-                  std::get<int>(condValue) : 
-                  (std::get<bool>(condValue) ? 1 : 0);
-    
-    if (condInt != 0) {
+    if (taken) {
         // Executa comando then
-        if (node->children.size() > 1) {
-            executeCommand(node->children[1]);
+        if (childCount > 1) {
+            pushBlock(ast->children(node).begin() + 1);
         }
     } else {
         // Executa comando else se existir
-        if (node->children.size() > 2) {
-            executeCommand(node->children[2]);
+        if (childCount > 2) {
+            pushBlock(ast->children(node).begin() + 2);
         }
     }
 }
 
-void Interpreter::executeWhile(ASTNodePtr node) {
-    if (!node || node->children.size() < 2) return;
-    
-    auto condition = node->children[0];
-    auto body = node->children[1];
-    
-    int loopCount = 0;
-    const int MAX_ITERATIONS = 100000; // Proteção contra loop infinito
-    
-    while (loopCount < MAX_ITERATIONS) {
-
-        //std::cout << "DEBUG: loop " << loopCount << std::endl;
-       // std::cout << "DEBUG: Antes de avaliar, contador = " << /* valor de contador do ambiente */ << std::endl;
-        //std::cout << "DEBUG: Antes de avaliar, limite = " << /* valor de limite do ambiente */ << std::endl;
-
-
-        auto condValue = evaluateExpression(condition);
-        int condInt = std::holds_alternative<int>(condValue) ? 
-                      std::get<int>(condValue) : 
-                      (std::get<bool>(condValue) ? 1 : 0);
-        
-        //std::cout << "DEBUG: condInt = " << condInt << std::endl;
-
-        if (condInt == 0) break;
-        
-        executeCommand(body);
-
-        //std::cout << "DEBUG: apos executeCommand, contador = " << /* novo valor de contador do ambiente */ << std::endl;
+bool Interpreter::loopCondition(NodeId loop) {
+    return evaluateCondition(ast->child(loop, 0));
+}
 
-        if (hasError()) break;
-        
-        loopCount++;
+void Interpreter::executeWhile(NodeId node) {
+    if ((*ast)[node].childCount < 2) return;
+    
+    if (loopCondition(node) && !hasError()) {
+        pushBlock(ast->children(node).begin() + 1, node);
     }
+}
+
+// O corpo do laço terminou: testa a condição de novo e, se ela valer,
+// recomeça o mesmo quadro
+bool Interpreter::repeatLoop(Frame& frame) {
+    if (hasError()) return false;
     
-    if (loopCount >= MAX_ITERATIONS) {
+    if (++frame.iterations >= MAX_ITERATIONS) {
         error("Loop infinito detectado - interrompendo execucao");
+        return false;
     }
+    
+    if (!loopCondition(frame.loop)) return false;
+    
+    frame.next = 0;
+    return true;
 }
 
-void Interpreter::executeRead(ASTNodePtr node) {
-    if (!node) return;
-    
-    for (auto var : node->children) {
-        Symbol* symbol = symbolTable.get(var->token.value);
-        if (!symbol) continue;
+void Interpreter::executeRead(NodeId node) {
+    for (NodeId varNode : ast->children(node)) {
+        const Token& var = (*ast)[varNode].token;
+        uint32_t slot = (*ast)[varNode].slot;
+        if (slot == NO_SLOT) continue;
+        Slot* symbol = &slots[slot];
         
-        std::cout << "Digite o valor para " << var->token.value << ": ";
+        std::cout << "Digite o valor para " << var.value << ": ";
         std::cout.flush();
         
         if (symbol->type == SymbolType::INTEIRO) {
             int value;
             if (std::cin >> value) {
-                symbolTable.assign(var->token.value, value);
+                symbol->value = value;
+                symbol->initialized = true;
+                symbol->logical = false;
                 // Limpa o buffer apos leitura bem-sucedida
                 std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
             } else {
                 // Trata erro de entrada
                 std::cin.clear();
                 std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-                error("Entrada inválida para variável inteira '" + var->token.value + "'");
+                error("Entrada inválida para variável inteira '" + std::string(var.value) + "'");
                 return;
             }
         } else {
@@ -162,116 +210,156 @@ void Interpreter::executeRead(ASTNodePtr node) {
             std::cin.ignore(); // Ignora o newline pendente
             std::getline(std::cin, input);
             bool value = (input == "verdadeiro" || input == "true" || input == "1");
-            symbolTable.assign(var->token.value, value);
+            symbol->value = value ? 1 : 0;
+            symbol->initialized = true;
+            symbol->logical = true;
         }
     }
 }
 
-void Interpreter::executeWrite(ASTNodePtr node) {
-    if (!node) return;
-    
-    for (size_t i = 0; i < node->children.size(); i++) {
+void Interpreter::executeWrite(NodeId node) {
+    ChildRange exprs = ast->children(node);
+    for (size_t i = 0; i < exprs.size(); i++) {
         if (i > 0) std::cout << " ";
         
-        auto expr = node->children[i];
+        NodeId expr = exprs[i];
         
-        if (expr->type == NodeType::STRING_LITERAL) {
-            std::cout << expr->token.value;
+        if ((*ast)[expr].type == NodeType::STRING_LITERAL) {
+            std::cout << (*ast)[expr].token.value;
         } else {
-            auto value = evaluateExpression(expr);
+            int value = evaluateInt(expr);
             
-            if (std::holds_alternative<int>(value)) {
-                std::cout << std::get<int>(value);
+            if (writesLogical((*ast)[expr])) {
+                std::cout << (value != 0 ? "verdadeiro" : "falso");
             } else {
-                std::cout << (std::get<bool>(value) ? "verdadeiro" : "falso");
+                std::cout << value;
             }
         }
     }
     std::cout << std::endl;
 }
 
-std::variant<int, bool> Interpreter::evaluateExpression(ASTNodePtr node) {
-    if (!node) return 0;
-    
-    switch (node->type) {
-        case NodeType::NUMERO:
-            return std::stoi(node->token.value);
-            
+// Operadores sempre produzem inteiros (os relacionais dao 1 ou 0) e um
+// lógico vale 1 ou 0: o percurso trabalha só com int, sem std::variant
+int Interpreter::evaluateInt(NodeId root) {
+    const ASTNode& node = (*ast)[root];
+    if (expressionOperands(node) == 0) {
+        return leafValue(node);
+    }
+    return foldExpression(*ast, root, expression, [this](const ASTNode& node, const int* operands) {
+        return operands ? applyOperator(node, operands) : leafValue(node);
+    });
+}
+
+// Condições sao do tipo logico: um relacional na raiz compara os operandos
+// direto, sem passar pelo 1 ou 0
+bool Interpreter::evaluateCondition(NodeId root) {
+    const ASTNode& node = (*ast)[root];
+    if (node.type == NodeType::BINARIO && node.childCount >= 2 && isRelational(node.token.type)) {
+        int left = evaluateInt(ast->child(root, 0));
+        int right = evaluateInt(ast->child(root, 1));
+        operators++;
+        return compare(node.token.type, left, right);
+    }
+    return evaluateInt(root) != 0;
+}
+
+int Interpreter::leafValue(const ASTNode& node) {
+    switch (node.type) {
+        case NodeType::NUMERO: // valores decodificados pelo parser
         case NodeType::LITERAL:
-            if (node->token.type == TokenType::VERDADEIRO) {
-                return true;
-            } else if (node->token.type == TokenType::FALSO) {
-                return false;
-            }
-            return 0;
+            return node.value;
             
         case NodeType::IDENTIFICADOR: {
-            Symbol* symbol = symbolTable.get(node->token.value);
-            if (!symbol || !symbol->initialized) {
-                error("Variável '" + node->token.value + "' nao foi inicializada");
+            if (node.assigned) {
+                return slots[node.slot].value; // inicializada em todos os caminhos
+            }
+            if (node.slot == NO_SLOT || !slots[node.slot].initialized) {
+                error("Variável '" + std::string(node.token.value) + "' nao foi inicializada");
                 return 0;
             }
-            return symbol->value;
+            return slots[node.slot].value;
         }
         
-        case NodeType::BINARIO: {
-            if (node->children.size() < 2) return 0;
-            
-            auto left = evaluateExpression(node->children[0]);
-            auto right = evaluateExpression(node->children[1]);
-            
-            int leftInt = std::holds_alternative<int>(left) ? 
-                         std::get<int>(left) : 
-                         (std::get<bool>(left) ? 1 : 0);
-            int rightInt = std::holds_alternative<int>(right) ? 
-                          std::get<int>(right) : 
-                          (std::get<bool>(right) ? 1 : 0);
-            
-            switch (node->token.type) {
-                case TokenType::MAIS:
-                    return leftInt + rightInt;
-                case TokenType::MENOS:
-                    return leftInt - rightInt;
-                case TokenType::MULTIPLICACAO:
-                    return leftInt * rightInt;
-                case TokenType::DIVISAO:
-                    if (rightInt == 0) {
-                        error("Divisão por zero");
-                        return 0;
-                    }
-                    return leftInt / rightInt;
-                case TokenType::IGUAL:
-                    return (leftInt == rightInt) ? 1 : 0;
-                case TokenType::DIFERENTE:
-                    return (leftInt != rightInt) ? 1 : 0;
-                case TokenType::MENOR:
-                    return (leftInt < rightInt) ? 1 : 0;
-                case TokenType::MENOR_IGUAL:
-                    return (leftInt <= rightInt) ? 1 : 0;
-                case TokenType::MAIOR:
-                    return (leftInt > rightInt) ? 1 : 0;
-                case TokenType::MAIOR_IGUAL:
-                    return (leftInt >= rightInt) ? 1 : 0;
-                default:
-                    return 0;
-            }
+        default:
+            return 0;
+    }
+}
+
+// Só uma folha lógica é escrita como verdadeiro/falso: expressões inteiras e
+// relacionais sao escritas como números
+bool Interpreter::writesLogical(const ASTNode& node) const {
+    if (node.valueType != SymbolType::LOGICO) {
+        return false;
+    }
+    if (node.type == NodeType::LITERAL) {
+        return node.token.type == TokenType::VERDADEIRO || node.token.type == TokenType::FALSO;
+    }
+    if (node.type == NodeType::IDENTIFICADOR && node.slot != NO_SLOT) {
+        return slots[node.slot].initialized && slots[node.slot].logical;
+    }
+    return false;
+}
+
+// Conta testada: um estouro é erro de execução e o resultado vale 0, como
+// na divisão por zero. Um operador provado pela RangeAnalysis ('proven')
+// nunca falha e roda sem os testes; a conta é feita sem sinal, com a volta do
+// complemento de dois, para nunca ter comportamento indefinido.
+int Interpreter::applyOperator(const ASTNode& node, const int* operands) {
+    int result;
+    operators++;
+    if (node.type == NodeType::UNARIO) {
+        if (node.token.type != TokenType::MENOS) {
+            return operands[0];
         }
-        
-        case NodeType::UNARIO: {
-            if (node->children.empty()) return 0;
-            
-            auto operand = evaluateExpression(node->children[0]);
-            int operandInt = std::holds_alternative<int>(operand) ? 
-                            std::get<int>(operand) : 
-                            (std::get<bool>(operand) ? 1 : 0);
-            
-            if (node->token.type == TokenType::MENOS) {
-                return -operandInt;
-            }
-            return operandInt;
+        if (node.proven) {
+            return static_cast<int>(0u - static_cast<unsigned>(operands[0]));
         }
-        
+        return __builtin_sub_overflow(0, operands[0], &result) ? overflow() : result;
+    }
+    
+    int leftInt = operands[0];
+    int rightInt = operands[1];
+    
+    if (node.proven) {
+        unsigned left = static_cast<unsigned>(leftInt);
+        unsigned right = static_cast<unsigned>(rightInt);
+        switch (node.token.type) {
+            case TokenType::MAIS:
+                return static_cast<int>(left + right);
+            case TokenType::MENOS:
+                return static_cast<int>(left - right);
+            case TokenType::MULTIPLICACAO:
+                return static_cast<int>(left * right);
+            case TokenType::DIVISAO:
+                return leftInt / rightInt;
+            default:
+                break;
+        }
+    }
+    
+    switch (node.token.type) {
+        case TokenType::MAIS:
+            return __builtin_add_overflow(leftInt, rightInt, &result) ? overflow() : result;
+        case TokenType::MENOS:
+            return __builtin_sub_overflow(leftInt, rightInt, &result) ? overflow() : result;
+        case TokenType::MULTIPLICACAO:
+            return __builtin_mul_overflow(leftInt, rightInt, &result) ? overflow() : result;
+        case TokenType::DIVISAO:
+            if (rightInt == 0) {
+                error("Divisão por zero");
+                return 0;
+            }
+            if (leftInt == INT_MIN && rightInt == -1) {
+                return overflow();
+            }
+            return leftInt / rightInt;
         default:
-            return 0;
+            return compare(node.token.type, leftInt, rightInt) ? 1 : 0;
     }
 }
+
+int Interpreter::overflow() {
+    error("Estouro de inteiro");
+    return 0;
+}
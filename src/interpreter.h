@@ -4,29 +4,67 @@
 
 #include "ast.h"
 #include "symbol_table.h"
-#include <variant>
 #include <iostream>
+#include <vector>
 
 class Interpreter {
 private:
-    SymbolTable& symbolTable;
+    // Sequência de comandos em execução na pilha explícita: uma lista, um
+    // bloco do 'se' ou o corpo de um 'enquanto' ('loop' = o nó do laço)
+    struct Frame {
+        const NodeId* commands;
+        uint32_t next;
+        uint32_t count;
+        NodeId loop;
+        int iterations;
+    };
+
+    // Valor de uma variável. Inteiros e lógicos ficam em um int; 'logical'
+    // diz se o valor veio de um lógico (verdadeiro/falso) e é escrito assim,
+    // já que os relacionais dao 1 ou 0 e sao escritos como números.
+    struct Slot {
+        int value;
+        bool initialized;
+        bool logical;
+        SymbolType type;
+    };
+
+    // Valores das variáveis, indexados pelo slot dos nós IDENTIFICADOR
+    std::vector<Slot> slots;
     std::string errorMessage;
+    const AST* ast; // árvore em execução
+    // Pilhas explícitas dos percursos (no lugar da recursão)
+    std::vector<Frame> frames;
+    ExpressionStack<int> expression;
+    size_t operators = 0; // operadores avaliados (relatório da eliminação de subexpressões)
     
     void error(const std::string& message);
-    std::variant<int, bool> evaluateExpression(ASTNodePtr node);
-    void executeCommand(ASTNodePtr node);
-    void executeAssignment(ASTNodePtr node);
-    void executeIf(ASTNodePtr node);
-    void executeWhile(ASTNodePtr node);
-    void executeRead(ASTNodePtr node);
-    void executeWrite(ASTNodePtr node);
-    void executeCommands(ASTNodePtr node);
+    // Avaliadores escolhidos pelo tipo que a análise semântica gravou nos nós
+    int evaluateInt(NodeId node);         // qualquer expressão; lógicos valem 1 ou 0
+    bool evaluateCondition(NodeId node);  // expressões do tipo logico
+    int leafValue(const ASTNode& node);
+    int applyOperator(const ASTNode& node, const int* operands); // operandos da esquerda para a direita
+    int overflow();
+    bool writesLogical(const ASTNode& node) const; // o valor é escrito como verdadeiro/falso
+    void executeCommand(NodeId node);
+    void executeAssignment(NodeId node);
+    void executeIf(NodeId node);
+    void executeWhile(NodeId node);
+    void pushList(NodeId list, NodeId loop = NO_NODE);
+    void pushBlock(const NodeId* slot, NodeId loop = NO_NODE);
+    bool loopCondition(NodeId loop);
+    bool repeatLoop(Frame& frame); // fim do corpo: true se o laço roda de novo
+    void executeRead(NodeId node);
+    void executeWrite(NodeId node);
+    void executeCommands(NodeId node);
     
 public:
-    Interpreter(SymbolTable& table);
-    bool execute(ASTNodePtr root);
+    // Um slot por variável, com o tipo dela (SlotResolver::slotTypes)
+    Interpreter(const std::vector<SymbolType>& slotTypes);
+    bool execute(const AST& tree); // a AST já foi resolvida por SlotResolver
     bool hasError() const { return !errorMessage.empty(); }
     const std::string& getError() const { return errorMessage; }
+    size_t operatorCount() const { return operators; }
 };
 
 #endif
@@ -0,0 +1,540 @@
+#include "ir.h"
+#include <algorithm>
+
+bool canFail(const Instruction& ins) {
+    switch (ins.op) {
+        case Opcode::ADD:
+        case Opcode::SUB:
+        case Opcode::MUL:
+        case Opcode::DIV:
+        case Opcode::NEG:
+            return ins.checked;
+        case Opcode::CHECK:
+        case Opcode::READ:
+        case Opcode::GUARD:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool hasEffect(const Instruction& ins) {
+    return ins.op == Opcode::READ || ins.op == Opcode::PRINT || ins.op == Opcode::PRINT_TEXT ||
+           ins.op == Opcode::NEWLINE || ins.op == Opcode::GUARD;
+}
+
+bool isPure(const Instruction& ins) {
+    return ins.op != Opcode::REMOVED && ins.op != Opcode::PHI && !canFail(ins) && !hasEffect(ins);
+}
+
+uint32_t successorCount(const BasicBlock& block) {
+    return block.exit == Exit::JUMP ? 1 : block.exit == Exit::BRANCH ? 2 : 0;
+}
+
+// Operandos de cada tipo de instrução (fora os do 'phi')
+static uint32_t operandCount(Opcode op) {
+    switch (op) {
+        case Opcode::ADD:
+        case Opcode::SUB:
+        case Opcode::MUL:
+        case Opcode::DIV:
+        case Opcode::EQ:
+        case Opcode::NE:
+        case Opcode::LT:
+        case Opcode::LE:
+        case Opcode::GT:
+        case Opcode::GE:
+            return 2;
+        case Opcode::NEG:
+        case Opcode::CHECK:
+        case Opcode::PRINT:
+        case Opcode::GUARD:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+BlockId IRFunction::addBlock() {
+    blocks.emplace_back();
+    return static_cast<BlockId>(blocks.size() - 1);
+}
+
+ValueId IRFunction::append(BlockId block, const Instruction& ins) {
+    ValueId id = static_cast<ValueId>(values.size());
+    values.push_back(ins);
+    blocks[block].instructions.push_back(id);
+    return id;
+}
+
+// 'phi' sem operandos, no início do bloco; os operandos entram na ordem dos
+// predecessores
+ValueId IRFunction::addPhi(BlockId block, uint32_t statement) {
+    Instruction phi{Opcode::PHI};
+    phi.statement = statement;
+    phi.extra = static_cast<uint32_t>(phiOperands.size());
+    phiOperands.emplace_back();
+    ValueId id = static_cast<ValueId>(values.size());
+    values.push_back(phi);
+    std::vector<ValueId>& list = blocks[block].instructions;
+    auto position = std::find_if(list.begin(), list.end(),
+                                 [this](ValueId v) { return values[v].op != Opcode::PHI; });
+    list.insert(position, id);
+    return id;
+}
+
+void IRFunction::jump(BlockId from, BlockId to) {
+    blocks[from].exit = Exit::JUMP;
+    blocks[from].targets[0] = to;
+    blocks[to].predecessors.push_back(from);
+}
+
+void IRFunction::branch(BlockId from, ValueId condition, BlockId ifTrue, BlockId ifFalse) {
+    blocks[from].exit = Exit::BRANCH;
+    blocks[from].condition = condition;
+    blocks[from].targets[0] = ifTrue;
+    blocks[from].targets[1] = ifFalse;
+    blocks[ifTrue].predecessors.push_back(from);
+    blocks[ifFalse].predecessors.push_back(from);
+}
+
+uint32_t IRFunction::addText(std::string_view text) {
+    texts.push_back(text);
+    return static_cast<uint32_t>(texts.size() - 1);
+}
+
+uint32_t IRFunction::addPosition(int line, int column) {
+    positions.push_back({line, column});
+    return static_cast<uint32_t>(positions.size() - 1);
+}
+
+void IRFunction::warn(uint32_t position, const char* message) {
+    for (const IRWarning& warning : warnings) {
+        if (warning.position == position) return;
+    }
+    warnings.push_back({position, message});
+}
+
+void IRFunction::substitute(std::vector<ValueId>& replacement) {
+    auto resolve = [&replacement](ValueId v) {
+        if (v == NO_VALUE || replacement[v] == NO_VALUE) return v;
+        ValueId target = v;
+        while (replacement[target] != NO_VALUE) target = replacement[target];
+        while (replacement[v] != NO_VALUE) { // encurta a cadeia
+            ValueId next = replacement[v];
+            replacement[v] = target;
+            v = next;
+        }
+        return target;
+    };
+    for (Instruction& ins : values) {
+        if (ins.op == Opcode::REMOVED) continue;
+        if (ins.op == Opcode::PHI) {
+            for (ValueId& operand : phiOperands[ins.extra]) operand = resolve(operand);
+            continue;
+        }
+        ins.operands[0] = resolve(ins.operands[0]);
+        ins.operands[1] = resolve(ins.operands[1]);
+    }
+    for (BasicBlock& block : blocks) {
+        if (!block.removed) block.condition = resolve(block.condition);
+    }
+}
+
+void IRFunction::removePredecessor(BlockId block, BlockId pred) {
+    BasicBlock& target = blocks[block];
+    auto position = std::find(target.predecessors.begin(), target.predecessors.end(), pred);
+    if (position == target.predecessors.end()) return;
+    size_t index = static_cast<size_t>(position - target.predecessors.begin());
+    target.predecessors.erase(position);
+    for (ValueId id : target.instructions) {
+        if (values[id].op != Opcode::PHI) break;
+        std::vector<ValueId>& operands = phiOperands[values[id].extra];
+        operands.erase(operands.begin() + index);
+    }
+}
+
+size_t IRFunction::liveInstructions() const {
+    size_t count = 0;
+    for (const BasicBlock& block : blocks) {
+        if (!block.removed) count += block.instructions.size();
+    }
+    return count;
+}
+
+size_t IRFunction::liveBlocks() const {
+    size_t count = 0;
+    for (const BasicBlock& block : blocks) {
+        count += block.removed ? 0 : 1;
+    }
+    return count;
+}
+
+// Dominadores pelo algoritmo iterativo de Cooper, Harvey e Kennedy sobre a
+// pós-ordem reversa; num grafo de laços estruturados bastam duas voltas
+void DominatorTree::build(const IRFunction& ir) {
+    size_t count = ir.blocks.size();
+    order.clear();
+    idom.assign(count, NO_BLOCK);
+    enter.assign(count, 0);
+    leave.assign(count, 0);
+    if (count == 0 || ir.blocks[0].removed) return;
+
+    // Pós-ordem com pilha explícita: (bloco, próximo sucessor)
+    std::vector<uint8_t> seen(count, 0);
+    std::vector<std::pair<BlockId, uint32_t>> stack{{0, 0}};
+    seen[0] = 1;
+    while (!stack.empty()) {
+        auto& [block, next] = stack.back();
+        const BasicBlock& node = ir.blocks[block];
+        if (next < successorCount(node)) {
+            BlockId successor = node.targets[next++];
+            if (!seen[successor]) {
+                seen[successor] = 1;
+                stack.push_back({successor, 0});
+            }
+            continue;
+        }
+        order.push_back(block);
+        stack.pop_back();
+    }
+    std::reverse(order.begin(), order.end());
+    std::vector<uint32_t> position(count, UINT32_MAX);
+    for (uint32_t i = 0; i < order.size(); i++) position[order[i]] = i;
+
+    idom[0] = 0;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < order.size(); i++) {
+            BlockId block = order[i];
+            BlockId best = NO_BLOCK;
+            for (BlockId pred : ir.blocks[block].predecessors) {
+                if (idom[pred] == NO_BLOCK) continue; // ainda nao processado ou inalcançável
+                if (best == NO_BLOCK) {
+                    best = pred;
+                    continue;
+                }
+                BlockId a = pred;
+                BlockId b = best;
+                while (a != b) {
+                    while (position[a] > position[b]) a = idom[a];
+                    while (position[b] > position[a]) b = idom[b];
+                }
+                best = a;
+            }
+            if (idom[block] != best) {
+                idom[block] = best;
+                changed = true;
+            }
+        }
+    }
+
+    // Intervalos do percurso em profundidade da árvore de dominadores
+    std::vector<uint32_t> firstChild(count, NO_BLOCK);
+    std::vector<uint32_t> nextSibling(count, NO_BLOCK);
+    for (size_t i = order.size(); i-- > 1;) {
+        BlockId block = order[i];
+        nextSibling[block] = firstChild[idom[block]];
+        firstChild[idom[block]] = block;
+    }
+    uint32_t clock = 0;
+    std::vector<BlockId> walk{0};
+    enter[0] = clock++;
+    while (!walk.empty()) {
+        BlockId block = walk.back();
+        BlockId child = firstChild[block];
+        if (child != NO_BLOCK) {
+            firstChild[block] = nextSibling[child];
+            enter[child] = clock++;
+            walk.push_back(child);
+            continue;
+        }
+        leave[block] = clock++;
+        walk.pop_back();
+    }
+}
+
+bool DominatorTree::dominates(BlockId a, BlockId b) const {
+    return enter[a] <= enter[b] && leave[b] <= leave[a];
+}
+
+const char* opcodeName(Opcode op) {
+    switch (op) {
+        case Opcode::UNDEF: return "undef";
+        case Opcode::CONST: return "const";
+        case Opcode::PHI: return "phi";
+        case Opcode::ADD: return "add";
+        case Opcode::SUB: return "sub";
+        case Opcode::MUL: return "mul";
+        case Opcode::DIV: return "div";
+        case Opcode::NEG: return "neg";
+        case Opcode::EQ: return "eq";
+        case Opcode::NE: return "ne";
+        case Opcode::LT: return "lt";
+        case Opcode::LE: return "le";
+        case Opcode::GT: return "gt";
+        case Opcode::GE: return "ge";
+        case Opcode::CHECK: return "check";
+        case Opcode::READ: return "read";
+        case Opcode::PRINT: return "print";
+        case Opcode::PRINT_TEXT: return "print_text";
+        case Opcode::NEWLINE: return "newline";
+        case Opcode::GUARD: return "guard";
+        case Opcode::REMOVED: return "removed";
+    }
+    return "?";
+}
+
+// Instruções que definem um valor (as outras só têm efeito)
+static bool definesValue(Opcode op) {
+    return op != Opcode::PRINT && op != Opcode::PRINT_TEXT && op != Opcode::NEWLINE && op != Opcode::REMOVED;
+}
+
+void printIR(const IRFunction& ir, std::ostream& out) {
+    for (BlockId b = 0; b < ir.blocks.size(); b++) {
+        const BasicBlock& block = ir.blocks[b];
+        if (block.removed) continue;
+        out << "b" << b << ":";
+        if (!block.predecessors.empty()) {
+            out << "  ; de";
+            for (BlockId pred : block.predecessors) out << " b" << pred;
+        }
+        out << "\n";
+        for (ValueId id : block.instructions) {
+            const Instruction& ins = ir.values[id];
+            out << "  ";
+            if (definesValue(ins.op)) out << "v" << id << " = ";
+            out << opcodeName(ins.op);
+            if (canFail(ins) && ins.op != Opcode::CHECK && ins.op != Opcode::READ && ins.op != Opcode::GUARD) {
+                out << ".testada";
+            }
+            switch (ins.op) {
+                case Opcode::CONST:
+                    out << " " << ins.value;
+                    if (ins.logical) out << (ins.value ? " (verdadeiro)" : " (falso)");
+                    break;
+                case Opcode::PHI: {
+                    const std::vector<ValueId>& operands = ir.phiOperands[ins.extra];
+                    for (size_t i = 0; i < operands.size(); i++) {
+                        out << (i ? ", [v" : " [v") << operands[i] << ", b";
+                        if (i < block.predecessors.size()) out << block.predecessors[i];
+                        out << "]";
+                    }
+                    break;
+                }
+                case Opcode::READ:
+                    out << " '" << ir.texts[ins.extra] << "'"
+                        << (static_cast<SymbolType>(ins.value) == SymbolType::LOGICO ? " logico" : " inteiro");
+                    break;
+                case Opcode::PRINT_TEXT:
+                    out << " '" << ir.texts[ins.extra] << "'";
+                    break;
+                default:
+                    for (uint32_t i = 0; i < operandCount(ins.op); i++) {
+                        out << (i ? ", v" : " v") << ins.operands[i];
+                    }
+                    if (ins.op == Opcode::CHECK) out << " '" << ir.texts[ins.extra] << "'";
+                    break;
+            }
+            if (ins.space) out << " (espaco antes)";
+            if (canFail(ins) || hasEffect(ins)) out << "  ; comando " << ins.statement;
+            out << "\n";
+        }
+        switch (block.exit) {
+            case Exit::JUMP:
+                out << "  jump b" << block.targets[0] << "\n";
+                break;
+            case Exit::BRANCH:
+                out << "  branch v" << block.condition << ", b" << block.targets[0] << ", b" << block.targets[1]
+                    << "\n";
+                break;
+            case Exit::HALT:
+                out << "  halt\n";
+                break;
+            case Exit::NONE:
+                out << "  (sem saida)\n";
+                break;
+        }
+    }
+}
+
+bool verifyIR(const IRFunction& ir, std::string& error) {
+    auto fail = [&error](const std::string& message) {
+        error = "IR invalida: " + message;
+        return false;
+    };
+    size_t count = ir.blocks.size();
+    if (count == 0 || ir.blocks[0].removed) return fail("sem bloco de entrada");
+    if (!ir.blocks[0].predecessors.empty()) return fail("o bloco de entrada tem predecessores");
+
+    // Arestas: cada predecessor listado corresponde a uma saída, e vice-versa
+    std::vector<uint32_t> incoming(count, 0);
+    for (BlockId b = 0; b < count; b++) {
+        const BasicBlock& block = ir.blocks[b];
+        if (block.removed) continue;
+        if (block.exit == Exit::NONE) return fail("b" + std::to_string(b) + " sem saida");
+        for (uint32_t i = 0; i < successorCount(block); i++) {
+            BlockId target = block.targets[i];
+            if (target >= count || ir.blocks[target].removed) {
+                return fail("b" + std::to_string(b) + " desvia para um bloco inexistente");
+            }
+            incoming[target]++;
+            const std::vector<BlockId>& preds = ir.blocks[target].predecessors;
+            size_t listed = static_cast<size_t>(std::count(preds.begin(), preds.end(), b));
+            size_t edges = 0;
+            for (uint32_t k = 0; k < successorCount(block); k++) edges += block.targets[k] == target ? 1 : 0;
+            if (listed != edges) {
+                return fail("b" + std::to_string(target) + " nao lista b" + std::to_string(b) +
+                            " como predecessor");
+            }
+        }
+        if (block.exit == Exit::BRANCH && block.condition == NO_VALUE) {
+            return fail("b" + std::to_string(b) + " desvia sem condicao");
+        }
+    }
+    for (BlockId b = 0; b < count; b++) {
+        if (!ir.blocks[b].removed && incoming[b] != ir.blocks[b].predecessors.size()) {
+            return fail("b" + std::to_string(b) + " lista predecessores que nao desviam para ele");
+        }
+    }
+
+    // Cada instrução em um único bloco, os 'phi' primeiro
+    std::vector<BlockId> owner(ir.values.size(), NO_BLOCK);
+    std::vector<uint32_t> index(ir.values.size(), 0);
+    for (BlockId b = 0; b < count; b++) {
+        const BasicBlock& block = ir.blocks[b];
+        if (block.removed) continue;
+        bool phis = true;
+        for (uint32_t i = 0; i < block.instructions.size(); i++) {
+            ValueId id = block.instructions[i];
+            if (id >= ir.values.size() || owner[id] != NO_BLOCK) {
+                return fail("v" + std::to_string(id) + " aparece duas vezes ou nao existe");
+            }
+            const Instruction& ins = ir.values[id];
+            if (ins.op == Opcode::REMOVED) return fail("v" + std::to_string(id) + " removida ainda esta em b" + std::to_string(b));
+            if (ins.op == Opcode::PHI) {
+                if (!phis) return fail("phi v" + std::to_string(id) + " depois de outra instrucao");
+                if (ir.phiOperands[ins.extra].size() != block.predecessors.size()) {
+                    return fail("phi v" + std::to_string(id) + " sem um operando por predecessor");
+                }
+            } else {
+                phis = false;
+            }
+            owner[id] = b;
+            index[id] = i;
+        }
+    }
+
+    // Cada definição domina os seus usos (nos blocos alcançáveis)
+    DominatorTree dominators;
+    dominators.build(ir);
+    auto available = [&](ValueId value, BlockId block, uint32_t position, bool endOfBlock) {
+        if (value >= ir.values.size() || owner[value] == NO_BLOCK) return false;
+        BlockId defBlock = owner[value];
+        if (dominators.idom[defBlock] == NO_BLOCK) return false;
+        if (defBlock == block) return endOfBlock || index[value] < position;
+        return dominators.dominates(defBlock, block);
+    };
+    for (BlockId block : dominators.order) {
+        const BasicBlock& node = ir.blocks[block];
+        for (uint32_t i = 0; i < node.instructions.size(); i++) {
+            ValueId id = node.instructions[i];
+            const Instruction& ins = ir.values[id];
+            if (ins.op == Opcode::PHI) {
+                const std::vector<ValueId>& operands = ir.phiOperands[ins.extra];
+                for (size_t k = 0; k < operands.size(); k++) {
+                    BlockId pred = node.predecessors[k];
+                    if (dominators.idom[pred] == NO_BLOCK) continue; // aresta de um bloco inalcançável
+                    if (!available(operands[k], pred, 0, true)) {
+                        return fail("operando " + std::to_string(k) + " de v" + std::to_string(id) +
+                                    " nao esta definido no fim de b" + std::to_string(pred));
+                    }
+                }
+                continue;
+            }
+            for (uint32_t k = 0; k < 2; k++) {
+                ValueId operand = ins.operands[k];
+                if (k >= operandCount(ins.op)) {
+                    if (operand != NO_VALUE) return fail("v" + std::to_string(id) + " com operandos demais");
+                    continue;
+                }
+                if (!available(operand, block, i, false) || !definesValue(ir.values[operand].op)) {
+                    return fail("operando de v" + std::to_string(id) + " nao domina o uso");
+                }
+            }
+        }
+        if (node.exit == Exit::BRANCH && !available(node.condition, block, 0, true)) {
+            return fail("condicao de b" + std::to_string(block) + " nao domina o desvio");
+        }
+    }
+    return true;
+}
+
+// Com uma lista de trabalho: quando um 'phi' sai, os 'phi' que o usam sao
+// vistos de novo (uma cadeia de laços aninhados sai numa passada só)
+bool IRFunction::removeTrivialPhis() {
+    std::vector<ValueId> replacement(values.size(), NO_VALUE);
+    auto resolve = [&replacement](ValueId v) {
+        ValueId target = v;
+        while (replacement[target] != NO_VALUE) target = replacement[target];
+        while (v != target) { // encurta a cadeia
+            ValueId next = replacement[v];
+            replacement[v] = target;
+            v = next;
+        }
+        return target;
+    };
+    std::vector<std::vector<ValueId>> users(values.size());
+    std::vector<ValueId> work;
+    for (ValueId id = 0; id < values.size(); id++) {
+        if (values[id].op != Opcode::PHI) continue;
+        work.push_back(id);
+        for (ValueId operand : phiOperands[values[id].extra]) {
+            if (values[operand].op == Opcode::PHI && operand != id) users[operand].push_back(id);
+        }
+    }
+    std::reverse(work.begin(), work.end());
+    bool removed = false;
+    while (!work.empty()) {
+        ValueId id = work.back();
+        work.pop_back();
+        if (replacement[id] != NO_VALUE) continue;
+        ValueId same = NO_VALUE;
+        bool trivial = true;
+        for (ValueId& operand : phiOperands[values[id].extra]) {
+            operand = resolve(operand);
+            if (operand == id || operand == same) continue;
+            if (same != NO_VALUE) {
+                trivial = false;
+                break;
+            }
+            same = operand;
+        }
+        if (!trivial || same == NO_VALUE) continue;
+        replacement[id] = same;
+        removed = true;
+        for (ValueId user : users[id]) work.push_back(user);
+        if (values[same].op == Opcode::PHI) { // quem usava este passa a usar 'same'
+            for (ValueId user : users[id]) users[same].push_back(user);
+        }
+    }
+    if (!removed) return false;
+    for (ValueId id = 0; id < values.size(); id++) {
+        if (replacement[id] != NO_VALUE) {
+            values[id].op = Opcode::REMOVED;
+        }
+    }
+    substitute(replacement);
+    compact();
+    return true;
+}
+
+void IRFunction::compact() {
+    for (BasicBlock& block : blocks) {
+        if (block.removed) continue;
+        auto end = std::remove_if(block.instructions.begin(), block.instructions.end(),
+                                  [this](ValueId v) { return values[v].op == Opcode::REMOVED; });
+        block.instructions.erase(end, block.instructions.end());
+    }
+}
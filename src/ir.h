@@ -0,0 +1,150 @@
+#ifndef IR_H
+#define IR_H
+
+#include "flow_graph.h"
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Representação intermediária em SSA sobre um grafo de blocos básicos. Cada
+// instrução define no máximo um valor, identificado pelo índice dela em
+// IRFunction::values, e cada valor é definido uma única vez: uma variável do
+// programa vira um valor novo a cada gravação, e os 'phi' no início dos
+// blocos juntam os valores que chegam por cada predecessor.
+//
+// Valores em execução: um int, se ele já foi gravado (o 'undef' das
+// variáveis nao inicializadas nao foi) e se é um lógico escrito como
+// verdadeiro/falso, como nos slots do Interpreter.
+//
+// Erros de execução seguem o interpretador da árvore: depois de um erro o
+// comando em que ele aconteceu termina (um 'escrever' escreve os itens que
+// faltam, com 0 no lugar do valor que falhou) e nenhum outro roda. Por isso
+// as instruções que podem falhar ou têm efeito guardam o número do comando
+// ('statement'); as outras sao puras e podem ser movidas ou removidas.
+
+using ValueId = uint32_t;
+constexpr ValueId NO_VALUE = UINT32_MAX;
+using BlockId = uint32_t;
+
+enum class Opcode : uint8_t {
+    UNDEF,      // valor de uma variável ainda nao gravada
+    CONST,      // 'value'; 'logical' para verdadeiro/falso
+    PHI,        // um operando por predecessor do bloco (IRFunction::phiOperands)
+    ADD, SUB, MUL, DIV, NEG,
+    EQ, NE, LT, LE, GT, GE,
+    CHECK,      // erro se o operando nao foi gravado; devolve o operando
+    READ,       // 'ler' de uma variável do tipo 'value'
+    PRINT,      // escreve o operando ('space': um espaço antes)
+    PRINT_TEXT, // escreve o texto 'text' ('space': um espaço antes)
+    NEWLINE,    // fim do 'escrever'
+    GUARD,      // contador de voltas de um laço: operando + 1, erro no limite
+    REMOVED     // instrução retirada por uma passada
+};
+
+struct Instruction {
+    Opcode op;
+    bool checked = false; // conta testada: estouro e divisão por zero sao erros
+    bool logical = false; // CONST: escrito como verdadeiro/falso
+    bool space = false;   // PRINT e PRINT_TEXT
+    uint32_t statement = 0; // comando de origem, em ordem de execução do programa
+    ValueId operands[2] = {NO_VALUE, NO_VALUE};
+    int32_t value = 0;    // CONST: o valor; READ: o tipo (SymbolType)
+    uint32_t extra = 0;   // PHI: índice em phiOperands; CHECK, READ, PRINT_TEXT: índice em texts;
+                          // DIV: índice em positions
+};
+
+enum class Exit : uint8_t { NONE, JUMP, BRANCH, HALT };
+
+struct BasicBlock {
+    std::vector<ValueId> instructions; // os 'phi' primeiro
+    std::vector<BlockId> predecessors; // na ordem dos operandos dos 'phi'
+    Exit exit = Exit::NONE;
+    ValueId condition = NO_VALUE;                // BRANCH: desvia se diferente de 0
+    BlockId targets[2] = {NO_BLOCK, NO_BLOCK}; // JUMP: [0]; BRANCH: verdadeiro, falso
+    bool removed = false;
+};
+
+// Laço 'enquanto' da árvore: a cabeça testa a condição e os blocos do corpo
+// têm índices entre 'header' e 'end' (a saída). Uma passada pode desfazer o
+// laço; LICM confere se ainda há um desvio de volta para a cabeça.
+struct LoopRange {
+    BlockId header;
+    BlockId end;
+};
+
+// Posição de um operador no fonte, para os avisos das passadas
+struct SourcePosition {
+    int line;
+    int column;
+};
+
+// Aviso de uma passada sobre o operador em 'position'
+struct IRWarning {
+    uint32_t position;
+    const char* message;
+};
+
+// Funções de uso comum das passadas
+bool canFail(const Instruction& ins);   // pode dar erro de execução
+bool hasEffect(const Instruction& ins); // lê, escreve ou conta voltas
+bool isPure(const Instruction& ins);    // nem falha nem tem efeito
+uint32_t successorCount(const BasicBlock& block);
+
+class IRFunction {
+public:
+    std::vector<Instruction> values;
+    std::vector<BasicBlock> blocks; // o bloco 0 é a entrada
+    std::vector<std::vector<ValueId>> phiOperands;
+    std::vector<std::string_view> texts; // strings do 'escrever' e nomes de variáveis; apontam para a árvore
+    std::vector<LoopRange> loops;        // de dentro para fora
+    std::vector<SourcePosition> positions;
+    std::vector<IRWarning> warnings;     // um por posição, mesmo com a passada repetida
+
+    BlockId addBlock();
+    ValueId append(BlockId block, const Instruction& ins);
+    ValueId addPhi(BlockId block, uint32_t statement);
+    void jump(BlockId from, BlockId to);
+    void branch(BlockId from, ValueId condition, BlockId ifTrue, BlockId ifFalse);
+    uint32_t addText(std::string_view text);
+    uint32_t addPosition(int line, int column);
+    void warn(uint32_t position, const char* message);
+
+    // Troca cada uso de um valor v por replacement[v] (NO_VALUE: fica),
+    // seguindo as cadeias de trocas
+    void substitute(std::vector<ValueId>& replacement);
+    // Retira a aresta pred -> block: o operando dos 'phi' vai junto
+    void removePredecessor(BlockId block, BlockId pred);
+    // Troca os 'phi' cujos operandos sao todos o mesmo valor (ou o próprio
+    // 'phi') por esse valor. True se algum saiu.
+    bool removeTrivialPhis();
+    // Tira as instruções REMOVED das listas dos blocos
+    void compact();
+    // Instruções e blocos que ainda contam
+    size_t liveInstructions() const;
+    size_t liveBlocks() const;
+};
+
+// Blocos alcançáveis em pós-ordem reversa a partir da entrada e o dominador
+// imediato de cada um (NO_BLOCK nos inalcançáveis; a entrada domina a si
+// mesma), sem recursão
+struct DominatorTree {
+    std::vector<BlockId> order;
+    std::vector<BlockId> idom;
+    std::vector<uint32_t> enter; // numeração do percurso da árvore de
+    std::vector<uint32_t> leave; // dominadores: a domina b se o intervalo contém o de b
+
+    void build(const IRFunction& ir);
+    bool dominates(BlockId a, BlockId b) const;
+};
+
+const char* opcodeName(Opcode op);
+
+// Um bloco por parágrafo, uma instrução por linha
+void printIR(const IRFunction& ir, std::ostream& out);
+
+// Confere arestas, operandos dos 'phi', tipos das instruções e se cada
+// definição domina os seus usos. False com a descrição do primeiro problema.
+bool verifyIR(const IRFunction& ir, std::string& error);
+
+#endif
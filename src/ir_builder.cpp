@@ -0,0 +1,411 @@
+#include "ir_builder.h"
+#include <algorithm>
+
+IRFunction IRBuilder::build(const AST& ast, const std::vector<SymbolType>& slotTypes) {
+    tree = &ast;
+    ir = IRFunction();
+    types = slotTypes;
+    statement = 0;
+    block = ir.addBlock();
+    undefined = ir.append(block, Instruction{Opcode::UNDEF});
+    zero = constant(0, false);
+    current.assign(types.size(), undefined);
+    stamp.assign(types.size(), 0);
+    clock = 0;
+    undo.clear();
+    branchValues.clear();
+    loopPhis.clear();
+    ifFrames.clear();
+    loopFrames.clear();
+    visits.clear();
+
+    if (!ast.empty()) {
+        collectWrites();
+        for (NodeId child : ast.children(ast.root)) {
+            if (ast[child].type == NodeType::LISTA_COMANDOS) {
+                visits.push_back({child, Step::ENTER});
+                break;
+            }
+        }
+    }
+    while (!visits.empty()) {
+        Visit visit = visits.back();
+        visits.pop_back();
+        switch (visit.step) {
+            case Step::ENTER:
+                enter(visit.node);
+                break;
+            case Step::THEN_DONE:
+                thenDone();
+                break;
+            case Step::IF_DONE:
+                ifDone();
+                break;
+            case Step::LOOP_DONE:
+                loopDone();
+                break;
+        }
+    }
+    ir.blocks[block].exit = Exit::HALT;
+    ir.removeTrivialPhis();
+
+    writtenBegin.clear();
+    writtenEnd.clear();
+    written.clear();
+    undo.clear();
+    current.clear();
+    return std::move(ir);
+}
+
+// Variáveis gravadas no corpo de cada 'enquanto', laços de dentro inclusive:
+// os slots vao para um registro, e ao fechar um laço o trecho dele perde as
+// repetições e fica como a lista do laço
+void IRBuilder::collectWrites() {
+    const AST& ast = *tree;
+    writtenBegin.assign(ast.size(), 0);
+    writtenEnd.assign(ast.size(), 0);
+    written.clear();
+
+    struct Pending {
+        NodeId node;
+        uint32_t mark;
+        bool leave;
+    };
+    std::vector<Pending> stack{{ast.root, 0, false}};
+    std::vector<uint32_t> log;
+    std::vector<NodeId> listed(types.size(), NO_NODE); // último laço que listou o slot
+    while (!stack.empty()) {
+        Pending visit = stack.back();
+        stack.pop_back();
+        if (visit.leave) {
+            size_t end = visit.mark;
+            for (size_t i = visit.mark; i < log.size(); i++) {
+                if (listed[log[i]] != visit.node) {
+                    listed[log[i]] = visit.node;
+                    log[end++] = log[i];
+                }
+            }
+            log.resize(end);
+            writtenBegin[visit.node] = static_cast<uint32_t>(written.size());
+            written.insert(written.end(), log.begin() + visit.mark, log.end());
+            writtenEnd[visit.node] = static_cast<uint32_t>(written.size());
+            continue;
+        }
+
+        const ASTNode& node = ast[visit.node];
+        ChildRange children = ast.children(visit.node);
+        switch (node.type) {
+            case NodeType::PROGRAMA:
+            case NodeType::LISTA_COMANDOS:
+            case NodeType::SE:
+                for (size_t i = children.size(); i-- > 0;) {
+                    stack.push_back({children[i], 0, false});
+                }
+                break;
+            case NodeType::ATRIBUICAO:
+                if (children.size() >= 2 && ast[children[0]].slot != NO_SLOT) {
+                    log.push_back(ast[children[0]].slot);
+                }
+                break;
+            case NodeType::LER:
+                for (NodeId target : children) {
+                    if (ast[target].slot != NO_SLOT) log.push_back(ast[target].slot);
+                }
+                break;
+            case NodeType::ENQUANTO:
+                stack.push_back({visit.node, static_cast<uint32_t>(log.size()), true});
+                for (size_t i = children.size(); i-- > 1;) {
+                    stack.push_back({children[i], 0, false});
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void IRBuilder::enter(NodeId id) {
+    const AST& ast = *tree;
+    const ASTNode& node = ast[id];
+    ChildRange children = ast.children(id);
+    switch (node.type) {
+        case NodeType::LISTA_COMANDOS:
+            for (size_t i = children.size(); i-- > 0;) {
+                visits.push_back({children[i], Step::ENTER});
+            }
+            break;
+
+        case NodeType::ATRIBUICAO: {
+            if (children.size() < 2) break;
+            uint32_t command = ++statement;
+            ValueId value = lowerExpression(children[1], command);
+            uint32_t slot = ast[children[0]].slot;
+            if (slot != NO_SLOT) setVariable(slot, value);
+            break;
+        }
+
+        case NodeType::LER: {
+            uint32_t command = ++statement;
+            for (NodeId target : children) {
+                uint32_t slot = ast[target].slot;
+                if (slot == NO_SLOT) continue;
+                Instruction read{Opcode::READ};
+                read.statement = command;
+                read.value = static_cast<int32_t>(types[slot]);
+                read.extra = ir.addText(ast[target].token.value);
+                setVariable(slot, ir.append(block, read));
+            }
+            break;
+        }
+
+        case NodeType::ESCREVER: {
+            uint32_t command = ++statement;
+            for (size_t i = 0; i < children.size(); i++) {
+                const ASTNode& item = ast[children[i]];
+                Instruction print{Opcode::PRINT_TEXT};
+                if (item.type == NodeType::STRING_LITERAL) {
+                    print.extra = ir.addText(item.token.value);
+                } else {
+                    print.op = Opcode::PRINT;
+                    print.operands[0] = lowerExpression(children[i], command);
+                }
+                print.statement = command;
+                print.space = i > 0;
+                ir.append(block, print);
+            }
+            Instruction newline{Opcode::NEWLINE};
+            newline.statement = command;
+            ir.append(block, newline);
+            break;
+        }
+
+        case NodeType::SE: {
+            if (children.empty()) break;
+            uint32_t command = ++statement;
+            ValueId condition = lowerExpression(children[0], command);
+            BlockId thenBlock = ir.addBlock();
+            bool hasElse = children.size() > 2;
+            BlockId elseBlock = hasElse ? ir.addBlock() : NO_BLOCK;
+            BlockId join = ir.addBlock();
+            ir.branch(block, condition, thenBlock, hasElse ? elseBlock : join);
+            ifFrames.push_back({join, hasElse ? elseBlock : block, NO_BLOCK, hasElse,
+                                static_cast<uint32_t>(undo.size()), 0});
+            visits.push_back({id, Step::IF_DONE});
+            if (hasElse) visits.push_back({children[2], Step::ENTER});
+            visits.push_back({id, Step::THEN_DONE});
+            if (children.size() > 1) visits.push_back({children[1], Step::ENTER});
+            block = thenBlock;
+            break;
+        }
+
+        case NodeType::ENQUANTO: {
+            if (children.size() < 2) break; // como Interpreter::executeWhile: nem a condição roda
+            uint32_t command = ++statement;
+            BlockId header = ir.addBlock();
+            ir.jump(block, header);
+            uint32_t phis = static_cast<uint32_t>(loopPhis.size());
+            for (uint32_t i = writtenBegin[id]; i < writtenEnd[id]; i++) {
+                uint32_t slot = written[i];
+                ValueId phi = ir.addPhi(header, command);
+                ir.phiOperands[ir.values[phi].extra].push_back(current[slot]);
+                loopPhis.push_back({slot, phi});
+                setVariable(slot, phi);
+            }
+            ValueId counter = ir.addPhi(header, command);
+            ir.phiOperands[ir.values[counter].extra].push_back(zero);
+
+            block = header;
+            ValueId condition = lowerExpression(children[0], command);
+            BlockId body = ir.addBlock();
+            // A saída é criada depois do corpo: os blocos do laço ficam entre
+            // a cabeça e ela
+            ir.blocks[header].exit = Exit::BRANCH;
+            ir.blocks[header].condition = condition;
+            ir.blocks[header].targets[0] = body;
+            ir.blocks[body].predecessors.push_back(header);
+            loopFrames.push_back({header, counter, command, static_cast<uint32_t>(undo.size()), phis});
+            visits.push_back({id, Step::LOOP_DONE});
+            visits.push_back({children[1], Step::ENTER});
+            block = body;
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void IRBuilder::thenDone() {
+    IfFrame& frame = ifFrames.back();
+    frame.thenEnd = block;
+    ir.jump(block, frame.join);
+    frame.saved = static_cast<uint32_t>(branchValues.size());
+    captureChanges(frame.mark);
+    while (undo.size() > frame.mark) { // o 'senao' parte dos valores de antes do 'se'
+        current[undo.back().first] = undo.back().second;
+        undo.pop_back();
+    }
+    if (frame.hasElse) block = frame.otherEnd;
+}
+
+// Junção do 'se': um 'phi' para cada variável gravada num dos lados que
+// chega com valores diferentes
+void IRBuilder::ifDone() {
+    IfFrame frame = ifFrames.back();
+    ifFrames.pop_back();
+    if (frame.hasElse) {
+        frame.otherEnd = block;
+        ir.jump(block, frame.join);
+    }
+    uint32_t elseBegin = static_cast<uint32_t>(branchValues.size());
+    captureChanges(frame.mark);
+    while (undo.size() > frame.mark) {
+        current[undo.back().first] = undo.back().second;
+        undo.pop_back();
+    }
+
+    // Valor de cada lado: o gravado nele ou o de antes do 'se'
+    size_t end = branchValues.size();
+    for (size_t i = frame.saved; i < end; i++) {
+        uint32_t slot = branchValues[i].first;
+        if (stamp[slot] == clock + 1) continue; // já tratado
+        stamp[slot] = clock + 1;
+        ValueId before = current[slot];
+        ValueId thenValue = before;
+        ValueId elseValue = before;
+        for (size_t k = frame.saved; k < elseBegin; k++) {
+            if (branchValues[k].first == slot) thenValue = branchValues[k].second;
+        }
+        for (size_t k = elseBegin; k < end; k++) {
+            if (branchValues[k].first == slot) elseValue = branchValues[k].second;
+        }
+        if (thenValue == elseValue) {
+            setVariable(slot, thenValue);
+            continue;
+        }
+        ValueId phi = ir.addPhi(frame.join, statement);
+        std::vector<ValueId>& operands = ir.phiOperands[ir.values[phi].extra];
+        for (BlockId pred : ir.blocks[frame.join].predecessors) {
+            operands.push_back(pred == frame.thenEnd ? thenValue : elseValue);
+        }
+        setVariable(slot, phi);
+    }
+    clock++;
+    branchValues.resize(frame.saved);
+    block = frame.join;
+}
+
+void IRBuilder::loopDone() {
+    LoopFrame frame = loopFrames.back();
+    loopFrames.pop_back();
+    Instruction guard{Opcode::GUARD};
+    guard.statement = frame.statement;
+    guard.operands[0] = frame.counter;
+    ValueId next = ir.append(block, guard);
+    ir.jump(block, frame.header);
+    for (size_t i = frame.phis; i < loopPhis.size(); i++) {
+        auto [slot, phi] = loopPhis[i];
+        ir.phiOperands[ir.values[phi].extra].push_back(current[slot]);
+    }
+    ir.phiOperands[ir.values[frame.counter].extra].push_back(next);
+    loopPhis.resize(frame.phis);
+    while (undo.size() > frame.mark) { // depois do laço as variáveis valem os 'phi' da cabeça
+        current[undo.back().first] = undo.back().second;
+        undo.pop_back();
+    }
+
+    BlockId exit = ir.addBlock();
+    ir.blocks[frame.header].targets[1] = exit;
+    ir.blocks[exit].predecessors.push_back(frame.header);
+    ir.loops.push_back({frame.header, exit});
+    block = exit;
+}
+
+void IRBuilder::setVariable(uint32_t slot, ValueId value) {
+    undo.push_back({slot, current[slot]});
+    current[slot] = value;
+}
+
+// Guarda em 'branchValues' o valor atual de cada variável gravada desde 'mark'
+void IRBuilder::captureChanges(uint32_t mark) {
+    clock += 2; // clock + 1 fica livre para ifDone
+    for (size_t i = mark; i < undo.size(); i++) {
+        uint32_t slot = undo[i].first;
+        if (stamp[slot] == clock) continue;
+        stamp[slot] = clock;
+        branchValues.push_back({slot, current[slot]});
+    }
+}
+
+ValueId IRBuilder::lowerExpression(NodeId root, uint32_t command) {
+    const AST& ast = *tree;
+    if (expressionOperands(ast[root]) == 0) {
+        return leaf(ast[root], command);
+    }
+    return foldExpression(ast, root, expression, [this, command](const ASTNode& node, const ValueId* operands) {
+        return operands ? operation(node, operands, command) : leaf(node, command);
+    });
+}
+
+ValueId IRBuilder::leaf(const ASTNode& node, uint32_t command) {
+    switch (node.type) {
+        case NodeType::NUMERO:
+            return constant(node.value, false);
+        case NodeType::LITERAL:
+            return constant(node.value, node.valueType == SymbolType::LOGICO &&
+                                            (node.token.type == TokenType::VERDADEIRO ||
+                                             node.token.type == TokenType::FALSO));
+        case NodeType::IDENTIFICADOR: {
+            ValueId value = node.slot == NO_SLOT ? undefined : current[node.slot];
+            if (node.slot != NO_SLOT && node.assigned) {
+                return value; // inicializada em todos os caminhos
+            }
+            Instruction check{Opcode::CHECK};
+            check.statement = command;
+            check.operands[0] = value;
+            check.extra = ir.addText(node.token.value);
+            return ir.append(block, check);
+        }
+        default:
+            return constant(0, false);
+    }
+}
+
+ValueId IRBuilder::operation(const ASTNode& node, const ValueId* operands, uint32_t command) {
+    Instruction ins{Opcode::ADD};
+    ins.statement = command;
+    ins.operands[0] = operands[0];
+    if (node.type == NodeType::UNARIO) {
+        if (node.token.type != TokenType::MENOS) {
+            return operands[0];
+        }
+        ins.op = Opcode::NEG;
+        ins.checked = !node.proven;
+        return ir.append(block, ins);
+    }
+    ins.operands[1] = operands[1];
+    switch (node.token.type) {
+        case TokenType::MAIS: ins.op = Opcode::ADD; break;
+        case TokenType::MENOS: ins.op = Opcode::SUB; break;
+        case TokenType::MULTIPLICACAO: ins.op = Opcode::MUL; break;
+        case TokenType::DIVISAO: ins.op = Opcode::DIV; break;
+        case TokenType::IGUAL: ins.op = Opcode::EQ; break;
+        case TokenType::DIFERENTE: ins.op = Opcode::NE; break;
+        case TokenType::MENOR: ins.op = Opcode::LT; break;
+        case TokenType::MENOR_IGUAL: ins.op = Opcode::LE; break;
+        case TokenType::MAIOR: ins.op = Opcode::GT; break;
+        default: ins.op = Opcode::GE; break;
+    }
+    ins.checked = ins.op <= Opcode::DIV && !node.proven;
+    if (ins.op == Opcode::DIV) {
+        ins.extra = ir.addPosition(node.token.line, node.token.column);
+    }
+    return ir.append(block, ins);
+}
+
+ValueId IRBuilder::constant(int32_t value, bool logical) {
+    Instruction ins{Opcode::CONST};
+    ins.value = value;
+    ins.logical = logical;
+    return ir.append(block, ins);
+}
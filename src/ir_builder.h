@@ -0,0 +1,91 @@
+#ifndef IR_BUILDER_H
+#define IR_BUILDER_H
+
+#include "ast.h"
+#include "ir.h"
+#include <vector>
+
+// Tradução da árvore verificada (com slots, 'assigned' e, se a RangeAnalysis
+// rodou, 'proven') para a IR em SSA, com pilha explícita. Cada 'se' vira um
+// desvio para o bloco 'entao' e o 'senao' (ou direto para a junção), com um
+// 'phi' na junção para cada variável que chega com valores diferentes. Cada
+// 'enquanto' vira uma cabeça com um 'phi' para cada variável gravada no corpo
+// e outro para o contador de voltas: o fim do corpo soma 1 nele ('guard') e
+// volta para a cabeça, como Interpreter::repeatLoop.
+//
+// A leitura de uma variável que talvez nao tenha sido inicializada vira um
+// 'check' do valor dela; as contas nao provadas sao testadas ('checked').
+class IRBuilder {
+private:
+    enum class Step : uint8_t {
+        ENTER,     // comando a traduzir
+        THEN_DONE, // fim do 'entao'
+        IF_DONE,   // fim do 'se'
+        LOOP_DONE  // fim do corpo do 'enquanto'
+    };
+    struct Visit {
+        NodeId node;
+        Step step;
+    };
+
+    // 'se' aberto
+    struct IfFrame {
+        BlockId join;
+        BlockId otherEnd;  // bloco que chega à junção pelo 'senao' (ou a condição)
+        BlockId thenEnd;
+        bool hasElse;
+        uint32_t mark;     // tamanho de 'undo' antes do 'se'
+        uint32_t saved;    // início dos valores de saída do 'entao' em 'branchValues'
+    };
+
+    // 'enquanto' aberto
+    struct LoopFrame {
+        BlockId header;
+        ValueId counter;   // 'phi' do contador de voltas
+        uint32_t statement;
+        uint32_t mark;     // tamanho de 'undo' depois dos 'phi' da cabeça
+        uint32_t phis;     // início dos 'phi' do laço em 'loopPhis'
+    };
+
+    const AST* tree;
+    IRFunction ir;
+    BlockId block;        // bloco em construção
+    uint32_t statement;   // último comando numerado
+    ValueId undefined;
+    ValueId zero;
+
+    std::vector<ValueId> current;                         // valor de cada slot no ponto atual
+    std::vector<SymbolType> types;
+    std::vector<std::pair<uint32_t, ValueId>> undo;       // (slot, valor anterior)
+    std::vector<std::pair<uint32_t, ValueId>> branchValues;
+    std::vector<std::pair<uint32_t, ValueId>> loopPhis;
+    std::vector<uint32_t> stamp;                          // por slot, para tirar repetições
+    uint32_t clock = 0;
+
+    // Variáveis gravadas em cada 'enquanto' (sem repetição), em 'written'
+    std::vector<uint32_t> writtenBegin;
+    std::vector<uint32_t> writtenEnd;
+    std::vector<uint32_t> written;
+
+    std::vector<Visit> visits;
+    std::vector<IfFrame> ifFrames;
+    std::vector<LoopFrame> loopFrames;
+    ExpressionStack<ValueId> expression;
+
+    void collectWrites();
+    void enter(NodeId id);
+    void thenDone();
+    void ifDone();
+    void loopDone();
+    void setVariable(uint32_t slot, ValueId value);
+    void captureChanges(uint32_t mark);
+    ValueId lowerExpression(NodeId root, uint32_t command);
+    ValueId leaf(const ASTNode& node, uint32_t command);
+    ValueId operation(const ASTNode& node, const ValueId* operands, uint32_t command);
+    ValueId constant(int32_t value, bool logical);
+
+public:
+    IRFunction build(const AST& ast, const std::vector<SymbolType>& slotTypes);
+};
+
+#endif
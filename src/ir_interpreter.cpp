@@ -0,0 +1,217 @@
+#include "ir_interpreter.h"
+#include "symbol_table.h"
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <limits>
+
+static const int MAX_ITERATIONS = 100000; // Proteção contra loop infinito, como no Interpreter
+
+void IRInterpreter::error(const std::string& message, uint32_t statement) {
+    errorMessage = "Erro de execucao: " + message;
+    errorStatement = statement;
+}
+
+IRInterpreter::Register IRInterpreter::overflow(uint32_t statement) {
+    error("Estouro de inteiro", statement);
+    return {0, true, false};
+}
+
+// Contas testadas como Interpreter::applyOperator; as nao testadas foram
+// provadas e rodam sem sinal. Uma divisão nao testada fora das condições da
+// prova (uma passada pode tê-la adiantado para antes de um erro) dá 0 em vez
+// de derrubar o processo.
+IRInterpreter::Register IRInterpreter::arithmetic(const Instruction& ins, int left, int right) {
+    int result;
+    unsigned l = static_cast<unsigned>(left);
+    unsigned r = static_cast<unsigned>(right);
+    if (!ins.checked) {
+        switch (ins.op) {
+            case Opcode::ADD: return {static_cast<int>(l + r), true, false};
+            case Opcode::SUB: return {static_cast<int>(l - r), true, false};
+            case Opcode::MUL: return {static_cast<int>(l * r), true, false};
+            case Opcode::NEG: return {static_cast<int>(0u - l), true, false};
+            default:
+                if (right == 0 || (left == INT_MIN && right == -1)) return {0, true, false};
+                return {left / right, true, false};
+        }
+    }
+    switch (ins.op) {
+        case Opcode::ADD:
+            return __builtin_add_overflow(left, right, &result) ? overflow(ins.statement) : Register{result, true, false};
+        case Opcode::SUB:
+            return __builtin_sub_overflow(left, right, &result) ? overflow(ins.statement) : Register{result, true, false};
+        case Opcode::MUL:
+            return __builtin_mul_overflow(left, right, &result) ? overflow(ins.statement) : Register{result, true, false};
+        case Opcode::NEG:
+            return __builtin_sub_overflow(0, left, &result) ? overflow(ins.statement) : Register{result, true, false};
+        default:
+            if (right == 0) {
+                error("Divisão por zero", ins.statement);
+                return {0, true, false};
+            }
+            if (left == INT_MIN && right == -1) {
+                return overflow(ins.statement);
+            }
+            return {left / right, true, false};
+    }
+}
+
+// Mesmos avisos e leitura de Interpreter::executeRead. False se a entrada
+// for inválida.
+bool IRInterpreter::read(const IRFunction& ir, const Instruction& ins, Register& target) {
+    std::string_view name = ir.texts[ins.extra];
+    std::cout << "Digite o valor para " << name << ": ";
+    std::cout.flush();
+
+    if (static_cast<SymbolType>(ins.value) == SymbolType::INTEIRO) {
+        int value;
+        if (std::cin >> value) {
+            target = {value, true, false};
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            return true;
+        }
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        error("Entrada inválida para variável inteira '" + std::string(name) + "'", ins.statement);
+        return false;
+    }
+    std::string input;
+    std::cin.ignore(); // Ignora o newline pendente
+    std::getline(std::cin, input);
+    bool value = (input == "verdadeiro" || input == "true" || input == "1");
+    target = {value ? 1 : 0, true, true};
+    return true;
+}
+
+bool IRInterpreter::execute(const IRFunction& ir) {
+    errorMessage.clear();
+    errorStatement = 0;
+    if (ir.blocks.empty()) return false;
+    registers.assign(ir.values.size(), Register{0, false, false});
+
+    const Instruction* values = ir.values.data();
+    BlockId current = 0;
+    BlockId from = NO_BLOCK;
+    for (;;) {
+        const BasicBlock& block = ir.blocks[current];
+        const ValueId* code = block.instructions.data();
+        size_t count = block.instructions.size();
+        size_t i = 0;
+
+        // 'phi' em paralelo: todos leem os valores de antes da aresta
+        if (count > 0 && values[code[0]].op == Opcode::PHI) {
+            size_t edge = static_cast<size_t>(
+                std::find(block.predecessors.begin(), block.predecessors.end(), from) - block.predecessors.begin());
+            incoming.clear();
+            for (; i < count && values[code[i]].op == Opcode::PHI; i++) {
+                incoming.push_back(registers[ir.phiOperands[values[code[i]].extra][edge]]);
+            }
+            for (size_t k = 0; k < i; k++) registers[code[k]] = incoming[k];
+        }
+
+        for (; i < count; i++) {
+            ValueId id = code[i];
+            const Instruction& ins = values[id];
+            Register& target = registers[id];
+            // Depois de um erro, só o resto do comando que falhou
+            bool stopped = hasError() && ins.statement != errorStatement;
+            switch (ins.op) {
+                case Opcode::UNDEF:
+                    target = {0, false, false};
+                    break;
+                case Opcode::CONST:
+                    target = {ins.value, true, ins.logical};
+                    break;
+                case Opcode::ADD:
+                case Opcode::SUB:
+                case Opcode::MUL:
+                case Opcode::DIV:
+                    if (stopped && ins.checked) return false;
+                    target = arithmetic(ins, registers[ins.operands[0]].value, registers[ins.operands[1]].value);
+                    break;
+                case Opcode::NEG:
+                    if (stopped && ins.checked) return false;
+                    target = arithmetic(ins, registers[ins.operands[0]].value, 0);
+                    break;
+                case Opcode::EQ:
+                case Opcode::NE:
+                case Opcode::LT:
+                case Opcode::LE:
+                case Opcode::GT:
+                case Opcode::GE: {
+                    int left = registers[ins.operands[0]].value;
+                    int right = registers[ins.operands[1]].value;
+                    bool result = ins.op == Opcode::EQ   ? left == right
+                                  : ins.op == Opcode::NE ? left != right
+                                  : ins.op == Opcode::LT ? left < right
+                                  : ins.op == Opcode::LE ? left <= right
+                                  : ins.op == Opcode::GT ? left > right
+                                                         : left >= right;
+                    target = {result ? 1 : 0, true, false};
+                    break;
+                }
+                case Opcode::CHECK: {
+                    if (stopped) return false;
+                    const Register& operand = registers[ins.operands[0]];
+                    if (operand.defined) {
+                        target = operand;
+                    } else {
+                        error("Variável '" + std::string(ir.texts[ins.extra]) + "' nao foi inicializada",
+                              ins.statement);
+                        target = {0, true, false};
+                    }
+                    break;
+                }
+                case Opcode::READ:
+                    if (hasError() || !read(ir, ins, target)) return false; // 'ler' para no primeiro erro
+                    break;
+                case Opcode::PRINT: {
+                    if (stopped) return false;
+                    if (ins.space) std::cout << " ";
+                    const Register& operand = registers[ins.operands[0]];
+                    if (operand.logical) {
+                        std::cout << (operand.value != 0 ? "verdadeiro" : "falso");
+                    } else {
+                        std::cout << operand.value;
+                    }
+                    break;
+                }
+                case Opcode::PRINT_TEXT:
+                    if (stopped) return false;
+                    if (ins.space) std::cout << " ";
+                    std::cout << ir.texts[ins.extra];
+                    break;
+                case Opcode::NEWLINE:
+                    if (stopped) return false;
+                    std::cout << std::endl;
+                    break;
+                case Opcode::GUARD: {
+                    if (stopped) return false;
+                    int iterations = registers[ins.operands[0]].value + 1;
+                    if (iterations >= MAX_ITERATIONS) {
+                        error("Loop infinito detectado - interrompendo execucao", ins.statement);
+                    }
+                    target = {iterations, true, false};
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        if (hasError()) return false;
+        switch (block.exit) {
+            case Exit::JUMP:
+                from = current;
+                current = block.targets[0];
+                break;
+            case Exit::BRANCH:
+                from = current;
+                current = block.targets[registers[block.condition].value != 0 ? 0 : 1];
+                break;
+            default:
+                return true;
+        }
+    }
+}
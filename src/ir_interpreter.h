@@ -0,0 +1,37 @@
+#ifndef IR_INTERPRETER_H
+#define IR_INTERPRETER_H
+
+#include "ir.h"
+#include <string>
+#include <vector>
+
+// Executa a IR bloco a bloco, com a mesma saída e os mesmos erros do
+// Interpreter: os 'phi' de um bloco recebem os valores do predecessor de
+// onde a execução veio, todos de uma vez. Depois de um erro só rodam as
+// instruções do mesmo comando; a primeira com efeito ou que pode falhar de
+// outro comando (ou qualquer saída de bloco) termina a execução.
+class IRInterpreter {
+private:
+    struct Register {
+        int value;
+        bool defined;
+        bool logical; // escrito como verdadeiro/falso
+    };
+
+    std::vector<Register> registers;
+    std::vector<Register> incoming; // valores dos 'phi' antes de gravá-los
+    std::string errorMessage;
+    uint32_t errorStatement = 0;
+
+    void error(const std::string& message, uint32_t statement);
+    Register overflow(uint32_t statement);
+    Register arithmetic(const Instruction& ins, int left, int right);
+    bool read(const IRFunction& ir, const Instruction& ins, Register& target);
+
+public:
+    bool execute(const IRFunction& ir);
+    bool hasError() const { return !errorMessage.empty(); }
+    const std::string& getError() const { return errorMessage; }
+};
+
+#endif
@@ -0,0 +1,734 @@
+#include "ir_passes.h"
+#include <algorithm>
+#include <climits>
+
+// Resultado de uma conta com operandos constantes. False se ela daria erro
+// (fica para a execução) ou, nao testada, seria indefinida em C++.
+static bool evaluate(const Instruction& ins, int left, int right, int& result) {
+    unsigned l = static_cast<unsigned>(left);
+    unsigned r = static_cast<unsigned>(right);
+    switch (ins.op) {
+        case Opcode::ADD:
+            if (!ins.checked) return result = static_cast<int>(l + r), true;
+            return !__builtin_add_overflow(left, right, &result);
+        case Opcode::SUB:
+            if (!ins.checked) return result = static_cast<int>(l - r), true;
+            return !__builtin_sub_overflow(left, right, &result);
+        case Opcode::MUL:
+            if (!ins.checked) return result = static_cast<int>(l * r), true;
+            return !__builtin_mul_overflow(left, right, &result);
+        case Opcode::NEG:
+            if (!ins.checked) return result = static_cast<int>(0u - l), true;
+            return !__builtin_sub_overflow(0, left, &result);
+        case Opcode::DIV:
+            if (right == 0 || (left == INT_MIN && right == -1)) return false;
+            result = left / right;
+            return true;
+        case Opcode::EQ: result = left == right; return true;
+        case Opcode::NE: result = left != right; return true;
+        case Opcode::LT: result = left < right; return true;
+        case Opcode::LE: result = left <= right; return true;
+        case Opcode::GT: result = left > right; return true;
+        case Opcode::GE: result = left >= right; return true;
+        default:
+            return false;
+    }
+}
+
+static bool isOperator(Opcode op) {
+    return op >= Opcode::ADD && op <= Opcode::GE;
+}
+
+// Os 'check' de valores sempre gravados saem: só o 'undef' e os 'phi' que o
+// recebem por algum caminho talvez nao tenham sido gravados
+static bool removeDefinedChecks(IRFunction& ir) {
+    std::vector<Instruction>& values = ir.values;
+    std::vector<uint8_t> maybeUndefined(values.size(), 0);
+    std::vector<std::vector<ValueId>> phiUsers(values.size());
+    std::vector<ValueId> work;
+    for (ValueId id = 0; id < values.size(); id++) {
+        if (values[id].op == Opcode::UNDEF) {
+            maybeUndefined[id] = 1;
+            work.push_back(id);
+        }
+        if (values[id].op != Opcode::PHI) continue;
+        for (ValueId operand : ir.phiOperands[values[id].extra]) phiUsers[operand].push_back(id);
+    }
+    while (!work.empty()) {
+        ValueId id = work.back();
+        work.pop_back();
+        for (ValueId user : phiUsers[id]) {
+            if (!maybeUndefined[user]) {
+                maybeUndefined[user] = 1;
+                work.push_back(user);
+            }
+        }
+    }
+
+    std::vector<ValueId> replacement(values.size(), NO_VALUE);
+    bool changed = false;
+    for (ValueId id = 0; id < values.size(); id++) {
+        Instruction& ins = values[id];
+        if (ins.op == Opcode::CHECK && !maybeUndefined[ins.operands[0]]) {
+            replacement[id] = ins.operands[0];
+            ins.op = Opcode::REMOVED;
+            changed = true;
+        }
+    }
+    if (changed) {
+        ir.substitute(replacement);
+        ir.compact();
+    }
+    return changed;
+}
+
+// Identidades do Optimizer da árvore com um operando 'const': x + 0, 0 + x,
+// x - 0, x * 1, 1 * x e x / 1 sao o próprio x (nenhuma delas falha)
+static bool removeIdentities(IRFunction& ir) {
+    std::vector<Instruction>& values = ir.values;
+    std::vector<ValueId> replacement(values.size(), NO_VALUE);
+    auto resolve = [&replacement](ValueId v) {
+        while (replacement[v] != NO_VALUE) v = replacement[v];
+        return v;
+    };
+    auto isConstant = [&values](ValueId v, int32_t value) {
+        return values[v].op == Opcode::CONST && values[v].value == value;
+    };
+    bool changed = false;
+    for (ValueId id = 0; id < values.size(); id++) {
+        Instruction& ins = values[id];
+        if (ins.op != Opcode::ADD && ins.op != Opcode::SUB && ins.op != Opcode::MUL && ins.op != Opcode::DIV) {
+            continue;
+        }
+        ValueId left = resolve(ins.operands[0]);
+        ValueId right = resolve(ins.operands[1]);
+        ValueId same = NO_VALUE;
+        if (ins.op == Opcode::ADD) {
+            same = isConstant(right, 0) ? left : isConstant(left, 0) ? right : NO_VALUE;
+        } else if (ins.op == Opcode::MUL) {
+            same = isConstant(right, 1) ? left : isConstant(left, 1) ? right : NO_VALUE;
+        } else if (isConstant(right, ins.op == Opcode::SUB ? 0 : 1)) {
+            same = left;
+        }
+        if (same == NO_VALUE) continue;
+        replacement[id] = same;
+        ins.op = Opcode::REMOVED;
+        changed = true;
+    }
+    if (changed) {
+        ir.substitute(replacement);
+        ir.compact();
+    }
+    return changed;
+}
+
+// Propagação de constantes esparsa e condicional (Wegman e Zadeck): cada
+// valor começa desconhecido e só desce (desconhecido, constante, variável);
+// um bloco só é visto quando alguma aresta executável chega nele, e um 'phi'
+// só junta os operandos das arestas executáveis. Assim uma cadeia de 'se'
+// com condições constantes se resolve numa passada só. As divisões que podem
+// rodar com divisor sempre 0 vao para 'zeroDivisions' (posições no fonte).
+enum class Lattice : uint8_t { UNKNOWN, CONSTANT, VARYING };
+
+static bool propagateConstants(IRFunction& ir, std::vector<uint32_t>& zeroDivisions) {
+    bool changed = false;
+    std::vector<Instruction>& values = ir.values;
+    std::vector<BasicBlock>& blocks = ir.blocks;
+    size_t valueCount = values.size();
+
+    std::vector<BlockId> owner(valueCount, NO_BLOCK);
+    for (BlockId b = 0; b < blocks.size(); b++) {
+        if (blocks[b].removed) continue;
+        for (ValueId id : blocks[b].instructions) owner[id] = b;
+    }
+    // Usos de cada valor em forma compacta; um uso >= valueCount é a condição
+    // do bloco (uso - valueCount)
+    std::vector<uint32_t> firstUse(valueCount + 1, 0);
+    auto forEachOperand = [&](auto&& visit) {
+        for (BlockId b = 0; b < blocks.size(); b++) {
+            const BasicBlock& block = blocks[b];
+            if (block.removed) continue;
+            for (ValueId id : block.instructions) {
+                const Instruction& ins = values[id];
+                if (ins.op == Opcode::PHI) {
+                    for (ValueId operand : ir.phiOperands[ins.extra]) visit(operand, id);
+                } else {
+                    if (ins.operands[0] != NO_VALUE) visit(ins.operands[0], id);
+                    if (ins.operands[1] != NO_VALUE) visit(ins.operands[1], id);
+                }
+            }
+            if (block.exit == Exit::BRANCH) visit(block.condition, static_cast<uint32_t>(valueCount + b));
+        }
+    };
+    forEachOperand([&](ValueId operand, uint32_t) { firstUse[operand + 1]++; });
+    for (size_t i = 0; i < valueCount; i++) firstUse[i + 1] += firstUse[i];
+    std::vector<uint32_t> uses(firstUse[valueCount]);
+    {
+        std::vector<uint32_t> next(firstUse.begin(), firstUse.end() - 1);
+        forEachOperand([&](ValueId operand, uint32_t user) { uses[next[operand]++] = user; });
+    }
+
+    std::vector<Lattice> state(valueCount, Lattice::UNKNOWN);
+    std::vector<int32_t> constant(valueCount, 0);
+    std::vector<uint8_t> logical(valueCount, 0);
+    std::vector<uint8_t> executable(blocks.size(), 0);
+    std::vector<uint8_t> edges(blocks.size(), 0); // bit i: a aresta para targets[i] é executável
+    std::vector<BlockId> blockWork;
+    std::vector<ValueId> valueWork;
+
+    auto lower = [&](ValueId id, Lattice next, int32_t value, bool isLogical) {
+        if (state[id] == Lattice::VARYING || (state[id] == next && next == Lattice::UNKNOWN)) return;
+        if (state[id] == Lattice::CONSTANT && next == Lattice::CONSTANT) {
+            if (constant[id] == value && logical[id] == isLogical) return;
+            next = Lattice::VARYING;
+        }
+        state[id] = next;
+        constant[id] = value;
+        logical[id] = isLogical;
+        valueWork.push_back(id);
+    };
+    auto edgeExecutable = [&](BlockId pred, BlockId block) {
+        const BasicBlock& from = blocks[pred];
+        return ((edges[pred] & 1) && from.targets[0] == block) ||
+               ((edges[pred] & 2) && successorCount(from) == 2 && from.targets[1] == block);
+    };
+    auto visit = [&](ValueId id) {
+        const Instruction& ins = values[id];
+        switch (ins.op) {
+            case Opcode::CONST:
+                lower(id, Lattice::CONSTANT, ins.value, ins.logical);
+                return;
+            case Opcode::PHI: {
+                const BasicBlock& block = blocks[owner[id]];
+                const std::vector<ValueId>& operands = ir.phiOperands[ins.extra];
+                for (size_t k = 0; k < operands.size(); k++) {
+                    if (!edgeExecutable(block.predecessors[k], owner[id])) continue;
+                    ValueId operand = operands[k];
+                    if (state[operand] == Lattice::UNKNOWN) continue;
+                    lower(id, state[operand], constant[operand], logical[operand]);
+                }
+                return;
+            }
+            default:
+                break;
+        }
+        if (!isOperator(ins.op)) {
+            lower(id, Lattice::VARYING, 0, false);
+            return;
+        }
+        ValueId left = ins.operands[0];
+        ValueId right = ins.op == Opcode::NEG ? left : ins.operands[1];
+        // Identidades do Optimizer da árvore que dao constante mesmo com um
+        // operando variável: x - x, x * 0 e x comparado com ele mesmo
+        if (ins.op == Opcode::MUL && ((state[left] == Lattice::CONSTANT && constant[left] == 0) ||
+                                      (state[right] == Lattice::CONSTANT && constant[right] == 0))) {
+            lower(id, Lattice::CONSTANT, 0, false);
+            return;
+        }
+        if (left == right && ins.op != Opcode::NEG && ins.op != Opcode::ADD && ins.op != Opcode::MUL &&
+            ins.op != Opcode::DIV) {
+            bool equal = ins.op == Opcode::EQ || ins.op == Opcode::LE || ins.op == Opcode::GE;
+            lower(id, Lattice::CONSTANT, equal ? 1 : 0, false);
+            return;
+        }
+        if (state[left] == Lattice::VARYING || state[right] == Lattice::VARYING) {
+            lower(id, Lattice::VARYING, 0, false);
+            return;
+        }
+        if (state[left] == Lattice::UNKNOWN || state[right] == Lattice::UNKNOWN) return;
+        int result;
+        if (evaluate(ins, constant[left], ins.op == Opcode::NEG ? 0 : constant[right], result)) {
+            lower(id, Lattice::CONSTANT, result, false);
+        } else {
+            lower(id, Lattice::VARYING, 0, false); // daria erro: fica para a execução
+        }
+    };
+    auto markEdge = [&](BlockId from, uint32_t index) {
+        if (edges[from] & (1u << index)) return;
+        edges[from] |= static_cast<uint8_t>(1u << index);
+        BlockId target = blocks[from].targets[index];
+        if (!executable[target]) {
+            executable[target] = 1;
+            blockWork.push_back(target);
+            return;
+        }
+        for (ValueId id : blocks[target].instructions) { // a aresta nova traz operandos aos 'phi'
+            if (values[id].op != Opcode::PHI) break;
+            visit(id);
+        }
+    };
+    auto visitExit = [&](BlockId b) {
+        const BasicBlock& block = blocks[b];
+        if (block.exit == Exit::JUMP) {
+            markEdge(b, 0);
+        } else if (block.exit == Exit::BRANCH) {
+            Lattice condition = state[block.condition];
+            if (condition == Lattice::VARYING) {
+                markEdge(b, 0);
+                markEdge(b, 1);
+            } else if (condition == Lattice::CONSTANT) {
+                markEdge(b, constant[block.condition] != 0 ? 0 : 1);
+            }
+        }
+    };
+
+    executable[0] = 1;
+    blockWork.push_back(0);
+    while (!blockWork.empty() || !valueWork.empty()) {
+        while (!valueWork.empty()) {
+            ValueId id = valueWork.back();
+            valueWork.pop_back();
+            for (uint32_t u = firstUse[id]; u < firstUse[id + 1]; u++) {
+                uint32_t user = uses[u];
+                if (user >= valueCount) {
+                    if (executable[user - valueCount]) visitExit(user - valueCount);
+                } else if (executable[owner[user]]) {
+                    visit(user);
+                }
+            }
+        }
+        if (!blockWork.empty()) {
+            BlockId b = blockWork.back();
+            blockWork.pop_back();
+            for (ValueId id : blocks[b].instructions) visit(id);
+            visitExit(b);
+        }
+    }
+
+    // Os valores constantes viram 'const'; um 'phi' constante vai para
+    // depois dos 'phi' que ficam. Os desvios por condição constante e os
+    // blocos que nunca rodam ficam para simplify-cfg.
+    for (BlockId b = 0; b < blocks.size(); b++) {
+        if (blocks[b].removed || !executable[b]) continue;
+        std::vector<ValueId>& instructions = blocks[b].instructions;
+        size_t phis = 0;
+        bool foldedPhi = false;
+        for (ValueId id : instructions) {
+            Instruction& ins = values[id];
+            phis += ins.op == Opcode::PHI;
+            if (ins.op == Opcode::DIV && state[ins.operands[1]] == Lattice::CONSTANT &&
+                constant[ins.operands[1]] == 0) {
+                zeroDivisions.push_back(ins.extra);
+            }
+            if (state[id] != Lattice::CONSTANT || ins.op == Opcode::CONST) continue;
+            if (ins.op != Opcode::PHI && !isOperator(ins.op)) continue;
+            foldedPhi = foldedPhi || ins.op == Opcode::PHI;
+            Instruction replacement{Opcode::CONST};
+            replacement.value = constant[id];
+            replacement.logical = logical[id];
+            replacement.statement = ins.statement;
+            ins = replacement;
+            changed = true;
+        }
+        if (foldedPhi) {
+            std::stable_partition(instructions.begin(), instructions.begin() + phis,
+                                  [&values](ValueId id) { return values[id].op == Opcode::PHI; });
+        }
+    }
+    return changed;
+}
+
+bool foldConstants(IRFunction& ir) {
+    static const int MAX_ROUNDS = 4;
+    bool changed = removeDefinedChecks(ir);
+    changed = removeIdentities(ir) || changed;
+    // Constantes novas revelam identidades (x * y com y constante 1) e as
+    // identidades revelam constantes (a <> a * 1). Os avisos de divisão por 0
+    // sao os da última volta, como no Optimizer da árvore: só as divisões que
+    // ainda podem rodar.
+    std::vector<uint32_t> zeroDivisions;
+    for (int round = 0; round < MAX_ROUNDS; round++) {
+        zeroDivisions.clear();
+        if (!propagateConstants(ir, zeroDivisions)) break;
+        changed = true;
+        if (!removeIdentities(ir)) break;
+    }
+    for (uint32_t position : zeroDivisions) {
+        ir.warn(position, "divisao por zero");
+    }
+    return changed;
+}
+
+// Retira o bloco e as suas instruções; os sucessores perdem a aresta
+static void removeBlock(IRFunction& ir, BlockId block) {
+    BasicBlock& node = ir.blocks[block];
+    for (uint32_t i = 0; i < successorCount(node); i++) {
+        ir.removePredecessor(node.targets[i], block);
+    }
+    for (ValueId id : node.instructions) ir.values[id].op = Opcode::REMOVED;
+    node.instructions.clear();
+    node.predecessors.clear();
+    node.removed = true;
+    node.exit = Exit::NONE;
+}
+
+bool simplifyControlFlow(IRFunction& ir) {
+    bool changed = false;
+    std::vector<BasicBlock>& blocks = ir.blocks;
+
+    // Desvios que sempre vao para o mesmo lado
+    for (BlockId b = 0; b < blocks.size(); b++) {
+        BasicBlock& block = blocks[b];
+        if (block.removed || block.exit != Exit::BRANCH) continue;
+        const Instruction& condition = ir.values[block.condition];
+        uint32_t taken;
+        if (block.targets[0] == block.targets[1]) {
+            taken = 0;
+        } else if (condition.op == Opcode::CONST) {
+            taken = condition.value != 0 ? 0 : 1;
+        } else {
+            continue;
+        }
+        ir.removePredecessor(block.targets[1 - taken], b);
+        block.targets[0] = block.targets[taken];
+        block.targets[1] = NO_BLOCK;
+        block.exit = Exit::JUMP;
+        block.condition = NO_VALUE;
+        changed = true;
+    }
+
+    // Blocos inalcançáveis
+    std::vector<uint8_t> reached(blocks.size(), 0);
+    std::vector<BlockId> stack{0};
+    reached[0] = 1;
+    while (!stack.empty()) {
+        const BasicBlock& block = blocks[stack.back()];
+        stack.pop_back();
+        for (uint32_t i = 0; i < successorCount(block); i++) {
+            if (!reached[block.targets[i]]) {
+                reached[block.targets[i]] = 1;
+                stack.push_back(block.targets[i]);
+            }
+        }
+    }
+    for (BlockId b = 0; b < blocks.size(); b++) {
+        if (!blocks[b].removed && !reached[b]) {
+            removeBlock(ir, b);
+            changed = true;
+        }
+    }
+
+    // Junta B ao predecessor A quando A só salta para B e B só vem de A. Os
+    // 'phi' de B têm um operando só e dao lugar a ele.
+    std::vector<ValueId> replacement(ir.values.size(), NO_VALUE);
+    bool merged = false;
+    for (BlockId a = 0; a < blocks.size(); a++) {
+        while (!blocks[a].removed && blocks[a].exit == Exit::JUMP) {
+            BlockId b = blocks[a].targets[0];
+            if (b == a || b == 0 || blocks[b].predecessors.size() != 1) break;
+            BasicBlock& from = blocks[a];
+            BasicBlock& into = blocks[b];
+            for (ValueId id : into.instructions) {
+                Instruction& ins = ir.values[id];
+                if (ins.op == Opcode::PHI) {
+                    replacement[id] = ir.phiOperands[ins.extra][0];
+                    ins.op = Opcode::REMOVED;
+                    continue;
+                }
+                from.instructions.push_back(id);
+            }
+            from.exit = into.exit;
+            from.condition = into.condition;
+            from.targets[0] = into.targets[0];
+            from.targets[1] = into.targets[1];
+            for (uint32_t i = 0; i < successorCount(into); i++) {
+                std::vector<BlockId>& preds = blocks[into.targets[i]].predecessors;
+                std::replace(preds.begin(), preds.end(), b, a);
+            }
+            into.instructions.clear();
+            into.predecessors.clear();
+            into.removed = true;
+            into.exit = Exit::NONE;
+            merged = changed = true;
+        }
+    }
+    if (merged) {
+        ir.substitute(replacement);
+        ir.compact();
+    }
+    if (ir.removeTrivialPhis()) changed = true;
+    return changed;
+}
+
+bool eliminateDeadCode(IRFunction& ir) {
+    std::vector<Instruction>& values = ir.values;
+    std::vector<uint8_t> live(values.size(), 0);
+    std::vector<ValueId> work;
+    auto mark = [&](ValueId id) {
+        if (id != NO_VALUE && !live[id]) {
+            live[id] = 1;
+            work.push_back(id);
+        }
+    };
+    for (const BasicBlock& block : ir.blocks) {
+        if (block.removed) continue;
+        for (ValueId id : block.instructions) {
+            if (canFail(values[id]) || hasEffect(values[id])) mark(id);
+        }
+        if (block.exit == Exit::BRANCH) mark(block.condition);
+    }
+    while (!work.empty()) {
+        const Instruction& ins = values[work.back()];
+        work.pop_back();
+        if (ins.op == Opcode::PHI) {
+            for (ValueId operand : ir.phiOperands[ins.extra]) mark(operand);
+        } else {
+            mark(ins.operands[0]);
+            mark(ins.operands[1]);
+        }
+    }
+
+    bool changed = false;
+    for (const BasicBlock& block : ir.blocks) {
+        if (block.removed) continue;
+        for (ValueId id : block.instructions) {
+            if (!live[id]) {
+                values[id].op = Opcode::REMOVED;
+                changed = true;
+            }
+        }
+    }
+    if (changed) ir.compact();
+    return changed;
+}
+
+// Chave da numeração: operador, operandos (já trocados pelos valores que
+// ficaram e em ordem nas contas comutativas) e, no 'const', o valor
+static uint32_t hashValue(const Instruction& ins) {
+    uint64_t hash = static_cast<uint64_t>(ins.op) * 31 + ins.logical;
+    hash = hash * 1000003u ^ static_cast<uint32_t>(ins.op == Opcode::CONST ? ins.value : 0);
+    hash = hash * 1000003u ^ ins.operands[0];
+    hash = hash * 1000003u ^ ins.operands[1];
+    hash ^= hash >> 33; // mistura os bits altos nos baixos, que escolhem a posição
+    hash *= 0xff51afd7ed558ccdull;
+    return static_cast<uint32_t>(hash ^ (hash >> 33));
+}
+
+static bool sameValue(const Instruction& a, const Instruction& b) {
+    return a.op == b.op && a.logical == b.logical && (a.op != Opcode::CONST || a.value == b.value) &&
+           a.operands[0] == b.operands[0] && a.operands[1] == b.operands[1];
+}
+
+// Tabela de espalhamento aberta, com sondagem linear, dos valores visíveis
+// no ponto do percurso; cada posição guarda o valor e o hash dele. Os valores
+// saem na ordem inversa da entrada (ao sair de um bloco da árvore de
+// dominadores): quando um sai, nenhum dos que ficam passou pela posição dele
+// ao ser inserido, e basta esvaziar a posição.
+class ScopedValueTable {
+private:
+    struct Entry {
+        uint32_t hash;
+        ValueId id; // NO_VALUE: posição vazia
+    };
+
+    const std::vector<Instruction>& values;
+    std::vector<Entry> entries;
+    std::vector<size_t> inserted; // posições, na ordem de entrada
+    size_t mask = 0;
+
+    size_t place(Entry entry) {
+        size_t position = entry.hash & mask;
+        while (entries[position].id != NO_VALUE) position = (position + 1) & mask;
+        entries[position] = entry;
+        return position;
+    }
+
+    void grow() {
+        std::vector<Entry> old = std::move(entries);
+        size_t capacity = old.empty() ? 1024 : old.size() * 2;
+        entries.assign(capacity, Entry{0, NO_VALUE});
+        mask = capacity - 1;
+        for (size_t& position : inserted) position = place(old[position]);
+    }
+
+public:
+    explicit ScopedValueTable(const std::vector<Instruction>& values) : values(values) {}
+
+    // O valor igual já registrado, ou NO_VALUE depois de registrar 'id'
+    ValueId findOrInsert(ValueId id) {
+        if ((inserted.size() + 1) * 2 > entries.size()) grow();
+        uint32_t hash = hashValue(values[id]);
+        size_t position = hash & mask;
+        while (entries[position].id != NO_VALUE) {
+            const Entry& entry = entries[position];
+            if (entry.hash == hash && sameValue(values[entry.id], values[id])) return entry.id;
+            position = (position + 1) & mask;
+        }
+        entries[position] = Entry{hash, id};
+        inserted.push_back(position);
+        return NO_VALUE;
+    }
+
+    size_t size() const { return inserted.size(); }
+
+    void popTo(size_t mark) {
+        while (inserted.size() > mark) {
+            entries[inserted.back()].id = NO_VALUE;
+            inserted.pop_back();
+        }
+    }
+};
+
+// Instruções numeradas: constantes, contas, comparações e 'check'. A conta
+// testada e a provada dao o mesmo valor, e o texto do 'check' (o nome da
+// variável) nao entra: se o primeiro passou, o segundo passa.
+static bool numbered(Opcode op) {
+    return op == Opcode::UNDEF || op == Opcode::CONST || isOperator(op) || op == Opcode::CHECK;
+}
+
+bool numberValues(IRFunction& ir) {
+    std::vector<Instruction>& values = ir.values;
+    DominatorTree dominators;
+    dominators.build(ir);
+    size_t count = ir.blocks.size();
+    std::vector<BlockId> firstChild(count, NO_BLOCK);
+    std::vector<BlockId> nextSibling(count, NO_BLOCK);
+    for (size_t i = dominators.order.size(); i-- > 1;) {
+        BlockId block = dominators.order[i];
+        nextSibling[block] = firstChild[dominators.idom[block]];
+        firstChild[dominators.idom[block]] = block;
+    }
+
+    ScopedValueTable table(values);
+    std::vector<size_t> marks(count, 0);
+    std::vector<ValueId> replacement(values.size(), NO_VALUE);
+    bool changed = false;
+
+    // Percurso da árvore de dominadores: (bloco, true) ao sair dele
+    std::vector<std::pair<BlockId, bool>> walk{{0, false}};
+    if (count == 0 || ir.blocks[0].removed) walk.clear();
+    while (!walk.empty()) {
+        auto [block, leaving] = walk.back();
+        walk.pop_back();
+        if (leaving) {
+            table.popTo(marks[block]);
+            continue;
+        }
+        marks[block] = table.size();
+        for (ValueId id : ir.blocks[block].instructions) {
+            Instruction& ins = values[id];
+            if (!numbered(ins.op)) continue;
+            // Os operandos passam a ser os valores que ficaram (substitute faria
+            // o mesmo no fim), em ordem nas contas comutativas
+            for (ValueId& operand : ins.operands) {
+                if (operand != NO_VALUE && replacement[operand] != NO_VALUE) operand = replacement[operand];
+            }
+            bool commutative = ins.op == Opcode::ADD || ins.op == Opcode::MUL || ins.op == Opcode::EQ ||
+                               ins.op == Opcode::NE;
+            if (commutative && ins.operands[0] > ins.operands[1]) std::swap(ins.operands[0], ins.operands[1]);
+            ValueId found = table.findOrInsert(id);
+            if (found == NO_VALUE) continue;
+            // Uma conta que falhou deixa o resto do comando rodar: a repetição
+            // no mesmo comando daria o erro de novo e fica
+            const Instruction& first = values[found];
+            if (canFail(first) && first.statement == ins.statement) continue;
+            replacement[id] = found;
+            ins.op = Opcode::REMOVED;
+            changed = true;
+        }
+        walk.push_back({block, true});
+        for (BlockId child = firstChild[block]; child != NO_BLOCK; child = nextSibling[child]) {
+            walk.push_back({child, false});
+        }
+    }
+    if (changed) {
+        ir.substitute(replacement);
+        ir.compact();
+    }
+    return changed;
+}
+
+// Laço que pode receber instruções: ainda tem um desvio de volta e um único
+// predecessor de fora, que só salta para a cabeça
+static BlockId preheaderOf(const IRFunction& ir, const LoopRange& loop) {
+    const BasicBlock& header = ir.blocks[loop.header];
+    if (header.removed) return NO_BLOCK;
+    BlockId preheader = NO_BLOCK;
+    bool backEdge = false;
+    for (BlockId pred : header.predecessors) {
+        if (pred > loop.header && pred < loop.end) {
+            backEdge = true;
+        } else if (preheader != NO_BLOCK) {
+            return NO_BLOCK;
+        } else {
+            preheader = pred;
+        }
+    }
+    if (!backEdge || preheader == NO_BLOCK || ir.blocks[preheader].exit != Exit::JUMP) return NO_BLOCK;
+    return preheader;
+}
+
+// Os blocos sao criados depois dos que os dominam e os de um laço ficam no
+// intervalo dele: percorridos em ordem, com a pilha dos laços abertos (do
+// mais de fora para o de dentro), os operandos já estao no lugar final. Cada
+// instrução vai direto para o laço mais de fora que nao contém nenhum dos
+// operandos, sem subir um nível por vez.
+bool hoistInvariants(IRFunction& ir) {
+    std::vector<Instruction>& values = ir.values;
+    std::vector<BlockId> owner(values.size(), NO_BLOCK);
+    for (BlockId b = 0; b < ir.blocks.size(); b++) {
+        if (ir.blocks[b].removed) continue;
+        for (ValueId id : ir.blocks[b].instructions) owner[id] = b;
+    }
+    std::vector<LoopRange> loops = ir.loops;
+    std::sort(loops.begin(), loops.end(), [](const LoopRange& a, const LoopRange& b) {
+        return a.header < b.header;
+    });
+    std::vector<BlockId> preheaders(loops.size());
+    for (size_t i = 0; i < loops.size(); i++) preheaders[i] = preheaderOf(ir, loops[i]);
+
+    bool changed = false;
+    std::vector<uint32_t> open; // índices em 'loops'
+    size_t nextLoop = 0;
+    for (BlockId block = 0; block < ir.blocks.size(); block++) {
+        while (!open.empty() && loops[open.back()].end <= block) open.pop_back();
+        while (nextLoop < loops.size() && loops[nextLoop].header == block) open.push_back(nextLoop++);
+        if (open.empty() || ir.blocks[block].removed) continue;
+
+        // Profundidade do laço mais de dentro da pilha que contém 'def' + 1
+        auto outside = [&](BlockId def) {
+            size_t low = 0;
+            size_t high = open.size();
+            while (low < high) {
+                size_t middle = (low + high) / 2;
+                const LoopRange& loop = loops[open[middle]];
+                if (def >= loop.header && def < loop.end) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            return low;
+        };
+        std::vector<ValueId>& instructions = ir.blocks[block].instructions;
+        size_t kept = 0;
+        for (ValueId id : instructions) {
+            const Instruction& ins = values[id];
+            size_t depth = open.size();
+            if (isPure(ins) && ins.op != Opcode::UNDEF) {
+                depth = 0;
+                for (int k = 0; k < 2; k++) {
+                    if (ins.operands[k] != NO_VALUE) depth = std::max(depth, outside(owner[ins.operands[k]]));
+                }
+                // Uma divisão provada só vale onde a prova foi feita: fora do
+                // laço o divisor pode ser 0, a nao ser que seja constante
+                if (ins.op == Opcode::DIV) {
+                    const Instruction& divisor = values[ins.operands[1]];
+                    if (divisor.op != Opcode::CONST || divisor.value == 0 || divisor.value == -1) {
+                        depth = open.size();
+                    }
+                }
+            }
+            BlockId target = depth < open.size() ? preheaders[open[depth]] : NO_BLOCK;
+            if (target == NO_BLOCK) {
+                instructions[kept++] = id;
+                continue;
+            }
+            ir.blocks[target].instructions.push_back(id);
+            owner[id] = target;
+            changed = true;
+        }
+        instructions.resize(kept);
+    }
+    return changed;
+}
@@ -0,0 +1,38 @@
+#ifndef IR_PASSES_H
+#define IR_PASSES_H
+
+#include "ir.h"
+
+// Passadas sobre a IR. Cada uma devolve true se mudou alguma coisa e deixa a
+// IR válida para verifyIR, para que possam rodar em qualquer ordem (o
+// PassManager monta as sequências dos níveis -O1 e -O2).
+//
+// Nenhuma passada muda o que o programa escreve nem os erros dele: só somem
+// ou mudam de lugar instruções puras, e uma conta testada ou um 'check' só
+// dá lugar a outro igual de um comando anterior que o domina (se aquele
+// tivesse falhado, a execução já teria parado).
+
+// fold: os 'check' de valores sempre gravados saem, as identidades do
+// Optimizer da árvore (x * 1, x - x, ...) se resolvem, e a propagação de
+// constantes esparsa e condicional troca por 'const' os valores que sao
+// constantes em todos os caminhos que podem rodar (as contas que dariam erro
+// ficam, e as divisões por 0 viram avisos em IRFunction::warnings)
+bool foldConstants(IRFunction& ir);
+
+// simplify-cfg: desvios por condição constante viram saltos, blocos
+// inalcançáveis saem, um bloco com um único predecessor que salta para ele
+// é juntado a esse predecessor, e os 'phi' triviais saem
+bool simplifyControlFlow(IRFunction& ir);
+
+// dce: instruções puras cujo valor ninguém usa saem
+bool eliminateDeadCode(IRFunction& ir);
+
+// gvn: numeração de valores pela árvore de dominadores; uma instrução igual
+// a outra que a domina passa a usar o valor dela
+bool numberValues(IRFunction& ir);
+
+// licm: instruções puras de um laço cujos operandos vêm de fora dele vao para
+// o fim do bloco que entra no laço
+bool hoistInvariants(IRFunction& ir);
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+
+#include "token.h"
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+// Reconhecimento das palavras reservadas por hash perfeito gerado em tempo de
+// compilação: nenhum mapa é construído por Lexer e a consulta nao aloca.
+// O hash usa o comprimento e a primeira e a última letra (em minúsculas);
+// o static_assert abaixo garante que nao há colisões.
+
+struct Keyword {
+    std::string_view text;
+    TokenType type;
+};
+
+constexpr std::array<Keyword, 17> KEYWORDS = {{
+    {"programa", TokenType::PROGRAMA},
+    {"inicio", TokenType::INICIO},
+    {"fim", TokenType::FIM},
+    {"var", TokenType::VAR},
+    {"inteiro", TokenType::INTEIRO},
+    {"logico", TokenType::LOGICO},
+    {"se", TokenType::SE},
+    {"entao", TokenType::ENTAO},
+    {"senao", TokenType::SENAO},
+    {"enquanto", TokenType::ENQUANTO},
+    {"faca", TokenType::FACA},
+    {"ler", TokenType::LER},
+    {"escrever", TokenType::ESCREVER},
+    {"verdadeiro", TokenType::VERDADEIRO},
+    {"falso", TokenType::FALSO},
+    {"fim_enquanto", TokenType::FIM_ENQUANTO},
+    {"fim_se", TokenType::FIM_SE},
+}};
+
+constexpr size_t KEYWORD_TABLE_SIZE = 32;
+constexpr size_t KEYWORD_MAX_LENGTH = 12; // "fim_enquanto"
+
+constexpr char toLowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+constexpr size_t keywordHash(std::string_view word) {
+    return (word.size() + 5 * static_cast<unsigned char>(toLowerAscii(word.front())) +
+            2 * static_cast<unsigned char>(toLowerAscii(word.back()))) % KEYWORD_TABLE_SIZE;
+}
+
+struct KeywordTable {
+    // Índice em KEYWORDS + 1 (0 = posição vazia)
+    std::array<unsigned char, KEYWORD_TABLE_SIZE> slots{};
+    bool perfect = true;
+};
+
+constexpr KeywordTable buildKeywordTable() {
+    KeywordTable table;
+    for (size_t i = 0; i < KEYWORDS.size(); i++) {
+        size_t h = keywordHash(KEYWORDS[i].text);
+        if (table.slots[h] != 0) {
+            table.perfect = false;
+        }
+        table.slots[h] = static_cast<unsigned char>(i + 1);
+    }
+    return table;
+}
+
+constexpr KeywordTable KEYWORD_TABLE = buildKeywordTable();
+static_assert(KEYWORD_TABLE.perfect, "colisao no hash das palavras reservadas");
+
+// Devolve o tipo da palavra reservada (sem diferenciar maiúsculas) ou
+// TokenType::IDENTIFICADOR se 'word' nao for reservada.
+constexpr TokenType lookupKeyword(std::string_view word) {
+    if (word.empty() || word.size() > KEYWORD_MAX_LENGTH) {
+        return TokenType::IDENTIFICADOR;
+    }
+
+    unsigned char slot = KEYWORD_TABLE.slots[keywordHash(word)];
+    if (slot == 0) {
+        return TokenType::IDENTIFICADOR;
+    }
+
+    const Keyword& candidate = KEYWORDS[slot - 1];
+    if (candidate.text.size() != word.size()) {
+        return TokenType::IDENTIFICADOR;
+    }
+    for (size_t i = 0; i < word.size(); i++) {
+        if (toLowerAscii(word[i]) != candidate.text[i]) {
+            return TokenType::IDENTIFICADOR;
+        }
+    }
+    return candidate.type;
+}
+
+static_assert(lookupKeyword("Fim_Enquanto") == TokenType::FIM_ENQUANTO, "palavra reservada nao reconhecida");
+static_assert(lookupKeyword("fimse") == TokenType::IDENTIFICADOR, "identificador tomado por palavra reservada");
+
+#endif
@@ -1,5 +1,8 @@
 #include "lexer.h"
-#include <cctype>
+#include "keywords.h"
+#include "operators.h"
+#include "utf8.h"
+#include <algorithm>
 #include <iostream>
 
 std::string tokenTypeToString(TokenType type)
@@ -95,30 +98,18 @@ std::string tokenTypeToString(TokenType type)
     }
 }
 
-Lexer::Lexer(const std::string &input) : input(input), position(0), line(1), column(1)
+Lexer::Lexer(std::string_view input, StringPool& pool, ScanEngine engine)
+    : input(input), position(0), line(1), lineStart(0), columnSkew(0),
+      kernels(scanKernels(engine)), pool(pool)
 {
-    initKeywords();
 }
 
-void Lexer::initKeywords()
+// Sem ler a entrada: um token a cada 4 bytes, um pouco mais que nos
+// programas comuns (um a cada 4,5). Só expressões muito densas passam disso
+// (até um a cada 2 bytes), e aí a arena ainda cresce uma vez.
+size_t Lexer::sizeHint() const
 {
-    keywords["programa"] = TokenType::PROGRAMA;
-    keywords["inicio"] = TokenType::INICIO;
-    keywords["fim"] = TokenType::FIM;
-    keywords["var"] = TokenType::VAR;
-    keywords["inteiro"] = TokenType::INTEIRO;
-    keywords["logico"] = TokenType::LOGICO;
-    keywords["se"] = TokenType::SE;
-    keywords["entao"] = TokenType::ENTAO;
-    keywords["senao"] = TokenType::SENAO;
-    keywords["enquanto"] = TokenType::ENQUANTO;
-    keywords["faca"] = TokenType::FACA;
-    keywords["ler"] = TokenType::LER;
-    keywords["escrever"] = TokenType::ESCREVER;
-    keywords["verdadeiro"] = TokenType::VERDADEIRO;
-    keywords["falso"] = TokenType::FALSO;
-    keywords["fim_enquanto"] = TokenType::FIM_ENQUANTO;
-    keywords["fim_se"] = TokenType::FIM_SE;
+    return (input.size() - position) / 4;
 }
 
 char Lexer::currentChar()
@@ -144,21 +135,35 @@ void Lexer::advance()
     if (position < input.length() && input[position] == '\n')
     {
         line++;
-        column = 1;
-    }
-    else
-    {
-        column++;
+        lineStart = position + 1;
+        columnSkew = 0;
     }
     position++;
 }
 
-void Lexer::skipWhitespace()
+void Lexer::consumeLines(const LineTracker& lines)
 {
-    while (currentChar() != '\0' && std::isspace(currentChar()))
+    if (lines.newlines > 0)
     {
-        advance();
+        columnSkew = 0;
     }
+    line += lines.newlines;
+    lineStart = static_cast<size_t>(lines.lineStart - input.data());
+}
+
+// Só strings, comentários, identificadores e caracteres inválidos podem ter
+// bytes nao ASCII; espaços, números e símbolos nunca passam por aqui.
+void Lexer::countContinuationsSince(size_t from)
+{
+    from = std::max(from, lineStart);
+    columnSkew += countContinuationBytes(input.data() + from, position - from);
+}
+
+void Lexer::skipWhitespace()
+{
+    LineTracker lines = {0, input.data() + lineStart};
+    position += kernels.skipWhitespace(input.data() + position, input.length() - position, lines);
+    consumeLines(lines);
 }
 
 void Lexer::skipComment()
@@ -166,10 +171,11 @@ void Lexer::skipComment()
     if (currentChar() == '{')
     {
         advance(); // Consome '{'
-        while (currentChar() != '\0' && currentChar() != '}')
-        {
-            advance();
-        }
+        size_t start = position;
+        LineTracker lines = {0, input.data() + lineStart};
+        position += kernels.findDelimiter(input.data() + position, input.length() - position, '}', lines);
+        consumeLines(lines);
+        countContinuationsSince(start);
         if (currentChar() == '}')
         {
             advance(); // Consome '}'
@@ -184,36 +190,31 @@ void Lexer::skipComment()
 
 Token Lexer::readNumber()
 {
-    std::string number;
-    int startColumn = column;
+    size_t start = position;
+    int startColumn = column();
 
-    while (currentChar() != '\0' && std::isdigit(currentChar()))
-    {
-        number += currentChar();
-        advance();
-    }
+    position += kernels.digitLength(input.data() + position, input.length() - position);
 
-    return Token(TokenType::NUMERO, number, line, startColumn);
+    return Token(TokenType::NUMERO, input.substr(start, position - start), line, startColumn);
 }
 
 Token Lexer::readString()
 {
-    std::string str;
-    int startColumn = column;
+    int startColumn = column();
 
     advance(); // Skip opening quote
+    size_t start = position;
 
     // Você tinha 'String' no seu Token.h mas aqui está lendo com aspas simples.
     // Presumo que 'STRING' seja para 'string literals' delimitadas por aspas simples, como no Pascal.
-    while (currentChar() != '\0' && currentChar() != '\'')
-    {
-        // Lógica para caracteres de escape (se Fortall suportar, como '\n', '\t', etc.)
-        // CUIDADO: código atual parece suportar '\n' e '\t' mas apenas quando '\' é o char.
-        // No Fortall (Pascal-like), aspas dentro de strings são geralmente duplicadas ('It''s').
+    // No Fortall (Pascal-like), aspas dentro de strings são geralmente duplicadas ('It''s'),
+    // mas isso ainda nao é suportado: a string termina na primeira aspa.
+    LineTracker lines = {0, input.data() + lineStart};
+    position += kernels.findDelimiter(input.data() + position, input.length() - position, '\'', lines);
+    consumeLines(lines);
+    countContinuationsSince(start);
 
-        str += currentChar();
-        advance();
-    }
+    std::string_view str = input.substr(start, position - start);
 
     if (currentChar() == '\'')
     {
@@ -230,23 +231,47 @@ Token Lexer::readString()
 
 Token Lexer::readIdentifier()
 {
-    std::string identifier;
-    int startColumn = column;
+    size_t start = position;
+    int startColumn = column();
 
-    while (currentChar() != '\0' && (std::isalnum(currentChar()) || currentChar() == '_'))
+    position += kernels.identifierLength(input.data() + position, input.length() - position);
+
+    // Letras acentuadas e de outros alfabetos: decodifica só o caractere nao
+    // ASCII e volta ao kernel para o resto
+    while (position < input.length() && !isAsciiByte(input[position]))
     {
-        identifier += std::tolower(currentChar()); // Converte para minúsculas para comparação de palavras-chave
-        advance();
+        size_t length = utf8IdentifierCharLength(input.data() + position, input.length() - position, true);
+        if (length == 0)
+        {
+            break;
+        }
+        position += length;
+        columnSkew += length - 1;
+        position += kernels.identifierLength(input.data() + position, input.length() - position);
     }
 
-    TokenType type = TokenType::IDENTIFICADOR;
-    auto it = keywords.find(identifier); // Procura no mapa de palavras-chave
-    if (it != keywords.end())
+    std::string_view identifier = input.substr(start, position - start);
+
+    TokenType type = lookupKeyword(identifier); // IDENTIFICADOR se nao for palavra reservada
+    if (type != TokenType::IDENTIFICADOR)
     {
-        type = it->second; // Se encontrado, é uma palavra-chave
+        return Token(type, identifier, line, startColumn);
     }
 
-    return Token(type, identifier, line, startColumn);
+    return Token(type, identifier, line, startColumn, pool.intern(identifier));
+}
+
+// Caractere que nao inicia nenhum token: a sequência UTF-8 inteira vira um
+// único ERRO (um byte só, se ela for inválida)
+Token Lexer::readInvalidChar()
+{
+    int startColumn = column();
+    uint32_t codePoint = 0;
+    size_t length = std::max<size_t>(1, decodeUtf8(input.data() + position, input.length() - position, codePoint));
+    std::string_view text = input.substr(position, length);
+    position += length;
+    columnSkew += length - 1;
+    return Token(TokenType::ERRO, text, line, startColumn);
 }
 
 Token Lexer::nextToken() {
@@ -257,7 +282,7 @@ Token Lexer::nextToken() {
         
         // Check if we hit EOF after skipping whitespace
         if (currentChar() == '\0') {
-            return Token(TokenType::FIM_ARQUIVO, "", line, column);
+            return Token(TokenType::FIM_ARQUIVO, "", line, column());
         }
 
         
@@ -278,15 +303,22 @@ Token Lexer::nextToken() {
 
    
     int currentLine = line;
-    int currentColumn = column;
+    int currentColumn = column();
     
   
 
-    if (std::isalpha(currentChar()) || currentChar() == '_') {
+    if (hasCharClass(currentChar(), CC_LETRA | CC_SUBLINHADO)) {
         return readIdentifier();
     }
+
+    if (!isAsciiByte(currentChar())) {
+        if (utf8IdentifierCharLength(input.data() + position, input.length() - position, false) > 0) {
+            return readIdentifier();
+        }
+        return readInvalidChar();
+    }
     
-    if (std::isdigit(currentChar())) {
+    if (hasCharClass(currentChar(), CC_DIGITO)) {
         return readNumber();
     }
     
@@ -294,70 +326,12 @@ Token Lexer::nextToken() {
         return readString();
     }
     
-    switch (currentChar()) {
-        case '+':
-            advance();
-            return Token(TokenType::MAIS, "+", currentLine, currentColumn);
-        case '-':
-            advance();
-            return Token(TokenType::MENOS, "-", currentLine, currentColumn);
-        case '*':
-            advance();
-            return Token(TokenType::MULTIPLICACAO, "*", currentLine, currentColumn);
-        case '/':
-            advance();
-            return Token(TokenType::DIVISAO, "/", currentLine, currentColumn);
-        case '=':
-            advance();
-            return Token(TokenType::IGUAL, "=", currentLine, currentColumn);
-        case '<':
-            advance();
-            if (currentChar() == '=') {
-                advance();
-                return Token(TokenType::MENOR_IGUAL, "<=", currentLine, currentColumn);
-            } else if (currentChar() == '>') {
-                advance();
-                return Token(TokenType::DIFERENTE, "<>", currentLine, currentColumn);
-            }
-            return Token(TokenType::MENOR, "<", currentLine, currentColumn);
-        case '>':
-            advance();
-            if (currentChar() == '=') {
-                advance();
-                return Token(TokenType::MAIOR_IGUAL, ">=", currentLine, currentColumn);
-            }
-            return Token(TokenType::MAIOR, ">", currentLine, currentColumn);
-        case ':':
-            advance();
-            if (currentChar() == '=') {
-                advance();
-                return Token(TokenType::ATRIBUICAO, ":=", currentLine, currentColumn);
-            }
-            return Token(TokenType::DOIS_PONTOS, ":", currentLine, currentColumn);
-        case ';':
-            advance();
-            return Token(TokenType::PONTO_VIRGULA, ";", currentLine, currentColumn);
-        case '.':
-            advance();
-            return Token(TokenType::PONTO, ".", currentLine, currentColumn);
-        case ',':
-            advance();
-            return Token(TokenType::VIRGULA, ",", currentLine, currentColumn);
-        case '(':
-            advance();
-            return Token(TokenType::PARENTESE_ESQ, "(", currentLine, currentColumn);
-        case ')':
-            advance();
-            return Token(TokenType::PARENTESE_DIR, ")", currentLine, currentColumn);
-        case '[': 
-            advance();
-            return Token(TokenType::COLCHETE_ESQ, "[", currentLine, currentColumn);
-        case ']': 
-            advance();
-            return Token(TokenType::COLCHETE_DIR, "]", currentLine, currentColumn);
-        default:
-            std::string errorChar(1, currentChar());
-            advance();
-            return Token(TokenType::ERRO, errorChar, currentLine, currentColumn);
+    OperatorToken op = scanOperator(currentChar(), peek());
+    if (op.type == TokenType::ERRO) {
+        std::string_view errorChar = input.substr(position, 1);
+        advance();
+        return Token(TokenType::ERRO, errorChar, currentLine, currentColumn);
     }
+    position += op.text.size(); // nenhum operador contém quebra de linha
+    return Token(op.type, op.text, currentLine, currentColumn);
 }
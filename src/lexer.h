@@ -3,30 +3,43 @@
 #define LEXER_H
 
 #include "token.h"
+#include "token_stream.h"
+#include "lexer_kernels.h"
+#include "string_pool.h"
 #include <string>
-#include <unordered_map>
+#include <string_view>
 
-class Lexer {
+class Lexer : public TokenStream {
 private:
-    std::string input;
+    std::string_view input;
     size_t position;
     int line;
-    int column;
-    std::unordered_map<std::string, TokenType> keywords;
+    size_t lineStart; // posição do primeiro caractere da linha corrente
+    size_t columnSkew; // bytes de continuação UTF-8 já consumidos na linha corrente
+    const ScanKernels& kernels;
+    StringPool& pool;
     
-    void initKeywords();
     char currentChar();
     char peek();
     void advance();
+    // Colunas sao contadas em code points, nao em bytes
+    int column() const { return static_cast<int>(position - lineStart - columnSkew) + 1; }
+    void countContinuationsSince(size_t from);
+    void consumeLines(const LineTracker& lines);
     void skipWhitespace();
     void skipComment();
     Token readNumber();
     Token readString();
     Token readIdentifier();
+    Token readInvalidChar();
     
 public:
-    Lexer(const std::string& input);
-    Token nextToken();
+    // O lexer nao copia a entrada: o buffer deve sobreviver aos tokens gerados.
+    // Os identificadores sao internados em 'pool', que também precisa
+    // sobreviver aos tokens.
+    Lexer(std::string_view input, StringPool& pool, ScanEngine engine = ScanEngine::AUTOMATICO);
+    Token nextToken() override;
+    size_t sizeHint() const override;
     bool hasError() const { return false; }
 };
 
@@ -0,0 +1,297 @@
+#include "lexer_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FORTALL_X86 1
+#include <immintrin.h>
+#endif
+
+static constexpr std::array<uint8_t, 256> buildCharClassTable() {
+    std::array<uint8_t, 256> table{};
+    table[' '] = table['\t'] = table['\n'] = table['\v'] = table['\f'] = table['\r'] = CC_ESPACO;
+    for (int c = 'a'; c <= 'z'; c++) table[c] = CC_LETRA;
+    for (int c = 'A'; c <= 'Z'; c++) table[c] = CC_LETRA;
+    for (int c = '0'; c <= '9'; c++) table[c] = CC_DIGITO;
+    table['_'] = CC_SUBLINHADO;
+    return table;
+}
+
+const std::array<uint8_t, 256> charClassTable = buildCharClassTable();
+
+// ============================================================
+// Versão escalar (também usada para as sobras dos kernels SIMD)
+// ============================================================
+
+static size_t skipWhitespaceScalar(const char* p, size_t n, LineTracker& lines) {
+    size_t i = 0;
+    while (i < n && hasCharClass(p[i], CC_ESPACO)) {
+        if (p[i] == '\n') {
+            lines.newlines++;
+            lines.lineStart = p + i + 1;
+        }
+        i++;
+    }
+    return i;
+}
+
+static size_t findDelimiterScalar(const char* p, size_t n, char delimiter, LineTracker& lines) {
+    size_t i = 0;
+    while (i < n && p[i] != delimiter) {
+        if (p[i] == '\n') {
+            lines.newlines++;
+            lines.lineStart = p + i + 1;
+        }
+        i++;
+    }
+    return i;
+}
+
+static size_t identifierLengthScalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && hasCharClass(p[i], CC_LETRA | CC_DIGITO | CC_SUBLINHADO)) {
+        i++;
+    }
+    return i;
+}
+
+static size_t digitLengthScalar(const char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && hasCharClass(p[i], CC_DIGITO)) {
+        i++;
+    }
+    return i;
+}
+
+#ifdef FORTALL_X86
+
+// Registra as quebras de linha de um bloco: 'mask' tem um bit por byte '\n'
+// do bloco que começa em 'block'.
+static inline void countNewlines(uint32_t mask, const char* block, LineTracker& lines) {
+    if (mask) {
+        lines.newlines += __builtin_popcount(mask);
+        lines.lineStart = block + (31 - __builtin_clz(mask)) + 1;
+    }
+}
+
+static inline uint32_t lowBits(uint32_t k) {
+    return k >= 32 ? 0xFFFFFFFFu : ((1u << k) - 1);
+}
+
+// ============================================================
+// SSE2: 16 bytes por iteração
+// ============================================================
+
+// x está em [lo, lo + len] (comparação sem sinal via min)
+static inline __m128i inRange16(__m128i x, char lo, char len) {
+    __m128i shifted = _mm_sub_epi8(x, _mm_set1_epi8(lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(len)), shifted);
+}
+
+static inline uint32_t spaceMask16(__m128i b) {
+    __m128i space = _mm_or_si128(_mm_cmpeq_epi8(b, _mm_set1_epi8(' ')),
+                                 inRange16(b, '\t', '\r' - '\t'));
+    return static_cast<uint32_t>(_mm_movemask_epi8(space));
+}
+
+static inline uint32_t identMask16(__m128i b) {
+    __m128i lower = _mm_or_si128(b, _mm_set1_epi8(0x20));
+    __m128i ident = _mm_or_si128(inRange16(lower, 'a', 'z' - 'a'),
+                                 _mm_or_si128(inRange16(b, '0', 9),
+                                              _mm_cmpeq_epi8(b, _mm_set1_epi8('_'))));
+    return static_cast<uint32_t>(_mm_movemask_epi8(ident));
+}
+
+static size_t skipWhitespaceSSE2(const char* p, size_t n, LineTracker& lines) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        uint32_t newline = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(b, _mm_set1_epi8('\n'))));
+        uint32_t stop = ~spaceMask16(b) & 0xFFFFu;
+        if (stop) {
+            uint32_t k = static_cast<uint32_t>(__builtin_ctz(stop));
+            countNewlines(newline & lowBits(k), p + i, lines);
+            return i + k;
+        }
+        countNewlines(newline, p + i, lines);
+    }
+    return i + skipWhitespaceScalar(p + i, n - i, lines);
+}
+
+static size_t findDelimiterSSE2(const char* p, size_t n, char delimiter, LineTracker& lines) {
+    size_t i = 0;
+    __m128i delim = _mm_set1_epi8(delimiter);
+    __m128i nl = _mm_set1_epi8('\n');
+    for (; i + 16 <= n; i += 16) {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        uint32_t newline = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(b, nl)));
+        uint32_t found = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(b, delim)));
+        if (found) {
+            uint32_t k = static_cast<uint32_t>(__builtin_ctz(found));
+            countNewlines(newline & lowBits(k), p + i, lines);
+            return i + k;
+        }
+        countNewlines(newline, p + i, lines);
+    }
+    return i + findDelimiterScalar(p + i, n - i, delimiter, lines);
+}
+
+static size_t identifierLengthSSE2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        uint32_t stop = ~identMask16(b) & 0xFFFFu;
+        if (stop) {
+            return i + static_cast<size_t>(__builtin_ctz(stop));
+        }
+    }
+    return i + identifierLengthScalar(p + i, n - i);
+}
+
+static size_t digitLengthSSE2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        uint32_t stop = ~static_cast<uint32_t>(_mm_movemask_epi8(inRange16(b, '0', 9))) & 0xFFFFu;
+        if (stop) {
+            return i + static_cast<size_t>(__builtin_ctz(stop));
+        }
+    }
+    return i + digitLengthScalar(p + i, n - i);
+}
+
+// ============================================================
+// AVX2: 32 bytes por iteração (selecionado em tempo de execução)
+// ============================================================
+
+#define FORTALL_AVX2 __attribute__((target("avx2")))
+
+FORTALL_AVX2 static inline __m256i inRange32(__m256i x, char lo, char len) {
+    __m256i shifted = _mm256_sub_epi8(x, _mm256_set1_epi8(lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(len)), shifted);
+}
+
+FORTALL_AVX2 static size_t skipWhitespaceAVX2(const char* p, size_t n, LineTracker& lines) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(b, _mm256_set1_epi8(' ')),
+                                        inRange32(b, '\t', '\r' - '\t'));
+        uint32_t newline = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, _mm256_set1_epi8('\n'))));
+        uint32_t stop = ~static_cast<uint32_t>(_mm256_movemask_epi8(space));
+        if (stop) {
+            uint32_t k = static_cast<uint32_t>(__builtin_ctz(stop));
+            countNewlines(newline & lowBits(k), p + i, lines);
+            return i + k;
+        }
+        countNewlines(newline, p + i, lines);
+    }
+    return i + skipWhitespaceSSE2(p + i, n - i, lines);
+}
+
+FORTALL_AVX2 static size_t findDelimiterAVX2(const char* p, size_t n, char delimiter, LineTracker& lines) {
+    size_t i = 0;
+    __m256i delim = _mm256_set1_epi8(delimiter);
+    __m256i nl = _mm256_set1_epi8('\n');
+    for (; i + 32 <= n; i += 32) {
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        uint32_t newline = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, nl)));
+        uint32_t found = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(b, delim)));
+        if (found) {
+            uint32_t k = static_cast<uint32_t>(__builtin_ctz(found));
+            countNewlines(newline & lowBits(k), p + i, lines);
+            return i + k;
+        }
+        countNewlines(newline, p + i, lines);
+    }
+    return i + findDelimiterSSE2(p + i, n - i, delimiter, lines);
+}
+
+FORTALL_AVX2 static size_t identifierLengthAVX2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i lower = _mm256_or_si256(b, _mm256_set1_epi8(0x20));
+        __m256i ident = _mm256_or_si256(inRange32(lower, 'a', 'z' - 'a'),
+                                        _mm256_or_si256(inRange32(b, '0', 9),
+                                                        _mm256_cmpeq_epi8(b, _mm256_set1_epi8('_'))));
+        uint32_t stop = ~static_cast<uint32_t>(_mm256_movemask_epi8(ident));
+        if (stop) {
+            return i + static_cast<size_t>(__builtin_ctz(stop));
+        }
+    }
+    return i + identifierLengthSSE2(p + i, n - i);
+}
+
+FORTALL_AVX2 static size_t digitLengthAVX2(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        uint32_t stop = ~static_cast<uint32_t>(_mm256_movemask_epi8(inRange32(b, '0', 9)));
+        if (stop) {
+            return i + static_cast<size_t>(__builtin_ctz(stop));
+        }
+    }
+    return i + digitLengthSSE2(p + i, n - i);
+}
+
+#endif // FORTALL_X86
+
+static const ScanKernels scalarKernels = {
+    skipWhitespaceScalar, findDelimiterScalar, identifierLengthScalar, digitLengthScalar
+};
+
+#ifdef FORTALL_X86
+static const ScanKernels sse2Kernels = {
+    skipWhitespaceSSE2, findDelimiterSSE2, identifierLengthSSE2, digitLengthSSE2
+};
+
+static const ScanKernels avx2Kernels = {
+    skipWhitespaceAVX2, findDelimiterAVX2, identifierLengthAVX2, digitLengthAVX2
+};
+#endif
+
+bool scanEngineAvailable(ScanEngine engine) {
+    switch (engine) {
+        case ScanEngine::AUTOMATICO:
+        case ScanEngine::ESCALAR:
+            return true;
+#ifdef FORTALL_X86
+        case ScanEngine::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case ScanEngine::AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+const ScanKernels& scanKernels(ScanEngine engine) {
+    if (engine == ScanEngine::AUTOMATICO) {
+        // Resolvido uma única vez por processo
+        static const ScanEngine best = scanEngineAvailable(ScanEngine::AVX2) ? ScanEngine::AVX2
+                                     : scanEngineAvailable(ScanEngine::SSE2) ? ScanEngine::SSE2
+                                     : ScanEngine::ESCALAR;
+        engine = best;
+    }
+
+    switch (engine) {
+#ifdef FORTALL_X86
+        case ScanEngine::SSE2:
+            return sse2Kernels;
+        case ScanEngine::AVX2:
+            return avx2Kernels;
+#endif
+        default:
+            return scalarKernels;
+    }
+}
+
+const char* scanEngineName(ScanEngine engine) {
+    switch (engine) {
+        case ScanEngine::AUTOMATICO: return "automatico";
+        case ScanEngine::ESCALAR: return "escalar";
+        case ScanEngine::SSE2: return "sse2";
+        case ScanEngine::AVX2: return "avx2";
+    }
+    return "desconhecido";
+}
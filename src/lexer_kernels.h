@@ -0,0 +1,54 @@
+#ifndef LEXER_KERNELS_H
+#define LEXER_KERNELS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Classes de caractere usadas pelo lexer. Substituem std::isspace/std::isalnum,
+// que dependem do locale e recebem char com sinal.
+enum CharClass : uint8_t {
+    CC_ESPACO = 1 << 0,     // ' ', \t, \n, \v, \f, \r
+    CC_LETRA = 1 << 1,      // a-z, A-Z
+    CC_DIGITO = 1 << 2,     // 0-9
+    CC_SUBLINHADO = 1 << 3  // _
+};
+
+extern const std::array<uint8_t, 256> charClassTable;
+
+inline bool hasCharClass(char c, uint8_t mask) {
+    return (charClassTable[static_cast<unsigned char>(c)] & mask) != 0;
+}
+
+// Contagem de linhas feita pelos kernels: quantas quebras de linha foram
+// consumidas e onde começa a linha corrente (para calcular a coluna).
+struct LineTracker {
+    int newlines;
+    const char* lineStart;
+};
+
+// Cada kernel recebe [p, p + n) e devolve quantos bytes consumiu.
+struct ScanKernels {
+    // Pula espaços em branco; atualiza o LineTracker
+    size_t (*skipWhitespace)(const char* p, size_t n, LineTracker& lines);
+    // Procura 'delimiter' (fim de comentário '}' ou aspa de string);
+    // devolve a posição do delimitador ou n se ele nao existir
+    size_t (*findDelimiter)(const char* p, size_t n, char delimiter, LineTracker& lines);
+    // Comprimento da sequência de letras, dígitos e '_'
+    size_t (*identifierLength)(const char* p, size_t n);
+    // Comprimento da sequência de dígitos
+    size_t (*digitLength)(const char* p, size_t n);
+};
+
+enum class ScanEngine {
+    AUTOMATICO,  // melhor disponível na CPU
+    ESCALAR,
+    SSE2,
+    AVX2
+};
+
+bool scanEngineAvailable(ScanEngine engine);
+const ScanKernels& scanKernels(ScanEngine engine);
+const char* scanEngineName(ScanEngine engine);
+
+#endif
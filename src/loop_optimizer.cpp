@@ -0,0 +1,659 @@
+#include "loop_optimizer.h"
+#include <algorithm>
+
+// Limites do desdobramento: cada um duplica o laço inteiro
+static const uint32_t MAX_UNSWITCH_LOOP = 256;     // nós do laço desdobrado
+static const size_t MAX_UNSWITCH_GROWTH = 4096;    // nós acrescentados no programa
+static const int MAX_ROUNDS = 4;
+
+static int32_t wrap(int64_t value) {
+    return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
+static bool isExpression(NodeType type) {
+    return type == NodeType::BINARIO || type == NodeType::UNARIO || type == NodeType::IDENTIFICADOR ||
+           type == NodeType::NUMERO || type == NodeType::LITERAL || type == NodeType::STRING_LITERAL;
+}
+
+AST LoopOptimizer::optimize(const AST& ast, const std::vector<SymbolType>& slotTypes) {
+    types = slotTypes;
+    firstTemporary = slotTypes.size();
+    stats = Stats();
+    growth = 0;
+    if (ast.empty()) {
+        return AST();
+    }
+
+    // Um desdobramento tira um 'se' de dentro do laço: a condição dele pode
+    // ser invariante no laço de fora, e as cópias podem ser desdobradas de
+    // novo. As temporárias de uma rodada sao gravadas antes do laço e lidas
+    // como variáveis inicializadas nas seguintes.
+    AST current = rebuild(ast);
+    size_t unswitched = 0;
+    for (int round = 1; round < MAX_ROUNDS && stats.unswitchedLoops > unswitched; round++) {
+        unswitched = stats.unswitchedLoops;
+        current = rebuild(current);
+    }
+
+    positions.clear();
+    commandAt.clear();
+    bodyOf.clear();
+    loopEnd.clear();
+    sizes.clear();
+    writeStart.clear();
+    writePositions.clear();
+    invariance.clear();
+    reductions.clear();
+    reductionOf.clear();
+    hoisted.clear();
+    return current;
+}
+
+// Numera os comandos em pré-ordem (a ordem do texto): os comandos de um
+// 'enquanto', condição inclusive, ficam em [posição do laço, loopEnd). Cada
+// gravação de variável (atribuição, ler) fica anotada com a posição do comando.
+void LoopOptimizer::analyze() {
+    const AST& tree = *source;
+    positions.assign(tree.size(), 0);
+    commandAt.clear();
+    bodyOf.assign(tree.size(), NO_NODE);
+    loopEnd.assign(tree.size(), 0);
+    invariance.assign(tree.size(), Invariance{0, false});
+    sizes.assign(tree.size(), 1);
+    for (NodeId id = 0; id < tree.size(); id++) {
+        for (NodeId child : tree.children(id)) {
+            sizes[id] += sizes[child]; // filhos vêm antes do pai
+        }
+    }
+
+    struct Visit {
+        NodeId node;
+        NodeId loop; // laço cujo corpo contém o nó direto
+        bool leave;
+    };
+    std::vector<Visit> stack{{tree.root, NO_NODE, false}};
+    std::vector<std::pair<uint32_t, uint32_t>> writes; // (slot, posição), em ordem de posição
+    uint32_t position = 0;
+    auto number = [&](const Visit& visit) {
+        positions[visit.node] = position;
+        commandAt.push_back(visit.node);
+        bodyOf[visit.node] = visit.loop;
+    };
+    while (!stack.empty()) {
+        Visit visit = stack.back();
+        stack.pop_back();
+        const ASTNode& node = tree[visit.node];
+        if (visit.leave) {
+            loopEnd[visit.node] = position;
+            continue;
+        }
+        ChildRange children = tree.children(visit.node);
+        switch (node.type) {
+            case NodeType::PROGRAMA:
+            case NodeType::LISTA_COMANDOS:
+                for (size_t i = children.size(); i-- > 0;) {
+                    stack.push_back({children[i], visit.loop, false});
+                }
+                break;
+            case NodeType::ATRIBUICAO:
+                number(visit);
+                if (!children.empty() && tree[children[0]].slot != NO_SLOT) {
+                    writes.push_back({tree[children[0]].slot, position});
+                }
+                position++;
+                break;
+            case NodeType::LER:
+                number(visit);
+                for (NodeId target : children) {
+                    if (tree[target].slot != NO_SLOT) writes.push_back({tree[target].slot, position});
+                }
+                position++;
+                break;
+            case NodeType::ESCREVER:
+                number(visit);
+                position++;
+                break;
+            case NodeType::SE:
+                number(visit);
+                position++;
+                for (size_t i = children.size(); i-- > 1;) {
+                    stack.push_back({children[i], NO_NODE, false});
+                }
+                break;
+            case NodeType::ENQUANTO:
+                number(visit);
+                position++;
+                stack.push_back({visit.node, NO_NODE, true});
+                if (children.size() > 1) stack.push_back({children[1], visit.node, false});
+                break;
+            default:
+                break;
+        }
+    }
+
+    writeStart.assign(types.size() + 1, 0);
+    for (const auto& write : writes) {
+        writeStart[write.first + 1]++;
+    }
+    for (size_t i = 1; i < writeStart.size(); i++) {
+        writeStart[i] += writeStart[i - 1];
+    }
+    writePositions.resize(writes.size());
+    std::vector<uint32_t> filled(writeStart.begin(), writeStart.end() - 1);
+    for (const auto& write : writes) {
+        writePositions[filled[write.first]++] = write.second;
+    }
+
+    findReductions();
+}
+
+// Produtos 'i * constante' (em qualquer ordem) de uma variável de indução,
+// agrupados por laço, variável e fator; só vira temporária o grupo com pelo
+// menos duas ocorrências no laço
+void LoopOptimizer::findReductions() {
+    const AST& tree = *source;
+    reductions.clear();
+    reductionOf.assign(tree.size(), NO_REDUCTION);
+
+    struct Occurrence {
+        NodeId loop;
+        uint32_t slot;
+        int32_t factor;
+        NodeId product;
+    };
+    std::vector<Occurrence> occurrences;
+    std::vector<NodeId> loops;
+    loopBegins.clear();
+    loopEnds.clear();
+    for (uint32_t position = 0; position < commandAt.size(); position++) {
+        while (!loopEnds.empty() && loopEnds.back() <= position) {
+            loops.pop_back();
+            loopBegins.pop_back();
+            loopEnds.pop_back();
+        }
+        NodeId command = commandAt[position];
+        const ASTNode& node = tree[command];
+        if (node.type == NodeType::ENQUANTO) {
+            loops.push_back(command);
+            loopBegins.push_back(position);
+            loopEnds.push_back(loopEnd[command]);
+        }
+        if (loops.empty() || node.childCount == 0 || node.type == NodeType::LER) {
+            continue;
+        }
+
+        search.clear();
+        if (node.type == NodeType::ESCREVER) {
+            for (NodeId child : tree.children(command)) search.push_back(child);
+        } else if (node.type == NodeType::ATRIBUICAO) {
+            if (node.childCount > 1) search.push_back(tree.child(command, 1));
+        } else {
+            search.push_back(tree.child(command, 0)); // condição do 'se'/'enquanto'
+        }
+        while (!search.empty()) {
+            NodeId id = search.back();
+            search.pop_back();
+            const ASTNode& expression = tree[id];
+            size_t operands = expressionOperands(expression);
+            if (expression.type == NodeType::BINARIO && expression.token.type == TokenType::MULTIPLICACAO &&
+                operands == 2 && expression.proven) {
+                const ASTNode* variable = &tree[tree.child(id, 0)];
+                const ASTNode* constant = &tree[tree.child(id, 1)];
+                if (variable->type == NodeType::NUMERO) std::swap(variable, constant);
+                if (variable->type == NodeType::IDENTIFICADOR && variable->slot != NO_SLOT &&
+                    constant->type == NodeType::NUMERO) {
+                    uint32_t depth = writerDepth(variable->slot, position);
+                    int32_t step;
+                    NodeId update;
+                    if (depth > 0 && inductionStep(loops[depth - 1], variable->slot, step, update)) {
+                        occurrences.push_back({loops[depth - 1], variable->slot, constant->value, id});
+                    }
+                    continue;
+                }
+            }
+            for (size_t i = 0; i < operands; i++) {
+                search.push_back(tree.child(id, i));
+            }
+        }
+    }
+    loopBegins.clear();
+    loopEnds.clear();
+
+    std::sort(occurrences.begin(), occurrences.end(), [](const Occurrence& a, const Occurrence& b) {
+        if (a.loop != b.loop) return a.loop < b.loop;
+        if (a.slot != b.slot) return a.slot < b.slot;
+        if (a.factor != b.factor) return a.factor < b.factor;
+        return a.product < b.product;
+    });
+    for (size_t begin = 0, end; begin < occurrences.size(); begin = end) {
+        const Occurrence& first = occurrences[begin];
+        for (end = begin + 1; end < occurrences.size() && occurrences[end].loop == first.loop &&
+                              occurrences[end].slot == first.slot && occurrences[end].factor == first.factor;
+             end++) {
+        }
+        if (end - begin < 2) continue;
+
+        int32_t step;
+        NodeId update;
+        inductionStep(first.loop, first.slot, step, update);
+        uint32_t index = static_cast<uint32_t>(reductions.size());
+        reductions.push_back({first.loop, first.slot, first.factor,
+                              wrap(static_cast<int64_t>(step) * first.factor), update, first.product, NO_SLOT});
+        for (size_t i = begin; i < end; i++) {
+            reductionOf[occurrences[i].product] = index;
+        }
+        if (reductionOf[first.loop] == NO_REDUCTION) reductionOf[first.loop] = index;
+        if (reductionOf[update] == NO_REDUCTION) reductionOf[update] = index;
+    }
+}
+
+// 'slot' é variável de indução do laço: a única gravação dela no laço é
+// 'slot := slot + passo' (ou '- passo'), direto no corpo, e roda uma vez por volta
+bool LoopOptimizer::inductionStep(NodeId loop, uint32_t slot, int32_t& step, NodeId& update) const {
+    const AST& tree = *source;
+    const uint32_t* first = writePositions.data() + writeStart[slot];
+    const uint32_t* last = writePositions.data() + writeStart[slot + 1];
+    const uint32_t* begin = std::lower_bound(first, last, positions[loop]);
+    const uint32_t* end = std::lower_bound(begin, last, loopEnd[loop]);
+    if (end - begin != 1) return false;
+
+    NodeId command = commandAt[*begin];
+    const ASTNode& node = tree[command];
+    if (bodyOf[command] != loop || node.type != NodeType::ATRIBUICAO || node.childCount < 2) return false;
+    NodeId value = tree.child(command, 1);
+    const ASTNode& expression = tree[value];
+    if (expression.type != NodeType::BINARIO || expression.childCount < 2) return false;
+
+    TokenType op = expression.token.type;
+    const ASTNode* variable = &tree[tree.child(value, 0)];
+    const ASTNode* constant = &tree[tree.child(value, 1)];
+    if (op == TokenType::MAIS && variable->type == NodeType::NUMERO) std::swap(variable, constant);
+    if ((op != TokenType::MAIS && op != TokenType::MENOS) || variable->type != NodeType::IDENTIFICADOR ||
+        variable->slot != slot || !variable->assigned || constant->type != NodeType::NUMERO) {
+        return false;
+    }
+    step = op == TokenType::MAIS ? constant->value : wrap(-static_cast<int64_t>(constant->value));
+    update = command;
+    return true;
+}
+
+// A cópia do laço começou: as temporárias das reduções dele recebem
+// 'i * fator' antes do laço ('i' já está inicializada: a leitura no passo é
+// 'assigned' e nenhuma outra gravação do laço vem antes dela)
+void LoopOptimizer::startReductions(NodeId loop) {
+    const AST& tree = *source;
+    std::vector<NodeId>& before = hoisted[loopBegins.size() - 1];
+    for (uint32_t r = reductionOf[loop]; r < reductions.size() && reductions[r].loop == loop; r++) {
+        Reduction& reduction = reductions[r];
+        const ASTNode& product = tree[reduction.product];
+        NodeId operands[2];
+        for (size_t i = 0; i < 2; i++) {
+            operands[i] = copyNode(tree[tree.child(reduction.product, i)]);
+            if (result[operands[i]].type == NodeType::IDENTIFICADOR) result[operands[i]].assigned = true;
+        }
+        reduction.temporary = newTemporary(product.valueType);
+        NodeId value = copyNode(product, operands, 2);
+        result[value].proven = true; // volta do complemento de dois, sem erro
+        before.push_back(assign(reduction.temporary, product.token, value));
+        stats.reducedProducts++;
+    }
+}
+
+// Quantos dos laços abertos gravam 'slot', para uma leitura na posição
+// 'position' (dentro de todos eles). Os laços abertos sao aninhados: os que
+// contêm uma gravação sao sempre os de fora, e basta olhar as gravações mais
+// próximas da leitura, antes e depois dela.
+uint32_t LoopOptimizer::writerDepth(uint32_t slot, uint32_t position) const {
+    const uint32_t* first = writePositions.data() + writeStart[slot];
+    const uint32_t* last = writePositions.data() + writeStart[slot + 1];
+    const uint32_t* after = std::upper_bound(first, last, position);
+    size_t depth = 0;
+    if (after != first) { // laços que começam antes da gravação
+        depth = std::upper_bound(loopBegins.begin(), loopBegins.end(), after[-1]) - loopBegins.begin();
+    }
+    if (after != last) { // laços que terminam depois dela
+        uint32_t write = *after;
+        size_t enclosing = std::partition_point(loopEnds.begin(), loopEnds.end(),
+                                                [write](uint32_t end) { return end > write; }) -
+                           loopEnds.begin();
+        depth = std::max(depth, enclosing);
+    }
+    return static_cast<uint32_t>(depth);
+}
+
+// Invariância da expressão lida na posição 'position'; a dos operadores fica
+// em 'invariance'
+LoopOptimizer::Invariance LoopOptimizer::classify(NodeId root, uint32_t position) {
+    const AST& tree = *source;
+    return foldExpression(tree, root, classifyStack, [&](const ASTNode& node, const Invariance* operands) {
+        if (!operands) {
+            switch (node.type) {
+                case NodeType::NUMERO:
+                case NodeType::LITERAL:
+                    return Invariance{0, true};
+                case NodeType::IDENTIFICADOR:
+                    if (node.slot == NO_SLOT) return Invariance{0, false};
+                    return Invariance{writerDepth(node.slot, position), node.assigned};
+                default:
+                    return Invariance{0, false};
+            }
+        }
+        NodeId id = static_cast<NodeId>(&node - tree.nodes.data());
+        Invariance info = operands[0];
+        if (expressionOperands(node) > 1) {
+            info.depth = std::max(info.depth, operands[1].depth);
+            info.safe = info.safe && operands[1].safe;
+        }
+        if (mayOverflow(node) && !node.proven) {
+            info.safe = false; // a RangeAnalysis nao descartou o estouro
+        }
+        if (node.type == NodeType::BINARIO && node.token.type == TokenType::DIVISAO) {
+            // Só por uma constante diferente de 0 e de -1: uma divisão provada
+            // pela RangeAnalysis pode depender da condição do laço
+            const ASTNode& divisor = tree[tree.child(id, 1)];
+            info.safe = info.safe && divisor.type == NodeType::NUMERO && divisor.value != 0 && divisor.value != -1;
+        }
+        invariance[id] = info;
+        return info;
+    });
+}
+
+void LoopOptimizer::pushLoop(NodeId loop) {
+    loopBegins.push_back(positions[loop]);
+    loopEnds.push_back(loopEnd[loop]);
+    if (hoisted.size() < loopBegins.size()) {
+        hoisted.resize(loopBegins.size());
+    }
+}
+
+void LoopOptimizer::popLoop() {
+    loopBegins.pop_back();
+    loopEnds.pop_back();
+}
+
+// Primeiro 'se' do corpo do laço (fora dos laços de dentro) com condição
+// invariante e que nao pode falhar; o laço já está na pilha
+NodeId LoopOptimizer::findUnswitch(NodeId loop) {
+    const AST& tree = *source;
+    uint32_t depth = static_cast<uint32_t>(loopBegins.size());
+    search.clear();
+    if (tree[loop].childCount > 1) {
+        search.push_back(tree.child(loop, 1));
+    }
+    while (!search.empty()) {
+        NodeId id = search.back();
+        search.pop_back();
+        const ASTNode& node = tree[id];
+        ChildRange children = tree.children(id);
+        if (node.type == NodeType::LISTA_COMANDOS) {
+            for (size_t i = children.size(); i-- > 0;) {
+                search.push_back(children[i]);
+            }
+        } else if (node.type == NodeType::SE && node.childCount >= 2) {
+            Invariance condition = classify(children[0], positions[id]);
+            if (condition.safe && condition.depth < depth) {
+                return id;
+            }
+            for (size_t i = children.size(); i-- > 1;) {
+                search.push_back(children[i]);
+            }
+        }
+    }
+    return NO_NODE;
+}
+
+// Reconstrói a árvore em pós-ordem, com pilha explícita: desdobra os laços
+// escolhidos e tira as expressões invariantes dos laços
+AST LoopOptimizer::rebuild(const AST& tree) {
+    source = &tree;
+    result = AST();
+    analyze();
+    loopBegins.clear();
+    loopEnds.clear();
+    frames.clear();
+    pending.clear();
+
+    frames.push_back({tree.root, 0, tree[tree.root].childCount, 0, Kind::COPY, NO_NODE, 0});
+    while (!frames.empty()) {
+        Frame& frame = frames.back();
+        if (frame.kind == Kind::UNSWITCH) {
+            unswitchStep();
+            continue;
+        }
+        if (frame.next < frame.end) {
+            NodeId child = tree.child(frame.node, frame.next++);
+            enter(child, frame.node, frame.specialized, frame.taken); // pode empilhar um quadro
+            continue;
+        }
+        Frame done = frame;
+        frames.pop_back();
+        if (done.kind == Kind::SPLICE) {
+            continue;
+        }
+        const ASTNode& node = tree[done.node];
+        NodeId copy = copyNode(node, pending.data() + done.mark, pending.size() - done.mark);
+        pending.resize(done.mark);
+        if (node.type == NodeType::ENQUANTO) {
+            // As temporárias deste laço sao calculadas logo antes dele
+            std::vector<NodeId>& before = hoisted[loopBegins.size() - 1];
+            pending.insert(pending.end(), before.begin(), before.end());
+            before.clear();
+            popLoop();
+        }
+        pending.push_back(copy);
+    }
+    result.root = pending.back();
+    return std::move(result);
+}
+
+void LoopOptimizer::enter(NodeId id, NodeId owner, NodeId specialized, uint8_t taken) {
+    const AST& tree = *source;
+    const ASTNode& node = tree[id];
+    if (isExpression(node.type)) {
+        pending.push_back(copyExpression(id, positions[owner])); // condição do 'se'/'enquanto'
+        return;
+    }
+
+    switch (node.type) {
+        case NodeType::ATRIBUICAO:
+        case NodeType::LER:
+        case NodeType::ESCREVER: {
+            size_t mark = pending.size();
+            for (NodeId child : tree.children(id)) {
+                pending.push_back(copyExpression(child, positions[id]));
+            }
+            NodeId copy = copyNode(node, pending.data() + mark, pending.size() - mark);
+            pending.resize(mark);
+            pending.push_back(copy);
+            // Depois de 'i := i + passo': $t := $t + passo * fator
+            for (uint32_t r = reductionOf[id]; r < reductions.size() && reductions[r].update == id; r++) {
+                const Reduction& reduction = reductions[r];
+                const Token& at = tree[reduction.product].token;
+                texts.push_back(std::to_string(reduction.increment));
+                NodeId operands[2];
+                operands[0] = temporary(reduction.temporary, at, true);
+                operands[1] = result.addNode(NodeType::NUMERO, Token(TokenType::NUMERO, texts.back(), at.line, at.column));
+                result[operands[1]].valueType = SymbolType::INTEIRO;
+                result[operands[1]].value = reduction.increment;
+                NodeId sum = result.addNode(NodeType::BINARIO, Token(TokenType::MAIS, "+", at.line, at.column), operands, 2);
+                result[sum].valueType = SymbolType::INTEIRO;
+                result[sum].proven = true;
+                pending.push_back(assign(reduction.temporary, at, sum));
+            }
+            return;
+        }
+        case NodeType::SE:
+            if (id == specialized) {
+                // Cópia de um laço desdobrado: fica só o bloco que vale nela
+                if (taken < node.childCount) {
+                    NodeId block = tree.child(id, taken);
+                    if (tree[block].type == NodeType::LISTA_COMANDOS) {
+                        frames.push_back({block, 0, tree[block].childCount, pending.size(), Kind::SPLICE,
+                                          specialized, taken});
+                    } else {
+                        frames.push_back({id, taken, taken + 1u, pending.size(), Kind::SPLICE, specialized, taken});
+                    }
+                }
+                return;
+            }
+            break;
+        case NodeType::ENQUANTO:
+            pushLoop(id);
+            if (specialized == NO_NODE && sizes[id] <= MAX_UNSWITCH_LOOP &&
+                growth + sizes[id] <= MAX_UNSWITCH_GROWTH) {
+                NodeId choice = findUnswitch(id);
+                if (choice != NO_NODE) {
+                    popLoop(); // cada cópia abre o laço de novo
+                    growth += sizes[id];
+                    stats.unswitchedLoops++;
+                    frames.push_back({id, 0, 0, pending.size(), Kind::UNSWITCH, choice, 0});
+                    return;
+                }
+            }
+            startReductions(id);
+            break;
+        default:
+            break;
+    }
+    frames.push_back({id, 0, node.childCount, pending.size(), Kind::COPY, specialized, taken});
+}
+
+// Um passo do desdobramento do laço do quadro do topo:
+//   se <condição> entao <laço só com o 'entao'> senao <laço só com o 'senao'> fim_se
+// A condição é calculada uma vez, antes do laço.
+void LoopOptimizer::unswitchStep() {
+    const AST& tree = *source;
+    Frame& frame = frames.back();
+    uint32_t step = frame.next++;
+    NodeId loop = frame.node;
+    NodeId choice = frame.specialized;
+    size_t mark = frame.mark;
+
+    switch (step) {
+        case 0:
+            pending.push_back(copyExpression(tree.child(choice, 0), positions[choice]));
+            break;
+        case 1:
+        case 2:
+            if (step == 2) {
+                pending.push_back(wrapList(mark + 1));
+            }
+            pushLoop(loop);
+            startReductions(loop);
+            frames.push_back({loop, 0, tree[loop].childCount, pending.size(), Kind::COPY, choice,
+                              static_cast<uint8_t>(step)});
+            break;
+        default: {
+            pending.push_back(wrapList(mark + 2));
+            NodeId copy = copyNode(tree[choice], pending.data() + mark, pending.size() - mark);
+            pending.resize(mark);
+            pending.push_back(copy);
+            frames.pop_back();
+            break;
+        }
+    }
+}
+
+// Lista de comandos com os nós de 'pending' a partir de 'mark'
+NodeId LoopOptimizer::wrapList(size_t mark) {
+    NodeId list = result.addNode(NodeType::LISTA_COMANDOS, Token(), pending.data() + mark, pending.size() - mark);
+    pending.resize(mark);
+    return list;
+}
+
+// Copia uma expressão lida na posição 'position', trocando cada subexpressão
+// invariante em algum laço aberto (a maior possível) por uma temporária
+NodeId LoopOptimizer::copyExpression(NodeId root, uint32_t position) {
+    const AST& tree = *source;
+    uint32_t depth = static_cast<uint32_t>(loopBegins.size());
+    if (expressionOperands(tree[root]) == 0) {
+        return copyNode(tree[root]);
+    }
+    bool hoisting = depth > 0;
+    if (hoisting) {
+        classify(root, position);
+    }
+
+    size_t base = values.size();
+    auto enterExpression = [&](NodeId id, uint32_t context) {
+        const ASTNode& node = tree[id];
+        if (expressionOperands(node) == 0) {
+            values.push_back(copyNode(node));
+            return;
+        }
+        if (reductionOf[id] != NO_REDUCTION) {
+            values.push_back(temporary(reductions[reductionOf[id]].temporary, node.token, true));
+            return;
+        }
+        const Invariance& info = invariance[id];
+        if (hoisting && info.safe && info.depth < context) {
+            expressionFrames.push_back({id, info.depth, 0, values.size(), true});
+        } else {
+            expressionFrames.push_back({id, context, 0, values.size(), false});
+        }
+    };
+
+    enterExpression(root, depth);
+    while (!expressionFrames.empty()) {
+        ExpressionFrame& frame = expressionFrames.back();
+        if (frame.next < expressionOperands(tree[frame.node])) {
+            NodeId child = tree.child(frame.node, frame.next++);
+            enterExpression(child, frame.context);
+            continue;
+        }
+        ExpressionFrame done = frame;
+        expressionFrames.pop_back();
+        const ASTNode& node = tree[done.node];
+        NodeId copy = copyNode(node, values.data() + done.mark, values.size() - done.mark);
+        values.resize(done.mark);
+        values.push_back(done.hoist ? hoist(done.context, node, copy) : copy);
+    }
+    NodeId copy = values.back();
+    values.resize(base);
+    return copy;
+}
+
+// Atribui 'value' (cópia de 'expression') a uma temporária nova antes do laço
+// 'level' da pilha e devolve a leitura dela
+NodeId LoopOptimizer::hoist(uint32_t level, const ASTNode& expression, NodeId value) {
+    uint32_t slot = newTemporary(expression.valueType);
+    hoisted[level].push_back(assign(slot, expression.token, value));
+    stats.hoistedExpressions++;
+    return temporary(slot, expression.token, true); // gravada antes do laço
+}
+
+uint32_t LoopOptimizer::newTemporary(SymbolType type) {
+    uint32_t slot = static_cast<uint32_t>(types.size());
+    types.push_back(type);
+    names.push_back("$t" + std::to_string(slot - firstTemporary));
+    return slot;
+}
+
+// Nó da temporária 'slot', na linha e coluna de 'position'
+NodeId LoopOptimizer::temporary(uint32_t slot, const Token& position, bool read) {
+    Token token(TokenType::IDENTIFICADOR, names[slot - firstTemporary], position.line, position.column);
+    NodeId id = result.addNode(NodeType::IDENTIFICADOR, token);
+    result[id].valueType = types[slot];
+    result[id].slot = slot;
+    result[id].assigned = read;
+    return id;
+}
+
+NodeId LoopOptimizer::assign(uint32_t slot, const Token& position, NodeId value) {
+    NodeId children[2] = {temporary(slot, position, false), value};
+    return result.addNode(NodeType::ATRIBUICAO, Token(), children, 2);
+}
+
+NodeId LoopOptimizer::copyNode(const ASTNode& node, const NodeId* children, size_t count) {
+    NodeId id = result.addNode(node.type, node.token, children, count);
+    ASTNode& copy = result[id];
+    copy.valueType = node.valueType;
+    copy.assigned = node.assigned;
+    copy.proven = node.proven;
+    if (node.type == NodeType::IDENTIFICADOR) {
+        copy.slot = node.slot;
+    } else {
+        copy.value = node.value;
+    }
+    return id;
+}
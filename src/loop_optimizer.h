@@ -0,0 +1,148 @@
+#ifndef LOOP_OPTIMIZER_H
+#define LOOP_OPTIMIZER_H
+
+#include "ast.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+// Otimização dos laços 'enquanto', depois do Optimizer:
+//
+// - Desdobramento (unswitching): um 'se' no corpo de um laço cuja condição
+//   nao muda dentro do laço vai para fora dele, com uma cópia do laço em cada
+//   bloco; cada cópia fica só com o lado do 'se' que vale nela. Cada rodada
+//   desdobra no máximo um 'se' por laço, e o crescimento da árvore é limitado.
+// - Movimentação de código invariante: uma subexpressão cujas variáveis o
+//   laço nunca grava é calculada uma vez numa variável temporária ($t0, $t1,
+//   ...), atribuída logo antes do laço mais externo em que ela é invariante.
+// - Redução de força: numa variável de indução (gravada no laço só por
+//   'i := i + passo', direto no corpo), 'i * constante' vira uma temporária
+//   calculada antes do laço e somada logo depois de cada 'i := i + passo'.
+//   Uma soma por volta custa tanto quanto uma multiplicação no interpretador,
+//   entao o mesmo produto tem que aparecer pelo menos duas vezes no laço. O
+//   produto tem que ter sido provado sem estouro pela RangeAnalysis: a
+//   temporária é somada sem testes (com a volta do complemento de dois) e,
+//   onde o produto é lido, vale exatamente i * constante.
+//
+// Só sai de um laço o que nao pode falhar: as variáveis lidas estao
+// inicializadas em todos os caminhos (nó 'assigned'), as contas foram
+// provadas sem estouro ('proven') e uma divisão é só por uma constante
+// diferente de 0 e de -1. Calcular uma expressão dessas antes do laço nao
+// muda nada, nem quando o laço roda zero vezes: uma conta provada só com a
+// condição do laço dá a volta sem erro e o valor nao é lido.
+class LoopOptimizer {
+public:
+    struct Stats {
+        size_t hoistedExpressions = 0; // temporárias criadas antes de um laço
+        size_t unswitchedLoops = 0;    // laços trocados por um 'se' com duas cópias
+        size_t reducedProducts = 0;    // produtos trocados por uma soma a cada volta
+    };
+
+private:
+    // Laços de fora para dentro em que uma expressão deixa de ser invariante:
+    // ela pode sair dos laços da pilha a partir do índice 'depth'
+    struct Invariance {
+        uint32_t depth;
+        bool safe; // nao pode falhar na execução
+    };
+
+    enum class Kind : uint8_t {
+        COPY,    // copia o nó com os filhos
+        SPLICE,  // os filhos vao para a lista de cima, sem nó próprio
+        UNSWITCH // troca o laço por 'se' (condição, cópia, cópia)
+    };
+    struct Frame {
+        NodeId node;
+        uint32_t next;
+        uint32_t end;
+        size_t mark;
+        Kind kind;
+        NodeId specialized; // 'se' trocado pelo bloco 'taken' nesta subárvore
+        uint8_t taken;
+    };
+
+    // Produto 'i * fator' de uma variável de indução do laço
+    struct Reduction {
+        NodeId loop;
+        uint32_t slot;      // a variável de indução
+        int32_t factor;
+        int32_t increment;  // passo vezes fator
+        NodeId update;      // 'i := i + passo'
+        NodeId product;     // primeira ocorrência
+        uint32_t temporary; // slot da temporária na cópia do laço em construção
+    };
+    static constexpr uint32_t NO_REDUCTION = UINT32_MAX;
+
+    struct ExpressionFrame {
+        NodeId node;
+        uint32_t context; // profundidade de laços onde a expressão é calculada
+        uint32_t next;
+        size_t mark;
+        bool hoist;       // vira uma temporária no nível 'context'
+    };
+
+    const AST* source;
+    AST result;
+    std::vector<SymbolType> types;
+    size_t firstTemporary = 0;
+    Stats stats;
+    size_t growth = 0;                   // nós acrescentados pelos desdobramentos
+    std::deque<std::string> names;       // nomes das temporárias ($t0, ...), por slot
+    std::deque<std::string> texts;       // números criados; referências estáveis
+
+    // Análise da árvore da rodada, em ordem de execução dos comandos
+    std::vector<uint32_t> positions;     // por comando
+    std::vector<NodeId> commandAt;       // por posição
+    std::vector<NodeId> bodyOf;          // por comando: o laço cujo corpo o contém direto
+    std::vector<uint32_t> loopEnd;       // por 'enquanto': primeira posição depois do corpo
+    std::vector<uint32_t> sizes;         // nós de cada subárvore
+    std::vector<uint32_t> writeStart;    // por slot, em 'writePositions' (+ sentinela)
+    std::vector<uint32_t> writePositions; // posições das gravações, crescentes por slot
+    std::vector<Invariance> invariance;  // por operador, da última 'classify'
+    std::vector<Reduction> reductions;   // em ordem de laço, variável e fator
+    std::vector<uint32_t> reductionOf;   // produto, laço ou 'i := i + passo' -> primeira redução
+
+    // Laços abertos durante a reconstrução, de fora para dentro
+    std::vector<uint32_t> loopBegins;
+    std::vector<uint32_t> loopEnds;
+    std::vector<std::vector<NodeId>> hoisted; // atribuições a pôr antes de cada laço aberto
+
+    std::vector<Frame> frames;
+    std::vector<NodeId> pending;
+    std::vector<ExpressionFrame> expressionFrames;
+    std::vector<NodeId> values;
+    std::vector<NodeId> search;
+    ExpressionStack<Invariance> classifyStack;
+
+    void analyze();
+    void findReductions();
+    bool inductionStep(NodeId loop, uint32_t slot, int32_t& step, NodeId& update) const;
+    void startReductions(NodeId loop);
+    AST rebuild(const AST& tree);
+    void enter(NodeId id, NodeId owner, NodeId specialized, uint8_t taken);
+    void unswitchStep();
+    void pushLoop(NodeId loop);
+    void popLoop();
+    NodeId findUnswitch(NodeId loop);
+    Invariance classify(NodeId root, uint32_t position);
+    uint32_t writerDepth(uint32_t slot, uint32_t position) const;
+    NodeId copyExpression(NodeId root, uint32_t position);
+    NodeId hoist(uint32_t level, const ASTNode& expression, NodeId value);
+    uint32_t newTemporary(SymbolType type);
+    NodeId temporary(uint32_t slot, const Token& position, bool read);
+    NodeId assign(uint32_t slot, const Token& position, NodeId value);
+    NodeId wrapList(size_t mark);
+    NodeId copyNode(const ASTNode& node, const NodeId* children = nullptr, size_t count = 0);
+
+public:
+    // 'ast' é uma árvore do Optimizer (sem nós compartilhados) com os slots
+    // 'slotTypes'. A árvore devolvida usa também os slots das temporárias
+    // (slotTypes()) e só vale enquanto este objeto existir (os nomes delas
+    // ficam aqui).
+    AST optimize(const AST& ast, const std::vector<SymbolType>& slotTypes);
+
+    const std::vector<SymbolType>& slotTypes() const { return types; }
+    const Stats& loopStats() const { return stats; }
+};
+
+#endif
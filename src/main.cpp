@@ -1,86 +1,420 @@
 
 #include <iostream>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <sstream>
+#include "source_buffer.h"
 #include "lexer.h"
+#include "token_buffer.h"
+#include "streaming_lexer.h"
+#include "reference_lexer.h"
+#include "token_pipeline.h"
 #include "parser.h"
 #include "semantic.h"
 #include "interpreter.h"
 #include "symbol_table.h"
-
-std::string readFile(const std::string &filename)
+#include "program_cache.h"
+#include "bench.h"
+#include "slot_resolver.h"
+#include "optimizer.h"
+#include "loop_optimizer.h"
+#include "common_subexpressions.h"
+#include "range_analysis.h"
+#include "definite_assignment.h"
+#include "ir_builder.h"
+#include "pass_manager.h"
+#include "ir_interpreter.h"
+
+struct CompileOptions
+{
+    bool parallelLex = false; // --parallel-lex[=N]: pré-tokeniza o arquivo em paralelo
+    unsigned lexThreads = 0;  // 0 = todos os núcleos
+    bool streamLex = false;   // --stream-lex: lê a fonte por uma janela de tamanho fixo
+    bool pipelined = false;   // --pipelined: lexer e parser em threads separadas
+    bool dumpAst = false;     // --dump-ast: imprime a AST antes da análise semântica
+    bool singlePass = false;  // --single-pass: análise semântica durante o parsing
+    bool hashCons = false;    // --hash-cons: subexpressões iguais compartilham um nó (implica --single-pass)
+    bool optimize = true;     // --no-optimize: executa a árvore como saiu da análise semântica
+    bool commonSubexpressions = true; // --no-cse: nao elimina as subexpressões comuns
+    bool dumpOptimized = false; // --dump-optimized: imprime a árvore que vai ser executada
+    bool useCache = false;    // --cache: lê e grava o cache (.fortc); --no-cache desliga
+    bool clearCache = false;  // --clear-cache: apaga o cache do programa antes de compilar
+    size_t *evaluatedOperators = nullptr; // recebe os operadores avaliados na execução (cse-report)
+    int irLevel = -1;         // -O0, -O1, -O2: executa pela IR com as passadas do nível (-1 = pela árvore)
+    std::string irPasses;     // --passes=a,b: roda só essas passadas sobre a IR, na ordem dada
+    bool dumpIR = false;      // --dump-ir: imprime a IR depois das passadas
+    bool verifyIR = false;    // --verify-ir: confere a IR depois de cada passada
+};
+
+bool parseOption(const std::string &arg, CompileOptions &options)
 {
-    std::ifstream file(filename);
-    if (!file.is_open())
+    if (arg == "--stream-lex")
     {
-        return "";
+        options.streamLex = true;
+        return true;
     }
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    return buffer.str();
+    if (arg == "--pipelined")
+    {
+        options.pipelined = true;
+        return true;
+    }
+    if (arg == "--dump-ast")
+    {
+        options.dumpAst = true;
+        return true;
+    }
+    if (arg == "--single-pass")
+    {
+        options.singlePass = true;
+        return true;
+    }
+    if (arg == "--hash-cons")
+    {
+        options.hashCons = true;
+        options.singlePass = true;
+        return true;
+    }
+    if (arg == "--no-optimize")
+    {
+        options.optimize = false;
+        return true;
+    }
+    if (arg == "--no-cse")
+    {
+        options.commonSubexpressions = false;
+        return true;
+    }
+    if (arg == "--dump-optimized")
+    {
+        options.dumpOptimized = true;
+        return true;
+    }
+    if (arg == "-O0" || arg == "-O1" || arg == "-O2")
+    {
+        options.irLevel = arg[2] - '0';
+        return true;
+    }
+    if (arg.rfind("--passes=", 0) == 0)
+    {
+        options.irPasses = arg.substr(9);
+        if (options.irLevel < 0)
+            options.irLevel = 0;
+        return true;
+    }
+    if (arg == "--dump-ir")
+    {
+        options.dumpIR = true;
+        if (options.irLevel < 0)
+            options.irLevel = 0;
+        return true;
+    }
+    if (arg == "--verify-ir")
+    {
+        options.verifyIR = true;
+        if (options.irLevel < 0)
+            options.irLevel = 0;
+        return true;
+    }
+    if (arg == "--cache")
+    {
+        options.useCache = true;
+        return true;
+    }
+    if (arg == "--no-cache")
+    {
+        options.useCache = false;
+        return true;
+    }
+    if (arg == "--clear-cache")
+    {
+        options.clearCache = true;
+        return true;
+    }
+    if (arg == "--parallel-lex")
+    {
+        options.parallelLex = true;
+        return true;
+    }
+    if (arg.rfind("--parallel-lex=", 0) == 0)
+    {
+        try
+        {
+            int threads = std::stoi(arg.substr(15));
+            if (threads < 0)
+                return false;
+            options.parallelLex = true;
+            options.lexThreads = static_cast<unsigned>(threads);
+            return true;
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+    }
+    return false;
 }
 
 void showHelp()
 {
     std::cout << "\n=== COMPILADOR/INTERPRETADOR FORTALL ===" << std::endl;
-    std::cout << "Uso: fortall <arquivo.fort>" << std::endl;
+    std::cout << "Uso: fortall [opcoes] <arquivo.fort>" << std::endl;
     std::cout << "Comandos disponiveis:" << std::endl;
     std::cout << "  help    - Mostra esta ajuda" << std::endl;
     std::cout << "  exit    - Sair do programa" << std::endl;
     std::cout << "  test    - Executar todos os testes" << std::endl;
+    std::cout << "  difftest [diretorio] - Compara a saida de cada programa .fort com e sem otimizacao (padrao: tests; com -O, pela IR)" << std::endl;
+    std::cout << "  cse-report [diretorio] - Conta os operadores avaliados em cada programa .fort com e sem eliminacao de subexpressoes comuns (padrao: tests)" << std::endl;
+    std::cout << "  lexcheck [arquivo.fort|diretorio] - Compara os tokens de cada motor do lexer com os do lexer de referencia (padrao: tests)" << std::endl;
+    std::cout << "  bench-lex <arquivo.fort> - Mede a vazao do lexer paralelo por numero de threads" << std::endl;
+    std::cout << "  bench-frontend <arquivo.fort> - Compara o front end serial e em pipeline" << std::endl;
+    std::cout << "  bench-cache <arquivo.fort> - Compara compilar o programa com carrega-lo do cache" << std::endl;
+    std::cout << "  bench-exec [iteracoes] - Mede a execucao de lacos com muitas operacoes aritmeticas e condicoes" << std::endl;
+    std::cout << "  bench-nesting [profundidade] - Mede parser, semantica e execucao em programas muito aninhados" << std::endl;
+    std::cout << "Opcoes:" << std::endl;
+    std::cout << "  --parallel-lex[=N] - Pre-tokeniza o arquivo com N threads (padrao: todos os nucleos)" << std::endl;
+    std::cout << "  --stream-lex       - Le o arquivo aos poucos, sem carrega-lo inteiro na memoria" << std::endl;
+    std::cout << "  --pipelined        - Executa lexer e parser em threads separadas" << std::endl;
+    std::cout << "  --dump-ast         - Imprime a arvore sintatica antes da analise semantica" << std::endl;
+    std::cout << "  --single-pass      - Verifica declaracoes e tipos durante a analise sintatica" << std::endl;
+    std::cout << "  --hash-cons        - Compartilha as subexpressoes iguais na arvore (implica --single-pass)" << std::endl;
+    std::cout << "  --no-optimize      - Executa o programa sem otimizar (faixas, constantes, codigo morto, lacos, subexpressoes)" << std::endl;
+    std::cout << "  --no-cse           - Nao elimina as subexpressoes comuns (calculadas de novo a cada ocorrencia)" << std::endl;
+    std::cout << "  --dump-optimized   - Imprime a arvore otimizada, que e a executada" << std::endl;
+    std::cout << "  -O0, -O1, -O2      - Executa pela representacao intermediaria (SSA), com as passadas do nivel" << std::endl;
+    std::cout << "  --passes=a,b       - Roda so essas passadas sobre a IR (fold, simplify-cfg, dce, gvn, licm)" << std::endl;
+    std::cout << "  --dump-ir          - Imprime a IR depois das passadas" << std::endl;
+    std::cout << "  --verify-ir        - Confere a IR depois de cada passada" << std::endl;
+    std::cout << "  --cache            - Usa o cache de programas compilados (.fortc): carrega ou grava" << std::endl;
+    std::cout << "  --no-cache         - Nao usa o cache (padrao)" << std::endl;
+    std::cout << "  --clear-cache      - Apaga o cache do programa antes de compila-lo" << std::endl;
     std::cout << "\nExemplo: fortall programa.fort" << std::endl;
 }
 
-bool compileAndRun(const std::string &filename)
+// Fases seguintes à análise léxica, comuns a todas as fontes de tokens: o
+// programa verificado fica em 'ast' e 'symbolTable'
+bool compileTokens(TokenStream &tokenStream, const CompileOptions &options, AST &ast, SymbolTable &symbolTable)
 {
-    std::cout << "Compilando arquivo: " << filename << std::endl;
+    SemanticAnalyzer semantic(symbolTable);
 
-    std::string source = readFile(filename);
-    if (source.empty())
+    // analise sintatica (e semantica, em uma passada)
+    if (options.singlePass)
+        std::cout << "Executando analise sintatica e semantica..." << std::endl;
+    else
+        std::cout << "Executando analise sintatica..." << std::endl;
+    Parser parser(tokenStream, options.singlePass ? &semantic : nullptr, options.hashCons);
+    ast = parser.parse();
+
+    // Erros de sintaxe têm prioridade, como nas duas passadas
+    if (parser.hasError())
     {
-        std::cout << "Erro: Nao foi possível ler o arquivo '" << filename << "'" << std::endl;
+        std::cout << parser.getError() << std::endl;
         return false;
     }
 
-    // analise lexica
-    std::cout << "Executando analise lexica..." << std::endl;
-    Lexer lexer(source);
+    if (ast.empty())
+    {
+        std::cout << "Erro: Falha na analise sintatica" << std::endl;
+        return false;
+    }
 
-    // analise sintatica
-    std::cout << "Executando analise sintatica..." << std::endl;
-    Parser parser(lexer);
-    auto ast = parser.parse();
+    if (options.hashCons)
+    {
+        const Parser::SharingStats &sharing = parser.sharingStats();
+        std::cout << "Hash-consing: " << sharing.reusedNodes << " de " << sharing.expressionNodes
+                  << " nos de expressao compartilhados, " << sharing.savedBytes << " bytes economizados" << std::endl;
+    }
 
-    if (parser.hasError())
+    if (options.dumpAst)
     {
-        std::cout << parser.getError() << std::endl;
+        printAST(ast, std::cout);
+    }
+
+    if (options.singlePass)
+    {
+        if (semantic.hasError())
+        {
+            std::cout << semantic.getError() << std::endl;
+            return false;
+        }
+    }
+    else
+    {
+        // analise semantica
+        std::cout << "Executando analise semantica..." << std::endl;
+        if (!semantic.analyze(ast))
+        {
+            std::cout << semantic.getError() << std::endl;
+            return false;
+        }
+    }
+
+    // Leituras de variáveis: sempre inicializadas, nunca, ou só testáveis na execução
+    DefiniteAssignment initialization;
+    if (!initialization.analyze(ast))
+    {
+        std::cout << initialization.getError() << std::endl;
         return false;
     }
+    return true;
+}
 
-    if (!ast)
+// Execução pela IR: a árvore resolvida (com as faixas de valores a partir
+// de -O1) vira SSA, passa pelas passadas do nível e roda no IRInterpreter
+bool runIR(AST &ast, const SlotResolver &resolver, const CompileOptions &options)
+{
+    if (options.irLevel >= 1)
     {
-        std::cout << "Erro: Falha na analise sintatica" << std::endl;
+        RangeAnalysis ranges;
+        ranges.analyze(ast, resolver.slotTypes());
+        for (const std::string &warning : ranges.getWarnings())
+        {
+            std::cout << warning << std::endl;
+        }
+        const RangeAnalysis::Stats &checks = ranges.rangeStats();
+        if (checks.arithmetic + checks.divisions > 0)
+        {
+            std::cout << "Faixas de valores: " << checks.provenArithmetic << " de " << checks.arithmetic
+                      << " contas sem teste de estouro, " << checks.provenDivisions << " de " << checks.divisions
+                      << " divisoes sem teste de divisor" << std::endl;
+        }
+    }
+
+    IRBuilder builder;
+    IRFunction ir = builder.build(ast, resolver.slotTypes());
+    size_t blocks = ir.liveBlocks();
+    size_t instructions = ir.liveInstructions();
+    PassManager passManager;
+    passManager.setLevel(options.irLevel);
+    if (!options.irPasses.empty() && !passManager.setPasses(options.irPasses))
+    {
+        std::cout << "Erro: " << passManager.getError() << std::endl;
+        return false;
+    }
+    passManager.setVerify(options.verifyIR);
+    if (!passManager.run(ir))
+    {
+        std::cout << "Erro: " << passManager.getError() << std::endl;
         return false;
     }
+    for (const std::string &warning : passManager.getWarnings())
+    {
+        std::cout << warning << std::endl;
+    }
+    std::cout << "Representacao intermediaria (-O" << options.irLevel << "): " << ir.liveBlocks() << " blocos, "
+              << ir.liveInstructions() << " instrucoes (" << blocks << " blocos e " << instructions
+              << " instrucoes antes das passadas; " << passManager.passStats().changes << " de "
+              << passManager.passStats().runs << " passadas mudaram a IR)" << std::endl;
+    if (options.dumpIR)
+    {
+        printIR(ir, std::cout);
+    }
 
-    // analise semantica
-    std::cout << "Executando analise semantica..." << std::endl;
-    SymbolTable symbolTable;
-    SemanticAnalyzer semantic(symbolTable);
+    std::cout << "Compilacao bem-sucedida! Executando programa..." << std::endl;
+    std::cout << "===========================================" << std::endl;
 
-    if (!semantic.analyze(ast))
+    IRInterpreter interpreter;
+    if (!interpreter.execute(ir))
     {
-        std::cout << semantic.getError() << std::endl;
+        std::cout << std::endl
+                  << "===========================================" << std::endl;
+        std::cout << interpreter.getError() << std::endl;
         return false;
     }
 
+    std::cout << "===========================================" << std::endl;
+    std::cout << "Programa executado com sucesso!" << std::endl;
+    return true;
+}
+
+bool runProgram(AST &ast, SymbolTable &symbolTable, const CompileOptions &options)
+{
+    // Variáveis -> slots do vetor de valores do interpretador
+    SlotResolver resolver;
+    resolver.resolve(ast, symbolTable);
+    if (options.irLevel >= 0)
+    {
+        return runIR(ast, resolver, options);
+    }
+
+    // Contas que nunca falham marcadas, constantes dobradas e propagadas,
+    // código morto removido, laços otimizados, subexpressões comuns calculadas
+    // uma vez; a árvore otimizada aponta para os otimizadores
+    RangeAnalysis ranges;
+    Optimizer optimizer;
+    LoopOptimizer loopOptimizer;
+    CommonSubexpressions commonSubexpressions;
+    AST optimized;
+    const AST *program = &ast;
+    const std::vector<SymbolType> *slotTypes = &resolver.slotTypes();
+    if (options.optimize)
+    {
+        ranges.analyze(ast, resolver.slotTypes());
+        for (const std::string &warning : ranges.getWarnings())
+        {
+            std::cout << warning << std::endl;
+        }
+        const RangeAnalysis::Stats &checks = ranges.rangeStats();
+        if (checks.arithmetic + checks.divisions > 0)
+        {
+            std::cout << "Faixas de valores: " << checks.provenArithmetic << " de " << checks.arithmetic
+                      << " contas sem teste de estouro, " << checks.provenDivisions << " de " << checks.divisions
+                      << " divisoes sem teste de divisor" << std::endl;
+        }
+        optimized = optimizer.optimize(ast, static_cast<uint32_t>(resolver.slotTypes().size()));
+        for (const std::string &warning : optimizer.getWarnings())
+        {
+            std::cout << warning << std::endl;
+        }
+        const Optimizer::RemovalStats &removal = optimizer.removalStats();
+        if (removal.removedNodes > 0)
+        {
+            std::cout << "Codigo morto removido: " << removal.removedNodes << " nos (atribuicoes sem uso: "
+                      << removal.deadStores << ", desvios constantes: " << removal.deadBranches << ")" << std::endl;
+        }
+        optimized = loopOptimizer.optimize(optimized, resolver.slotTypes());
+        const LoopOptimizer::Stats &loops = loopOptimizer.loopStats();
+        if (loops.hoistedExpressions > 0 || loops.reducedProducts > 0 || loops.unswitchedLoops > 0)
+        {
+            std::cout << "Lacos otimizados: " << loops.hoistedExpressions
+                      << " expressoes invariantes calculadas antes do laco, " << loops.reducedProducts
+                      << " multiplicacoes trocadas por somas, " << loops.unswitchedLoops
+                      << " lacos desdobrados" << std::endl;
+        }
+        slotTypes = &loopOptimizer.slotTypes();
+        if (options.commonSubexpressions)
+        {
+            optimized = commonSubexpressions.optimize(optimized, *slotTypes, resolver.slotTypes().size());
+            const CommonSubexpressions::Stats &common = commonSubexpressions.eliminationStats();
+            if (common.temporaryReads + common.variableReads > 0)
+            {
+                std::cout << "Subexpressoes comuns: " << common.temporaries << " calculadas uma vez em temporarias, "
+                          << common.temporaryReads + common.variableReads << " ocorrencias trocadas por leituras ("
+                          << common.variableReads << " de variaveis), " << common.savedOperators
+                          << " operadores a menos" << std::endl;
+            }
+            slotTypes = &commonSubexpressions.slotTypes();
+        }
+        program = &optimized;
+    }
+    if (options.dumpOptimized)
+    {
+        printAST(*program, std::cout);
+    }
+
     // Execução
     std::cout << "Compilacao bem-sucedida! Executando programa..." << std::endl;
     std::cout << "===========================================" << std::endl;
 
-    Interpreter interpreter(symbolTable);
-    if (!interpreter.execute(ast))
+    Interpreter interpreter(*slotTypes);
+    bool executed = interpreter.execute(*program);
+    if (options.evaluatedOperators)
+    {
+        *options.evaluatedOperators = interpreter.operatorCount();
+    }
+    if (!executed)
     {
         std::cout << std::endl
                   << "===========================================" << std::endl;
@@ -93,16 +427,412 @@ bool compileAndRun(const std::string &filename)
     return true;
 }
 
-void runTests() {
+// Com --pipelined, o lexer roda em outra thread e entrega os tokens em lotes
+bool runFrontEnd(TokenStream &lexer, const CompileOptions &options, AST &ast, SymbolTable &symbolTable)
+{
+    if (options.pipelined)
+    {
+        PipelinedTokenStream pipeline(lexer);
+        return compileTokens(pipeline, options, ast, symbolTable);
+    }
+    return compileTokens(lexer, options, ast, symbolTable);
+}
+
+bool compileAndRun(const std::string &filename, const CompileOptions &options)
+{
+    std::cout << "Compilando arquivo: " << filename << std::endl;
+
+    std::string cacheFile = ProgramCache::pathFor(filename);
+    if (options.clearCache)
+    {
+        ProgramCache::remove(cacheFile);
+    }
+
+    AST ast;
+    SymbolTable symbolTable;
+    // Nomes desta compilação. Com --pipelined o lexer interna em outra thread.
+    StringPool pool(options.pipelined);
+
+    // --stream-lex evita manter o arquivo inteiro acessível, entao nao há
+    // hash da fonte nem cache
+    if (options.streamLex)
+    {
+        int fd = openSourceFile(filename);
+        if (fd < 0)
+        {
+            std::cout << "Erro: Nao foi possível ler o arquivo '" << filename << "'" << std::endl;
+            return false;
+        }
+
+        // O lexer guarda o texto dos tokens que a AST referencia. Um arquivo
+        // vazio é recusado como na leitura mapeada.
+        StreamingLexer lexer(fd, pool);
+        if (lexer.empty())
+        {
+            std::cout << "Erro: Nao foi possível ler o arquivo '" << filename << "'" << std::endl;
+            closeSourceFile(fd);
+            return false;
+        }
+        std::cout << "Executando analise lexica..." << std::endl;
+        bool ok = runFrontEnd(lexer, options, ast, symbolTable) && runProgram(ast, symbolTable, options);
+        closeSourceFile(fd);
+        return ok;
+    }
+
+    // O buffer mapeado precisa viver até o fim da execução: tokens e AST apontam para ele
+    SourceBuffer source;
+    if (!source.open(filename) || source.empty())
+    {
+        std::cout << "Erro: Nao foi possível ler o arquivo '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    // Programa já verificado com esta mesma fonte: pula lexer, parser e semântica
+    if (options.useCache && ProgramCache::load(cacheFile, source.view(), ast, symbolTable, pool))
+    {
+        std::cout << "Programa carregado do cache: " << cacheFile << std::endl;
+        if (options.dumpAst)
+        {
+            printAST(ast, std::cout);
+        }
+        return runProgram(ast, symbolTable, options);
+    }
+
+    // analise lexica
+    std::cout << "Executando analise lexica..." << std::endl;
+    bool compiled;
+    if (options.parallelLex)
+    {
+        TokenBuffer tokens;
+        tokens.tokenize(source.view(), pool, options.lexThreads);
+        TokenBufferStream bufferedTokens(tokens);
+        compiled = compileTokens(bufferedTokens, options, ast, symbolTable);
+    }
+    else
+    {
+        Lexer lexer(source.view(), pool);
+        compiled = runFrontEnd(lexer, options, ast, symbolTable);
+    }
+    if (!compiled)
+    {
+        return false;
+    }
+
+    // Só programas sem erros de compilação vao para o cache; antes da
+    // execução, que altera a tabela de símbolos
+    if (options.useCache)
+    {
+        ProgramCache::store(cacheFile, source.view(), ast, symbolTable, pool);
+    }
+    return runProgram(ast, symbolTable, options);
+}
+
+// Tokens de 'lexer' até o fim do arquivo
+static std::vector<Token> collectTokens(TokenStream &lexer)
+{
+    std::vector<Token> tokens;
+    do
+    {
+        tokens.push_back(lexer.nextToken());
+    } while (tokens.back().type != TokenType::FIM_ARQUIVO);
+    return tokens;
+}
+
+// Compara os tokens de um lexer com os do ReferenceLexer e mostra o
+// primeiro que diverge
+static bool compareTokens(const std::string &name, const std::vector<Token> &reference,
+                          const std::vector<Token> &tokens)
+{
+    size_t count = std::min(tokens.size(), reference.size());
+    size_t mismatch = count;
+    for (size_t i = 0; i < count; i++)
+    {
+        const Token &a = reference[i];
+        const Token &b = tokens[i];
+        if (a.type != b.type || a.value != b.value || a.line != b.line || a.column != b.column ||
+            a.symbol != b.symbol)
+        {
+            mismatch = i;
+            break;
+        }
+    }
+
+    if (mismatch == count && tokens.size() == reference.size())
+    {
+        std::cout << name << ": OK (" << tokens.size() << " tokens)" << std::endl;
+        return true;
+    }
+
+    std::cout << name << ": DIVERGE no token " << mismatch << std::endl;
+    if (mismatch < count)
+    {
+        const Token &a = reference[mismatch];
+        const Token &b = tokens[mismatch];
+        std::cout << "  referencia: " << tokenTypeToString(a.type) << " '" << a.value << "' " << a.line << ":"
+                  << a.column << std::endl;
+        std::cout << "  " << name << ": " << tokenTypeToString(b.type) << " '" << b.value << "' " << b.line << ":"
+                  << b.column << std::endl;
+    }
+    return false;
+}
+
+// Teste diferencial do lexer: cada motor de varredura (escalar, SSE2, AVX2) e
+// o lexer de janela fixa devem produzir exatamente os tokens do
+// ReferenceLexer, o lexer de um byte por vez de antes dos kernels.
+bool checkLexerEngines(const std::string &filename)
+{
+    SourceBuffer source;
+    if (!source.open(filename) || source.empty())
+    {
+        std::cout << "Erro: Nao foi possível ler o arquivo '" << filename << "'" << std::endl;
+        return false;
+    }
+
+    // Cada lexer com um pool novo: os ids dos identificadores também precisam
+    // coincidir
+    StringPool referencePool;
+    ReferenceLexer referenceLexer(source.view(), referencePool);
+    std::vector<Token> reference = collectTokens(referenceLexer);
+    bool ok = true;
+
+    for (ScanEngine engine : {ScanEngine::ESCALAR, ScanEngine::SSE2, ScanEngine::AVX2})
+    {
+        if (!scanEngineAvailable(engine))
+        {
+            std::cout << scanEngineName(engine) << ": indisponivel nesta CPU" << std::endl;
+            continue;
+        }
+        StringPool pool;
+        Lexer lexer(source.view(), pool, engine);
+        ok = compareTokens(scanEngineName(engine), reference, collectTokens(lexer)) && ok;
+    }
+
+    // A janela mínima faz quase todo token atravessar uma borda
+    for (size_t window : {size_t(16), StreamingLexer::DEFAULT_WINDOW_SIZE})
+    {
+        int fd = openSourceFile(filename);
+        if (fd < 0)
+        {
+            std::cout << "Erro: Nao foi possível ler o arquivo '" << filename << "'" << std::endl;
+            return false;
+        }
+        StringPool pool;
+        StreamingLexer lexer(fd, pool, window);
+        ok = compareTokens("janela de " + std::to_string(window) + " bytes", reference, collectTokens(lexer)) && ok;
+        closeSourceFile(fd);
+    }
+
+    return ok;
+}
+
+// Executa o programa com a saída capturada e a entrada vinda de 'input'
+static std::string runCaptured(const std::string &filename, const std::string &input, const CompileOptions &options,
+                               bool &ok)
+{
+    std::ostringstream output;
+    std::istringstream source(input);
+    std::streambuf *out = std::cout.rdbuf(output.rdbuf());
+    std::streambuf *in = std::cin.rdbuf(source.rdbuf());
+    std::cin.clear();
+    ok = compileAndRun(filename, options);
+    std::cout.rdbuf(out);
+    std::cin.rdbuf(in);
+    std::cin.clear();
+
+    // Os avisos e estatísticas dos otimizadores vêm antes da execução
+    std::string text = output.str();
+    size_t start = text.find("Compilacao bem-sucedida! Executando programa...");
+    return start == std::string::npos ? text : text.substr(start);
+}
+
+// Programas .fort do diretório, em ordem alfabética
+static bool listPrograms(const std::string &directory, std::vector<std::filesystem::path> &programs)
+{
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(directory, error))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".fort")
+        {
+            programs.push_back(entry.path());
+        }
+    }
+    if (error)
+    {
+        std::cout << "Erro: Nao foi possível ler o diretorio '" << directory << "'" << std::endl;
+        return false;
+    }
+    std::sort(programs.begin(), programs.end());
+    return true;
+}
+
+// lexcheck de um arquivo ou de cada programa .fort de um diretório
+bool checkLexer(const std::string &path)
+{
+    if (!std::filesystem::is_directory(path))
+    {
+        return checkLexerEngines(path);
+    }
+    std::vector<std::filesystem::path> programs;
+    if (!listPrograms(path, programs))
+    {
+        return false;
+    }
+    size_t failures = 0;
+    for (const std::filesystem::path &program : programs)
+    {
+        std::cout << program.string() << ":" << std::endl;
+        failures += checkLexerEngines(program.string()) ? 0 : 1;
+    }
+    std::cout << programs.size() - failures << " de " << programs.size() << " programas com os mesmos tokens"
+              << std::endl;
+    return failures == 0;
+}
+
+// Entrada de um programa com 'ler': o arquivo <nome>.in, se existir
+static std::string programInput(const std::filesystem::path &program)
+{
+    std::filesystem::path inputFile = program;
+    inputFile.replace_extension(".in");
+    std::ifstream inputStream(inputFile);
+    std::stringstream input;
+    input << inputStream.rdbuf();
+    return input.str();
+}
+
+// Teste diferencial dos otimizadores: cada programa .fort do diretório roda
+// sem e com otimização, e a saída da execução (erros inclusive) tem que ser
+// a mesma. A entrada de um programa com 'ler' fica em <nome>.in. Com -O0,
+// -O1 ou -O2 o lado otimizado roda pela IR.
+bool runDiffTests(const std::string &directory, CompileOptions options)
+{
+    std::vector<std::filesystem::path> programs;
+    if (!listPrograms(directory, programs))
+    {
+        return false;
+    }
+
+    options.useCache = false;
+    size_t failures = 0;
+    for (const std::filesystem::path &program : programs)
+    {
+        std::string input = programInput(program);
+
+        bool plainOk;
+        bool optimizedOk;
+        CompileOptions plainOptions = options;
+        plainOptions.optimize = false;
+        plainOptions.irLevel = -1; // a referência é sempre a árvore sem otimizar
+        std::string plain = runCaptured(program.string(), input, plainOptions, plainOk);
+        options.optimize = true;
+        std::string optimized = runCaptured(program.string(), input, options, optimizedOk);
+
+        if (plain == optimized && plainOk == optimizedOk)
+        {
+            std::cout << program.string() << ": OK" << std::endl;
+            continue;
+        }
+
+        failures++;
+        std::istringstream plainLines(plain);
+        std::istringstream optimizedLines(optimized);
+        std::string a;
+        std::string b;
+        int line = 1;
+        while (true)
+        {
+            bool moreA = static_cast<bool>(std::getline(plainLines, a));
+            bool moreB = static_cast<bool>(std::getline(optimizedLines, b));
+            if (!moreA && !moreB)
+                break;
+            if (!moreA || !moreB || a != b)
+            {
+                if (!moreA)
+                    a = "(fim da saida)";
+                if (!moreB)
+                    b = "(fim da saida)";
+                break;
+            }
+            line++;
+        }
+        std::cout << program.string() << ": DIVERGE na linha " << line << " da execucao" << std::endl;
+        std::cout << "  sem otimizacao: " << a << std::endl;
+        std::cout << "  otimizado:      " << b << std::endl;
+    }
+
+    std::cout << programs.size() - failures << " de " << programs.size() << " programas com a mesma saida" << std::endl;
+    return failures == 0;
+}
+
+// Relatório da eliminação de subexpressões comuns: cada programa .fort do
+// diretório roda otimizado com e sem ela, e o interpretador conta os
+// operadores avaliados (aritméticos e relacionais). A saída da execução tem
+// que ser a mesma nas duas.
+bool runCseReport(const std::string &directory, CompileOptions options)
+{
+    std::vector<std::filesystem::path> programs;
+    if (!listPrograms(directory, programs))
+    {
+        return false;
+    }
+
+    options.useCache = false;
+    options.optimize = true;
+    size_t failures = 0;
+    size_t totalWithout = 0;
+    size_t totalWith = 0;
+    for (const std::filesystem::path &program : programs)
+    {
+        std::string input = programInput(program);
+
+        size_t without = 0;
+        size_t with = 0;
+        bool withoutOk;
+        bool withOk;
+        options.commonSubexpressions = false;
+        options.evaluatedOperators = &without;
+        std::string plain = runCaptured(program.string(), input, options, withoutOk);
+        options.commonSubexpressions = true;
+        options.evaluatedOperators = &with;
+        std::string eliminated = runCaptured(program.string(), input, options, withOk);
+
+        if (plain != eliminated || withoutOk != withOk)
+        {
+            failures++;
+            std::cout << program.string() << ": DIVERGE (a saida muda com a eliminacao)" << std::endl;
+            continue;
+        }
+        totalWithout += without;
+        totalWith += with;
+        std::cout << program.string() << ": " << without << " -> " << with << " operadores avaliados";
+        if (with < without)
+        {
+            std::cout << " (" << without - with << " a menos)";
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << "Total: " << totalWithout << " -> " << totalWith << " operadores avaliados";
+    if (totalWithout > 0)
+    {
+        long long saved = static_cast<long long>(totalWithout) - static_cast<long long>(totalWith);
+        std::ostringstream percent;
+        percent << std::fixed << std::setprecision(1) << 100.0 * saved / totalWithout;
+        std::cout << " (" << saved << " a menos, " << percent.str() << "%)";
+    }
+    std::cout << std::endl;
+    return failures == 0;
+}
+
+void runTests(const CompileOptions &options) {
     std::cout << "\n=== EXECUTANDO TESTES ===" << std::endl;
     
-    for (int i = 1; i <= 6; i++) { //  '5' para o número total de seus testes
+    for (int i = 1; i <= 7; i++) { //  '5' para o número total de seus testes
         
         std::string filename = "tests/test" + std::to_string(i) + ".fort"; // <--caminho da pasta
         
         std::cout << "\n--- TESTE " << i << " ---" << std::endl;
         
-        if (compileAndRun(filename)) {
+        if (compileAndRun(filename, options)) {
             std::cout << "TESTE " << i << ": PASSOU" << std::endl;
         } else {
             std::cout << "TESTE " << i << ": FALHOU" << std::endl;
@@ -119,10 +849,92 @@ int main(int argc, char *argv[])
 
     std::cout << "Versao 1.0 - Desenvolvido em C++" << std::endl;
 
-    if (argc == 2)
+    CompileOptions options;
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.rfind("--", 0) == 0 || arg.rfind("-O", 0) == 0)
+        {
+            if (!parseOption(arg, options))
+            {
+                std::cout << "Opcao desconhecida: " << arg << std::endl;
+                showHelp();
+                return 1;
+            }
+        }
+        else
+        {
+            args.push_back(arg);
+        }
+    }
+
+    if (!args.empty() && args.size() <= 2 && args[0] == "lexcheck")
+    {
+        return checkLexer(args.size() == 2 ? args[1] : "tests") ? 0 : 1;
+    }
+
+    if (args.size() == 2 && args[0] == "bench-lex")
+    {
+        return benchmarkLexer(args[1]) ? 0 : 1;
+    }
+
+    if (args.size() == 2 && args[0] == "bench-frontend")
+    {
+        return benchmarkFrontEnd(args[1]) ? 0 : 1;
+    }
+
+    if (args.size() == 2 && args[0] == "bench-cache")
+    {
+        return benchmarkCache(args[1]) ? 0 : 1;
+    }
+
+    if (!args.empty() && args.size() <= 2 && args[0] == "difftest")
+    {
+        return runDiffTests(args.size() == 2 ? args[1] : "tests", options) ? 0 : 1;
+    }
+
+    if (!args.empty() && args.size() <= 2 && args[0] == "cse-report")
+    {
+        return runCseReport(args.size() == 2 ? args[1] : "tests", options) ? 0 : 1;
+    }
+
+    if (!args.empty() && args.size() <= 2 && args[0] == "bench-exec")
+    {
+        int iterations = 2000000;
+        try
+        {
+            if (args.size() == 2)
+                iterations = std::stoi(args[1]);
+        }
+        catch (const std::exception &)
+        {
+            std::cout << "Erro: numero de iteracoes invalido '" << args[1] << "'" << std::endl;
+            return 1;
+        }
+        return benchmarkExecution(std::max(iterations, 1)) ? 0 : 1;
+    }
+
+    if (!args.empty() && args.size() <= 2 && args[0] == "bench-nesting")
+    {
+        int depth = 100000;
+        try
+        {
+            if (args.size() == 2)
+                depth = std::stoi(args[1]);
+        }
+        catch (const std::exception &)
+        {
+            std::cout << "Erro: profundidade invalida '" << args[1] << "'" << std::endl;
+            return 1;
+        }
+        return benchmarkNesting(std::max(depth, 1)) ? 0 : 1;
+    }
+
+    if (args.size() == 1)
     {
 
-        std::string arg = argv[1];
+        std::string arg = args[0];
 
         if (arg == "help")
         {
@@ -134,14 +946,14 @@ int main(int argc, char *argv[])
         else if (arg == "test")
         {
 
-            runTests();
+            runTests(options);
 
             return 0;
         }
         else
         {
 
-            compileAndRun(arg);
+            compileAndRun(arg, options);
 
             return 0;
         }
@@ -173,12 +985,12 @@ int main(int argc, char *argv[])
         else if (input == "test")
         {
 
-            runTests();
+            runTests(options);
         }
         else if (!input.empty())
         {
 
-            compileAndRun(input);
+            compileAndRun(input, options);
         }
     }
 
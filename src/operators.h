@@ -0,0 +1,48 @@
+#ifndef OPERATORS_H
+#define OPERATORS_H
+
+#include "token.h"
+#include <string_view>
+
+// Operadores e pontuação, reconhecidos do mesmo jeito pelo Lexer e pelo
+// StreamingLexer. O texto é literal e nao aponta para a entrada.
+struct OperatorToken {
+    TokenType type;
+    std::string_view text;
+};
+
+// Token que começa em 'c'; 'next' é o caractere seguinte ('\0' no fim da
+// entrada) e só decide os operadores de dois caracteres. TokenType::ERRO se
+// 'c' nao inicia nenhum operador.
+constexpr OperatorToken scanOperator(char c, char next) {
+    switch (c) {
+        case '+': return {TokenType::MAIS, "+"};
+        case '-': return {TokenType::MENOS, "-"};
+        case '*': return {TokenType::MULTIPLICACAO, "*"};
+        case '/': return {TokenType::DIVISAO, "/"};
+        case '=': return {TokenType::IGUAL, "="};
+        case '<':
+            if (next == '=') return {TokenType::MENOR_IGUAL, "<="};
+            if (next == '>') return {TokenType::DIFERENTE, "<>"};
+            return {TokenType::MENOR, "<"};
+        case '>':
+            if (next == '=') return {TokenType::MAIOR_IGUAL, ">="};
+            return {TokenType::MAIOR, ">"};
+        case ':':
+            if (next == '=') return {TokenType::ATRIBUICAO, ":="};
+            return {TokenType::DOIS_PONTOS, ":"};
+        case ';': return {TokenType::PONTO_VIRGULA, ";"};
+        case '.': return {TokenType::PONTO, "."};
+        case ',': return {TokenType::VIRGULA, ","};
+        case '(': return {TokenType::PARENTESE_ESQ, "("};
+        case ')': return {TokenType::PARENTESE_DIR, ")"};
+        case '[': return {TokenType::COLCHETE_ESQ, "["};
+        case ']': return {TokenType::COLCHETE_DIR, "]"};
+        default: return {TokenType::ERRO, std::string_view()};
+    }
+}
+
+static_assert(scanOperator('<', '>').type == TokenType::DIFERENTE, "operador de dois caracteres");
+static_assert(scanOperator(':', ' ').text.size() == 1, "operador de um caractere");
+
+#endif
@@ -0,0 +1,709 @@
+#include "optimizer.h"
+#include <algorithm>
+#include <climits>
+
+// Acima disso (blocos x variáveis) os estados nao cabem com folga na memória:
+// o programa é só dobrado, sem propagar valores de variáveis
+static const uint64_t MAX_STATE_ENTRIES = uint64_t(1) << 24;
+
+// Resultado que cabe no inteiro; o que nao cabe é o estouro da execução
+static bool fits(int64_t value, int& result) {
+    if (value < INT_MIN || value > INT_MAX) {
+        return false;
+    }
+    result = static_cast<int>(value);
+    return true;
+}
+
+// Valor de um operador sobre operandos constantes; false se a conta falha
+// na execução (estouro, divisão por zero) e por isso fica para o interpretador
+static bool foldOperator(const ASTNode& node, int left, int right, int& result) {
+    if (node.type == NodeType::UNARIO) {
+        return fits(node.token.type == TokenType::MENOS ? -int64_t(left) : left, result);
+    }
+    switch (node.token.type) {
+        case TokenType::MAIS:
+            return fits(int64_t(left) + right, result);
+        case TokenType::MENOS:
+            return fits(int64_t(left) - right, result);
+        case TokenType::MULTIPLICACAO:
+            return fits(int64_t(left) * right, result);
+        case TokenType::DIVISAO:
+            if (right == 0 || (left == INT_MIN && right == -1)) {
+                return false;
+            }
+            result = left / right;
+            return true;
+        case TokenType::IGUAL:
+            result = left == right;
+            return true;
+        case TokenType::DIFERENTE:
+            result = left != right;
+            return true;
+        case TokenType::MENOR:
+            result = left < right;
+            return true;
+        case TokenType::MENOR_IGUAL:
+            result = left <= right;
+            return true;
+        case TokenType::MAIOR:
+            result = left > right;
+            return true;
+        case TokenType::MAIOR_IGUAL:
+            result = left >= right;
+            return true;
+        default:
+            return false;
+    }
+}
+
+AST Optimizer::optimize(const AST& ast, uint32_t slotCount) {
+    source = &ast;
+    result = AST();
+    variableCount = slotCount;
+    blocks.clear();
+    warnings.clear();
+    stats = RemovalStats();
+    if (ast.empty()) {
+        return AST();
+    }
+
+    blocks = buildFlowGraph(ast);
+    propagate();
+    findDeadStores();
+    rewrite();
+    rebuildStatements();
+
+    std::stable_sort(warnings.begin(), warnings.end(), [](const Warning& a, const Warning& b) {
+        return a.line != b.line ? a.line < b.line : a.column < b.column;
+    });
+    blocks.clear();
+    entryStates.clear();
+    reached.clear();
+    rewritten.clear();
+    outcomes.clear();
+    deadStores.clear();
+    accesses.clear();
+    blockAccesses.clear();
+    uses.clear();
+    return std::move(result);
+}
+
+std::vector<std::string> Optimizer::getWarnings() const {
+    std::vector<std::string> messages;
+    for (const Warning& warning : warnings) {
+        messages.push_back(warning.message);
+    }
+    return messages;
+}
+
+NodeId Optimizer::idOf(const ASTNode& node) const {
+    return static_cast<NodeId>(&node - source->nodes.data());
+}
+
+// Junta 'state' à entrada do bloco; o bloco volta à lista de trabalho quando
+// é alcançado pela primeira vez ou quando algum estado sobe no reticulado
+void Optimizer::flowInto(uint32_t block, const Variable* state, std::vector<uint32_t>& worklist,
+                         std::vector<uint8_t>& queued) {
+    Variable* entry = entryStates.data() + size_t(block) * variableCount;
+    bool changed = false;
+    if (!reached[block]) {
+        reached[block] = 1;
+        std::copy(state, state + variableCount, entry);
+        changed = true;
+    } else {
+        for (uint32_t i = 0; i < variableCount; i++) {
+            Variable& known = entry[i];
+            const Variable& incoming = state[i];
+            if (known.state == VarState::VARYING) continue;
+            if (known.state == incoming.state &&
+                (known.state != VarState::CONSTANT ||
+                 (known.value == incoming.value && known.logical == incoming.logical))) {
+                continue;
+            }
+            bool initialized = known.state != VarState::UNINITIALIZED && incoming.state != VarState::UNINITIALIZED &&
+                               incoming.state != VarState::VARYING;
+            VarState merged = initialized ? VarState::INITIALIZED : VarState::VARYING;
+            if (known.state != merged) {
+                known.state = merged; // valores diferentes, ou talvez nao inicializada
+                changed = true;
+            }
+        }
+    }
+    if (changed && !queued[block]) {
+        queued[block] = 1;
+        worklist.push_back(block);
+    }
+}
+
+void Optimizer::propagate() {
+    reached.assign(blocks.size(), 0);
+    if (uint64_t(blocks.size()) * variableCount > MAX_STATE_ENTRIES) {
+        // Só dobra: todo bloco é alcançável e toda variável é desconhecida
+        reached.assign(blocks.size(), 1);
+        entryStates.clear();
+        return;
+    }
+    entryStates.assign(blocks.size() * size_t(variableCount), Variable{VarState::UNINITIALIZED, false, 0});
+
+    std::vector<uint32_t> worklist;
+    std::vector<uint8_t> queued(blocks.size(), 0);
+    std::vector<Variable> state(variableCount, Variable{VarState::UNINITIALIZED, false, 0});
+    flowInto(0, state.data(), worklist, queued);
+
+    while (!worklist.empty()) {
+        uint32_t block = worklist.back();
+        worklist.pop_back();
+        queued[block] = 0;
+
+        const Variable* entry = entryStates.data() + size_t(block) * variableCount;
+        std::copy(entry, entry + variableCount, state.begin());
+        for (NodeId command : blocks[block].commands) {
+            transfer(command, state.data(), false);
+        }
+
+        const FlowBlock& flow = blocks[block];
+        if (flow.branch != NO_NODE) {
+            Operand condition = evaluate(source->child(flow.branch, 0), state.data(), false);
+            if (!condition.constant || condition.value != 0) {
+                flowInto(flow.successors[0], state.data(), worklist, queued);
+            }
+            if (!condition.constant || condition.value == 0) {
+                flowInto(flow.successors[1], state.data(), worklist, queued);
+            }
+        } else if (flow.successors[0] != NO_BLOCK) {
+            flowInto(flow.successors[0], state.data(), worklist, queued);
+        }
+    }
+}
+
+// Vivacidade "forte", de trás para frente: uma atribuição que nao pode falhar
+// só lê as variáveis da sua expressão se o valor dela for lido depois, entao
+// uma cadeia de atribuições mortas cai inteira. As leituras de cada comando
+// sao as que sobram depois da propagação (uma variável constante vira
+// número). Blocos inalcançáveis nao contam.
+void Optimizer::findDeadStores() {
+    deadStores.assign(source->size(), 0);
+    if (entryStates.empty()) {
+        return; // sem os estados (programa grande demais) nada é removido
+    }
+    const AST& tree = *source;
+
+    // Acessos de cada bloco alcançável, na ordem de execução
+    accesses.clear();
+    uses.clear();
+    blockAccesses.assign(blocks.size() + 1, 0);
+    std::vector<Variable> state(variableCount);
+    collecting = true;
+    for (uint32_t block = 0; block < blocks.size(); block++) {
+        blockAccesses[block] = static_cast<uint32_t>(accesses.size());
+        if (!reached[block]) continue;
+        const Variable* entry = entryStates.data() + size_t(block) * variableCount;
+        std::copy(entry, entry + variableCount, state.begin());
+
+        for (NodeId command : blocks[block].commands) {
+            uint32_t begin = static_cast<uint32_t>(uses.size());
+            bool mayFail = transfer(command, state.data(), false);
+            uint32_t end = static_cast<uint32_t>(uses.size());
+            const ASTNode& node = tree[command];
+            if (node.type == NodeType::LER) {
+                for (NodeId target : tree.children(command)) {
+                    accesses.push_back({command, tree[target].slot, begin, end, false});
+                }
+            } else if (node.type == NodeType::ATRIBUICAO && node.childCount >= 2) {
+                accesses.push_back({command, tree[tree.child(command, 0)].slot, begin, end, !mayFail});
+            } else {
+                accesses.push_back({command, NO_SLOT, begin, end, false});
+            }
+        }
+        NodeId branch = blocks[block].branch;
+        if (branch != NO_NODE) {
+            uint32_t begin = static_cast<uint32_t>(uses.size());
+            evaluate(tree.child(branch, 0), state.data(), false);
+            accesses.push_back({branch, NO_SLOT, begin, static_cast<uint32_t>(uses.size()), false});
+        }
+    }
+    blockAccesses[blocks.size()] = static_cast<uint32_t>(accesses.size());
+    collecting = false;
+
+    // Predecessores alcançáveis de cada bloco, contíguos
+    std::vector<uint32_t> firstPredecessor(blocks.size() + 1, 0);
+    for (uint32_t block = 0; block < blocks.size(); block++) {
+        if (!reached[block]) continue;
+        for (uint32_t successor : blocks[block].successors) {
+            if (successor != NO_BLOCK && reached[successor]) firstPredecessor[successor + 1]++;
+        }
+    }
+    for (size_t i = 1; i < firstPredecessor.size(); i++) {
+        firstPredecessor[i] += firstPredecessor[i - 1];
+    }
+    std::vector<uint32_t> predecessors(firstPredecessor.back());
+    std::vector<uint32_t> filled(firstPredecessor.begin(), firstPredecessor.end() - 1);
+    for (uint32_t block = 0; block < blocks.size(); block++) {
+        if (!reached[block]) continue;
+        for (uint32_t successor : blocks[block].successors) {
+            if (successor != NO_BLOCK && reached[successor]) predecessors[filled[successor]++] = block;
+        }
+    }
+
+    // Ponto fixo: variáveis vivas na entrada de cada bloco, um bit por slot
+    size_t words = (variableCount + 63) / 64;
+    std::vector<uint64_t> liveIns(blocks.size() * words, 0);
+    std::vector<uint64_t> live(words);
+    auto liveOut = [&](uint32_t block) {
+        std::fill(live.begin(), live.end(), 0);
+        for (uint32_t successor : blocks[block].successors) {
+            if (successor == NO_BLOCK || !reached[successor]) continue;
+            const uint64_t* in = liveIns.data() + successor * words;
+            for (size_t i = 0; i < words; i++) live[i] |= in[i];
+        }
+    };
+
+    std::vector<uint32_t> worklist;
+    std::vector<uint8_t> queued(blocks.size(), 0);
+    for (uint32_t block = 0; block < blocks.size(); block++) {
+        if (reached[block]) {
+            worklist.push_back(block); // os últimos saem primeiro
+            queued[block] = 1;
+        }
+    }
+    while (!worklist.empty()) {
+        uint32_t block = worklist.back();
+        worklist.pop_back();
+        queued[block] = 0;
+
+        liveOut(block);
+        liveThrough(block, live.data(), false);
+        uint64_t* in = liveIns.data() + block * words;
+        if (std::equal(live.begin(), live.end(), in)) continue;
+        std::copy(live.begin(), live.end(), in);
+        for (uint32_t i = firstPredecessor[block]; i < firstPredecessor[block + 1]; i++) {
+            if (!queued[predecessors[i]]) {
+                queued[predecessors[i]] = 1;
+                worklist.push_back(predecessors[i]);
+            }
+        }
+    }
+
+    for (uint32_t block = 0; block < blocks.size(); block++) {
+        if (!reached[block]) continue;
+        liveOut(block);
+        liveThrough(block, live.data(), true);
+    }
+}
+
+// Leva as variáveis vivas da saída do bloco ('live') para a entrada; com
+// 'mark', anota as atribuições mortas
+void Optimizer::liveThrough(uint32_t block, uint64_t* live, bool mark) {
+    for (uint32_t i = blockAccesses[block + 1]; i-- > blockAccesses[block];) {
+        const Access& access = accesses[i];
+        if (access.target != NO_SLOT) {
+            uint64_t bit = uint64_t(1) << (access.target % 64);
+            uint64_t& word = live[access.target / 64];
+            if (access.removable && !(word & bit)) {
+                if (mark && !deadStores[access.command]) {
+                    deadStores[access.command] = 1;
+                    stats.deadStores++;
+                }
+                continue;
+            }
+            word &= ~bit;
+        }
+        for (uint32_t use = access.usesBegin; use < access.usesEnd; use++) {
+            live[uses[use] / 64] |= uint64_t(1) << (uses[use] % 64);
+        }
+    }
+}
+
+// Cria os comandos e condições da árvore nova, cada um com os valores
+// conhecidos no seu ponto do programa. Blocos inalcançáveis e atribuições
+// mortas nao criam nada.
+void Optimizer::rewrite() {
+    rewritten.assign(source->size(), NO_NODE);
+    outcomes.assign(source->size(), Outcome::UNREACHED);
+    std::vector<Variable> state(variableCount);
+    bool propagating = !entryStates.empty();
+
+    for (uint32_t block = 0; block < blocks.size(); block++) {
+        if (!reached[block]) continue;
+        if (propagating) {
+            const Variable* entry = entryStates.data() + size_t(block) * variableCount;
+            std::copy(entry, entry + variableCount, state.begin());
+        } else {
+            std::fill(state.begin(), state.end(), Variable{VarState::VARYING, false, 0});
+        }
+
+        for (NodeId command : blocks[block].commands) {
+            transfer(command, state.data(), !deadStores[command]);
+        }
+        NodeId branch = blocks[block].branch;
+        if (branch == NO_NODE) continue;
+        Operand condition = evaluate(source->child(branch, 0), state.data(), true);
+        if (!condition.constant) {
+            outcomes[branch] = Outcome::RUNTIME;
+            rewritten[branch] = condition.node;
+        } else {
+            outcomes[branch] = condition.value != 0 ? Outcome::ALWAYS : Outcome::NEVER;
+            if ((*source)[branch].type == NodeType::ENQUANTO && condition.value != 0) {
+                rewritten[branch] = materialize(condition); // laço sem fim: fica para a guarda
+            }
+        }
+    }
+}
+
+// Efeito de um comando simples sobre os estados; com 'emit', cria também o
+// comando reescrito na árvore nova. Devolve se o comando pode falhar.
+bool Optimizer::transfer(NodeId command, Variable* state, bool emit) {
+    const AST& tree = *source;
+    const ASTNode& node = tree[command];
+    NodeId children[2];
+
+    switch (node.type) {
+        case NodeType::ATRIBUICAO: {
+            if (node.childCount < 2) return false;
+            const ASTNode& target = tree[tree.child(command, 0)];
+            Operand value = evaluate(tree.child(command, 1), state, emit);
+            if (target.slot != NO_SLOT) {
+                state[target.slot] = value.constant ? Variable{VarState::CONSTANT, value.logical, value.value}
+                                                    : Variable{VarState::INITIALIZED, false, 0};
+            }
+            if (emit) {
+                children[0] = copyNode(target);
+                children[1] = materialize(value);
+                rewritten[command] = copyNode(node, children, 2);
+            }
+            return value.mayFail;
+        }
+        case NodeType::LER: {
+            std::vector<NodeId> targets;
+            for (NodeId child : tree.children(command)) {
+                const ASTNode& target = tree[child];
+                if (target.slot != NO_SLOT) {
+                    state[target.slot] = Variable{VarState::INITIALIZED, false, 0};
+                }
+                if (emit) targets.push_back(copyNode(target));
+            }
+            if (emit) rewritten[command] = copyNode(node, targets.data(), targets.size());
+            return true; // entrada inválida
+        }
+        case NodeType::ESCREVER: {
+            std::vector<NodeId> values;
+            bool mayFail = false;
+            for (NodeId child : tree.children(command)) {
+                const ASTNode& value = tree[child];
+                if (value.type == NodeType::STRING_LITERAL) {
+                    if (emit) values.push_back(copyNode(value));
+                    continue;
+                }
+                Operand operand = evaluate(child, state, emit);
+                mayFail = mayFail || operand.mayFail;
+                if (emit) values.push_back(materialize(operand));
+            }
+            if (emit) rewritten[command] = copyNode(node, values.data(), values.size());
+            return mayFail;
+        }
+        default:
+            return false;
+    }
+}
+
+Optimizer::Operand Optimizer::evaluate(NodeId root, const Variable* state, bool emit) {
+    return foldExpression(*source, root, expression, [this, state, emit](const ASTNode& node, const Operand* operands) {
+        return operands ? evaluateOperator(node, operands, emit) : evaluateLeaf(node, state, emit);
+    });
+}
+
+Optimizer::Operand Optimizer::evaluateLeaf(const ASTNode& node, const Variable* state, bool emit) {
+    Operand operand{false, false, false, 0, idOf(node)};
+    switch (node.type) {
+        case NodeType::NUMERO:
+            operand = {true, false, false, node.value, idOf(node)};
+            break;
+        case NodeType::LITERAL:
+            operand = {true, true, false, node.value, idOf(node)};
+            break;
+        case NodeType::IDENTIFICADOR: {
+            // Só variáveis com certeza inicializadas: a leitura das outras
+            // pode ser o erro de execução do programa
+            VarState known = state && node.slot != NO_SLOT ? state[node.slot].state : VarState::VARYING;
+            if (known == VarState::CONSTANT) {
+                operand = {true, state[node.slot].logical, false, state[node.slot].value, idOf(node)};
+                break;
+            }
+            operand.mayFail = known != VarState::INITIALIZED;
+            operand.slot = node.slot;
+            if (collecting && node.slot != NO_SLOT) {
+                uses.push_back(node.slot);
+            }
+            break;
+        }
+        default: // STRING_LITERAL vale 0, mas fica como está
+            break;
+    }
+    if (!operand.constant && emit) {
+        operand.node = copyNode(node);
+        if (node.type == NodeType::IDENTIFICADOR && !operand.mayFail) {
+            result[operand.node].assigned = true; // a propagação provou a inicialização
+        }
+    }
+    return operand;
+}
+
+Optimizer::Operand Optimizer::evaluateOperator(const ASTNode& node, const Operand* operands, bool emit) {
+    uint32_t count = expressionOperands(node);
+    bool constant = operands[0].constant && (count < 2 || operands[1].constant);
+    int value = 0;
+    if (constant && foldOperator(node, operands[0].value, count > 1 ? operands[1].value : 0, value)) {
+        return {true, false, false, value, idOf(node)}; // operadores dao inteiros (relacionais: 1 ou 0)
+    }
+    Operand simplified;
+    if (simplify(node, operands, emit, simplified)) {
+        return simplified;
+    }
+
+    // Uma conta só é segura se a RangeAnalysis provou que ela nunca estoura;
+    // uma divisão, também por uma constante diferente de 0 e de -1 (INT_MIN / -1
+    // estoura)
+    bool division = node.type == NodeType::BINARIO && node.token.type == TokenType::DIVISAO;
+    Operand operand{false, false, false, 0, NO_NODE};
+    operand.mayFail = operands[0].mayFail || (count > 1 && operands[1].mayFail) ||
+                      (mayOverflow(node) && !node.proven) ||
+                      (division && !node.proven &&
+                       !(operands[1].constant && operands[1].value != 0 && operands[1].value != -1));
+    if (!emit) {
+        return operand;
+    }
+    if (division && operands[1].constant && operands[1].value == 0) {
+        warn(node, "divisao por zero");
+    }
+    NodeId children[2];
+    for (uint32_t i = 0; i < count; i++) {
+        children[i] = operands[i].constant ? materialize(operands[i]) : operands[i].node;
+    }
+    operand.node = copyNode(node, children, count);
+    return operand;
+}
+
+// Identidades algébricas com um operando constante ou com a mesma variável
+// dos dois lados. Como na dobra, nada que possa falhar some: 'x * 0' e
+// 'x - x' só valem 0 se a leitura de x nao puder falhar. A constância e o
+// 'mayFail' do resultado nao dependem de 'emit', entao a propagação e a
+// reescrita veem o mesmo valor.
+bool Optimizer::simplify(const ASTNode& node, const Operand* operands, bool emit, Operand& simplified) {
+    auto constant = [](const Operand& operand, int value) { return operand.constant && operand.value == value; };
+    auto number = [&](int value) { return Operand{true, false, false, value, idOf(node)}; };
+
+    if (node.type == NodeType::UNARIO) {
+        const Operand& operand = operands[0];
+        if (node.token.type != TokenType::MENOS) {
+            // '+x' é o próprio x; um lógico nao, porque seria escrito como verdadeiro/falso
+            if (node.valueType != SymbolType::INTEIRO) return false;
+            simplified = operand;
+            return true;
+        }
+        // --x: a negação de dentro já está na árvore nova e nunca estoura
+        if (emit && result[operand.node].type == NodeType::UNARIO && result[operand.node].proven &&
+            result[operand.node].token.type == TokenType::MENOS && result[operand.node].childCount == 1) {
+            simplified = operand; // sem 'slot': a propagação nao vê a troca
+            simplified.node = result.child(operand.node, 0);
+            return true;
+        }
+        return false;
+    }
+
+    const Operand& left = operands[0];
+    const Operand& right = operands[1];
+    bool same = !left.constant && !right.constant && left.slot != NO_SLOT && left.slot == right.slot &&
+                !left.mayFail;
+    switch (node.token.type) {
+        case TokenType::MAIS:
+            if (constant(right, 0)) simplified = left;
+            else if (constant(left, 0)) simplified = right;
+            else return false;
+            return true;
+        case TokenType::MENOS:
+            if (constant(right, 0)) simplified = left;
+            else if (same) simplified = number(0);
+            else return false;
+            return true;
+        case TokenType::MULTIPLICACAO:
+            if (constant(right, 1)) simplified = left;
+            else if (constant(left, 1)) simplified = right;
+            else if (constant(right, 0) && !left.mayFail) simplified = number(0);
+            else if (constant(left, 0) && !right.mayFail) simplified = number(0);
+            else return false;
+            return true;
+        case TokenType::DIVISAO:
+            if (!constant(right, 1)) return false;
+            simplified = left;
+            return true;
+        case TokenType::IGUAL:
+        case TokenType::MENOR_IGUAL:
+        case TokenType::MAIOR_IGUAL:
+            if (!same) return false;
+            simplified = number(1);
+            return true;
+        case TokenType::DIFERENTE:
+        case TokenType::MENOR:
+        case TokenType::MAIOR:
+            if (!same) return false;
+            simplified = number(0);
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Nó da árvore nova para o operando. Uma constante vira NUMERO ou, se for
+// escrita como verdadeiro/falso, LITERAL, com a posição e o tipo do nó de onde
+// veio; um número ou lógico do próprio programa é copiado como está.
+NodeId Optimizer::materialize(const Operand& operand) {
+    if (!operand.constant) {
+        return operand.node;
+    }
+    const ASTNode& origin = (*source)[operand.node];
+    if (origin.type == NodeType::NUMERO || origin.type == NodeType::LITERAL) {
+        return copyNode(origin);
+    }
+
+    Token token = origin.token;
+    token.symbol = NO_SYMBOL;
+    NodeType type;
+    if (operand.logical) {
+        type = NodeType::LITERAL;
+        token.type = operand.value != 0 ? TokenType::VERDADEIRO : TokenType::FALSO;
+        token.value = operand.value != 0 ? "verdadeiro" : "falso";
+    } else {
+        type = NodeType::NUMERO;
+        token.type = TokenType::NUMERO;
+        texts.push_back(std::to_string(operand.value));
+        token.value = texts.back();
+    }
+    NodeId id = result.addNode(type, token);
+    result[id].valueType = origin.valueType;
+    result[id].value = operand.value;
+    return id;
+}
+
+NodeId Optimizer::copyNode(const ASTNode& node, const NodeId* children, size_t count) {
+    NodeId id = result.addNode(node.type, node.token, children, count);
+    ASTNode& copy = result[id];
+    copy.valueType = node.valueType;
+    copy.assigned = node.assigned;
+    copy.proven = node.proven;
+    if (node.type == NodeType::IDENTIFICADOR) {
+        copy.slot = node.slot;
+    } else {
+        copy.value = node.value;
+    }
+    return id;
+}
+
+void Optimizer::warn(const ASTNode& node, const std::string& message) {
+    for (const Warning& warning : warnings) {
+        if (warning.line == node.token.line && warning.column == node.token.column) {
+            return;
+        }
+    }
+    warnings.push_back({node.token.line, node.token.column,
+                        "Aviso na linha " + std::to_string(node.token.line) + ": " + message});
+}
+
+// Monta os comandos compostos e as listas em pós-ordem, com pilha explícita,
+// usando os comandos e condições já reescritos: todo filho é criado antes do
+// pai. Um 'se' com condição constante é trocado pelos comandos do bloco
+// escolhido, e os comandos que nao foram reescritos (mortos ou inalcançáveis)
+// ficam de fora.
+void Optimizer::rebuildStatements() {
+    const AST& tree = *source;
+    struct CopyFrame {
+        NodeId node;
+        uint32_t next;
+        uint32_t end;
+        size_t mark;
+        bool splice; // os filhos vao para a lista de baixo, sem nó próprio
+    };
+    std::vector<CopyFrame> frames;
+    std::vector<NodeId> pending;
+
+    auto enter = [&](NodeId id) {
+        const ASTNode& node = tree[id];
+        switch (node.type) {
+            case NodeType::ATRIBUICAO:
+            case NodeType::LER:
+            case NodeType::ESCREVER:
+                if (rewritten[id] != NO_NODE) {
+                    pending.push_back(rewritten[id]);
+                } else {
+                    stats.removedNodes += treeSize(id);
+                }
+                return;
+            case NodeType::SE:
+            case NodeType::ENQUANTO: {
+                Outcome outcome = outcomes[id];
+                if (outcome == Outcome::RUNTIME || (node.type == NodeType::ENQUANTO && outcome == Outcome::ALWAYS)) {
+                    frames.push_back({id, 1, node.childCount, pending.size(), false});
+                    pending.push_back(rewritten[id]); // a condição
+                    return;
+                }
+                stats.deadBranches++;
+                uint32_t taken = 0; // filho que fica no lugar do 'se'
+                if (node.type == NodeType::SE && outcome != Outcome::UNREACHED) {
+                    taken = outcome == Outcome::ALWAYS ? 1 : 2;
+                }
+                if (taken == 0 || taken >= node.childCount) {
+                    stats.removedNodes += treeSize(id);
+                    return;
+                }
+                NodeId block = tree.child(id, taken);
+                stats.removedNodes += 1 + treeSize(tree.child(id, 0)); // o 'se' e a condição
+                if (node.childCount > 2) {
+                    stats.removedNodes += treeSize(tree.child(id, 3 - taken)); // o outro bloco
+                }
+                if (tree[block].type == NodeType::LISTA_COMANDOS) {
+                    stats.removedNodes++;
+                    frames.push_back({block, 0, tree[block].childCount, pending.size(), true});
+                } else {
+                    frames.push_back({id, taken, taken + 1, pending.size(), true});
+                }
+                return;
+            }
+            default:
+                frames.push_back({id, 0, node.childCount, pending.size(), false});
+                return;
+        }
+    };
+
+    enter(tree.root);
+    while (!frames.empty()) {
+        CopyFrame& frame = frames.back();
+        if (frame.next < frame.end) {
+            enter(tree.child(frame.node, frame.next++));
+            continue;
+        }
+        CopyFrame done = frame;
+        frames.pop_back();
+        if (done.splice) {
+            continue;
+        }
+        NodeId copy = copyNode(tree[done.node], pending.data() + done.mark, pending.size() - done.mark);
+        pending.resize(done.mark);
+        pending.push_back(copy);
+    }
+    result.root = pending.back();
+}
+
+// Número de nós da subárvore (um nó compartilhado conta a cada uso)
+size_t Optimizer::treeSize(NodeId root) const {
+    size_t count = 0;
+    std::vector<NodeId> stack{root};
+    while (!stack.empty()) {
+        NodeId id = stack.back();
+        stack.pop_back();
+        count++;
+        for (NodeId child : source->children(id)) {
+            stack.push_back(child);
+        }
+    }
+    return count;
+}
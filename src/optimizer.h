@@ -0,0 +1,133 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include "ast.h"
+#include "flow_graph.h"
+#include <deque>
+#include <string>
+#include <vector>
+
+// Otimização entre a análise semântica e o interpretador, em três etapas:
+//
+// 1. Propagação condicional de constantes (no estilo SCCP): o programa é
+//    visto como um grafo de fluxo, com blocos de comandos simples
+//    (atribuição, ler, escrever) terminados pela condição de um 'se' ou
+//    'enquanto' ou pela passagem ao bloco seguinte. Um bloco só é analisado
+//    quando uma aresta executável chega nele, e uma condição constante deixa
+//    só um dos lados executável; os laços sao resolvidos por ponto fixo numa
+//    lista de trabalho, sem recursão.
+// 2. Vivacidade, de trás para frente no mesmo grafo: uma atribuição cujo
+//    valor nunca é lido depois é removida, se a expressão nao puder falhar.
+// 3. Reescrita: as subexpressões constantes sao dobradas e as identidades
+//    algébricas aplicadas (x + 0, x * 1, --x, x - x, ...), um 'se' com
+//    condição constante dá lugar ao bloco escolhido, um 'enquanto' que nunca
+//    roda e o código inalcançável somem.
+//
+// Nada que possa falhar na execução é dobrado nem removido (divisão por
+// zero, estouro que a RangeAnalysis nao descartou, leitura de variável talvez
+// nao inicializada), entao a saída e os erros do programa otimizado sao os
+// mesmos do original: depois de um erro de execução o interpretador nao roda
+// mais nenhum comando. Uma divisão por zero constante vira um aviso de
+// compilação.
+class Optimizer {
+public:
+    // O que a otimização tirou da árvore executada
+    struct RemovalStats {
+        size_t deadStores = 0;   // atribuições cujo valor nunca é lido
+        size_t deadBranches = 0; // 'se' e 'enquanto' resolvidos na compilação ou inalcançáveis
+        size_t removedNodes = 0; // nós desses comandos e do código inalcançável
+    };
+
+private:
+    // Estado de uma variável num ponto do programa
+    enum class VarState : uint8_t {
+        UNINITIALIZED,
+        CONSTANT,
+        INITIALIZED, // inicializada em todos os caminhos, valor desconhecido
+        VARYING      // talvez nao inicializada
+    };
+    struct Variable {
+        VarState state;
+        bool logical; // o valor é escrito como verdadeiro/falso (ver Interpreter)
+        int value;
+    };
+
+    // Como a condição de um 'se'/'enquanto' fica depois da propagação
+    enum class Outcome : uint8_t { UNREACHED, RUNTIME, ALWAYS, NEVER };
+
+    // Efeito de um comando (ou da condição de um bloco) sobre a vivacidade:
+    // grava 'target' e lê as variáveis de uses[usesBegin, usesEnd)
+    struct Access {
+        NodeId command;
+        uint32_t target;
+        uint32_t usesBegin;
+        uint32_t usesEnd;
+        bool removable; // atribuição que nao pode falhar
+    };
+
+    // Valor de uma subexpressão: uma constante (e o nó da árvore original de
+    // onde ela vem) ou um nó já criado na árvore nova
+    struct Operand {
+        bool constant;
+        bool logical;
+        bool mayFail; // a avaliação pode dar erro de execução
+        int value;
+        NodeId node;
+        uint32_t slot = NO_SLOT; // leitura de uma variável: o slot dela
+    };
+
+    struct Warning {
+        int line;
+        int column;
+        std::string message;
+    };
+
+    const AST* source;
+    AST result;
+    uint32_t variableCount = 0;
+    std::vector<FlowBlock> blocks;
+    std::vector<Variable> entryStates; // variableCount estados por bloco
+    std::vector<uint8_t> reached;
+    std::vector<NodeId> rewritten;     // comando (ou 'se'/'enquanto': a condição) -> nó novo
+    std::vector<Outcome> outcomes;     // por 'se'/'enquanto' da árvore original
+    std::vector<uint8_t> deadStores;   // por atribuição da árvore original
+    std::vector<Access> accesses;      // de todos os blocos alcançáveis, em ordem
+    std::vector<uint32_t> blockAccesses; // início de cada bloco em 'accesses' (+ sentinela)
+    std::vector<uint32_t> uses;        // slots lidos pelos acessos
+    bool collecting = false;           // 'evaluate' anota em 'uses' as variáveis lidas
+    RemovalStats stats;
+    std::vector<Warning> warnings;
+    std::deque<std::string> texts;     // textos dos números criados; referências estáveis
+    ExpressionStack<Operand> expression;
+
+    NodeId idOf(const ASTNode& node) const;
+    void propagate();
+    void flowInto(uint32_t block, const Variable* state, std::vector<uint32_t>& worklist,
+                  std::vector<uint8_t>& queued);
+    void findDeadStores();
+    void liveThrough(uint32_t block, uint64_t* live, bool mark);
+    void rewrite();
+    void rebuildStatements();
+    size_t treeSize(NodeId root) const;
+    bool transfer(NodeId command, Variable* state, bool emit);
+    Operand evaluate(NodeId root, const Variable* state, bool emit);
+    Operand evaluateLeaf(const ASTNode& node, const Variable* state, bool emit);
+    Operand evaluateOperator(const ASTNode& node, const Operand* operands, bool emit);
+    bool simplify(const ASTNode& node, const Operand* operands, bool emit, Operand& simplified);
+    NodeId materialize(const Operand& operand);
+    NodeId copyNode(const ASTNode& node, const NodeId* children = nullptr, size_t count = 0);
+    void warn(const ASTNode& node, const std::string& message);
+
+public:
+    // 'ast' já foi verificado e passou pelo SlotResolver ('slotCount'
+    // variáveis). Devolve uma árvore nova, que só vale enquanto este objeto
+    // existir (os números calculados guardam o texto aqui).
+    AST optimize(const AST& ast, uint32_t slotCount);
+
+    // Avisos da última otimização, em ordem de linha
+    std::vector<std::string> getWarnings() const;
+
+    const RemovalStats& removalStats() const { return stats; }
+};
+
+#endif
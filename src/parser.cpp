@@ -1,8 +1,12 @@
 
 #include "parser.h"
+#include "semantic.h"
+#include <array>
+#include <charconv>
 #include <iostream>
 
-Parser::Parser(Lexer &lexer) : lexer(lexer)
+Parser::Parser(TokenStream &lexer, SemanticAnalyzer *semantic, bool hashConsing)
+    : lexer(lexer), semantic(semantic), hashConsing(hashConsing && semantic)
 {
     currentToken = lexer.nextToken();
 }
@@ -29,133 +33,170 @@ bool Parser::expect(TokenType expected)
     return false;
 }
 
+// Só o primeiro erro é guardado: depois dele o parser ainda pode chegar a
+// outros pontos de erro, que seriam consequência do primeiro
 void Parser::error(const std::string &message)
 {
+    if (hasError())
+    {
+        return;
+    }
     errorMessage = "Erro sintatico na linha " + std::to_string(currentToken.line) +
                    ", coluna " + std::to_string(currentToken.column) + ": " + message;
 }
 
-ASTNodePtr Parser::parse()
+NodeId Parser::makeNode(NodeType type, const Token &token, size_t mark)
+{
+    NodeId node = ast.addNode(type, token, pending.data() + mark, pending.size() - mark);
+    pending.resize(mark);
+    return node;
+}
+
+void Parser::addChild(NodeId child)
 {
-    return parsePrograma();
+    if (child != NO_NODE)
+        pending.push_back(child);
 }
 
-ASTNodePtr Parser::parsePrograma()
+// Regra de SemanticAnalyzer::analyze: o comando 'index' de um bloco analisado
+// só é verificado se for o primeiro ou se ainda nao houver erro semântico
+bool Parser::checks(bool active, size_t index) const
 {
-    auto node = std::make_shared<ASTNode>(NodeType::PROGRAMA);
+    return semantic && active && (index == 0 || !semantic->hasError());
+}
+
+AST Parser::parse()
+{
+    // Arena reservada de uma vez: crescer dobrando copia os nós já criados e
+    // toca páginas novas a cada realocação, quase metade do custo da arena
+    size_t hint = lexer.sizeHint();
+    ast.nodes.reserve(hint);
+    ast.childIds.reserve(hint);
+    if (semantic)
+    {
+        semantic->beginSinglePass(ast);
+    }
+    ast.root = parsePrograma();
+    if (hasError())
+    {
+        ast.root = NO_NODE;
+    }
+    pending.clear();
+    return std::move(ast);
+}
+
+NodeId Parser::parsePrograma()
+{
+    size_t mark = pending.size();
 
     if (!expect(TokenType::PROGRAMA))
     {
         error("Esperado 'programa'");
-        return nullptr;
+        return NO_NODE;
     }
 
     if (!match(TokenType::IDENTIFICADOR))
     {
         error("Esperado nome do programa");
-        return nullptr;
+        return NO_NODE;
     }
 
-    node->token = currentToken;
+    Token name = currentToken;
     advance();
 
     if (!expect(TokenType::PONTO_VIRGULA))
     {
         error("Esperado ';' apos nome do programa");
-        return nullptr;
+        return NO_NODE;
     }
 
     // Declarações opcionais
     if (match(TokenType::VAR))
     {
-        auto decl = parseDeclaracoes();
-        if (decl)
-            node->addChild(decl);
+        addChild(parseDeclaracoes());
     }
 
     if (!expect(TokenType::INICIO))
     {
         error("Esperado 'inicio'");
-        return nullptr;
+        return NO_NODE;
     }
 
-    auto comandos = parseListaComandos();
-    if (comandos)
-        node->addChild(comandos);
+    addChild(parseListaComandos());
 
     if (!expect(TokenType::FIM))
     {
         error("Esperado 'fim'");
-        return nullptr;
+        return NO_NODE;
     }
 
     if (!expect(TokenType::PONTO))
     {
         error("Esperado '.' no final do programa");
-        return nullptr;
+        return NO_NODE;
     }
 
-    return node;
+    return makeNode(NodeType::PROGRAMA, name, mark);
 }
 
-ASTNodePtr Parser::parseDeclaracoes()
+NodeId Parser::parseDeclaracoes()
 {
-    auto node = std::make_shared<ASTNode>(NodeType::DECLARACAO);
+    size_t mark = pending.size();
 
     if (!expect(TokenType::VAR))
     {
-        return nullptr;
+        return NO_NODE;
     }
 
     do
     {
-        auto decl = parseDeclaracao();
-        if (decl)
-            node->addChild(decl);
+        addChild(parseDeclaracao());
 
         if (!expect(TokenType::PONTO_VIRGULA))
         {
             error("Esperado ';' apos declaração");
-            return nullptr;
+            return NO_NODE;
         }
     } while (match(TokenType::IDENTIFICADOR));
 
-    return node;
+    return makeNode(NodeType::DECLARACAO, Token(), mark);
 }
 
-ASTNodePtr Parser::parseDeclaracao()
+NodeId Parser::parseDeclaracao()
 {
-    auto node = std::make_shared<ASTNode>(NodeType::DECLARACAO);
+    size_t mark = pending.size();
 
-    auto listaVar = parseListaVar();
-    if (listaVar)
-        node->addChild(listaVar);
+    NodeId listaVar = parseListaVar();
+    addChild(listaVar);
 
     if (!expect(TokenType::DOIS_PONTOS))
     {
         error("Esperado ':' na declaração");
-        return nullptr;
+        return NO_NODE;
     }
 
-    auto tipo = parseTipo();
-    if (tipo)
-        node->addChild(tipo);
+    NodeId tipo = parseTipo();
+    addChild(tipo);
 
-    return node;
+    if (semantic && listaVar != NO_NODE && tipo != NO_NODE)
+    {
+        semantic->declareVariables(listaVar, tipo);
+    }
+
+    return makeNode(NodeType::DECLARACAO, Token(), mark);
 }
 
-ASTNodePtr Parser::parseListaVar()
+NodeId Parser::parseListaVar()
 {
-    auto node = std::make_shared<ASTNode>(NodeType::LISTA_VAR);
+    size_t mark = pending.size();
 
     if (!match(TokenType::IDENTIFICADOR))
     {
         error("Esperado identificador");
-        return nullptr;
+        return NO_NODE;
     }
 
-    auto id = std::make_shared<ASTNode>(NodeType::IDENTIFICADOR, currentToken);
-    node->addChild(id);
+    addChild(ast.addNode(NodeType::IDENTIFICADOR, currentToken));
     advance();
 
     while (match(TokenType::VIRGULA))
@@ -164,149 +205,211 @@ ASTNodePtr Parser::parseListaVar()
         if (!match(TokenType::IDENTIFICADOR))
         {
             error("Esperado identificador apos ','");
-            return nullptr;
+            return NO_NODE;
         }
-        auto nextId = std::make_shared<ASTNode>(NodeType::IDENTIFICADOR, currentToken);
-        node->addChild(nextId);
+        addChild(ast.addNode(NodeType::IDENTIFICADOR, currentToken));
         advance();
     }
 
-    return node;
+    return makeNode(NodeType::LISTA_VAR, Token(), mark);
 }
 
-ASTNodePtr Parser::parseTipo()
+NodeId Parser::parseTipo()
 {
-    auto node = std::make_shared<ASTNode>(NodeType::TIPO);
-
     if (match(TokenType::INTEIRO) || match(TokenType::LOGICO))
     {
-        node->token = currentToken;
+        NodeId node = ast.addNode(NodeType::TIPO, currentToken);
         advance();
         return node;
     }
 
     error("Esperado tipo 'inteiro' ou 'logico'");
-    return nullptr;
+    return NO_NODE;
 }
 
-ASTNodePtr Parser::parseListaComandos()
+// Sentinela de parseComando: o comando é composto e o seu quadro foi
+// empilhado em 'blocks'; o resultado chega quando o quadro terminar
+static constexpr NodeId PENDING_NODE = NO_NODE - 1;
+
+bool Parser::isBlockEnd()
 {
-    auto node = std::make_shared<ASTNode>(NodeType::LISTA_COMANDOS);
+    return match(TokenType::FIM) ||            // FIM do programa
+           match(TokenType::FIM_ARQUIVO) ||    // FIM do arquivo
+           match(TokenType::SENAO) ||          // SENAO do bloco SE
+           match(TokenType::FIM_SE) ||         // FIM_SE do bloco SE
+           match(TokenType::FIM_ENQUANTO);     // FIM_ENQUANTO do bloco ENQUANTO
+}
 
-    // O loop continua enquanto o token atual nao for um dos delimitadores de fim de bloco
-    while (!match(TokenType::FIM) &&            // FIM do programa
-           !match(TokenType::FIM_ARQUIVO) &&    // FIM do arquivo
-           !match(TokenType::SENAO) &&          // SENAO do bloco SE
-           !match(TokenType::FIM_SE) &&         // FIM_SE do bloco SE
-           !match(TokenType::FIM_ENQUANTO))     // FIM_ENQUANTO do bloco ENQUANTO
-    {
-        auto comando = parseComando();
-        if (comando)
+void Parser::pushBlock(NodeType type, const Token &token, bool active)
+{
+    blocks.push_back({type, BlockStage::START, active, pending.size(), 0, token});
+}
+
+// Analisa uma lista de comandos sem recursão: cada 'se', 'enquanto' e bloco
+// aninhado vira um quadro em 'blocks', e cada passo (step*) avança o quadro
+// do topo até ele terminar (true, com o nó em 'result') ou empilhar um filho
+// (false). O resultado de um quadro é entregue ao quadro de baixo no passo
+// seguinte.
+NodeId Parser::parseListaComandos()
+{
+    size_t base = blocks.size();
+    pushBlock(NodeType::LISTA_COMANDOS);
+
+    NodeId result = NO_NODE;
+    while (blocks.size() > base)
+    {
+        size_t top = blocks.size() - 1;
+        bool done;
+        switch (blocks[top].type)
         {
-            node->addChild(comando);
-
-            // === TRATAMENTO DE PONTO E VÍRGULA ===
-            // Comandos como SE e ENQUANTO já gerenciam seu próprio fim de bloco
-            // e nao exigem um ponto e vírgula após o seu término.
-            // Outros comandos (atribuição, ler, escrever) geralmente exigem.
-            if (comando->type != NodeType::SE && comando->type != NodeType::ENQUANTO) {
-                if (!expect(TokenType::PONTO_VIRGULA)) {
-                    // Se o ponto e vírgula estiver faltando, mas o token atual for um
-                    // delimitador de bloco (que nao exige ';' precedente), nao é um erro.
-                    if (currentToken.type != TokenType::FIM_SE &&
-                        currentToken.type != TokenType::SENAO &&
-                        currentToken.type != TokenType::FIM_ENQUANTO &&
-                        currentToken.type != TokenType::FIM &&
-                        currentToken.type != TokenType::FIM_ARQUIVO)
-                    {
-                        error("Esperado ';' apos comando.");
-                        return nullptr;
-                    }
-                }
-            }
-            // Para comandos SE ou ENQUANTO, nenhum ';' é esperado aqui.
-            // O loop simplesmente continuará para o próximo comando ou terminará
-            // se um delimitador global (como FIM) for encontrado.
+        case NodeType::SE:
+            done = stepSe(top, result);
+            break;
+        case NodeType::ENQUANTO:
+            done = stepEnquanto(top, result);
+            break;
+        default:
+            done = stepListaComandos(top, result);
+            break;
         }
-        else
+        if (done)
         {
-            // Se parseComando retornou nullptr (sem um comando válido),
-            // e nao estamos em um token de término de bloco esperado (ou já há um erro),
-            // então é um novo erro.
-            if (!hasError() &&
-                !match(TokenType::FIM) && !match(TokenType::FIM_ARQUIVO) &&
-                !match(TokenType::SENAO) && !match(TokenType::FIM_SE) && !match(TokenType::FIM_ENQUANTO))
-            {
-                error("Comando inesperado ou faltou ';'.");
-                return nullptr; // Propaga o erro
+            blocks.pop_back();
+        }
+    }
+    return result;
+}
+
+bool Parser::stepListaComandos(size_t frame, NodeId &result)
+{
+    ListStatus status = ListStatus::CONTINUE;
+    if (blocks[frame].stage == BlockStage::AWAITING_COMMAND) // um 'se' ou 'enquanto' terminou
+    {
+        status = acceptListaComando(result);
+    }
+
+    // O loop continua enquanto o token atual nao for um dos delimitadores de fim de bloco
+    while (status == ListStatus::CONTINUE && !isBlockEnd())
+    {
+        NodeId comando = parseComando(checks(blocks[frame].active, pending.size() - blocks[frame].mark));
+        if (comando == PENDING_NODE)
+        {
+            blocks[frame].stage = BlockStage::AWAITING_COMMAND;
+            return false;
+        }
+        status = acceptListaComando(comando);
+    }
+
+    result = (status == ListStatus::FAIL) ? NO_NODE : makeNode(NodeType::LISTA_COMANDOS, Token(), blocks[frame].mark);
+    return true;
+}
+
+Parser::ListStatus Parser::acceptListaComando(NodeId comando)
+{
+    if (comando != NO_NODE)
+    {
+        addChild(comando);
+
+        // === TRATAMENTO DE PONTO E VÍRGULA ===
+        // Comandos como SE e ENQUANTO já gerenciam seu próprio fim de bloco
+        // e nao exigem um ponto e vírgula após o seu término.
+        // Outros comandos (atribuição, ler, escrever) geralmente exigem.
+        if (ast[comando].type != NodeType::SE && ast[comando].type != NodeType::ENQUANTO) {
+            if (!expect(TokenType::PONTO_VIRGULA)) {
+                // Se o ponto e vírgula estiver faltando, mas o token atual for um
+                // delimitador de bloco (que nao exige ';' precedente), nao é um erro.
+                if (currentToken.type != TokenType::FIM_SE &&
+                    currentToken.type != TokenType::SENAO &&
+                    currentToken.type != TokenType::FIM_ENQUANTO &&
+                    currentToken.type != TokenType::FIM &&
+                    currentToken.type != TokenType::FIM_ARQUIVO)
+                {
+                    error("Esperado ';' apos comando.");
+                    return ListStatus::FAIL;
+                }
             }
-            break; // Se é um token de término de bloco ou já há erro, sai do loop.
-                   // A função pai (parseSe, parseEnquanto, parsePrograma) irá lidar com o token.
         }
+        return ListStatus::CONTINUE;
     }
-    return node;
+
+    // Se parseComando retornou NO_NODE (sem um comando válido),
+    // e nao estamos em um token de término de bloco esperado (ou já há um erro),
+    // então é um novo erro.
+    if (!hasError() && !isBlockEnd())
+    {
+        error("Comando inesperado ou faltou ';'.");
+        return ListStatus::FAIL; // Propaga o erro
+    }
+    return ListStatus::END; // Se é um token de término de bloco ou já há erro, encerra a lista.
+                            // O quadro de baixo (se, enquanto ou programa) irá lidar com o token.
 }
 
-ASTNodePtr Parser::parseComando()
+NodeId Parser::parseComando(bool checked)
 {
     if (match(TokenType::IDENTIFICADOR))
     {
-        return parseAtribuicao();
+        return parseAtribuicao(checked);
     }
     else if (match(TokenType::SE))
     {
-        return parseSe();
+        pushBlock(NodeType::SE, currentToken, checked);
+        return PENDING_NODE;
     }
     else if (match(TokenType::ENQUANTO))
     {
-        return parseEnquanto();
+        pushBlock(NodeType::ENQUANTO, currentToken, checked);
+        return PENDING_NODE;
     }
     else if (match(TokenType::LER))
     {
-        return parseLer();
+        return parseLer(checked);
     }
     else if (match(TokenType::ESCREVER))
     {
-        return parseEscrever();
+        return parseEscrever(checked);
     }
 
-    return nullptr;
+    return NO_NODE;
 }
 
-ASTNodePtr Parser::parseAtribuicao()
+NodeId Parser::parseAtribuicao(bool checked)
 {
-    auto node = std::make_shared<ASTNode>(NodeType::ATRIBUICAO);
+    size_t mark = pending.size();
 
     if (!match(TokenType::IDENTIFICADOR))
     {
         error("Esperado identificador na atribuicao");
-        return nullptr;
+        return NO_NODE;
     }
 
-    auto id = std::make_shared<ASTNode>(NodeType::IDENTIFICADOR, currentToken);
-    node->addChild(id);
+    NodeId target = ast.addNode(NodeType::IDENTIFICADOR, currentToken);
+    addChild(target);
     advance();
 
     if (!expect(TokenType::ATRIBUICAO))
     {
         error("Esperado ':=' na atribuicao");
-        return nullptr;
+        return NO_NODE;
     }
 
-    auto expr = parseExpressao();
-    if (expr)
-        node->addChild(expr);
+    // A expressão só é verificada se a variável existe
+    bool typed = checked && semantic->checkAssignmentTarget(target);
+    NodeId expressao = parseExpressao(typed);
+    addChild(expressao);
+    if (typed && expressao != NO_NODE)
+    {
+        semantic->checkAssignment(target, semantic->expressionType());
+    }
 
-    return node;
+    return makeNode(NodeType::ATRIBUICAO, Token(), mark);
 }
 
-ASTNodePtr Parser::parseSe()
+// 'se' ['('] condição [')'] 'entao'
+bool Parser::parseCabecalhoSe(bool checked)
 {
-    auto node = std::make_shared<ASTNode>(NodeType::SE);
-
     // 1. Consome 'se'
     if (!expect(TokenType::SE)) {
-        return nullptr;
+        return false;
     }
 
     // 2. Lida com os parênteses opcionais da condição
@@ -317,71 +420,97 @@ ASTNodePtr Parser::parseSe()
     }
 
     // 3. Analisa a expressão condicional
-    auto condicao = parseExpressao();
-    if (!condicao) {
-        return nullptr;
+    NodeId condicao = parseExpressao(checked);
+    if (condicao == NO_NODE) {
+        return false;
     }
-    node->addChild(condicao);
+    addChild(condicao);
 
     // 4. Consome ')' se houver parênteses
     if (hasParentheses) {
         if (!expect(TokenType::PARENTESE_DIR)) {
             error("Esperado ')' apos a condicao do 'se'.");
-            return nullptr;
+            return false;
         }
     }
 
     // 5. Consome 'entao'
     if (!expect(TokenType::ENTAO)) {
         error("Esperado 'entao' apos condicao.");
-        return nullptr;
+        return false;
     }
+    return true;
+}
 
-    // 6. Espera a LISTA DE COMANDOS para o bloco 'ENTAO'
-    auto blocoEntao = parseListaComandos();
-    if (!blocoEntao) {
-        return nullptr;
-    }
-    node->addChild(blocoEntao);
+bool Parser::stepSe(size_t frame, NodeId &result)
+{
+    switch (blocks[frame].stage)
+    {
+    case BlockStage::START:
+        if (!parseCabecalhoSe(blocks[frame].active)) {
+            result = NO_NODE;
+            return true;
+        }
+        if (blocks[frame].active) {
+            blocks[frame].active = semantic->checkCondition(expressionLine, semantic->expressionType(), "se");
+        }
+        // 6. Espera a LISTA DE COMANDOS para o bloco 'ENTAO'
+        blocks[frame].stage = BlockStage::AWAITING_THEN;
+        pushBlock(NodeType::LISTA_COMANDOS, Token(), checks(blocks[frame].active, 0));
+        return false;
+
+    case BlockStage::AWAITING_THEN:
+        if (result == NO_NODE) {
+            return true;
+        }
+        addChild(result);
 
-    // --- Trata o SENAO e o FIM_SE UNIFICADAMENTE ---
-    // O FIM_SE final só é esperado uma vez para toda a estrutura SE-SENAO.
+        // --- Trata o SENAO e o FIM_SE UNIFICADAMENTE ---
+        // O FIM_SE final só é esperado uma vez para toda a estrutura SE-SENAO.
+        if (match(TokenType::SENAO)) { // Se há uma cláusula 'senao'
+            advance(); // Consome 'senao'
 
-    if (match(TokenType::SENAO)) { // Se há uma cláusula 'senao'
-        advance(); // Consome 'senao'
-        
-        // 7. Espera a LISTA DE COMANDOS para o bloco 'SENAO'
-        auto blocoSenao = parseListaComandos();
-        if (!blocoSenao) {
-            return nullptr;
+            // 7. Espera a LISTA DE COMANDOS para o bloco 'SENAO'
+            blocks[frame].stage = BlockStage::AWAITING_ELSE;
+            pushBlock(NodeType::LISTA_COMANDOS, Token(), checks(blocks[frame].active, 1));
+            return false;
         }
-        node->addChild(blocoSenao);
 
-        // 8. O FIM_SE para toda a estrutura SE-SENAO, APÓS o bloco SENAO
-        if (!expect(TokenType::FIM_SE)) {
-            error("Esperado 'fim_se' apos o bloco 'senao'.");
-            return nullptr;
-        }
-    } else { // Se nao HÁ cláusula 'senao'
         // 9. O FIM_SE para o SE sem SENAO, APÓS o bloco ENTAO
         if (!expect(TokenType::FIM_SE)) {
             error("Esperado 'fim_se' apos o bloco 'entao'.");
-            return nullptr;
+            result = NO_NODE;
+            return true;
+        }
+        break;
+
+    default: // AWAITING_ELSE
+        if (result == NO_NODE) {
+            return true;
         }
+        addChild(result);
+
+        // 8. O FIM_SE para toda a estrutura SE-SENAO, APÓS o bloco SENAO
+        if (!expect(TokenType::FIM_SE)) {
+            error("Esperado 'fim_se' apos o bloco 'senao'.");
+            result = NO_NODE;
+            return true;
+        }
+        break;
     }
 
-    return node;
+    result = makeNode(NodeType::SE, blocks[frame].token, blocks[frame].mark);
+    return true;
 }
-ASTNodePtr Parser::parseEnquanto()
-{
-    auto whileNode = std::make_shared<ASTNode>(NodeType::ENQUANTO, currentToken);
 
+// 'enquanto' ['('] condição [')'] 'faca'
+bool Parser::parseCabecalhoEnquanto(bool checked)
+{
     if (!expect(TokenType::ENQUANTO)) // Consome 'enquanto'
     {
-        return nullptr;
+        return false;
     }
 
-
     // Verifica se há um parêntese esquerdo (ABRE_PARENTESES)
     bool hasParentheses = false;
     if (match(TokenType::PARENTESE_ESQ)) { // Verifica se o próximo token é '('
@@ -389,87 +518,116 @@ ASTNodePtr Parser::parseEnquanto()
         advance(); // Consome o '('
     }
 
-    auto condition = parseExpressao(); // Parsers a expressão (que pode ter outros parênteses internos)
-    if (!condition)
+    NodeId condition = parseExpressao(checked); // Parsers a expressão (que pode ter outros parênteses internos)
+    if (condition == NO_NODE)
     {
         error("Condição esperada para o comando 'enquanto'.");
-        return nullptr;
+        return false;
     }
-    whileNode->addChild(condition);
+    addChild(condition);
 
     // Se encontramos um '(' antes da expressão, então esperamos um ')' depois dela
     if (hasParentheses) {
         if (!expect(TokenType::PARENTESE_DIR)) { // Consome o ')'
             error("Esperado ')' apos a condição do 'enquanto'.");
-            return nullptr;
+            return false;
         }
     }
 
-
     if (!expect(TokenType::FACA)) // Consome 'faca'
     {
         error("Esperado 'faca' apos a condição do 'enquanto'.");
-        return nullptr;
+        return false;
     }
+    return true;
+}
 
-    auto bodyCommands = std::make_shared<ASTNode>(NodeType::LISTA_COMANDOS);
-
-    // Loop para ler comandos até encontrar 'fim_enquanto'
-    while (!match(TokenType::FIM_ENQUANTO) && !hasError() && !match(TokenType::FIM_ARQUIVO))
+bool Parser::stepEnquanto(size_t frame, NodeId &result)
+{
+    if (blocks[frame].stage == BlockStage::START)
     {
-        auto command = parseComando();
-        if (command)
+        if (!parseCabecalhoEnquanto(blocks[frame].active))
         {
-            bodyCommands->addChild(command);
+            result = NO_NODE;
+            return true;
         }
-        else
+        if (blocks[frame].active)
         {
-            if (!hasError())
-            {
-                error("Comando inesperado no bloco 'enquanto'.");
-            }
-            return nullptr;
+            blocks[frame].active = semantic->checkCondition(expressionLine, semantic->expressionType(), "enquanto");
         }
+        blocks[frame].bodyMark = pending.size();
+    }
+    else // um 'se' ou 'enquanto' do corpo terminou
+    {
+        if (!acceptEnquantoComando(result))
+        {
+            result = NO_NODE;
+            return true;
+        }
+    }
 
-        // Correção no ';': um comando simples deve ter ';'. Um bloco de chaves nao.
-        // Se a regra é "qualquer comando dentro do laço deve ter ';'",
-        // então seu parseComando() precisa ser capaz de diferenciar um comando simples de um bloco.
-        // Assumindo que parseComando() já retorna um comando simples ou um bloco completo.
-        // Se `parseComando` nunca retorna um bloco, então o ';' é sempre obrigatório.
-
-        // Esta parte da sua lógica para o ';' já está bem próxima do que precisa,
-        // mas é bom confirmar se parseComando() pode retornar um bloco {}
-        // Se ele pode retornar um bloco, a lógica do ';' precisa ser mais sofisticada.
-        // Por enquanto, vamos manter a sua lógica do ';', que já parece tratar a ausência
-        // antes de FIM_ENQUANTO como uma exceção.
-        if (!expect(TokenType::PONTO_VIRGULA))
+    // Loop para ler comandos até encontrar 'fim_enquanto'
+    while (!match(TokenType::FIM_ENQUANTO) && !hasError() && !match(TokenType::FIM_ARQUIVO))
+    {
+        NodeId command = parseComando(checks(blocks[frame].active, pending.size() - blocks[frame].bodyMark));
+        if (command == PENDING_NODE)
         {
-            if (currentToken.type != TokenType::FIM_ENQUANTO && currentToken.type != TokenType::FIM_ARQUIVO)
-            {
-                error("Esperado ';' apos comando dentro do 'enquanto'.");
-                return nullptr;
-            }
+            blocks[frame].stage = BlockStage::AWAITING_COMMAND;
+            return false;
+        }
+        if (!acceptEnquantoComando(command))
+        {
+            result = NO_NODE;
+            return true;
         }
     }
 
     if (!expect(TokenType::FIM_ENQUANTO)) // Consome 'fim_enquanto'
     {
         error("Esperado 'fim_enquanto' para fechar o bloco 'enquanto'.");
-        return nullptr;
+        result = NO_NODE;
+        return true;
     }
 
-    whileNode->addChild(bodyCommands);
+    addChild(makeNode(NodeType::LISTA_COMANDOS, Token(), blocks[frame].bodyMark));
+
+    result = makeNode(NodeType::ENQUANTO, blocks[frame].token, blocks[frame].mark);
+    return true;
+}
 
-    return whileNode;
+bool Parser::acceptEnquantoComando(NodeId command)
+{
+    if (command == NO_NODE)
+    {
+        if (!hasError())
+        {
+            error("Comando inesperado no bloco 'enquanto'.");
+        }
+        return false;
+    }
+    addChild(command);
+
+    // Todo comando dentro do laço exige ';', inclusive um 'se' ou 'enquanto'
+    // aninhado; a falta dele só é tolerada antes de 'fim_enquanto'.
+    if (!expect(TokenType::PONTO_VIRGULA))
+    {
+        if (currentToken.type != TokenType::FIM_ENQUANTO && currentToken.type != TokenType::FIM_ARQUIVO)
+        {
+            error("Esperado ';' apos comando dentro do 'enquanto'.");
+            return false;
+        }
+    }
+    return true;
 }
 
-ASTNodePtr Parser::parseLer()
+NodeId Parser::parseLer(bool checked)
 {
-    auto node = std::make_shared<ASTNode>(NodeType::LER);
+    size_t mark = pending.size();
+    Token keyword = currentToken;
 
     if (!expect(TokenType::LER))
     {
-        return nullptr;
+        return NO_NODE;
     }
 
     bool temParenteses = false;
@@ -482,12 +640,10 @@ ASTNodePtr Parser::parseLer()
     if (!match(TokenType::IDENTIFICADOR))
     {
         error("Esperado identificador em 'ler'");
-        return nullptr;
+        return NO_NODE;
     }
 
-    auto id = std::make_shared<ASTNode>(NodeType::IDENTIFICADOR, currentToken);
-    node->addChild(id);
-    advance();
+    addChild(parseVariavelLida(checked));
 
     while (match(TokenType::VIRGULA))
     {
@@ -495,29 +651,39 @@ ASTNodePtr Parser::parseLer()
         if (!match(TokenType::IDENTIFICADOR))
         {
             error("Esperado identificador apos ','");
-            return nullptr;
+            return NO_NODE;
         }
-        auto nextId = std::make_shared<ASTNode>(NodeType::IDENTIFICADOR, currentToken);
-        node->addChild(nextId);
-        advance();
+        addChild(parseVariavelLida(checked));
     }
 
     if (temParenteses && !expect(TokenType::PARENTESE_DIR))
     {
         error("Esperado ')' em 'ler'");
-        return nullptr;
+        return NO_NODE;
     }
 
+    return makeNode(NodeType::LER, keyword, mark);
+}
+
+NodeId Parser::parseVariavelLida(bool checked)
+{
+    NodeId node = ast.addNode(NodeType::IDENTIFICADOR, currentToken);
+    advance();
+    if (checked)
+    {
+        semantic->checkRead(node);
+    }
     return node;
 }
 
-ASTNodePtr Parser::parseEscrever()
+NodeId Parser::parseEscrever(bool checked)
 {
-    auto node = std::make_shared<ASTNode>(NodeType::ESCREVER);
+    size_t mark = pending.size();
+    Token keyword = currentToken;
 
     if (!expect(TokenType::ESCREVER))
     {
-        return nullptr;
+        return NO_NODE;
     }
 
     bool temParenteses = false;
@@ -527,148 +693,222 @@ ASTNodePtr Parser::parseEscrever()
         advance();
     }
 
-    auto expr = parseExpressao();
-    if (expr)
-        node->addChild(expr);
+    // Como em analyze(), as expressões param de ser verificadas no primeiro erro
+    addChild(parseExpressao(checked));
 
     while (match(TokenType::VIRGULA))
     {
         advance();
-        auto nextExpr = parseExpressao();
-        if (nextExpr)
-            node->addChild(nextExpr);
+        addChild(parseExpressao(checks(checked, pending.size() - mark)));
     }
 
     if (temParenteses && !expect(TokenType::PARENTESE_DIR))
     {
         error("Esperado ')' em 'escrever'");
-        return nullptr;
+        return NO_NODE;
     }
 
-    return node;
-}
-
-ASTNodePtr Parser::parseExpressao()
-{
-    return parseExpressaoLogica();
+    return makeNode(NodeType::ESCREVER, keyword, mark);
 }
 
-ASTNodePtr Parser::parseExpressaoLogica()
+// Poder de ligação (binding power) dos operadores binários, indexado pelo
+// TokenType; 0 = o token nao continua uma expressão. Um operador novo é só
+// uma entrada nesta tabela.
+static constexpr size_t TOKEN_TYPE_COUNT = static_cast<size_t>(TokenType::COMENTARIO) + 1;
+static constexpr int UNARY_BINDING_POWER = 40; // '-' unário liga mais forte que qualquer binário
+
+static constexpr std::array<uint8_t, TOKEN_TYPE_COUNT> BINDING_POWER = [] {
+    std::array<uint8_t, TOKEN_TYPE_COUNT> table{};
+    auto set = [&table](TokenType type, uint8_t power) { table[static_cast<size_t>(type)] = power; };
+    set(TokenType::IGUAL, 10);
+    set(TokenType::DIFERENTE, 10);
+    set(TokenType::MENOR, 10);
+    set(TokenType::MENOR_IGUAL, 10);
+    set(TokenType::MAIOR, 10);
+    set(TokenType::MAIOR_IGUAL, 10);
+    set(TokenType::MAIS, 20);
+    set(TokenType::MENOS, 20);
+    set(TokenType::MULTIPLICACAO, 30);
+    set(TokenType::DIVISAO, 30);
+    return table;
+}();
+
+static inline int bindingPower(TokenType type)
 {
-    return parseExpressaoRelacional();
+    return BINDING_POWER[static_cast<size_t>(type)];
 }
 
-ASTNodePtr Parser::parseExpressaoRelacional()
+// Parser de Pratt com pilha explícita: '(' e '-' unário abrem um quadro em
+// 'operators' antes do operando, e um operador binário abre um quadro com o
+// operando esquerdo já lido. Depois de cada operando, fecha os quadros cujo
+// poder nao é menor que o do próximo operador (todos associam à esquerda).
+// É a mesma ordem de chamadas da versão recursiva, sem usar a pilha do C++.
+NodeId Parser::parseExpressao(bool typed)
 {
-    auto left = parseExpressaoAritmetica();
-
-    while (match(TokenType::IGUAL) || match(TokenType::DIFERENTE) ||
-           match(TokenType::MENOR) || match(TokenType::MENOR_IGUAL) ||
-           match(TokenType::MAIOR) || match(TokenType::MAIOR_IGUAL))
+    size_t base = operators.size();
+    typing = typed;
+    if (typed)
     {
+        semantic->beginExpression();
+    }
 
-        auto node = std::make_shared<ASTNode>(NodeType::BINARIO, currentToken);
-        advance();
+    for (;;)
+    {
+        if (match(TokenType::PARENTESE_ESQ))
+        {
+            advance();
+            operators.push_back({Token(), NO_NODE, 0, OperatorKind::PARENTHESES});
+            continue;
+        }
+        if (match(TokenType::MENOS))
+        {
+            operators.push_back({currentToken, NO_NODE, UNARY_BINDING_POWER, OperatorKind::UNARY});
+            advance();
+            continue;
+        }
 
-        auto right = parseExpressaoAritmetica();
+        NodeId operand = parseFator();
 
-        node->addChild(left);
-        node->addChild(right);
-        left = node;
+        for (;;)
+        {
+            int power = bindingPower(currentToken.type);
+            int minPower = operators.size() > base ? operators.back().power : 0;
+            if (power > minPower)
+            {
+                operators.push_back({currentToken, operand, power, OperatorKind::BINARY});
+                advance();
+                break; // lê o operando direito
+            }
+            if (operators.size() == base)
+            {
+                typing = false;
+                return operand;
+            }
+            OperatorFrame frame = operators.back();
+            operators.pop_back();
+            operand = closeOperator(frame, operand);
+        }
     }
-
-    return left;
 }
 
-ASTNodePtr Parser::parseExpressaoAritmetica()
+NodeId Parser::closeOperator(const OperatorFrame &frame, NodeId operand)
 {
-    auto left = parseTermo();
-
-    while (match(TokenType::MAIS) || match(TokenType::MENOS))
+    if (frame.kind == OperatorKind::PARENTHESES)
     {
-        auto node = std::make_shared<ASTNode>(NodeType::BINARIO, currentToken);
-        advance();
-
-        auto right = parseTermo();
+        if (!expect(TokenType::PARENTESE_DIR))
+        {
+            error("Esperado ')' apos expressão");
+        }
+        return operand;
+    }
 
-        node->addChild(left);
-        node->addChild(right);
-        left = node;
+    size_t mark = pending.size();
+    if (frame.kind == OperatorKind::BINARY)
+    {
+        addChild(frame.left);
     }
+    addChild(operand);
+    return makeExpressionNode(frame.kind == OperatorKind::BINARY ? NodeType::BINARIO : NodeType::UNARIO, frame.op, mark);
+}
 
-    return left;
+bool Parser::ExpressionKey::operator==(const ExpressionKey &other) const
+{
+    return type == other.type && token == other.token && left == other.left && right == other.right &&
+           text == other.text;
 }
 
-ASTNodePtr Parser::parseTermo()
+size_t Parser::ExpressionKeyHash::operator()(const ExpressionKey &key) const
 {
-    auto left = parseFator();
+    size_t h = std::hash<std::string_view>()(key.text);
+    h = h * 31 + static_cast<size_t>(key.type) * 64 + static_cast<size_t>(key.token);
+    h = h * 0x9e3779b97f4a7c15ULL + key.left;
+    h = h * 0x9e3779b97f4a7c15ULL + key.right;
+    return h ^ (h >> 29);
+}
 
-    while (match(TokenType::MULTIPLICACAO) || match(TokenType::DIVISAO))
+// Cria o nó de expressão com os filhos empilhados desde 'mark'. Na análise em
+// uma passada o tipo do nó é calculado assim que ele é criado; com
+// hash-consing, uma expressão igual a outra já criada (mesmo nó, mesmo texto
+// do token e mesmos filhos) reaproveita o nó e o tipo dela.
+//
+// Só entram na tabela os nós cujo tipo foi calculado sem erro: um erro
+// semântico sempre aponta a linha de onde ocorreu, e os pais de um nó com erro
+// nunca sao reaproveitados, porque o filho de outra ocorrência é outro nó.
+NodeId Parser::makeExpressionNode(NodeType type, const Token &token, size_t mark)
+{
+    expressionLine = token.line;
+    if (!typing)
     {
-        auto node = std::make_shared<ASTNode>(NodeType::BINARIO, currentToken);
-        advance();
-
-        auto right = parseFator();
+        return makeNode(type, token, mark);
+    }
 
-        node->addChild(left);
-        node->addChild(right);
-        left = node;
+    size_t count = pending.size() - mark;
+    ExpressionKey key{type, token.type, token.value, count > 0 ? pending[mark] : NO_NODE,
+                      count > 1 ? pending[mark + 1] : NO_NODE};
+    if (hashConsing)
+    {
+        sharing.expressionNodes++;
+        auto found = expressions.find(key);
+        if (found != expressions.end())
+        {
+            pending.resize(mark);
+            semantic->reuseExpressionNode(static_cast<uint32_t>(count), found->second.type);
+            sharing.reusedNodes++;
+            sharing.savedBytes += sizeof(ASTNode) + count * sizeof(NodeId);
+            return found->second.node;
+        }
     }
 
-    return left;
+    NodeId node = makeNode(type, token, mark);
+    if (semantic->typeExpressionNode(node) && hashConsing)
+    {
+        expressions.emplace(key, SharedExpression{node, semantic->expressionType()});
+    }
+    return node;
 }
 
-ASTNodePtr Parser::parseFator()
+NodeId Parser::parseFator()
 {
     if (match(TokenType::NUMERO))
     {
-        auto node = std::make_shared<ASTNode>(NodeType::NUMERO, currentToken);
+        // O valor é decodificado uma vez aqui, nao a cada avaliação
+        int32_t value = 0;
+        std::string_view digits = currentToken.value;
+        auto decoded = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+        if (decoded.ec != std::errc() || decoded.ptr != digits.data() + digits.size())
+        {
+            error("Numero '" + std::string(digits) + "' fora do intervalo dos inteiros (maximo " +
+                  std::to_string(INT32_MAX) + ")");
+            return NO_NODE;
+        }
+        NodeId node = makeExpressionNode(NodeType::NUMERO, currentToken, pending.size());
+        ast[node].value = value;
         advance();
         return node;
     }
 
     if (match(TokenType::STRING))
     {
-        auto node = std::make_shared<ASTNode>(NodeType::STRING_LITERAL, currentToken);
+        NodeId node = makeExpressionNode(NodeType::STRING_LITERAL, currentToken, pending.size());
         advance();
         return node;
     }
 
     if (match(TokenType::IDENTIFICADOR))
     {
-        auto node = std::make_shared<ASTNode>(NodeType::IDENTIFICADOR, currentToken);
+        NodeId node = makeExpressionNode(NodeType::IDENTIFICADOR, currentToken, pending.size());
         advance();
         return node;
     }
 
     if (match(TokenType::VERDADEIRO) || match(TokenType::FALSO))
     {
-        auto node = std::make_shared<ASTNode>(NodeType::LITERAL, currentToken);
-        advance();
-        return node;
-    }
-
-    if (match(TokenType::PARENTESE_ESQ))
-    {
-        advance();
-        auto expr = parseExpressao();
-        if (!expect(TokenType::PARENTESE_DIR))
-        {
-            error("Esperado ')' apos expressão");
-        }
-        return expr;
-    }
-
-    if (match(TokenType::MENOS))
-    {
-        auto node = std::make_shared<ASTNode>(NodeType::UNARIO, currentToken);
+        NodeId node = makeExpressionNode(NodeType::LITERAL, currentToken, pending.size());
+        ast[node].value = match(TokenType::VERDADEIRO) ? 1 : 0;
         advance();
-        auto operand = parseFator();
-        if (operand)
-            node->addChild(operand);
         return node;
     }
 
     error("Esperado número, string, identificador ou expressão");
-    return nullptr;
+    return NO_NODE;
 }
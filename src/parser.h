@@ -2,45 +2,127 @@
 #ifndef PARSER_H
 #define PARSER_H
 
-#include "lexer.h"
+#include "token_stream.h"
 #include "ast.h"
-#include <memory>
+#include "symbol_table.h"
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class SemanticAnalyzer;
 
 class Parser {
+public:
+    // Hash-consing: quanto a AST deixou de crescer
+    struct SharingStats {
+        size_t expressionNodes = 0; // nós de expressão pedidos pelo parser
+        size_t reusedNodes = 0;     // ... que já existiam
+        size_t savedBytes = 0;      // nós e ids de filhos que a AST deixou de guardar
+    };
+
 private:
-    Lexer& lexer;
+    // Comando composto ('se', 'enquanto') ou lista de comandos em análise.
+    // A pilha 'blocks' faz o papel da recursão parseComando -> parseSe ->
+    // parseListaComandos, então o aninhamento só é limitado pelo heap.
+    enum class BlockStage : uint8_t { START, AWAITING_COMMAND, AWAITING_THEN, AWAITING_ELSE };
+    struct BlockFrame {
+        NodeType type;
+        BlockStage stage;
+        // Uma passada: a lista é analisada, ou o 'se'/'enquanto' é analisado
+        // e (depois do cabeçalho) a sua condição é lógica
+        bool active;
+        size_t mark;     // início dos filhos em 'pending'
+        size_t bodyMark; // início dos comandos do corpo do 'enquanto'
+        Token token;
+    };
+
+    // Operador à espera do seu operando direito; idem para as expressões
+    enum class OperatorKind : uint8_t { PARENTHESES, UNARY, BINARY };
+    struct OperatorFrame {
+        Token op;
+        NodeId left; // operando esquerdo de um BINARY
+        int power;   // o operando termina no primeiro operador que nao ligue mais forte
+        OperatorKind kind;
+    };
+
+    enum class ListStatus { CONTINUE, END, FAIL };
+
+    // Hash-consing: nós de expressão iguais (tipo, token e filhos) sao um só
+    struct ExpressionKey {
+        NodeType type;
+        TokenType token;
+        std::string_view text; // grafia do token: mensagens citam o nome como foi escrito
+        NodeId left;           // NO_NODE nas folhas
+        NodeId right;          // NO_NODE nas folhas e nos unários
+        bool operator==(const ExpressionKey& other) const;
+    };
+    struct ExpressionKeyHash {
+        size_t operator()(const ExpressionKey& key) const;
+    };
+    struct SharedExpression {
+        NodeId node;
+        SymbolType type;
+    };
+
+    TokenStream& lexer;
     Token currentToken;
     std::string errorMessage;
+    AST ast;
+    std::vector<NodeId> pending; // filhos dos nós ainda em construção
+    std::vector<BlockFrame> blocks;
+    std::vector<OperatorFrame> operators;
+    SharingStats sharing;
+    SemanticAnalyzer* semantic; // análise em uma passada; nullptr = só a sintaxe
+    bool typing = false;        // os nós da expressão em análise recebem tipo
+    int expressionLine = 0;     // linha do token da raiz da última expressão
+    bool hashConsing;
+    std::unordered_map<ExpressionKey, SharedExpression, ExpressionKeyHash> expressions;
     
     void advance();
     bool match(TokenType expected);
     bool expect(TokenType expected);
     void error(const std::string& message);
+    // Cria o nó com os filhos empilhados em 'pending' desde 'mark'
+    NodeId makeNode(NodeType type, const Token& token, size_t mark);
+    void addChild(NodeId child);
+    bool checks(bool active, size_t index) const;
     
-    ASTNodePtr parsePrograma();
-    ASTNodePtr parseDeclaracoes();
-    ASTNodePtr parseDeclaracao();
-    ASTNodePtr parseListaVar();
-    ASTNodePtr parseTipo();
-    ASTNodePtr parseListaComandos();
-    ASTNodePtr parseComando();
-    ASTNodePtr parseAtribuicao();
-    ASTNodePtr parseSe();
-    ASTNodePtr parseEnquanto();
-    ASTNodePtr parseLer();
-    ASTNodePtr parseEscrever();
-    ASTNodePtr parseExpressao();
-    ASTNodePtr parseExpressaoLogica();
-    ASTNodePtr parseExpressaoRelacional();
-    ASTNodePtr parseExpressaoAritmetica();
-    ASTNodePtr parseTermo();
-    ASTNodePtr parseFator();
+    NodeId parsePrograma();
+    NodeId parseDeclaracoes();
+    NodeId parseDeclaracao();
+    NodeId parseListaVar();
+    NodeId parseTipo();
+    NodeId parseListaComandos();
+    NodeId parseComando(bool checked); // 'se' e 'enquanto' empilham um bloco e devolvem PENDING_NODE
+    NodeId parseAtribuicao(bool checked);
+    bool parseCabecalhoSe(bool checked);
+    bool parseCabecalhoEnquanto(bool checked);
+    bool isBlockEnd();
+    void pushBlock(NodeType type, const Token& token = Token(), bool active = true);
+    bool stepListaComandos(size_t frame, NodeId& result);
+    bool stepSe(size_t frame, NodeId& result);
+    bool stepEnquanto(size_t frame, NodeId& result);
+    ListStatus acceptListaComando(NodeId comando);
+    bool acceptEnquantoComando(NodeId comando);
+    NodeId parseLer(bool checked);
+    NodeId parseVariavelLida(bool checked);
+    NodeId parseEscrever(bool checked);
+    NodeId parseExpressao(bool typed = false);
+    NodeId parseFator(); // literal ou identificador
+    NodeId closeOperator(const OperatorFrame& frame, NodeId operand);
+    NodeId makeExpressionNode(NodeType type, const Token& token, size_t mark);
     
 public:
-    Parser(Lexer& lexer);
-    ASTNodePtr parse();
+    // Com 'semantic', declarações e tipos sao verificados durante o parsing
+    // (uma passada), com os mesmos erros de SemanticAnalyzer::analyze.
+    // 'hashConsing' (só com 'semantic') compartilha as subexpressões iguais:
+    // a AST vira um grafo acíclico, e as posições de um nó compartilhado sao
+    // as da primeira ocorrência.
+    Parser(TokenStream& lexer, SemanticAnalyzer* semantic = nullptr, bool hashConsing = false);
+    AST parse(); // AST vazia em caso de erro
     bool hasError() const { return !errorMessage.empty(); }
     const std::string& getError() const { return errorMessage; }
+    const SharingStats& sharingStats() const { return sharing; }
 };
 
 #endif
@@ -0,0 +1,97 @@
+#include "pass_manager.h"
+#include "ir_passes.h"
+#include <algorithm>
+
+const std::vector<PassManager::Pass>& PassManager::passes() {
+    static const std::vector<Pass> known = {
+        {"fold", foldConstants},
+        {"simplify-cfg", simplifyControlFlow},
+        {"dce", eliminateDeadCode},
+        {"gvn", numberValues},
+        {"licm", hoistInvariants},
+    };
+    return known;
+}
+
+static const PassManager::Pass* findPass(const std::string& name) {
+    for (const PassManager::Pass& pass : PassManager::passes()) {
+        if (name == pass.name) return &pass;
+    }
+    return nullptr;
+}
+
+void PassManager::setLevel(int level) {
+    pipeline.clear();
+    repeat = true;
+    // gvn antes de licm: cada constante e conta repetida no laço vira uma
+    // só, que é levada para fora uma vez
+    const char* o1[] = {"fold", "simplify-cfg", "dce"};
+    const char* o2[] = {"fold", "gvn", "licm", "fold", "simplify-cfg", "dce"};
+    if (level >= 2) {
+        for (const char* name : o2) pipeline.push_back(*findPass(name));
+    } else if (level == 1) {
+        for (const char* name : o1) pipeline.push_back(*findPass(name));
+    }
+}
+
+bool PassManager::setPasses(const std::string& list) {
+    pipeline.clear();
+    repeat = false;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string name = list.substr(start, end - start);
+        if (!name.empty()) {
+            const Pass* pass = findPass(name);
+            if (!pass) {
+                errorMessage = "Passada desconhecida: '" + name + "'";
+                return false;
+            }
+            pipeline.push_back(*pass);
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+bool PassManager::check(const IRFunction& ir, const char* after) {
+    if (!verify) return true;
+    std::string error;
+    if (verifyIR(ir, error)) return true;
+    errorMessage = std::string(after) + ": " + error;
+    return false;
+}
+
+bool PassManager::run(IRFunction& ir) {
+    errorMessage.clear();
+    warnings.clear();
+    stats = Stats();
+    ir.warnings.clear();
+    if (!check(ir, "construcao da IR")) return false;
+    for (int round = 0; round < (repeat ? MAX_ROUNDS : 1); round++) {
+        stats.rounds++;
+        bool changed = false;
+        for (const Pass& pass : pipeline) {
+            stats.runs++;
+            if (pass.run(ir)) {
+                stats.changes++;
+                changed = true;
+            }
+            if (!check(ir, pass.name)) return false;
+        }
+        if (!changed) break;
+    }
+
+    std::vector<IRWarning> found = ir.warnings;
+    std::stable_sort(found.begin(), found.end(), [&ir](const IRWarning& a, const IRWarning& b) {
+        const SourcePosition& p = ir.positions[a.position];
+        const SourcePosition& q = ir.positions[b.position];
+        return p.line != q.line ? p.line < q.line : p.column < q.column;
+    });
+    for (const IRWarning& warning : found) {
+        warnings.push_back("Aviso na linha " + std::to_string(ir.positions[warning.position].line) + ": " +
+                           warning.message);
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef PASS_MANAGER_H
+#define PASS_MANAGER_H
+
+#include "ir.h"
+#include <string>
+#include <vector>
+
+// Sequência de passadas sobre a IR. Os níveis montam sequências fixas:
+// -O0 nenhuma, -O1 fold, simplify-cfg e dce, -O2 também gvn e licm; a
+// sequência do nível se repete enquanto alguma passada mudar a IR (até
+// MAX_ROUNDS vezes). Uma lista dada com --passes roda uma vez, na ordem dada,
+// para testar as passadas uma a uma. Com verify a IR é conferida antes da
+// primeira passada e depois de cada uma, e o erro diz qual passada a quebrou.
+class PassManager {
+public:
+    using PassFunction = bool (*)(IRFunction&);
+
+    struct Pass {
+        const char* name;
+        PassFunction run;
+    };
+
+    struct Stats {
+        size_t runs = 0;    // passadas executadas
+        size_t changes = 0; // das quais mudaram a IR
+        size_t rounds = 0;
+    };
+
+private:
+    static const int MAX_ROUNDS = 4;
+
+    std::vector<Pass> pipeline;
+    bool repeat = false;
+    bool verify = false;
+    std::string errorMessage;
+    std::vector<std::string> warnings;
+    Stats stats;
+
+    bool check(const IRFunction& ir, const char* after);
+
+public:
+    // Passadas conhecidas, pelo nome usado em --passes
+    static const std::vector<Pass>& passes();
+
+    void setLevel(int level);
+    // Nomes separados por vírgula; false com a mensagem se algum nao existir
+    bool setPasses(const std::string& list);
+    void setVerify(bool enabled) { verify = enabled; }
+
+    bool run(IRFunction& ir);
+    bool hasError() const { return !errorMessage.empty(); }
+    const std::string& getError() const { return errorMessage; }
+    const Stats& passStats() const { return stats; }
+    // Avisos das passadas da última execução, em ordem de linha
+    const std::vector<std::string>& getWarnings() const { return warnings; }
+};
+
+#endif
@@ -0,0 +1,352 @@
+#include "program_cache.h"
+#include "operators.h"
+#include "source_buffer.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
+
+// Layout do arquivo: cabeçalho, nós, símbolos e ids dos filhos. O texto dos
+// tokens nao é gravado: os registros guardam a posição dele na fonte, que o
+// cache só aceita se for idêntica (mesmo tamanho e hash). Os registros estao
+// na ordem de bytes da máquina.
+static const char CACHE_MAGIC[8] = {'F', 'O', 'R', 'T', 'A', 'L', 'L', 'C'};
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const uint32_t UNDECLARED = UINT32_MAX;
+static const uint32_t OPERATOR_TEXT = UINT32_MAX; // texto fixo do tipo do token, fora da fonte
+static const uint32_t NODE_TYPE_COUNT = static_cast<uint32_t>(NodeType::STRING_LITERAL) + 1;
+static const uint32_t TOKEN_TYPE_COUNT = static_cast<uint32_t>(TokenType::COMENTARIO) + 1;
+
+struct CacheHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint64_t payloadHash; // tudo depois do cabeçalho
+    uint32_t nodeCount;
+    uint32_t childCount;
+    uint32_t symbolCount;
+    uint32_t root;
+};
+
+// 32 bytes. Os filhos de cada nó vêm logo depois dos do nó anterior em
+// childIds (a AST é construída assim), entao o início deles nao é gravado.
+struct CachedNode {
+    uint8_t type;
+    uint8_t tokenType;
+    uint8_t valueType;
+    uint8_t assigned; // IDENTIFICADOR: leitura sempre inicializada
+    int32_t line;
+    int32_t column;
+    uint32_t symbol; // índice na tabela de símbolos do arquivo (id no pool da compilação)
+    uint32_t textOffset; // na fonte, ou OPERATOR_TEXT
+    uint32_t textLength;
+    uint32_t childCount;
+    int32_t value; // NUMERO e LITERAL; o slot das variáveis é refeito a cada execução
+};
+
+// Nome de uma variável (a grafia de uma ocorrência na fonte) e o tipo
+// declarado (UNDECLARED se só é usada)
+struct CachedSymbol {
+    uint32_t textOffset;
+    uint32_t textLength;
+    uint32_t type;
+};
+
+// Texto dos operadores e da pontuação: o Lexer usa literais, que nao estao na
+// fonte. Vazio para os outros tipos de token.
+static std::string_view operatorText(TokenType type) {
+    for (char c : std::string_view("+-*/=<>:;.,()[]")) {
+        for (char next : {'\0', '=', '>'}) {
+            OperatorToken op = scanOperator(c, next);
+            if (op.type == type) {
+                return op.text;
+            }
+        }
+    }
+    return std::string_view();
+}
+
+static bool hasValue(NodeType type) {
+    return type == NodeType::NUMERO || type == NodeType::LITERAL;
+}
+
+static uint64_t mix(uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+static uint64_t hashBytes(const char* data, size_t size) {
+    // FNV-1a de 8 em 8 bytes, com uma mistura final
+    uint64_t h = 0xcbf29ce484222325ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        h = (h ^ word) * 0x100000001b3ULL;
+    }
+    for (; i < size; i++) {
+        h = (h ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ULL;
+    }
+    return mix(h);
+}
+
+template <typename Record>
+static Record readRecord(const char* data, size_t index) {
+    Record record;
+    std::memcpy(&record, data + index * sizeof(Record), sizeof(Record));
+    return record;
+}
+
+std::string ProgramCache::pathFor(const std::string& sourceFile) {
+    const std::string extension = ".fort";
+    if (sourceFile.size() > extension.size() &&
+        sourceFile.compare(sourceFile.size() - extension.size(), extension.size(), extension) == 0) {
+        return sourceFile + "c";
+    }
+    return sourceFile + ".fortc";
+}
+
+uint64_t ProgramCache::hashSource(std::string_view source) {
+    return hashBytes(source.data(), source.size());
+}
+
+bool ProgramCache::store(const std::string& cacheFile, std::string_view source, const AST& ast,
+                         const SymbolTable& symbols, const StringPool& pool) {
+    if (ast.empty() || source.size() >= OPERATOR_TEXT) {
+        return false;
+    }
+
+    // Posição do texto na fonte; os textos de fora dela só podem ser o de um operador
+    auto textOffset = [&](const Token& token, uint32_t& offset) {
+        std::string_view value = token.value;
+        if (value.empty()) {
+            offset = 0;
+            return true;
+        }
+        if (value.data() >= source.data() && value.data() + value.size() <= source.data() + source.size()) {
+            offset = static_cast<uint32_t>(value.data() - source.data());
+            return true;
+        }
+        offset = OPERATOR_TEXT;
+        return value == operatorText(token.type);
+    };
+
+    uint64_t nodesSize = uint64_t(ast.size()) * sizeof(CachedNode);
+    uint64_t symbolsSize = uint64_t(pool.size()) * sizeof(CachedSymbol);
+    uint64_t childrenSize = uint64_t(ast.childIds.size()) * sizeof(NodeId);
+    std::string payload(nodesSize + symbolsSize + childrenSize, '\0');
+    char* nodeRecords = payload.data();
+    char* symbolRecords = nodeRecords + nodesSize;
+
+    // Um nó de cada nome, para a grafia dele na fonte
+    std::vector<NodeId> spelling(pool.size(), NO_NODE);
+    uint32_t firstChild = 0;
+    for (NodeId i = 0; i < ast.size(); i++) {
+        const ASTNode& node = ast[i];
+        const Token& token = node.token;
+        CachedNode cached;
+        cached.type = static_cast<uint8_t>(node.type);
+        cached.tokenType = static_cast<uint8_t>(token.type);
+        cached.valueType = static_cast<uint8_t>(node.valueType);
+        cached.assigned = node.assigned;
+        cached.line = token.line;
+        cached.column = token.column;
+        cached.symbol = token.symbol;
+        cached.textLength = static_cast<uint32_t>(token.value.size());
+        cached.childCount = node.childCount;
+        cached.value = hasValue(node.type) ? node.value : 0;
+        if (node.firstChild != firstChild || !textOffset(token, cached.textOffset) ||
+            (token.symbol != NO_SYMBOL && token.symbol >= pool.size())) {
+            return false;
+        }
+        firstChild += node.childCount;
+        if (token.symbol != NO_SYMBOL && spelling[token.symbol] == NO_NODE) {
+            spelling[token.symbol] = i;
+        }
+        std::memcpy(nodeRecords + i * sizeof(CachedNode), &cached, sizeof(CachedNode));
+    }
+
+    // Um registro por nome do pool, na ordem dos ids: o índice no arquivo é o
+    // próprio id, e um pool novo interna os nomes de volta com os mesmos ids
+    for (uint32_t id = 0; id < pool.size(); id++) {
+        const Symbol* symbol = symbols.get(id);
+        CachedSymbol cached;
+        if (spelling[id] == NO_NODE || !textOffset(ast[spelling[id]].token, cached.textOffset)) {
+            return false; // nome que nao aparece na AST
+        }
+        cached.textLength = static_cast<uint32_t>(ast[spelling[id]].token.value.size());
+        cached.type = symbol ? static_cast<uint32_t>(symbol->type) : UNDECLARED;
+        std::memcpy(symbolRecords + id * sizeof(CachedSymbol), &cached, sizeof(CachedSymbol));
+    }
+    std::memcpy(symbolRecords + symbolsSize, ast.childIds.data(), childrenSize);
+
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.sourceHash = hashSource(source);
+    header.sourceSize = source.size();
+    header.payloadHash = hashBytes(payload.data(), payload.size());
+    header.nodeCount = static_cast<uint32_t>(ast.size());
+    header.childCount = static_cast<uint32_t>(ast.childIds.size());
+    header.symbolCount = static_cast<uint32_t>(pool.size());
+    header.root = ast.root;
+
+    // Grava em um arquivo temporário e troca de uma vez: outro processo nunca
+    // vê um cache pela metade
+    std::string temporary = cacheFile + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if (!out.flush()) {
+            out.close();
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+#ifdef _WIN32
+    std::remove(cacheFile.c_str()); // rename nao substitui arquivos no Windows
+#endif
+    if (std::rename(temporary.c_str(), cacheFile.c_str()) != 0) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool ProgramCache::load(const std::string& cacheFile, std::string_view source, AST& ast, SymbolTable& symbols,
+                        StringPool& pool) {
+    SourceBuffer file;
+    if (!file.open(cacheFile)) {
+        return false;
+    }
+    std::string_view data = file.view();
+    if (data.size() < sizeof(CacheHeader)) {
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != VERSION ||
+        header.byteOrder != BYTE_ORDER_MARK || header.sourceSize != source.size() ||
+        header.root >= header.nodeCount) {
+        return false;
+    }
+
+    uint64_t nodesSize = uint64_t(header.nodeCount) * sizeof(CachedNode);
+    uint64_t symbolsSize = uint64_t(header.symbolCount) * sizeof(CachedSymbol);
+    uint64_t childrenSize = uint64_t(header.childCount) * sizeof(NodeId);
+    if (sizeof(CacheHeader) + nodesSize + symbolsSize + childrenSize != data.size()) {
+        return false;
+    }
+
+    const char* payload = data.data() + sizeof(CacheHeader);
+    if (header.sourceHash != hashSource(source) ||
+        header.payloadHash != hashBytes(payload, data.size() - sizeof(CacheHeader))) {
+        return false;
+    }
+
+    const char* nodeRecords = payload;
+    const char* symbolRecords = nodeRecords + nodesSize;
+    const char* children = symbolRecords + symbolsSize;
+    auto textAt = [&](uint32_t offset, uint32_t length, TokenType type, std::string_view& value) {
+        if (offset == OPERATOR_TEXT) {
+            value = operatorText(type);
+            return value.size() == length && length > 0;
+        }
+        if (uint64_t(offset) + length > source.size()) {
+            return false;
+        }
+        value = length > 0 ? source.substr(offset, length) : std::string_view();
+        return true;
+    };
+
+    // A tabela de símbolos do arquivo está na ordem dos ids: no pool vazio da
+    // compilação os nomes voltam com os mesmos ids, e os nós e a tabela de
+    // símbolos usam os índices do arquivo sem tradução
+    if (pool.size() != 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < header.symbolCount; i++) {
+        CachedSymbol cached = readRecord<CachedSymbol>(symbolRecords, i);
+        std::string_view name;
+        if (cached.textOffset == OPERATOR_TEXT ||
+            !textAt(cached.textOffset, cached.textLength, TokenType::IDENTIFICADOR, name) ||
+            (cached.type != UNDECLARED && cached.type > static_cast<uint32_t>(SymbolType::LOGICO)) ||
+            pool.intern(name) != i) {
+            return false;
+        }
+    }
+
+    AST loaded;
+    loaded.childIds.resize(header.childCount);
+    std::memcpy(loaded.childIds.data(), children, childrenSize);
+    const NodeId* childIds = loaded.childIds.data();
+    loaded.nodes.resize(header.nodeCount);
+    ASTNode* nodes = loaded.nodes.data();
+    uint32_t firstChild = 0;
+    for (uint32_t i = 0; i < header.nodeCount; i++) {
+        CachedNode cached = readRecord<CachedNode>(nodeRecords, i);
+        ASTNode& node = nodes[i];
+        if (cached.type >= NODE_TYPE_COUNT || cached.tokenType >= TOKEN_TYPE_COUNT ||
+            (cached.symbol != NO_SYMBOL && cached.symbol >= header.symbolCount) ||
+            uint64_t(firstChild) + cached.childCount > header.childCount ||
+            cached.valueType > static_cast<uint32_t>(SymbolType::LOGICO) || cached.assigned > 1 ||
+            !textAt(cached.textOffset, cached.textLength, static_cast<TokenType>(cached.tokenType), node.token.value)) {
+            return false;
+        }
+        // Filhos sempre antes do pai: a árvore nao tem ciclos
+        for (uint32_t c = 0; c < cached.childCount; c++) {
+            if (childIds[firstChild + c] >= i) {
+                return false;
+            }
+        }
+        node.type = static_cast<NodeType>(cached.type);
+        node.token.type = static_cast<TokenType>(cached.tokenType);
+        node.token.line = cached.line;
+        node.token.column = cached.column;
+        node.token.symbol = cached.symbol;
+        node.firstChild = firstChild;
+        node.childCount = cached.childCount;
+        node.valueType = static_cast<SymbolType>(cached.valueType);
+        node.assigned = cached.assigned != 0;
+        if (hasValue(node.type)) {
+            node.value = cached.value;
+        }
+        firstChild += cached.childCount;
+    }
+    if (firstChild != header.childCount) {
+        return false;
+    }
+    loaded.root = header.root;
+
+    for (uint32_t i = 0; i < header.symbolCount; i++) {
+        CachedSymbol cached = readRecord<CachedSymbol>(symbolRecords, i);
+        if (cached.type != UNDECLARED) {
+            symbols.declare(i, static_cast<SymbolType>(cached.type));
+        }
+    }
+    ast = std::move(loaded);
+    return true;
+}
+
+bool ProgramCache::remove(const std::string& cacheFile) {
+    return std::remove(cacheFile.c_str()) == 0;
+}
@@ -0,0 +1,48 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include "ast.h"
+#include "string_pool.h"
+#include "symbol_table.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Cache em disco de programas já verificados (arquivo.fort -> arquivo.fortc),
+// ligado com --cache. Guarda a AST e as declarações depois das análises
+// sintática e semântica, identificado pelo hash do conteúdo da fonte.
+// Carregar o cache dispensa lexer, parser e análise semântica: o arquivo é
+// mapeado em memória, os nomes das variáveis voltam ao StringPool (vazio) da
+// compilação com os ids do arquivo e os nós sao copiados para a arena, com o
+// texto dos tokens apontando para a fonte já aberta.
+//
+// A AST nao usa o mapeamento diretamente: o texto de cada token é um
+// string_view (ponteiro absoluto) e a arena é um std::vector que o
+// SlotResolver e a RangeAnalysis anotam. Por isso a carga custa uma passada
+// que escreve sizeof(ASTNode) bytes por nó, além do hash do conteúdo, e fica
+// longe do custo de só abrir a fonte.
+//
+// Um cache de outra versão do formato, de outra fonte ou corrompido é
+// ignorado (e regravado na compilação seguinte), nunca lido pela metade.
+class ProgramCache {
+public:
+    // Muda sempre que o formato do arquivo ou o significado da AST mudar
+    static const uint32_t VERSION = 6;
+
+    static std::string pathFor(const std::string& sourceFile);
+    static uint64_t hashSource(std::string_view source);
+
+    // Preenche 'ast' e 'symbols' a partir do cache da fonte; false se o cache
+    // nao existe ou nao serve. A AST aponta para 'source', que precisa
+    // sobreviver a ela.
+    static bool load(const std::string& cacheFile, std::string_view source, AST& ast, SymbolTable& symbols,
+                     StringPool& pool);
+
+    // Grava o programa verificado (troca atômica do arquivo), com os nomes
+    // tirados do pool em que ele foi compilado; false se nao foi possível escrever
+    static bool store(const std::string& cacheFile, std::string_view source, const AST& ast,
+                      const SymbolTable& symbols, const StringPool& pool);
+    static bool remove(const std::string& cacheFile);
+};
+
+#endif
@@ -0,0 +1,435 @@
+#include "range_analysis.h"
+#include <algorithm>
+#include <climits>
+
+// Acima disso (blocos x variáveis) os intervalos nao cabem com folga na
+// memória: nenhum operador é provado e todos sao testados na execução
+static const uint64_t MAX_STATE_ENTRIES = uint64_t(1) << 24;
+
+// Mudanças na entrada de uma cabeça de laço antes de alargar os intervalos
+static const uint8_t WIDEN_AFTER = 2;
+
+static bool isEmpty(int64_t low, int64_t high) {
+    return low > high;
+}
+
+static bool isRelational(TokenType op) {
+    return op == TokenType::IGUAL || op == TokenType::DIFERENTE || op == TokenType::MENOR ||
+           op == TokenType::MENOR_IGUAL || op == TokenType::MAIOR || op == TokenType::MAIOR_IGUAL;
+}
+
+// 'a op b' falso é 'a (negação de op) b'
+static TokenType negate(TokenType op) {
+    switch (op) {
+        case TokenType::IGUAL: return TokenType::DIFERENTE;
+        case TokenType::DIFERENTE: return TokenType::IGUAL;
+        case TokenType::MENOR: return TokenType::MAIOR_IGUAL;
+        case TokenType::MENOR_IGUAL: return TokenType::MAIOR;
+        case TokenType::MAIOR: return TokenType::MENOR_IGUAL;
+        default: return TokenType::MENOR; // MAIOR_IGUAL
+    }
+}
+
+// 'a op b' é 'b (op trocado) a'
+static TokenType swapSides(TokenType op) {
+    switch (op) {
+        case TokenType::MENOR: return TokenType::MAIOR;
+        case TokenType::MENOR_IGUAL: return TokenType::MAIOR_IGUAL;
+        case TokenType::MAIOR: return TokenType::MENOR;
+        case TokenType::MAIOR_IGUAL: return TokenType::MENOR_IGUAL;
+        default: return op; // IGUAL, DIFERENTE
+    }
+}
+
+void RangeAnalysis::analyze(AST& tree, const std::vector<SymbolType>& slotTypes) {
+    ast = &tree;
+    types = &slotTypes;
+    variableCount = static_cast<uint32_t>(slotTypes.size());
+    stats = Stats();
+    found.clear();
+    warnings.clear();
+    for (ASTNode& node : tree.nodes) {
+        node.proven = false;
+    }
+    if (tree.empty()) {
+        return;
+    }
+
+    blocks = buildFlowGraph(tree);
+    if (uint64_t(blocks.size()) * std::max<uint32_t>(variableCount, 1) <= MAX_STATE_ENTRIES) {
+        propagate();
+        mark();
+    }
+
+    std::stable_sort(found.begin(), found.end(), [](const Warning& a, const Warning& b) {
+        return a.line != b.line ? a.line < b.line : a.column < b.column;
+    });
+    for (const Warning& warning : found) {
+        warnings.push_back(warning.message);
+    }
+    blocks.clear();
+    entryStates.clear();
+    reached.clear();
+    changes.clear();
+    verdicts.clear();
+}
+
+// Junta 'state' à entrada do bloco. Na cabeça de um laço que já mudou
+// WIDEN_AFTER vezes, um limite que ainda cresce vai direto ao limite do
+// inteiro: cada limite só pode ser alargado uma vez.
+void RangeAnalysis::flowInto(uint32_t block, const Range* state, std::vector<uint32_t>& worklist,
+                             std::vector<uint8_t>& queued) {
+    Range* entry = entryStates.data() + size_t(block) * variableCount;
+    bool changed = false;
+    if (!reached[block]) {
+        reached[block] = 1;
+        std::copy(state, state + variableCount, entry);
+        changed = true;
+    } else {
+        const FlowBlock& flow = blocks[block];
+        bool widen = changes[block] >= WIDEN_AFTER && flow.branch != NO_NODE &&
+                     (*ast)[flow.branch].type == NodeType::ENQUANTO;
+        for (uint32_t i = 0; i < variableCount; i++) {
+            Range& known = entry[i];
+            const Range& incoming = state[i];
+            if (incoming.low < known.low) {
+                known.low = widen ? INT_MIN : incoming.low;
+                changed = true;
+            }
+            if (incoming.high > known.high) {
+                known.high = widen ? INT_MAX : incoming.high;
+                changed = true;
+            }
+        }
+    }
+    if (changed && changes[block] < UINT8_MAX) {
+        changes[block]++;
+    }
+    if (changed && !queued[block]) {
+        queued[block] = 1;
+        worklist.push_back(block);
+    }
+}
+
+void RangeAnalysis::propagate() {
+    reached.assign(blocks.size(), 0);
+    changes.assign(blocks.size(), 0);
+    entryStates.assign(blocks.size() * size_t(variableCount), Range{0, 0});
+
+    // Uma variável ainda nao inicializada vale 0: o interpretador guarda 0 no
+    // slot, e a leitura dela dá erro e devolve 0
+    std::vector<uint32_t> worklist;
+    std::vector<uint8_t> queued(blocks.size(), 0);
+    std::vector<Range> state(variableCount, Range{0, 0});
+    std::vector<Range> edge(variableCount);
+    flowInto(0, state.data(), worklist, queued);
+
+    while (!worklist.empty()) {
+        uint32_t block = worklist.back();
+        worklist.pop_back();
+        queued[block] = 0;
+
+        const Range* entry = entryStates.data() + size_t(block) * variableCount;
+        std::copy(entry, entry + variableCount, state.begin());
+        for (NodeId command : blocks[block].commands) {
+            transfer(command, state.data());
+        }
+
+        const FlowBlock& flow = blocks[block];
+        if (flow.branch != NO_NODE) {
+            NodeId condition = ast->child(flow.branch, 0);
+            for (int side = 0; side < 2; side++) {
+                edge = state;
+                if (refine(condition, side == 0, edge.data())) {
+                    flowInto(flow.successors[side], edge.data(), worklist, queued);
+                }
+            }
+        } else if (flow.successors[0] != NO_BLOCK) {
+            flowInto(flow.successors[0], state.data(), worklist, queued);
+        }
+    }
+}
+
+// Estreita 'state' para o lado 'outcome' da condição; false se o lado nunca
+// é tomado. Só as variáveis comparadas direto (ou a variável lógica da
+// condição) sao estreitadas.
+bool RangeAnalysis::refine(NodeId condition, bool outcome, Range* state) {
+    const AST& tree = *ast;
+    Range value = evaluate(condition, state);
+    bool canBeTrue = value.low != 0 || value.high != 0;
+    bool canBeFalse = value.low <= 0 && value.high >= 0;
+    if (outcome ? !canBeTrue : !canBeFalse) {
+        return false;
+    }
+
+    const ASTNode& node = tree[condition];
+    if (node.type == NodeType::IDENTIFICADOR && node.slot != NO_SLOT) {
+        Range& variable = state[node.slot];
+        if (!outcome) {
+            variable = {0, 0};
+        } else if (variable.low == 0) {
+            variable.low = 1;
+        } else if (variable.high == 0) {
+            variable.high = -1;
+        }
+        return !isEmpty(variable.low, variable.high);
+    }
+    if (node.type != NodeType::BINARIO || node.childCount < 2 || !isRelational(node.token.type)) {
+        return true;
+    }
+
+    TokenType op = outcome ? node.token.type : negate(node.token.type);
+    NodeId sides[2] = {tree.child(condition, 0), tree.child(condition, 1)};
+    Range ranges[2] = {evaluate(sides[0], state), evaluate(sides[1], state)};
+    for (int i = 0; i < 2; i++) {
+        const ASTNode& side = tree[sides[i]];
+        if (side.type != NodeType::IDENTIFICADOR || side.slot == NO_SLOT) continue;
+        Range& variable = state[side.slot];
+        const Range& other = ranges[1 - i];
+        int64_t low = variable.low;
+        int64_t high = variable.high;
+        switch (i == 0 ? op : swapSides(op)) {
+            case TokenType::MENOR:
+                high = std::min<int64_t>(high, int64_t(other.high) - 1);
+                break;
+            case TokenType::MENOR_IGUAL:
+                high = std::min<int64_t>(high, other.high);
+                break;
+            case TokenType::MAIOR:
+                low = std::max<int64_t>(low, int64_t(other.low) + 1);
+                break;
+            case TokenType::MAIOR_IGUAL:
+                low = std::max<int64_t>(low, other.low);
+                break;
+            case TokenType::IGUAL:
+                low = std::max<int64_t>(low, other.low);
+                high = std::min<int64_t>(high, other.high);
+                break;
+            default: // DIFERENTE: só tira um valor da ponta
+                if (other.low == other.high) {
+                    if (low == other.low) low++;
+                    if (high == other.low) high--;
+                }
+                break;
+        }
+        if (isEmpty(low, high)) {
+            return false;
+        }
+        variable = {static_cast<int32_t>(low), static_cast<int32_t>(high)};
+    }
+    return true;
+}
+
+void RangeAnalysis::transfer(NodeId command, Range* state) {
+    const AST& tree = *ast;
+    const ASTNode& node = tree[command];
+    switch (node.type) {
+        case NodeType::ATRIBUICAO: {
+            if (node.childCount < 2) return;
+            Range value = evaluate(tree.child(command, 1), state);
+            uint32_t slot = tree[tree.child(command, 0)].slot;
+            if (slot != NO_SLOT) state[slot] = value;
+            return;
+        }
+        case NodeType::LER:
+            for (NodeId child : tree.children(command)) {
+                uint32_t slot = tree[child].slot;
+                if (slot == NO_SLOT) continue;
+                state[slot] = (*types)[slot] == SymbolType::LOGICO ? Range{0, 1} : Range{INT_MIN, INT_MAX};
+            }
+            return;
+        case NodeType::ESCREVER:
+            for (NodeId child : tree.children(command)) {
+                if (tree[child].type != NodeType::STRING_LITERAL) evaluate(child, state);
+            }
+            return;
+        default:
+            return;
+    }
+}
+
+// Percorre de novo os blocos alcançáveis com os intervalos do ponto fixo,
+// anotando cada operador que pode falhar; um nó compartilhado (hash-consing)
+// só é provado se nenhum dos seus usos falhar
+void RangeAnalysis::mark() {
+    AST& tree = *ast;
+    verdicts.assign(tree.size(), UNSEEN);
+    marking = true;
+    std::vector<Range> state(variableCount);
+    for (uint32_t block = 0; block < blocks.size(); block++) {
+        if (!reached[block]) continue;
+        const Range* entry = entryStates.data() + size_t(block) * variableCount;
+        std::copy(entry, entry + variableCount, state.begin());
+        for (NodeId command : blocks[block].commands) {
+            transfer(command, state.data());
+        }
+        if (blocks[block].branch != NO_NODE) {
+            evaluate(tree.child(blocks[block].branch, 0), state.data());
+        }
+    }
+    marking = false;
+
+    for (NodeId id = 0; id < tree.size(); id++) {
+        uint8_t verdict = verdicts[id] & ~WARNED;
+        if (verdict == UNSEEN) continue;
+        bool safe = verdict == SAFE;
+        tree[id].proven = safe;
+        if (tree[id].token.type == TokenType::DIVISAO) {
+            stats.divisions++;
+            stats.provenDivisions += safe;
+        } else {
+            stats.arithmetic++;
+            stats.provenArithmetic += safe;
+        }
+    }
+}
+
+RangeAnalysis::Range RangeAnalysis::evaluate(NodeId root, const Range* state) {
+    return foldExpression(*ast, root, expression, [this, state](const ASTNode& node, const Range* operands) {
+        return operands ? evaluateOperator(node, operands) : evaluateLeaf(node, state);
+    });
+}
+
+RangeAnalysis::Range RangeAnalysis::evaluateLeaf(const ASTNode& node, const Range* state) const {
+    switch (node.type) {
+        case NodeType::NUMERO:
+        case NodeType::LITERAL:
+            return {node.value, node.value};
+        case NodeType::IDENTIFICADOR:
+            return node.slot != NO_SLOT ? state[node.slot] : Range{0, 0};
+        default: // STRING_LITERAL vale 0
+            return {0, 0};
+    }
+}
+
+// Intervalo do resultado. Uma conta que pode falhar devolve 0 no
+// interpretador (depois do erro), entao o 0 entra no intervalo.
+RangeAnalysis::Range RangeAnalysis::evaluateOperator(const ASTNode& node, const Range* operands) {
+    const Range& left = operands[0];
+    const Range right = expressionOperands(node) > 1 ? operands[1] : Range{0, 0};
+    if (isEmpty(left.low, left.high) || isEmpty(right.low, right.high)) {
+        return {1, 0};
+    }
+    if (node.type == NodeType::UNARIO && node.token.type != TokenType::MENOS) {
+        return left;
+    }
+
+    int64_t low;
+    int64_t high;
+    bool mayFail = false;
+    TokenType op = node.type == NodeType::UNARIO ? TokenType::ERRO : node.token.type;
+    switch (op) {
+        case TokenType::ERRO: // negação
+            low = -int64_t(left.high);
+            high = -int64_t(left.low);
+            break;
+        case TokenType::MAIS:
+            low = int64_t(left.low) + right.low;
+            high = int64_t(left.high) + right.high;
+            break;
+        case TokenType::MENOS:
+            low = int64_t(left.low) - right.high;
+            high = int64_t(left.high) - right.low;
+            break;
+        case TokenType::MULTIPLICACAO: {
+            int64_t products[4] = {int64_t(left.low) * right.low, int64_t(left.low) * right.high,
+                                   int64_t(left.high) * right.low, int64_t(left.high) * right.high};
+            low = *std::min_element(products, products + 4);
+            high = *std::max_element(products, products + 4);
+            break;
+        }
+        case TokenType::DIVISAO: {
+            // O quociente é monótono em cada operando com o divisor de sinal
+            // fixo: os extremos estao nos cantos de cada lado do zero
+            mayFail = (right.low <= 0 && right.high >= 0) ||
+                      (left.low == INT_MIN && right.low <= -1 && right.high >= -1);
+            low = INT64_MAX;
+            high = INT64_MIN;
+            int64_t parts[2][2] = {{right.low, std::min<int64_t>(right.high, -1)},
+                                   {std::max<int64_t>(right.low, 1), right.high}};
+            for (const auto& part : parts) {
+                if (isEmpty(part[0], part[1])) continue;
+                for (int64_t dividend : {int64_t(left.low), int64_t(left.high)}) {
+                    for (int64_t divisor : part) {
+                        low = std::min(low, dividend / divisor);
+                        high = std::max(high, dividend / divisor);
+                    }
+                }
+            }
+            if (isEmpty(low, high)) { // divisor sempre 0
+                low = high = 0;
+            }
+            break;
+        }
+        default: { // relacionais: 1 ou 0, ou o resultado se já for decidido
+            bool always;
+            bool never;
+            switch (op) {
+                case TokenType::MENOR:
+                    always = left.high < right.low;
+                    never = left.low >= right.high;
+                    break;
+                case TokenType::MENOR_IGUAL:
+                    always = left.high <= right.low;
+                    never = left.low > right.high;
+                    break;
+                case TokenType::MAIOR:
+                    always = left.low > right.high;
+                    never = left.high <= right.low;
+                    break;
+                case TokenType::MAIOR_IGUAL:
+                    always = left.low >= right.high;
+                    never = left.high < right.low;
+                    break;
+                case TokenType::IGUAL:
+                case TokenType::DIFERENTE:
+                    always = left.low == left.high && right.low == right.high && left.low == right.low;
+                    never = left.high < right.low || right.high < left.low;
+                    if (op == TokenType::DIFERENTE) std::swap(always, never);
+                    break;
+                default:
+                    always = never = false;
+                    break;
+            }
+            return {always ? 1 : 0, never ? 0 : 1};
+        }
+    }
+
+    if (op != TokenType::DIVISAO) {
+        mayFail = low < INT_MIN || high > INT_MAX;
+        if (marking && (high < INT_MIN || low > INT_MAX)) {
+            warn(node, "estouro de inteiro");
+        }
+    }
+    if (marking) {
+        record(node, !mayFail);
+    }
+    low = std::max<int64_t>(low, INT_MIN);
+    high = std::min<int64_t>(high, INT_MAX);
+    if (mayFail) {
+        if (isEmpty(low, high)) { // sempre estoura
+            low = high = 0;
+        }
+        low = std::min<int64_t>(low, 0);
+        high = std::max<int64_t>(high, 0);
+    }
+    return {static_cast<int32_t>(low), static_cast<int32_t>(high)};
+}
+
+void RangeAnalysis::record(const ASTNode& node, bool safe) {
+    uint8_t& verdict = verdicts[&node - ast->nodes.data()];
+    if ((verdict & UNSAFE) == 0) {
+        verdict = (verdict & WARNED) | (safe ? SAFE : UNSAFE);
+    }
+}
+
+// Um aviso por nó, mesmo com o nó visto em vários caminhos
+void RangeAnalysis::warn(const ASTNode& node, const std::string& message) {
+    uint8_t& verdict = verdicts[&node - ast->nodes.data()];
+    if (verdict & WARNED) {
+        return;
+    }
+    verdict |= WARNED;
+    found.push_back({node.token.line, node.token.column,
+                     "Aviso na linha " + std::to_string(node.token.line) + ": " + message});
+}
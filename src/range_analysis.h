@@ -0,0 +1,85 @@
+#ifndef RANGE_ANALYSIS_H
+#define RANGE_ANALYSIS_H
+
+#include "ast.h"
+#include "flow_graph.h"
+#include <string>
+#include <vector>
+
+// Análise de faixas de valores, antes do Optimizer. Em cada ponto do
+// programa cada variável tem um intervalo [mínimo, máximo] dos valores que
+// ela pode ter; os intervalos se propagam pelo grafo de fluxo numa lista de
+// trabalho. A condição de um 'se'/'enquanto' estreita o intervalo das
+// variáveis comparadas em cada lado, e na cabeça de um laço que continua
+// mudando o intervalo é alargado até o limite do inteiro, para o ponto fixo
+// terminar.
+//
+// Um operador que nunca falha em nenhum caminho (a conta cabe no inteiro; a
+// divisão nunca é por 0 nem -2147483648 / -1) fica marcado ('proven') e o
+// interpretador o executa sem testes. Os outros sao testados na execução, e
+// um estouro é erro de execução como a divisão por zero. Uma conta que
+// estoura sempre que roda vira aviso de compilação.
+class RangeAnalysis {
+public:
+    struct Stats {
+        size_t arithmetic = 0;       // +, - e * e negações alcançáveis
+        size_t provenArithmetic = 0; // ... que nunca estouram
+        size_t divisions = 0;        // divisões alcançáveis
+        size_t provenDivisions = 0;  // ... que nunca falham
+    };
+
+private:
+    // Valores possíveis de uma variável ou expressão; vazio (low > high)
+    // onde nenhum valor chega
+    struct Range {
+        int32_t low;
+        int32_t high;
+    };
+
+    // Por operador; WARNED se soma ao veredicto depois do aviso
+    enum Verdict : uint8_t { UNSEEN = 0, SAFE = 1, UNSAFE = 2, WARNED = 4 };
+
+    struct Warning {
+        int line;
+        int column;
+        std::string message;
+    };
+
+    AST* ast;
+    const std::vector<SymbolType>* types;
+    uint32_t variableCount = 0;
+    std::vector<FlowBlock> blocks;
+    std::vector<Range> entryStates;  // variableCount intervalos por bloco
+    std::vector<uint8_t> reached;
+    std::vector<uint8_t> changes;    // vezes que a entrada do bloco mudou (até 255)
+    std::vector<uint8_t> verdicts;   // por operador que pode falhar
+    bool marking = false;            // 'evaluate' anota os veredictos e avisos
+    Stats stats;
+    std::vector<Warning> found;
+    std::vector<std::string> warnings;
+    ExpressionStack<Range> expression;
+
+    void propagate();
+    void flowInto(uint32_t block, const Range* state, std::vector<uint32_t>& worklist,
+                  std::vector<uint8_t>& queued);
+    bool refine(NodeId condition, bool outcome, Range* state);
+    void transfer(NodeId command, Range* state);
+    void mark();
+    Range evaluate(NodeId root, const Range* state);
+    Range evaluateLeaf(const ASTNode& node, const Range* state) const;
+    Range evaluateOperator(const ASTNode& node, const Range* operands);
+    void record(const ASTNode& node, bool safe);
+    void warn(const ASTNode& node, const std::string& message);
+
+public:
+    // 'tree' já passou pelo SlotResolver ('slotTypes'); os operadores que
+    // nunca falham ficam marcados
+    void analyze(AST& tree, const std::vector<SymbolType>& slotTypes);
+
+    // Avisos da última análise, em ordem de linha
+    const std::vector<std::string>& getWarnings() const { return warnings; }
+
+    const Stats& rangeStats() const { return stats; }
+};
+
+#endif
@@ -0,0 +1,171 @@
+#include "reference_lexer.h"
+#include "keywords.h"
+#include "operators.h"
+#include "utf8.h"
+#include <algorithm>
+#include <cctype>
+#include <string>
+
+ReferenceLexer::ReferenceLexer(std::string_view input, StringPool& pool)
+    : input(input), position(0), line(1), column(1), pool(pool) {}
+
+char ReferenceLexer::currentChar() const {
+    if (position >= input.size()) {
+        return '\0';
+    }
+    return input[position];
+}
+
+// Os bytes de continuação UTF-8 (10xxxxxx) nao contam coluna: nas strings e
+// nos comentários a coluna anda por code point
+void ReferenceLexer::advance() {
+    if (position >= input.size()) {
+        return;
+    }
+    unsigned char c = static_cast<unsigned char>(input[position]);
+    if (c == '\n') {
+        line++;
+        column = 1;
+    } else if ((c & 0xC0) != 0x80) {
+        column++;
+    }
+    position++;
+}
+
+void ReferenceLexer::advanceCharacter(size_t length) {
+    position += length;
+    column++;
+}
+
+// Comprimento do caractere corrente se ele puder estar em um identificador
+// (no início, sem dígitos nem marcas combinantes); senão 0
+size_t ReferenceLexer::identifierCharLength(bool first) const {
+    if (position >= input.size()) {
+        return 0;
+    }
+    unsigned char c = static_cast<unsigned char>(input[position]);
+    if (c < 0x80) {
+        bool accepted = first ? (std::isalpha(c) || c == '_') : (std::isalnum(c) || c == '_');
+        return accepted ? 1 : 0;
+    }
+    uint32_t codePoint = 0;
+    size_t length = decodeUtf8(input.data() + position, input.size() - position, codePoint);
+    if (length < 2) {
+        return 0;
+    }
+    return isUnicodeLetter(codePoint) || (!first && isUnicodeMark(codePoint)) ? length : 0;
+}
+
+void ReferenceLexer::skipWhitespace() {
+    while (currentChar() != '\0' && std::isspace(static_cast<unsigned char>(currentChar()))) {
+        advance();
+    }
+}
+
+void ReferenceLexer::skipComment() {
+    advance(); // Consome '{'
+    while (position < input.size() && input[position] != '}') {
+        advance();
+    }
+    advance(); // Consome '}', se houver
+}
+
+Token ReferenceLexer::readNumber() {
+    size_t start = position;
+    int startColumn = column;
+    while (std::isdigit(static_cast<unsigned char>(currentChar()))) {
+        advance();
+    }
+    return Token(TokenType::NUMERO, input.substr(start, position - start), line, startColumn);
+}
+
+Token ReferenceLexer::readString() {
+    int startColumn = column;
+    advance(); // Consome a aspa de abertura
+    size_t start = position;
+    while (position < input.size() && input[position] != '\'') {
+        advance();
+    }
+    std::string_view str = input.substr(start, position - start);
+    if (position >= input.size()) {
+        return Token(TokenType::ERRO, str, line, startColumn);
+    }
+    advance();
+    return Token(TokenType::STRING, str, line, startColumn);
+}
+
+// Como no Lexer original: o nome em minúsculas é procurado entre as palavras
+// reservadas
+static TokenType keywordType(std::string_view word) {
+    std::string lowered;
+    for (char c : word) {
+        lowered += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    for (const Keyword& keyword : KEYWORDS) {
+        if (keyword.text == lowered) {
+            return keyword.type;
+        }
+    }
+    return TokenType::IDENTIFICADOR;
+}
+
+Token ReferenceLexer::readIdentifier() {
+    size_t start = position;
+    int startColumn = column;
+    for (size_t length = identifierCharLength(true); length > 0; length = identifierCharLength(false)) {
+        advanceCharacter(length);
+    }
+
+    std::string_view identifier = input.substr(start, position - start);
+    TokenType type = keywordType(identifier);
+    if (type != TokenType::IDENTIFICADOR) {
+        return Token(type, identifier, line, startColumn);
+    }
+    return Token(type, identifier, line, startColumn, pool.intern(identifier));
+}
+
+Token ReferenceLexer::nextToken() {
+    while (true) {
+        skipWhitespace();
+        if (currentChar() == '\0') {
+            return Token(TokenType::FIM_ARQUIVO, "", line, column);
+        }
+        if (currentChar() != '{') {
+            break;
+        }
+        skipComment();
+    }
+
+    int currentLine = line;
+    int currentColumn = column;
+    char c = currentChar();
+
+    if (identifierCharLength(true) > 0) {
+        return readIdentifier();
+    }
+    if (std::isdigit(static_cast<unsigned char>(c))) {
+        return readNumber();
+    }
+    if (c == '\'') {
+        return readString();
+    }
+    if (!isAsciiByte(c)) {
+        // Sequência UTF-8 que nao é letra: um único ERRO (um byte, se inválida)
+        uint32_t codePoint = 0;
+        size_t length = std::max<size_t>(1, decodeUtf8(input.data() + position, input.size() - position, codePoint));
+        std::string_view text = input.substr(position, length);
+        advanceCharacter(length);
+        return Token(TokenType::ERRO, text, currentLine, currentColumn);
+    }
+
+    OperatorToken op = scanOperator(c, position + 1 < input.size() ? input[position + 1] : '\0');
+    if (op.type == TokenType::ERRO) {
+        std::string_view errorChar = input.substr(position, 1);
+        advance();
+        return Token(TokenType::ERRO, errorChar, currentLine, currentColumn);
+    }
+    for (size_t i = 0; i < op.text.size(); i++) {
+        advance();
+    }
+    return Token(op.type, op.text, currentLine, currentColumn);
+}
@@ -0,0 +1,39 @@
+#ifndef REFERENCE_LEXER_H
+#define REFERENCE_LEXER_H
+
+#include "token.h"
+#include "token_stream.h"
+#include "string_pool.h"
+#include <string_view>
+
+// Lexer de referência para o teste diferencial (lexcheck): o Lexer de antes
+// dos kernels, um byte por vez com currentChar()/advance() e as funções de
+// <cctype>, acrescido só das regras que a linguagem ganhou depois (texto
+// apontando para a fonte, identificadores UTF-8 e colunas em code points).
+// Nao usa a tabela de classes, os kernels nem o hash das palavras
+// reservadas, para que uma divergência aponte para eles.
+class ReferenceLexer : public TokenStream {
+private:
+    std::string_view input;
+    size_t position;
+    int line;
+    int column;
+    StringPool& pool;
+
+    char currentChar() const;
+    void advance();
+    // Consome um caractere de 'length' bytes que ocupa uma coluna
+    void advanceCharacter(size_t length);
+    size_t identifierCharLength(bool first) const;
+    void skipWhitespace();
+    void skipComment();
+    Token readNumber();
+    Token readString();
+    Token readIdentifier();
+
+public:
+    ReferenceLexer(std::string_view input, StringPool& pool);
+    Token nextToken() override;
+};
+
+#endif
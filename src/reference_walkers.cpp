@@ -0,0 +1,827 @@
+#include "reference_walkers.h"
+#include <charconv>
+#include <climits>
+#include <iostream>
+#include <limits>
+
+static const int MAX_ITERATIONS = 100000; // o mesmo limite do Interpreter
+static const int UNARY_BINDING_POWER = 40;
+
+static int bindingPower(TokenType type) {
+    switch (type) {
+        case TokenType::IGUAL:
+        case TokenType::DIFERENTE:
+        case TokenType::MENOR:
+        case TokenType::MENOR_IGUAL:
+        case TokenType::MAIOR:
+        case TokenType::MAIOR_IGUAL:
+            return 10;
+        case TokenType::MAIS:
+        case TokenType::MENOS:
+            return 20;
+        case TokenType::MULTIPLICACAO:
+        case TokenType::DIVISAO:
+            return 30;
+        default:
+            return 0;
+    }
+}
+
+static bool isRelational(TokenType op) {
+    return bindingPower(op) == 10;
+}
+
+static bool compare(TokenType op, int left, int right) {
+    switch (op) {
+        case TokenType::IGUAL: return left == right;
+        case TokenType::DIFERENTE: return left != right;
+        case TokenType::MENOR: return left < right;
+        case TokenType::MENOR_IGUAL: return left <= right;
+        case TokenType::MAIOR: return left > right;
+        case TokenType::MAIOR_IGUAL: return left >= right;
+        default: return false;
+    }
+}
+
+// ===== Parser =====
+
+ReferenceParser::ReferenceParser(TokenStream& lexer) : lexer(lexer) {
+    currentToken = lexer.nextToken();
+}
+
+void ReferenceParser::advance() {
+    currentToken = lexer.nextToken();
+    while (currentToken.type == TokenType::COMENTARIO) {
+        currentToken = lexer.nextToken();
+    }
+}
+
+bool ReferenceParser::expect(TokenType expected) {
+    if (match(expected)) {
+        advance();
+        return true;
+    }
+    return false;
+}
+
+void ReferenceParser::error(const std::string& message) {
+    if (hasError()) return;
+    errorMessage = "Erro sintatico na linha " + std::to_string(currentToken.line) +
+                   ", coluna " + std::to_string(currentToken.column) + ": " + message;
+}
+
+NodeId ReferenceParser::makeNode(NodeType type, const Token& token, size_t mark) {
+    NodeId node = ast.addNode(type, token, pending.data() + mark, pending.size() - mark);
+    pending.resize(mark);
+    return node;
+}
+
+void ReferenceParser::addChild(NodeId child) {
+    if (child != NO_NODE) pending.push_back(child);
+}
+
+bool ReferenceParser::isBlockEnd() const {
+    return match(TokenType::FIM) || match(TokenType::FIM_ARQUIVO) || match(TokenType::SENAO) ||
+           match(TokenType::FIM_SE) || match(TokenType::FIM_ENQUANTO);
+}
+
+AST ReferenceParser::parse() {
+    ast.nodes.reserve(lexer.sizeHint()); // como o Parser
+    ast.childIds.reserve(lexer.sizeHint());
+    ast.root = parsePrograma();
+    if (hasError()) ast.root = NO_NODE;
+    pending.clear();
+    return std::move(ast);
+}
+
+NodeId ReferenceParser::parsePrograma() {
+    size_t mark = pending.size();
+    if (!expect(TokenType::PROGRAMA)) {
+        error("Esperado 'programa'");
+        return NO_NODE;
+    }
+    if (!match(TokenType::IDENTIFICADOR)) {
+        error("Esperado nome do programa");
+        return NO_NODE;
+    }
+    Token name = currentToken;
+    advance();
+    if (!expect(TokenType::PONTO_VIRGULA)) {
+        error("Esperado ';' apos nome do programa");
+        return NO_NODE;
+    }
+    if (match(TokenType::VAR)) {
+        addChild(parseDeclaracoes());
+    }
+    if (!expect(TokenType::INICIO)) {
+        error("Esperado 'inicio'");
+        return NO_NODE;
+    }
+    addChild(parseListaComandos());
+    if (!expect(TokenType::FIM)) {
+        error("Esperado 'fim'");
+        return NO_NODE;
+    }
+    if (!expect(TokenType::PONTO)) {
+        error("Esperado '.' no final do programa");
+        return NO_NODE;
+    }
+    return makeNode(NodeType::PROGRAMA, name, mark);
+}
+
+NodeId ReferenceParser::parseDeclaracoes() {
+    size_t mark = pending.size();
+    if (!expect(TokenType::VAR)) return NO_NODE;
+    do {
+        addChild(parseDeclaracao());
+        if (!expect(TokenType::PONTO_VIRGULA)) {
+            error("Esperado ';' apos declaração");
+            return NO_NODE;
+        }
+    } while (match(TokenType::IDENTIFICADOR));
+    return makeNode(NodeType::DECLARACAO, Token(), mark);
+}
+
+NodeId ReferenceParser::parseDeclaracao() {
+    size_t mark = pending.size();
+    addChild(parseListaVar());
+    if (!expect(TokenType::DOIS_PONTOS)) {
+        error("Esperado ':' na declaração");
+        return NO_NODE;
+    }
+    addChild(parseTipo());
+    return makeNode(NodeType::DECLARACAO, Token(), mark);
+}
+
+NodeId ReferenceParser::parseListaVar() {
+    size_t mark = pending.size();
+    if (!match(TokenType::IDENTIFICADOR)) {
+        error("Esperado identificador");
+        return NO_NODE;
+    }
+    addChild(ast.addNode(NodeType::IDENTIFICADOR, currentToken));
+    advance();
+    while (match(TokenType::VIRGULA)) {
+        advance();
+        if (!match(TokenType::IDENTIFICADOR)) {
+            error("Esperado identificador apos ','");
+            return NO_NODE;
+        }
+        addChild(ast.addNode(NodeType::IDENTIFICADOR, currentToken));
+        advance();
+    }
+    return makeNode(NodeType::LISTA_VAR, Token(), mark);
+}
+
+NodeId ReferenceParser::parseTipo() {
+    if (match(TokenType::INTEIRO) || match(TokenType::LOGICO)) {
+        NodeId node = ast.addNode(NodeType::TIPO, currentToken);
+        advance();
+        return node;
+    }
+    error("Esperado tipo 'inteiro' ou 'logico'");
+    return NO_NODE;
+}
+
+NodeId ReferenceParser::parseListaComandos() {
+    size_t mark = pending.size();
+    while (!isBlockEnd()) {
+        NodeId comando = parseComando();
+        if (comando == NO_NODE) {
+            if (!hasError() && !isBlockEnd()) {
+                error("Comando inesperado ou faltou ';'.");
+                return NO_NODE;
+            }
+            break; // o bloco de cima lida com o delimitador
+        }
+        addChild(comando);
+        // 'se' e 'enquanto' nao exigem ';'; os outros comandos só o dispensam
+        // antes de um delimitador de bloco
+        if (ast[comando].type != NodeType::SE && ast[comando].type != NodeType::ENQUANTO &&
+            !expect(TokenType::PONTO_VIRGULA) && !isBlockEnd()) {
+            error("Esperado ';' apos comando.");
+            return NO_NODE;
+        }
+    }
+    return makeNode(NodeType::LISTA_COMANDOS, Token(), mark);
+}
+
+NodeId ReferenceParser::parseComando() {
+    switch (currentToken.type) {
+        case TokenType::IDENTIFICADOR: return parseAtribuicao();
+        case TokenType::SE: return parseSe();
+        case TokenType::ENQUANTO: return parseEnquanto();
+        case TokenType::LER: return parseLer();
+        case TokenType::ESCREVER: return parseEscrever();
+        default: return NO_NODE;
+    }
+}
+
+NodeId ReferenceParser::parseAtribuicao() {
+    size_t mark = pending.size();
+    addChild(ast.addNode(NodeType::IDENTIFICADOR, currentToken));
+    advance();
+    if (!expect(TokenType::ATRIBUICAO)) {
+        error("Esperado ':=' na atribuicao");
+        return NO_NODE;
+    }
+    addChild(parseExpressao());
+    return makeNode(NodeType::ATRIBUICAO, Token(), mark);
+}
+
+NodeId ReferenceParser::parseSe() {
+    size_t mark = pending.size();
+    Token keyword = currentToken;
+    advance(); // 'se'
+
+    bool hasParentheses = expect(TokenType::PARENTESE_ESQ);
+    NodeId condicao = parseExpressao();
+    if (condicao == NO_NODE) return NO_NODE;
+    addChild(condicao);
+    if (hasParentheses && !expect(TokenType::PARENTESE_DIR)) {
+        error("Esperado ')' apos a condicao do 'se'.");
+        return NO_NODE;
+    }
+    if (!expect(TokenType::ENTAO)) {
+        error("Esperado 'entao' apos condicao.");
+        return NO_NODE;
+    }
+
+    NodeId blocoEntao = parseListaComandos();
+    if (blocoEntao == NO_NODE) return NO_NODE;
+    addChild(blocoEntao);
+
+    const char* fimSe = "Esperado 'fim_se' apos o bloco 'entao'.";
+    if (expect(TokenType::SENAO)) {
+        NodeId blocoSenao = parseListaComandos();
+        if (blocoSenao == NO_NODE) return NO_NODE;
+        addChild(blocoSenao);
+        fimSe = "Esperado 'fim_se' apos o bloco 'senao'.";
+    }
+    if (!expect(TokenType::FIM_SE)) {
+        error(fimSe);
+        return NO_NODE;
+    }
+    return makeNode(NodeType::SE, keyword, mark);
+}
+
+NodeId ReferenceParser::parseEnquanto() {
+    size_t mark = pending.size();
+    Token keyword = currentToken;
+    advance(); // 'enquanto'
+
+    bool hasParentheses = expect(TokenType::PARENTESE_ESQ);
+    NodeId condition = parseExpressao();
+    if (condition == NO_NODE) {
+        error("Condição esperada para o comando 'enquanto'.");
+        return NO_NODE;
+    }
+    addChild(condition);
+    if (hasParentheses && !expect(TokenType::PARENTESE_DIR)) {
+        error("Esperado ')' apos a condição do 'enquanto'.");
+        return NO_NODE;
+    }
+    if (!expect(TokenType::FACA)) {
+        error("Esperado 'faca' apos a condição do 'enquanto'.");
+        return NO_NODE;
+    }
+
+    size_t bodyMark = pending.size();
+    while (!match(TokenType::FIM_ENQUANTO) && !hasError() && !match(TokenType::FIM_ARQUIVO)) {
+        NodeId command = parseComando();
+        if (command == NO_NODE) {
+            error("Comando inesperado no bloco 'enquanto'.");
+            return NO_NODE;
+        }
+        addChild(command);
+        // Todo comando dentro do laço exige ';', menos o último
+        if (!expect(TokenType::PONTO_VIRGULA) && !match(TokenType::FIM_ENQUANTO) &&
+            !match(TokenType::FIM_ARQUIVO)) {
+            error("Esperado ';' apos comando dentro do 'enquanto'.");
+            return NO_NODE;
+        }
+    }
+    if (!expect(TokenType::FIM_ENQUANTO)) {
+        error("Esperado 'fim_enquanto' para fechar o bloco 'enquanto'.");
+        return NO_NODE;
+    }
+    addChild(makeNode(NodeType::LISTA_COMANDOS, Token(), bodyMark));
+    return makeNode(NodeType::ENQUANTO, keyword, mark);
+}
+
+NodeId ReferenceParser::parseLer() {
+    size_t mark = pending.size();
+    Token keyword = currentToken;
+    advance(); // 'ler'
+
+    bool temParenteses = expect(TokenType::PARENTESE_ESQ);
+    if (!match(TokenType::IDENTIFICADOR)) {
+        error("Esperado identificador em 'ler'");
+        return NO_NODE;
+    }
+    addChild(ast.addNode(NodeType::IDENTIFICADOR, currentToken));
+    advance();
+    while (expect(TokenType::VIRGULA)) {
+        if (!match(TokenType::IDENTIFICADOR)) {
+            error("Esperado identificador apos ','");
+            return NO_NODE;
+        }
+        addChild(ast.addNode(NodeType::IDENTIFICADOR, currentToken));
+        advance();
+    }
+    if (temParenteses && !expect(TokenType::PARENTESE_DIR)) {
+        error("Esperado ')' em 'ler'");
+        return NO_NODE;
+    }
+    return makeNode(NodeType::LER, keyword, mark);
+}
+
+NodeId ReferenceParser::parseEscrever() {
+    size_t mark = pending.size();
+    Token keyword = currentToken;
+    advance(); // 'escrever'
+
+    bool temParenteses = expect(TokenType::PARENTESE_ESQ);
+    addChild(parseExpressao());
+    while (expect(TokenType::VIRGULA)) {
+        addChild(parseExpressao());
+    }
+    if (temParenteses && !expect(TokenType::PARENTESE_DIR)) {
+        error("Esperado ')' em 'escrever'");
+        return NO_NODE;
+    }
+    return makeNode(NodeType::ESCREVER, keyword, mark);
+}
+
+// Pratt recursivo: o operando direito de um operador é uma chamada com o
+// poder dele como mínimo
+NodeId ReferenceParser::parseExpressao(int minPower) {
+    NodeId left = parseFator();
+    while (bindingPower(currentToken.type) > minPower) {
+        Token op = currentToken;
+        int power = bindingPower(op.type);
+        advance();
+        NodeId right = parseExpressao(power);
+        size_t mark = pending.size();
+        addChild(left);
+        addChild(right);
+        left = makeNode(NodeType::BINARIO, op, mark);
+    }
+    return left;
+}
+
+NodeId ReferenceParser::parseFator() {
+    Token token = currentToken;
+    NodeId node;
+    switch (token.type) {
+        case TokenType::PARENTESE_ESQ:
+            advance();
+            node = parseExpressao();
+            if (!expect(TokenType::PARENTESE_DIR)) {
+                error("Esperado ')' apos expressão");
+            }
+            return node;
+
+        case TokenType::MENOS: {
+            advance();
+            size_t mark = pending.size();
+            addChild(parseExpressao(UNARY_BINDING_POWER));
+            return makeNode(NodeType::UNARIO, token, mark);
+        }
+
+        case TokenType::NUMERO: {
+            int32_t value = 0;
+            auto decoded = std::from_chars(token.value.data(), token.value.data() + token.value.size(), value);
+            if (decoded.ec != std::errc() || decoded.ptr != token.value.data() + token.value.size()) {
+                error("Numero '" + std::string(token.value) + "' fora do intervalo dos inteiros (maximo " +
+                      std::to_string(INT32_MAX) + ")");
+                return NO_NODE;
+            }
+            node = ast.addNode(NodeType::NUMERO, token);
+            ast[node].value = value;
+            advance();
+            return node;
+        }
+
+        case TokenType::STRING:
+            node = ast.addNode(NodeType::STRING_LITERAL, token);
+            advance();
+            return node;
+
+        case TokenType::IDENTIFICADOR:
+            node = ast.addNode(NodeType::IDENTIFICADOR, token);
+            advance();
+            return node;
+
+        case TokenType::VERDADEIRO:
+        case TokenType::FALSO:
+            node = ast.addNode(NodeType::LITERAL, token);
+            ast[node].value = token.type == TokenType::VERDADEIRO ? 1 : 0;
+            advance();
+            return node;
+
+        default:
+            error("Esperado número, string, identificador ou expressão");
+            return NO_NODE;
+    }
+}
+
+// ===== Análise semântica =====
+
+ReferenceChecker::ReferenceChecker(SymbolTable& table) : symbolTable(table), ast(nullptr) {}
+
+void ReferenceChecker::error(const std::string& message, int line) {
+    errorMessage = "Erro semantico";
+    if (line > 0) {
+        errorMessage += " na linha " + std::to_string(line);
+    }
+    errorMessage += ": " + message;
+}
+
+bool ReferenceChecker::analyze(AST& tree) {
+    if (tree.empty()) return false;
+    ast = &tree;
+    errorMessage.clear();
+    for (NodeId child : tree.children(tree.root)) {
+        if (tree[child].type == NodeType::DECLARACAO) {
+            analyzeDeclarations(child);
+        } else if (tree[child].type == NodeType::LISTA_COMANDOS) {
+            analyzeSequence(tree.children(child).begin(), tree[child].childCount);
+        }
+    }
+    return !hasError();
+}
+
+void ReferenceChecker::analyzeDeclarations(NodeId node) {
+    const AST& tree = *ast;
+    for (NodeId decl : tree.children(node)) {
+        if (tree[decl].childCount < 2 || hasError()) continue;
+        NodeId listaVar = tree.child(decl, 0);
+        SymbolType type = tree[tree.child(decl, 1)].token.type == TokenType::INTEIRO ? SymbolType::INTEIRO
+                                                                                      : SymbolType::LOGICO;
+        for (NodeId var : tree.children(listaVar)) {
+            const Token& token = tree[var].token;
+            if (!symbolTable.declare(token.symbol, type)) {
+                error("Variavel '" + std::string(token.value) + "' ja foi declarada", token.line);
+                break;
+            }
+        }
+    }
+}
+
+// O primeiro comando de uma sequência é analisado mesmo que já haja erro
+void ReferenceChecker::analyzeSequence(const NodeId* commands, uint32_t count) {
+    for (uint32_t i = 0; i < count && !(i > 0 && hasError()); i++) {
+        analyzeCommand(commands[i]);
+    }
+}
+
+void ReferenceChecker::analyzeCommand(NodeId node) {
+    const ASTNode& command = (*ast)[node];
+    const NodeId* children = ast->children(node).begin();
+    switch (command.type) {
+        case NodeType::ATRIBUICAO:
+            analyzeAssignment(node);
+            break;
+        case NodeType::SE:
+            if (analyzeCondition(node, "se") && command.childCount > 1) {
+                analyzeSequence(children + 1, command.childCount - 1);
+            }
+            break;
+        case NodeType::ENQUANTO:
+            if (analyzeCondition(node, "enquanto") && command.childCount > 1) {
+                analyzeSequence(children + 1, 1);
+            }
+            break;
+        case NodeType::LER:
+            analyzeRead(node);
+            break;
+        case NodeType::ESCREVER:
+            analyzeWrite(node);
+            break;
+        case NodeType::LISTA_COMANDOS:
+            analyzeSequence(children, command.childCount);
+            break;
+        default:
+            break;
+    }
+}
+
+void ReferenceChecker::analyzeAssignment(NodeId node) {
+    if ((*ast)[node].childCount < 2) return;
+    const Token& var = (*ast)[ast->child(node, 0)].token;
+    if (!symbolTable.exists(var.symbol)) {
+        error("Variavel '" + std::string(var.value) + "' nao foi declarada", var.line);
+        return;
+    }
+    if (symbolTable.get(var.symbol)->type != expressionType(ast->child(node, 1))) {
+        error("Tipos incompativeis na atribuicao", var.line);
+    }
+}
+
+bool ReferenceChecker::analyzeCondition(NodeId node, const char* command) {
+    if ((*ast)[node].childCount == 0) return false;
+    NodeId condition = ast->child(node, 0);
+    if (expressionType(condition) != SymbolType::LOGICO) {
+        error(std::string("Condicao do '") + command + "' deve ser do tipo logico", (*ast)[condition].token.line);
+        return false;
+    }
+    return true;
+}
+
+void ReferenceChecker::analyzeRead(NodeId node) {
+    for (NodeId idNode : ast->children(node)) {
+        const ASTNode& id = (*ast)[idNode];
+        if (id.type == NodeType::IDENTIFICADOR && !symbolTable.exists(id.token.symbol)) {
+            error("Variavel '" + std::string(id.token.value) + "' nao foi declarada", id.token.line);
+        }
+    }
+}
+
+void ReferenceChecker::analyzeWrite(NodeId node) {
+    for (NodeId expr : ast->children(node)) {
+        expressionType(expr);
+        if (hasError()) return;
+    }
+}
+
+// Os operandos sao analisados da esquerda para a direita, antes do operador
+SymbolType ReferenceChecker::expressionType(NodeId id) {
+    ASTNode& node = (*ast)[id];
+    uint32_t count = expressionOperands(node);
+    SymbolType type = SymbolType::INTEIRO;
+    if (count == 0) {
+        if (node.type == NodeType::LITERAL) {
+            if (node.token.type == TokenType::VERDADEIRO || node.token.type == TokenType::FALSO) {
+                type = SymbolType::LOGICO;
+            }
+        } else if (node.type == NodeType::IDENTIFICADOR) {
+            Symbol* symbol = symbolTable.get(node.token.symbol);
+            if (symbol) {
+                type = symbol->type;
+            } else {
+                error("Variavel '" + std::string(node.token.value) + "' nao foi declarada", node.token.line);
+            }
+        }
+    } else if (count == 1) {
+        SymbolType operand = expressionType(ast->child(id, 0));
+        type = operand;
+        if (node.token.type == TokenType::MENOS) {
+            type = SymbolType::INTEIRO;
+            if (operand != SymbolType::INTEIRO) {
+                error("Operador unario '-' espera operando inteiro", node.token.line);
+            }
+        }
+    } else {
+        SymbolType left = expressionType(ast->child(id, 0));
+        SymbolType right = expressionType(ast->child(id, 1));
+        bool integers = left == SymbolType::INTEIRO && right == SymbolType::INTEIRO;
+        int power = bindingPower(node.token.type);
+        if (power == 10) {
+            if (!integers) error("Operadores relacionais esperam operandos inteiros", node.token.line);
+            type = SymbolType::LOGICO;
+        } else if (power > 10) {
+            if (!integers) error("Operadores aritmeticos esperam operandos inteiros", node.token.line);
+        } else {
+            type = left;
+        }
+    }
+    node.valueType = type;
+    return type;
+}
+
+// ===== Interpretador =====
+
+ReferenceEvaluator::ReferenceEvaluator(const std::vector<SymbolType>& slotTypes) : ast(nullptr) {
+    slots.reserve(slotTypes.size());
+    for (SymbolType type : slotTypes) {
+        slots.push_back({0, false, false, type});
+    }
+}
+
+void ReferenceEvaluator::error(const std::string& message) {
+    errorMessage = "Erro de execucao: " + message;
+}
+
+bool ReferenceEvaluator::execute(const AST& tree) {
+    if (tree.empty()) return false;
+    ast = &tree;
+    errorMessage.clear();
+    for (NodeId child : tree.children(tree.root)) {
+        if (tree[child].type == NodeType::LISTA_COMANDOS) {
+            executeList(child);
+            break;
+        }
+    }
+    return !hasError();
+}
+
+void ReferenceEvaluator::executeList(NodeId list) {
+    for (NodeId command : ast->children(list)) {
+        if (hasError()) return;
+        executeCommand(command);
+    }
+}
+
+void ReferenceEvaluator::executeBlock(NodeId block) {
+    if ((*ast)[block].type == NodeType::LISTA_COMANDOS) {
+        executeList(block);
+    } else if (!hasError()) {
+        executeCommand(block);
+    }
+}
+
+void ReferenceEvaluator::executeCommand(NodeId node) {
+    switch ((*ast)[node].type) {
+        case NodeType::ATRIBUICAO: executeAssignment(node); break;
+        case NodeType::SE: executeIf(node); break;
+        case NodeType::ENQUANTO: executeWhile(node); break;
+        case NodeType::LER: executeRead(node); break;
+        case NodeType::ESCREVER: executeWrite(node); break;
+        case NodeType::LISTA_COMANDOS: executeList(node); break;
+        default: break;
+    }
+}
+
+void ReferenceEvaluator::executeAssignment(NodeId node) {
+    if ((*ast)[node].childCount < 2) return;
+    NodeId expr = ast->child(node, 1);
+    int value = evaluateInt(expr);
+    bool logical = writesLogical((*ast)[expr]);
+    uint32_t slot = (*ast)[ast->child(node, 0)].slot;
+    if (slot != NO_SLOT) {
+        slots[slot] = {value, true, logical, slots[slot].type};
+    }
+}
+
+void ReferenceEvaluator::executeIf(NodeId node) {
+    uint32_t childCount = (*ast)[node].childCount;
+    if (childCount == 0) return;
+    bool taken = evaluateCondition(ast->child(node, 0));
+    if (hasError()) return;
+    if (taken && childCount > 1) {
+        executeBlock(ast->child(node, 1));
+    } else if (!taken && childCount > 2) {
+        executeBlock(ast->child(node, 2));
+    }
+}
+
+void ReferenceEvaluator::executeWhile(NodeId node) {
+    if ((*ast)[node].childCount < 2) return;
+    NodeId condition = ast->child(node, 0);
+    int iterations = 0;
+    if (!evaluateCondition(condition) || hasError()) return;
+    do {
+        executeBlock(ast->child(node, 1));
+        if (hasError()) return;
+        if (++iterations >= MAX_ITERATIONS) {
+            error("Loop infinito detectado - interrompendo execucao");
+            return;
+        }
+    } while (evaluateCondition(condition));
+}
+
+void ReferenceEvaluator::executeRead(NodeId node) {
+    for (NodeId varNode : ast->children(node)) {
+        const Token& var = (*ast)[varNode].token;
+        uint32_t slot = (*ast)[varNode].slot;
+        if (slot == NO_SLOT) continue;
+        Slot& symbol = slots[slot];
+
+        std::cout << "Digite o valor para " << var.value << ": ";
+        std::cout.flush();
+
+        if (symbol.type == SymbolType::INTEIRO) {
+            int value;
+            if (std::cin >> value) {
+                symbol = {value, true, false, symbol.type};
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            } else {
+                std::cin.clear();
+                std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+                error("Entrada inválida para variável inteira '" + std::string(var.value) + "'");
+                return;
+            }
+        } else {
+            std::string input;
+            std::cin.ignore();
+            std::getline(std::cin, input);
+            bool value = (input == "verdadeiro" || input == "true" || input == "1");
+            symbol = {value ? 1 : 0, true, true, symbol.type};
+        }
+    }
+}
+
+void ReferenceEvaluator::executeWrite(NodeId node) {
+    ChildRange exprs = ast->children(node);
+    for (size_t i = 0; i < exprs.size(); i++) {
+        if (i > 0) std::cout << " ";
+        const ASTNode& expr = (*ast)[exprs[i]];
+        if (expr.type == NodeType::STRING_LITERAL) {
+            std::cout << expr.token.value;
+            continue;
+        }
+        int value = evaluateInt(exprs[i]);
+        if (writesLogical(expr)) {
+            std::cout << (value != 0 ? "verdadeiro" : "falso");
+        } else {
+            std::cout << value;
+        }
+    }
+    std::cout << std::endl;
+}
+
+int ReferenceEvaluator::evaluateInt(NodeId id) {
+    const ASTNode& node = (*ast)[id];
+    switch (expressionOperands(node)) {
+        case 0:
+            return leafValue(node);
+        case 1:
+            return applyOperator(node, evaluateInt(ast->child(id, 0)), 0);
+        default: {
+            int left = evaluateInt(ast->child(id, 0));
+            return applyOperator(node, left, evaluateInt(ast->child(id, 1)));
+        }
+    }
+}
+
+bool ReferenceEvaluator::evaluateCondition(NodeId id) {
+    const ASTNode& node = (*ast)[id];
+    if (node.type == NodeType::BINARIO && node.childCount >= 2 && isRelational(node.token.type)) {
+        int left = evaluateInt(ast->child(id, 0));
+        return compare(node.token.type, left, evaluateInt(ast->child(id, 1)));
+    }
+    return evaluateInt(id) != 0;
+}
+
+int ReferenceEvaluator::leafValue(const ASTNode& node) {
+    switch (node.type) {
+        case NodeType::NUMERO:
+        case NodeType::LITERAL:
+            return node.value;
+        case NodeType::IDENTIFICADOR:
+            if (node.assigned) {
+                return slots[node.slot].value;
+            }
+            if (node.slot == NO_SLOT || !slots[node.slot].initialized) {
+                error("Variável '" + std::string(node.token.value) + "' nao foi inicializada");
+                return 0;
+            }
+            return slots[node.slot].value;
+        default:
+            return 0;
+    }
+}
+
+bool ReferenceEvaluator::writesLogical(const ASTNode& node) const {
+    if (node.valueType != SymbolType::LOGICO) return false;
+    if (node.type == NodeType::LITERAL) {
+        return node.token.type == TokenType::VERDADEIRO || node.token.type == TokenType::FALSO;
+    }
+    if (node.type == NodeType::IDENTIFICADOR && node.slot != NO_SLOT) {
+        return slots[node.slot].initialized && slots[node.slot].logical;
+    }
+    return false;
+}
+
+int ReferenceEvaluator::applyOperator(const ASTNode& node, int left, int right) {
+    int result;
+    if (node.type == NodeType::UNARIO) {
+        if (node.token.type != TokenType::MENOS) return left;
+        if (node.proven) return static_cast<int>(0u - static_cast<unsigned>(left));
+        return __builtin_sub_overflow(0, left, &result) ? overflow() : result;
+    }
+    if (node.proven && node.token.type != TokenType::DIVISAO && !isRelational(node.token.type)) {
+        unsigned l = static_cast<unsigned>(left);
+        unsigned r = static_cast<unsigned>(right);
+        switch (node.token.type) {
+            case TokenType::MAIS: return static_cast<int>(l + r);
+            case TokenType::MENOS: return static_cast<int>(l - r);
+            case TokenType::MULTIPLICACAO: return static_cast<int>(l * r);
+            default: break;
+        }
+    }
+    switch (node.token.type) {
+        case TokenType::MAIS:
+            return __builtin_add_overflow(left, right, &result) ? overflow() : result;
+        case TokenType::MENOS:
+            return __builtin_sub_overflow(left, right, &result) ? overflow() : result;
+        case TokenType::MULTIPLICACAO:
+            return __builtin_mul_overflow(left, right, &result) ? overflow() : result;
+        case TokenType::DIVISAO:
+            if (node.proven) return left / right;
+            if (right == 0) {
+                error("Divisão por zero");
+                return 0;
+            }
+            if (left == INT_MIN && right == -1) return overflow();
+            return left / right;
+        default:
+            return compare(node.token.type, left, right) ? 1 : 0;
+    }
+}
+
+int ReferenceEvaluator::overflow() {
+    error("Estouro de inteiro");
+    return 0;
+}
@@ -0,0 +1,116 @@
+#ifndef REFERENCE_WALKERS_H
+#define REFERENCE_WALKERS_H
+
+#include "ast.h"
+#include "symbol_table.h"
+#include "token_stream.h"
+#include <string>
+#include <vector>
+
+// Percursos recursivos de referência para o bench-nesting: o parser, a
+// análise semântica e o interpretador como eram antes das pilhas explícitas
+// (uma chamada de função por nível de aninhamento), com as regras que a
+// linguagem ganhou depois (valores decodificados no parser, tipo gravado nos
+// nós, slots, primeiro erro sintático). Produzem a mesma AST, os mesmos tipos
+// e os mesmos erros que Parser, SemanticAnalyzer e Interpreter, para que a
+// diferença de tempo medida seja só a da recursão. Estouram a pilha do C++ em
+// programas muito aninhados: o bench limita a profundidade.
+
+class ReferenceParser {
+private:
+    TokenStream& lexer;
+    Token currentToken;
+    std::string errorMessage;
+    AST ast;
+    std::vector<NodeId> pending; // filhos dos nós ainda em construção
+
+    void advance();
+    bool match(TokenType expected) const { return currentToken.type == expected; }
+    bool expect(TokenType expected);
+    void error(const std::string& message);
+    NodeId makeNode(NodeType type, const Token& token, size_t mark);
+    void addChild(NodeId child);
+    bool isBlockEnd() const;
+
+    NodeId parsePrograma();
+    NodeId parseDeclaracoes();
+    NodeId parseDeclaracao();
+    NodeId parseListaVar();
+    NodeId parseTipo();
+    NodeId parseListaComandos();
+    NodeId parseComando();
+    NodeId parseAtribuicao();
+    NodeId parseSe();
+    NodeId parseEnquanto();
+    NodeId parseLer();
+    NodeId parseEscrever();
+    NodeId parseExpressao(int minPower = 0);
+    NodeId parseFator();
+
+public:
+    ReferenceParser(TokenStream& lexer);
+    AST parse(); // AST vazia em caso de erro
+    bool hasError() const { return !errorMessage.empty(); }
+    const std::string& getError() const { return errorMessage; }
+};
+
+class ReferenceChecker {
+private:
+    SymbolTable& symbolTable;
+    std::string errorMessage;
+    AST* ast;
+
+    void error(const std::string& message, int line = 0);
+    void analyzeDeclarations(NodeId node);
+    void analyzeSequence(const NodeId* commands, uint32_t count);
+    void analyzeCommand(NodeId node);
+    void analyzeAssignment(NodeId node);
+    bool analyzeCondition(NodeId node, const char* command);
+    void analyzeRead(NodeId node);
+    void analyzeWrite(NodeId node);
+    SymbolType expressionType(NodeId node);
+
+public:
+    ReferenceChecker(SymbolTable& table);
+    bool analyze(AST& tree);
+    bool hasError() const { return !errorMessage.empty(); }
+    const std::string& getError() const { return errorMessage; }
+};
+
+class ReferenceEvaluator {
+private:
+    struct Slot {
+        int value;
+        bool initialized;
+        bool logical;
+        SymbolType type;
+    };
+
+    std::vector<Slot> slots;
+    std::string errorMessage;
+    const AST* ast;
+
+    void error(const std::string& message);
+    void executeList(NodeId list);
+    void executeBlock(NodeId block); // lista de comandos ou um comando só
+    void executeCommand(NodeId node);
+    void executeAssignment(NodeId node);
+    void executeIf(NodeId node);
+    void executeWhile(NodeId node);
+    void executeRead(NodeId node);
+    void executeWrite(NodeId node);
+    int evaluateInt(NodeId node);
+    bool evaluateCondition(NodeId node);
+    int leafValue(const ASTNode& node);
+    int applyOperator(const ASTNode& node, int left, int right);
+    int overflow();
+    bool writesLogical(const ASTNode& node) const;
+
+public:
+    ReferenceEvaluator(const std::vector<SymbolType>& slotTypes);
+    bool execute(const AST& tree); // a AST já foi resolvida por SlotResolver
+    bool hasError() const { return !errorMessage.empty(); }
+    const std::string& getError() const { return errorMessage; }
+};
+
+#endif
@@ -1,9 +1,11 @@
 #include "semantic.h"
+#include <algorithm>
 #include <iostream>
 
-SemanticAnalyzer::SemanticAnalyzer(SymbolTable& table) : symbolTable(table) {}
+SemanticAnalyzer::SemanticAnalyzer(SymbolTable& table) : symbolTable(table), ast(nullptr) {}
 
 void SemanticAnalyzer::error(const std::string& message, int line) {
+    errorCount++;
     errorMessage = "Erro semantico";
     if (line > 0) {
         errorMessage += " na linha " + std::to_string(line);
@@ -11,16 +13,17 @@ void SemanticAnalyzer::error(const std::string& message, int line) {
     errorMessage += ": " + message;
 }
 
-bool SemanticAnalyzer::analyze(ASTNodePtr root) {
-    if (!root) return false;
+bool SemanticAnalyzer::analyze(AST& tree) {
+    if (tree.empty()) return false;
     
+    ast = &tree;
     errorMessage.clear();
     
     // Análise das declarações
-    for (auto child : root->children) {
-        if (child->type == NodeType::DECLARACAO) {
+    for (NodeId child : tree.children(tree.root)) {
+        if (tree[child].type == NodeType::DECLARACAO) {
             analyzeDeclarations(child);
-        } else if (child->type == NodeType::LISTA_COMANDOS) {
+        } else if (tree[child].type == NodeType::LISTA_COMANDOS) {
             analyzeCommands(child);
         }
     }
@@ -28,50 +31,74 @@ bool SemanticAnalyzer::analyze(ASTNodePtr root) {
     return !hasError();
 }
 
-void SemanticAnalyzer::analyzeDeclarations(ASTNodePtr node) {
-    if (!node) return;
+void SemanticAnalyzer::analyzeDeclarations(NodeId node) {
+    const AST& tree = *ast;
     
     // Agora processa cada declaração individual dentro do nó DECLARACAO
-    for (auto decl : node->children) {
-        if (decl->children.size() < 2) continue;
-        
-        auto listaVar = decl->children[0];
-        auto tipo = decl->children[1];
-        
-        SymbolType symbolType = (tipo->token.type == TokenType::INTEIRO) ? 
-                               SymbolType::INTEIRO : SymbolType::LOGICO;
-        
-        // Processa cada variavel na lista
-        for (auto var : listaVar->children) {
-            if (!symbolTable.declare(var->token.value, symbolType)) {
-                error("Variavel '" + var->token.value + "' ja foi declarada", var->token.line);
-                return;
-            }
-        }
+    for (NodeId decl : tree.children(node)) {
+        if (tree[decl].childCount < 2) continue;
+        declareVariables(tree.child(decl, 0), tree.child(decl, 1));
     }
 }
 
-void SemanticAnalyzer::analyzeCommands(ASTNodePtr node) {
-    if (!node) return;
+void SemanticAnalyzer::declareVariables(NodeId listaVar, NodeId tipo) {
+    const AST& tree = *ast;
+    // As declarações param na primeira variável repetida
+    if (hasError()) return;
+
+    SymbolType symbolType = (tree[tipo].token.type == TokenType::INTEIRO) ? 
+                           SymbolType::INTEIRO : SymbolType::LOGICO;
     
-    for (auto cmd : node->children) {
-        analyzeCommand(cmd);
-        if (hasError()) return;
+    // Processa cada variavel na lista
+    for (NodeId var : tree.children(listaVar)) {
+        const Token& token = tree[var].token;
+        if (!symbolTable.declare(token.symbol, symbolType)) {
+            error("Variavel '" + std::string(token.value) + "' ja foi declarada", token.line);
+            return;
+        }
     }
 }
 
-void SemanticAnalyzer::analyzeCommand(ASTNodePtr node) {
-    if (!node) return;
-    
-    switch (node->type) {
+// Percorre os comandos com uma pilha de blocos em vez de recursão: um 'se'
+// ou 'enquanto' com condição válida empilha os seus blocos, que sao
+// analisados até o primeiro erro. Cada bloco analisa o primeiro comando mesmo
+// que já haja erro, como a versão recursiva fazia.
+void SemanticAnalyzer::analyzeCommands(NodeId node) {
+    size_t base = blocks.size();
+    pushBlock(node, 0, (*ast)[node].childCount);
+
+    while (blocks.size() > base) {
+        Block& block = blocks.back();
+        if (block.next < block.count && !(block.next > 0 && hasError())) {
+            analyzeCommand(block.commands[block.next++]); // pode empilhar um bloco
+        } else {
+            blocks.pop_back();
+        }
+    }
+}
+
+// Empilha os filhos [first, end) de 'node'
+void SemanticAnalyzer::pushBlock(NodeId node, uint32_t first, uint32_t end) {
+    if (first < end) {
+        blocks.push_back({ast->children(node).begin() + first, 0, end - first});
+    }
+}
+
+void SemanticAnalyzer::analyzeCommand(NodeId node) {
+    const ASTNode& command = (*ast)[node];
+    switch (command.type) {
         case NodeType::ATRIBUICAO:
             analyzeAssignment(node);
             break;
-        case NodeType::SE:
-            analyzeIf(node);
+        case NodeType::SE: // blocos entao e senao
+            if (analyzeCondition(node, "se")) {
+                pushBlock(node, 1, command.childCount);
+            }
             break;
-        case NodeType::ENQUANTO:
-            analyzeWhile(node);
+        case NodeType::ENQUANTO: // corpo
+            if (analyzeCondition(node, "enquanto")) {
+                pushBlock(node, 1, std::min<uint32_t>(command.childCount, 2));
+            }
             break;
         case NodeType::LER:
             analyzeRead(node);
@@ -79,163 +106,186 @@ void SemanticAnalyzer::analyzeCommand(ASTNodePtr node) {
         case NodeType::ESCREVER:
             analyzeWrite(node);
             break;
+        case NodeType::LISTA_COMANDOS: // blocos do 'se' e do 'enquanto'
+            pushBlock(node, 0, command.childCount);
+            break;
         default:
             break;
     }
 }
 
-void SemanticAnalyzer::analyzeAssignment(ASTNodePtr node) {
-    if (!node || node->children.size() < 2) return;
+void SemanticAnalyzer::analyzeAssignment(NodeId node) {
+    if ((*ast)[node].childCount < 2) return;
     
-    auto var = node->children[0];
-    auto expr = node->children[1];
-    
-    if (!symbolTable.exists(var->token.value)) {
-        error("Variavel '" + var->token.value + "' nao foi declarada", var->token.line);
-        return;
-    }
-    
-    Symbol* symbol = symbolTable.get(var->token.value);
-    SymbolType exprType = getExpressionType(expr);
-    
-    if (symbol->type != exprType) {
-        error("Tipos incompativeis na atribuicao", var->token.line);
+    NodeId target = ast->child(node, 0);
+    if (checkAssignmentTarget(target)) {
+        checkAssignment(target, getExpressionType(ast->child(node, 1)));
     }
 }
 
-void SemanticAnalyzer::analyzeIf(ASTNodePtr node) {
-    if (!node || node->children.empty()) return;
-    
-    auto condition = node->children[0];
-    SymbolType condType = getExpressionType(condition);
-    
-    if (condType != SymbolType::LOGICO) { 
-        error("Condicao do 'se' deve ser do tipo logico", condition->token.line);
-        return;
+bool SemanticAnalyzer::checkAssignmentTarget(NodeId target) {
+    const Token& var = (*ast)[target].token;
+    if (!symbolTable.exists(var.symbol)) {
+        error("Variavel '" + std::string(var.value) + "' nao foi declarada", var.line);
+        return false;
     }
-    
-    for (size_t i = 1; i < node->children.size(); i++) {
-        analyzeCommand(node->children[i]);
-        if (hasError()) return;
+    return true;
+}
+
+void SemanticAnalyzer::checkAssignment(NodeId target, SymbolType expressionType) {
+    const Token& var = (*ast)[target].token;
+    if (symbolTable.get(var.symbol)->type != expressionType) {
+        error("Tipos incompativeis na atribuicao", var.line);
     }
 }
 
-void SemanticAnalyzer::analyzeWhile(ASTNodePtr node) {
-    if (!node || node->children.empty()) return;
+bool SemanticAnalyzer::analyzeCondition(NodeId node, const char* command) {
+    if ((*ast)[node].childCount == 0) return false;
     
-    auto condition = node->children[0];
-    SymbolType condType = getExpressionType(condition);
-    
-    if (condType != SymbolType::LOGICO) {
-        error("Condicao do 'enquanto' deve ser do tipo logico", condition->token.line);
-        return;
+    NodeId condition = ast->child(node, 0);
+    return checkCondition((*ast)[condition].token.line, getExpressionType(condition), command);
+}
+
+bool SemanticAnalyzer::checkCondition(int line, SymbolType type, const char* command) {
+    if (type != SymbolType::LOGICO) { 
+        error(std::string("Condicao do '") + command + "' deve ser do tipo logico", line);
+        return false;
     }
-    
-    if (node->children.size() > 1) {
-        analyzeCommand(node->children[1]);
-        if (hasError()) return;
+    return true;
+}
+
+void SemanticAnalyzer::analyzeRead(NodeId node) {
+    for (NodeId idNode : ast->children(node)) {
+        checkRead(idNode);
     }
 }
 
-void SemanticAnalyzer::analyzeRead(ASTNodePtr node) {
-    if (!node || node->children.empty()) return;
-    
-    for (auto idNode : node->children) {
-        if (idNode->type == NodeType::IDENTIFICADOR) {
-            std::string varName = idNode->token.value;
-            if (!symbolTable.exists(varName)) {
-                error("Variavel '" + varName + "' nao foi declarada", idNode->token.line);
-            }
+void SemanticAnalyzer::checkRead(NodeId identifier) {
+    const ASTNode& id = (*ast)[identifier];
+    if (id.type == NodeType::IDENTIFICADOR) {
+        if (!symbolTable.exists(id.token.symbol)) {
+            error("Variavel '" + std::string(id.token.value) + "' nao foi declarada", id.token.line);
         }
     }
 }
 
-void SemanticAnalyzer::analyzeWrite(ASTNodePtr node) {
-    if (!node || node->children.empty()) return;
-    
-    for (auto expr : node->children) {
+void SemanticAnalyzer::analyzeWrite(NodeId node) {
+    for (NodeId expr : ast->children(node)) {
         getExpressionType(expr);
         if (hasError()) return;
     }
 }
 
-SymbolType SemanticAnalyzer::getExpressionType(ASTNodePtr node) {
-    if (!node) return SymbolType::INTEIRO;
+SymbolType SemanticAnalyzer::getExpressionType(NodeId root) {
+    return foldExpression(*ast, root, expression, [this](const ASTNode& node, const SymbolType* operands) {
+        return storeType(node, operands ? operatorType(node, operands) : leafType(node));
+    });
+}
 
-    switch (node->type) {
-        case NodeType::NUMERO:
-            return SymbolType::INTEIRO;
-            
+// Grava no nó o tipo calculado: o interpretador escolhe o avaliador por ele
+SymbolType SemanticAnalyzer::storeType(const ASTNode& node, SymbolType type) {
+    ast->nodes[static_cast<size_t>(&node - ast->nodes.data())].valueType = type;
+    return type;
+}
+
+void SemanticAnalyzer::beginSinglePass(AST& tree) {
+    ast = &tree;
+    errorMessage.clear();
+    operandTypes.clear();
+}
+
+// Os nós de uma expressão sao criados em pós-ordem, a mesma de
+// foldExpression: os tipos dos operandos estao sempre no topo da pilha
+bool SemanticAnalyzer::typeExpressionNode(NodeId node) {
+    const ASTNode& expr = (*ast)[node];
+    unsigned errorsBefore = errorCount;
+    uint32_t count = expressionOperands(expr);
+    if (count == 0) {
+        operandTypes.push_back(storeType(expr, leafType(expr)));
+        return errorCount == errorsBefore;
+    }
+    SymbolType* operands = operandTypes.data() + operandTypes.size() - count;
+    SymbolType type = storeType(expr, operatorType(expr, operands));
+    operandTypes.resize(operandTypes.size() - count);
+    operandTypes.push_back(type);
+    return errorCount == errorsBefore;
+}
+
+// Com as declarações completas, o tipo de uma expressão só depende da sua
+// estrutura: um nó compartilhado sem erros tem sempre o mesmo tipo
+void SemanticAnalyzer::reuseExpressionNode(uint32_t operands, SymbolType type) {
+    operandTypes.resize(operandTypes.size() - operands);
+    operandTypes.push_back(type);
+}
+
+SymbolType SemanticAnalyzer::expressionType() const {
+    return operandTypes.empty() ? SymbolType::INTEIRO : operandTypes.back();
+}
+
+SymbolType SemanticAnalyzer::leafType(const ASTNode& node) {
+    switch (node.type) {
         case NodeType::LITERAL:
-            if (node->token.type == TokenType::VERDADEIRO || 
-                node->token.type == TokenType::FALSO) {
+            if (node.token.type == TokenType::VERDADEIRO || 
+                node.token.type == TokenType::FALSO) {
                 return SymbolType::LOGICO;
             }
             return SymbolType::INTEIRO;
             
         case NodeType::IDENTIFICADOR: {
-            std::string varName = node->token.value;
-            if (!symbolTable.exists(varName)) {
-                error("Variavel '" + varName + "' nao foi declarada", node->token.line);
+            Symbol* symbol = symbolTable.get(node.token.symbol);
+            if (!symbol) {
+                error("Variavel '" + std::string(node.token.value) + "' nao foi declarada", node.token.line);
                 return SymbolType::INTEIRO;
             }
-            Symbol* symbol = symbolTable.get(varName);
-            // === REMOÇÃO: A verificação de inicialização foi movida para o interpretador. ===
-            // if (!symbol->initialized) {
-            //     error("Variavel '" + varName + "' nao foi inicializada", node->token.line);
-            // }
-            // ==============================================================================
+            // A inicialização depende do fluxo do programa: ver DefiniteAssignment
             return symbol->type;
         }
         
-        case NodeType::BINARIO: {
-            if (node->children.size() < 2) return SymbolType::INTEIRO;
-            
-            SymbolType leftType = getExpressionType(node->children[0]);
-            SymbolType rightType = getExpressionType(node->children[1]);
-            
-            if (node->token.type == TokenType::IGUAL || 
-                node->token.type == TokenType::DIFERENTE ||
-                node->token.type == TokenType::MENOR ||
-                node->token.type == TokenType::MENOR_IGUAL ||
-                node->token.type == TokenType::MAIOR ||
-                node->token.type == TokenType::MAIOR_IGUAL) {
-                
-                if (leftType != SymbolType::INTEIRO || rightType != SymbolType::INTEIRO) {
-                    error("Operadores relacionais esperam operandos inteiros", node->token.line);
-                }
-                return SymbolType::LOGICO;
-            }
-            
-            if (node->token.type == TokenType::MAIS ||
-                node->token.type == TokenType::MENOS ||
-                node->token.type == TokenType::MULTIPLICACAO ||
-                node->token.type == TokenType::DIVISAO) {
-                
-                if (leftType != SymbolType::INTEIRO || rightType != SymbolType::INTEIRO) {
-                    error("Operadores aritmeticos esperam operandos inteiros", node->token.line);
-                    return SymbolType::INTEIRO;
-                }
+        default: // NUMERO, STRING_LITERAL e operadores sem operandos
+            return SymbolType::INTEIRO;
+    }
+}
+
+SymbolType SemanticAnalyzer::operatorType(const ASTNode& node, const SymbolType* operands) {
+    if (node.type == NodeType::UNARIO) {
+        SymbolType operandType = operands[0];
+        if (node.token.type == TokenType::MENOS) {
+            if (operandType != SymbolType::INTEIRO) {
+                error("Operador unario '-' espera operando inteiro", node.token.line);
                 return SymbolType::INTEIRO;
             }
-            
-            return leftType;
+            return SymbolType::INTEIRO;
         }
+        return operandType;
+    }
+    
+    SymbolType leftType = operands[0];
+    SymbolType rightType = operands[1];
+    
+    if (node.token.type == TokenType::IGUAL || 
+        node.token.type == TokenType::DIFERENTE ||
+        node.token.type == TokenType::MENOR ||
+        node.token.type == TokenType::MENOR_IGUAL ||
+        node.token.type == TokenType::MAIOR ||
+        node.token.type == TokenType::MAIOR_IGUAL) {
         
-        case NodeType::UNARIO: {
-            if (node->children.empty()) return SymbolType::INTEIRO;
-            SymbolType operandType = getExpressionType(node->children[0]);
-            if (node->token.type == TokenType::MENOS) {
-                if (operandType != SymbolType::INTEIRO) {
-                    error("Operador unario '-' espera operando inteiro", node->token.line);
-                    return SymbolType::INTEIRO;
-                }
-                return SymbolType::INTEIRO;
-            }
-            return operandType;
+        if (leftType != SymbolType::INTEIRO || rightType != SymbolType::INTEIRO) {
+            error("Operadores relacionais esperam operandos inteiros", node.token.line);
         }
+        return SymbolType::LOGICO;
+    }
+    
+    if (node.token.type == TokenType::MAIS ||
+        node.token.type == TokenType::MENOS ||
+        node.token.type == TokenType::MULTIPLICACAO ||
+        node.token.type == TokenType::DIVISAO) {
         
-        default:
+        if (leftType != SymbolType::INTEIRO || rightType != SymbolType::INTEIRO) {
+            error("Operadores aritmeticos esperam operandos inteiros", node.token.line);
             return SymbolType::INTEIRO;
+        }
+        return SymbolType::INTEIRO;
     }
-}
\ No newline at end of file
+    
+    return leftType;
+}
@@ -5,28 +5,60 @@
 #include "ast.h"
 #include "symbol_table.h"
 #include <string>
+#include <vector>
 
 class SemanticAnalyzer {
 private:
+    // Sequência de comandos em análise: uma lista, os blocos de um 'se' ou o
+    // corpo de um 'enquanto'
+    struct Block {
+        const NodeId* commands;
+        uint32_t next;
+        uint32_t count;
+    };
+
     SymbolTable& symbolTable;
     std::string errorMessage;
+    unsigned errorCount = 0;
+    AST* ast; // árvore em análise; os nós de expressão recebem o tipo calculado
+    // Pilhas explícitas dos percursos (no lugar da recursão)
+    std::vector<Block> blocks;
+    ExpressionStack<SymbolType> expression;
+    std::vector<SymbolType> operandTypes; // uma passada: tipos já calculados da expressão em construção
     
     void error(const std::string& message, int line = 0);
-    SymbolType getExpressionType(ASTNodePtr node);
-    void analyzeDeclarations(ASTNodePtr node);
-    void analyzeCommands(ASTNodePtr node);
-    void analyzeCommand(ASTNodePtr node);
-    void analyzeAssignment(ASTNodePtr node);
-    void analyzeIf(ASTNodePtr node);
-    void analyzeWhile(ASTNodePtr node);
-    void analyzeRead(ASTNodePtr node);
-    void analyzeWrite(ASTNodePtr node);
+    SymbolType getExpressionType(NodeId node);
+    SymbolType storeType(const ASTNode& node, SymbolType type);
+    SymbolType leafType(const ASTNode& node);
+    SymbolType operatorType(const ASTNode& node, const SymbolType* operands); // operandos da esquerda para a direita
+    void analyzeDeclarations(NodeId node);
+    void analyzeCommands(NodeId node);
+    void analyzeCommand(NodeId node);
+    void pushBlock(NodeId node, uint32_t first, uint32_t end);
+    void analyzeAssignment(NodeId node);
+    bool analyzeCondition(NodeId node, const char* command);
+    void analyzeRead(NodeId node);
+    void analyzeWrite(NodeId node);
     
 public:
     SemanticAnalyzer(SymbolTable& table);
-    bool analyze(ASTNodePtr root);
+    bool analyze(AST& tree);
     bool hasError() const { return !errorMessage.empty(); }
     const std::string& getError() const { return errorMessage; }
+
+    // Análise em uma passada: o Parser chama estes métodos enquanto constrói a
+    // árvore, na mesma ordem em que analyze() visitaria os nós, e as mesmas
+    // regras valem nos dois modos
+    void beginSinglePass(AST& tree);
+    void declareVariables(NodeId listaVar, NodeId tipo);
+    bool checkAssignmentTarget(NodeId target); // false se a variável nao foi declarada
+    void checkAssignment(NodeId target, SymbolType expressionType);
+    bool checkCondition(int line, SymbolType type, const char* command); // linha da raiz da condição
+    void checkRead(NodeId identifier);
+    void beginExpression() { operandTypes.clear(); }
+    bool typeExpressionNode(NodeId node); // nós da expressão em pós-ordem; false se gerou erro
+    void reuseExpressionNode(uint32_t operands, SymbolType type); // nó compartilhado, já verificado
+    SymbolType expressionType() const;
 };
 
 #endif
@@ -0,0 +1,25 @@
+#include "slot_resolver.h"
+
+void SlotResolver::resolve(AST& ast, const SymbolTable& symbols) {
+    types.clear();
+    std::vector<uint32_t> slots; // id do StringPool -> slot
+    for (ASTNode& node : ast.nodes) {
+        if (node.type != NodeType::IDENTIFICADOR) continue;
+
+        uint32_t id = node.token.symbol;
+        const Symbol* symbol = symbols.get(id);
+        if (!symbol) {
+            node.slot = NO_SLOT; // nunca acontece num programa verificado
+            continue;
+        }
+        if (id >= slots.size()) {
+            slots.resize(id + 1, NO_SLOT);
+        }
+        // As declarações vêm antes dos comandos: os slots seguem a ordem delas
+        if (slots[id] == NO_SLOT) {
+            slots[id] = static_cast<uint32_t>(types.size());
+            types.push_back(symbol->type);
+        }
+        node.slot = slots[id];
+    }
+}
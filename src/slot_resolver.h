@@ -0,0 +1,22 @@
+#ifndef SLOT_RESOLVER_H
+#define SLOT_RESOLVER_H
+
+#include "ast.h"
+#include "symbol_table.h"
+#include <vector>
+
+// Resolução das variáveis antes da execução: cada variável declarada recebe
+// um slot (índice denso, na ordem de declaração) e cada nó IDENTIFICADOR que
+// a referencia é anotado com ele. O interpretador lê e grava um vetor de
+// valores indexado pelo slot, sem consultar a tabela de símbolos.
+class SlotResolver {
+private:
+    std::vector<SymbolType> types; // tipo de cada slot
+
+public:
+    // A AST já passou pela análise semântica (ou veio do cache)
+    void resolve(AST& ast, const SymbolTable& symbols);
+    const std::vector<SymbolType>& slotTypes() const { return types; }
+};
+
+#endif
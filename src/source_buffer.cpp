@@ -0,0 +1,118 @@
+#include "source_buffer.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+SourceBuffer::SourceBuffer()
+    : data(nullptr), size(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {}
+
+void SourceBuffer::release() {
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != INVALID_HANDLE_VALUE) {
+        CloseHandle(fileHandle);
+    }
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+}
+
+bool SourceBuffer::open(const std::string& filename) {
+    release();
+
+    fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+        release();
+        return false;
+    }
+    if (fileSize.QuadPart == 0) {
+        // Arquivo vazio: nao ha o que mapear
+        return true;
+    }
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        release();
+        return false;
+    }
+
+    data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        release();
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    return true;
+}
+
+#else
+
+SourceBuffer::SourceBuffer() : data(nullptr), size(0), fd(-1) {}
+
+void SourceBuffer::release() {
+    if (data) {
+        munmap(const_cast<char*>(data), size);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    data = nullptr;
+    size = 0;
+    fd = -1;
+}
+
+bool SourceBuffer::open(const std::string& filename) {
+    release();
+
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        release();
+        return false;
+    }
+    if (info.st_size == 0) {
+        // Arquivo vazio: mmap nao aceita tamanho zero
+        return true;
+    }
+
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        release();
+        return false;
+    }
+    // A leitura do lexer é sequencial
+    madvise(mapped, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+    data = static_cast<const char*>(mapped);
+    size = static_cast<size_t>(info.st_size);
+    return true;
+}
+
+#endif
+
+SourceBuffer::~SourceBuffer() {
+    release();
+}
@@ -0,0 +1,35 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Buffer somente-leitura com o conteúdo de um arquivo fonte, mapeado em memória.
+// Os tokens guardam std::string_view apontando para este buffer, então ele deve
+// viver durante toda a compilação (análise, AST e execução).
+class SourceBuffer {
+private:
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fd;
+#endif
+
+    void release();
+
+public:
+    SourceBuffer();
+    ~SourceBuffer();
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    bool open(const std::string& filename);
+    std::string_view view() const { return std::string_view(data, size); }
+    bool empty() const { return size == 0; }
+};
+
+#endif
@@ -0,0 +1,331 @@
+#include "streaming_lexer.h"
+#include "keywords.h"
+#include "operators.h"
+#include "utf8.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+std::string_view StringArena::store(std::string_view text) {
+    if (text.empty()) {
+        return std::string_view();
+    }
+    if (text.size() > BLOCK_SIZE - used) {
+        // Textos maiores que um bloco ganham um bloco só para eles
+        size_t size = std::max(BLOCK_SIZE, text.size());
+        blocks.emplace_back(new char[size]);
+        used = 0;
+        if (size > BLOCK_SIZE) {
+            std::memcpy(blocks.back().get(), text.data(), text.size());
+            used = BLOCK_SIZE; // o próximo texto abre outro bloco
+            return std::string_view(blocks.back().get(), text.size());
+        }
+    }
+    char* destination = blocks.back().get() + used;
+    std::memcpy(destination, text.data(), text.size());
+    used += text.size();
+    return std::string_view(destination, text.size());
+}
+
+// Texto de tokens de um único caractere inválido, sem depender da janela
+static std::string_view singleCharText(char c) {
+    static const std::array<char, 256> chars = [] {
+        std::array<char, 256> table{};
+        for (size_t i = 0; i < table.size(); i++) {
+            table[i] = static_cast<char>(i);
+        }
+        return table;
+    }();
+    return std::string_view(&chars[static_cast<unsigned char>(c)], 1);
+}
+
+int openSourceFile(const std::string& filename) {
+#ifdef _WIN32
+    return _open(filename.c_str(), _O_RDONLY | _O_BINARY);
+#else
+    return ::open(filename.c_str(), O_RDONLY);
+#endif
+}
+
+void closeSourceFile(int fd) {
+    if (fd < 0) return;
+#ifdef _WIN32
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+StreamingLexer::StreamingLexer(int fd, StringPool& pool, size_t windowSize, bool retainText)
+    : fd(fd), window(std::max<size_t>(windowSize, 16)), begin(0), end(0), windowOffset(0),
+      eof(false), line(1), lineStart(0), columnSkew(0),
+      kernels(scanKernels(ScanEngine::AUTOMATICO)), pool(pool), retainText(retainText), stalled(false) {}
+
+// Descarta o que já foi consumido, move o restante para o início da janela e
+// lê mais dados do arquivo. Devolve false se nada novo pôde ser lido.
+bool StreamingLexer::refill() {
+    if (eof) {
+        return false;
+    }
+
+    size_t remaining = end - begin;
+    if (begin > 0) {
+        std::memmove(window.data(), window.data() + begin, remaining);
+        windowOffset += begin;
+        begin = 0;
+        end = remaining;
+    }
+
+    while (end < window.size()) {
+#ifdef _WIN32
+        int count = _read(fd, window.data() + end, static_cast<unsigned>(window.size() - end));
+#else
+        ssize_t count = ::read(fd, window.data() + end, window.size() - end);
+#endif
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            eof = true;
+            break;
+        }
+        end += static_cast<size_t>(count);
+        return true;
+    }
+    return end > remaining;
+}
+
+char StreamingLexer::currentChar() {
+    if (begin >= end && !refill()) {
+        return '\0';
+    }
+    return window[begin];
+}
+
+void StreamingLexer::advance() {
+    if (begin >= end && !refill()) {
+        return;
+    }
+    if (window[begin] == '\n') {
+        line++;
+        lineStart = windowOffset + begin + 1;
+        columnSkew = 0;
+    }
+    begin++;
+}
+
+bool StreamingLexer::empty() {
+    return begin >= end && !refill();
+}
+
+void StreamingLexer::consumeLines(const LineTracker& lines) {
+    if (lines.newlines > 0) {
+        columnSkew = 0;
+        line += lines.newlines;
+        lineStart = windowOffset + static_cast<unsigned long long>(lines.lineStart - window.data());
+    }
+}
+
+// Como no Lexer: desconta da coluna os bytes de continuação de [from, to),
+// trecho da janela, que pertencem à linha corrente
+void StreamingLexer::countContinuations(const char* from, const char* to) {
+    if (lineStart > windowOffset) {
+        from = std::max<const char*>(from, window.data() + (lineStart - windowOffset));
+    }
+    if (from < to) {
+        columnSkew += countContinuationBytes(from, static_cast<size_t>(to - from));
+    }
+}
+
+// Aplica 'scan' a partir da posição corrente, reabastecendo a janela enquanto
+// o trecho chegar até a borda. Se o trecho atravessar a borda, seu texto é
+// montado em 'spill'; senão, a visão aponta para a própria janela (válida até
+// o próximo reabastecimento). O scan liga 'stalled' quando para em um
+// caractere UTF-8 incompleto na borda: a janela é reabastecida e ele continua.
+template <typename Scan>
+std::string_view StreamingLexer::scanRun(Scan scan) {
+    bool spilled = false;
+    size_t start = begin;
+
+    while (true) {
+        stalled = false;
+        begin += scan(window.data() + begin, end - begin);
+        if (begin < end && !stalled) {
+            break;
+        }
+        if (!spilled) {
+            spill.clear();
+            spilled = true;
+        }
+        spill.append(window.data() + start, begin - start);
+        bool more = refill();
+        start = begin;
+        if (!more) {
+            break;
+        }
+    }
+
+    if (!spilled) {
+        return std::string_view(window.data() + start, begin - start);
+    }
+    spill.append(window.data() + start, begin - start);
+    return spill;
+}
+
+std::string_view StreamingLexer::keep(std::string_view text) {
+    return retainText ? arena.store(text) : text;
+}
+
+void StreamingLexer::skipWhitespace() {
+    do {
+        LineTracker lines = {0, nullptr};
+        begin += kernels.skipWhitespace(window.data() + begin, end - begin, lines);
+        consumeLines(lines);
+        if (begin < end) {
+            return;
+        }
+    } while (refill());
+}
+
+void StreamingLexer::skipComment() {
+    if (currentChar() != '{') {
+        return;
+    }
+    advance(); // Consome '{'
+    do {
+        LineTracker lines = {0, nullptr};
+        const char* start = window.data() + begin;
+        begin += kernels.findDelimiter(window.data() + begin, end - begin, '}', lines);
+        consumeLines(lines);
+        countContinuations(start, window.data() + begin);
+        if (begin < end) {
+            break;
+        }
+    } while (refill());
+
+    if (currentChar() == '}') {
+        advance(); // Consome '}'
+    }
+}
+
+Token StreamingLexer::readNumber() {
+    int startColumn = column();
+    std::string_view number = scanRun([this](const char* p, size_t n) {
+        return kernels.digitLength(p, n);
+    });
+    return Token(TokenType::NUMERO, keep(number), line, startColumn);
+}
+
+Token StreamingLexer::readString() {
+    int startColumn = column();
+    advance(); // Consome a aspa de abertura
+
+    std::string_view str = scanRun([this](const char* p, size_t n) {
+        LineTracker lines = {0, nullptr};
+        size_t length = kernels.findDelimiter(p, n, '\'', lines);
+        consumeLines(lines);
+        countContinuations(p, p + length);
+        return length;
+    });
+    str = keep(str);
+
+    if (currentChar() != '\'') {
+        return Token(TokenType::ERRO, str, line, startColumn);
+    }
+    advance();
+    return Token(TokenType::STRING, str, line, startColumn);
+}
+
+Token StreamingLexer::readIdentifier() {
+    int startColumn = column();
+    std::string_view identifier = scanRun([this](const char* p, size_t n) {
+        size_t length = kernels.identifierLength(p, n);
+        while (length < n && !isAsciiByte(p[length])) {
+            size_t charLength = utf8IdentifierCharLength(p + length, n - length, true);
+            if (charLength == 0) {
+                stalled = n - length < utf8SequenceLength(p[length]);
+                break;
+            }
+            length += charLength;
+            columnSkew += charLength - 1;
+            length += kernels.identifierLength(p + length, n - length);
+        }
+        return length;
+    });
+
+    TokenType type = lookupKeyword(identifier);
+    // O texto é a grafia da fonte, como no Lexer; do pool só vem o id
+    if (type != TokenType::IDENTIFICADOR) {
+        return Token(type, keep(identifier), line, startColumn);
+    }
+    uint32_t symbol = pool.intern(identifier);
+    return Token(type, keep(identifier), line, startColumn, symbol);
+}
+
+Token StreamingLexer::readInvalidChar() {
+    int startColumn = column();
+    uint32_t codePoint = 0;
+    size_t length = std::max<size_t>(1, decodeUtf8(window.data() + begin, end - begin, codePoint));
+    std::string_view text(window.data() + begin, length);
+    begin += length;
+    columnSkew += length - 1;
+    return Token(TokenType::ERRO, length == 1 ? singleCharText(text[0]) : keep(text), line, startColumn);
+}
+
+Token StreamingLexer::nextToken() {
+    // Pula espaços e comentários até um caractere significativo
+    while (true) {
+        skipWhitespace();
+        if (currentChar() == '\0') {
+            return Token(TokenType::FIM_ARQUIVO, "", line, column());
+        }
+        if (currentChar() != '{') {
+            break;
+        }
+        skipComment();
+    }
+
+    int currentLine = line;
+    int currentColumn = column();
+    char c = currentChar();
+
+    if (hasCharClass(c, CC_LETRA | CC_SUBLINHADO)) {
+        return readIdentifier();
+    }
+    if (!isAsciiByte(c)) {
+        // A sequência UTF-8 inteira precisa estar na janela
+        if (end - begin < 4) {
+            refill();
+        }
+        if (utf8IdentifierCharLength(window.data() + begin, end - begin, false) > 0) {
+            return readIdentifier();
+        }
+        return readInvalidChar();
+    }
+    if (hasCharClass(c, CC_DIGITO)) {
+        return readNumber();
+    }
+    if (c == '\'') {
+        return readString();
+    }
+
+    // O operador pode terminar no primeiro byte do próximo bloco
+    if (end - begin < 2) {
+        refill();
+    }
+    OperatorToken op = scanOperator(c, end - begin >= 2 ? window[begin + 1] : '\0');
+    if (op.type == TokenType::ERRO) {
+        advance();
+        return Token(TokenType::ERRO, singleCharText(c), currentLine, currentColumn);
+    }
+    begin += op.text.size(); // nenhum operador contém quebra de linha
+    return Token(op.type, op.text, currentLine, currentColumn);
+}
@@ -0,0 +1,83 @@
+#ifndef STREAMING_LEXER_H
+#define STREAMING_LEXER_H
+
+#include "token.h"
+#include "token_stream.h"
+#include "lexer_kernels.h"
+#include "string_pool.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Área de armazenamento só de acréscimo: guarda o texto dos tokens que
+// precisam sobreviver à janela do StreamingLexer.
+class StringArena {
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t used = BLOCK_SIZE;
+
+public:
+    std::string_view store(std::string_view text);
+};
+
+// Lexer que lê a fonte de um descritor de arquivo através de uma janela de
+// tamanho fixo, reabastecida sob demanda: a fonte nunca fica inteira na
+// memória. Produz os mesmos tokens (tipo, texto, linha e coluna) que o Lexer.
+//
+// Identificadores sao internados no StringPool, que dá o id do token. Com
+// retainText, o texto de identificadores, números e strings é copiado para
+// uma arena e continua válido enquanto o lexer existir, como exige a AST.
+// Sem retainText, esse texto só vale até a próxima chamada de nextToken e a
+// memória do lexer nao depende do tamanho da entrada.
+class StreamingLexer : public TokenStream {
+public:
+    static constexpr size_t DEFAULT_WINDOW_SIZE = 64 * 1024;
+
+private:
+    int fd;
+    std::vector<char> window;
+    size_t begin;             // próximo byte a ser lido na janela
+    size_t end;               // fim dos dados válidos na janela
+    unsigned long long windowOffset; // posição, no arquivo, do início da janela
+    bool eof;
+    int line;
+    unsigned long long lineStart; // posição, no arquivo, do início da linha corrente
+    size_t columnSkew; // bytes de continuação UTF-8 já consumidos na linha corrente
+    const ScanKernels& kernels;
+    StringPool& pool;
+
+    bool retainText;
+    StringArena arena;
+    std::string spill; // tokens que atravessam a borda da janela
+    bool stalled;      // o scan de scanRun parou em um caractere cortado pela borda
+
+    bool refill();
+    char currentChar();
+    void advance();
+    int column() const { return static_cast<int>(windowOffset + begin - lineStart - columnSkew) + 1; }
+    void countContinuations(const char* from, const char* to);
+    void consumeLines(const LineTracker& lines);
+    template <typename Scan> std::string_view scanRun(Scan scan);
+    std::string_view keep(std::string_view text);
+    void skipWhitespace();
+    void skipComment();
+    Token readNumber();
+    Token readString();
+    Token readIdentifier();
+    Token readInvalidChar();
+
+public:
+    // O descritor nao é fechado pelo lexer
+    StreamingLexer(int fd, StringPool& pool, size_t windowSize = DEFAULT_WINDOW_SIZE, bool retainText = true);
+    Token nextToken() override;
+    // True se a fonte nao tem nenhum byte; só lê o primeiro bloco
+    bool empty();
+};
+
+// Abertura do arquivo fonte como descritor (-1 em caso de falha)
+int openSourceFile(const std::string& filename);
+void closeSourceFile(int fd);
+
+#endif
@@ -0,0 +1,71 @@
+#include "string_pool.h"
+#include "keywords.h"
+
+// Minúscula de text[i]. Além do ASCII, as maiúsculas acentuadas do latim-1
+// (U+00C0-U+00DE, exceto o sinal de multiplicação) sao dobradas: em UTF-8
+// elas sao 0xC3 0x80-0x9E e a minúscula fica 0x20 adiante no segundo byte.
+static inline char foldedByte(std::string_view text, size_t i) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    if (c < 0x80) {
+        return toLowerAscii(text[i]);
+    }
+    if (i > 0 && static_cast<unsigned char>(text[i - 1]) == 0xC3 && c <= 0x9E && c != 0x97) {
+        return static_cast<char>(c + 0x20);
+    }
+    return text[i];
+}
+
+size_t StringPool::CaseInsensitiveHash::operator()(std::string_view text) const {
+    // FNV-1a sobre os caracteres em minúsculas
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < text.size(); i++) {
+        hash ^= static_cast<unsigned char>(foldedByte(text, i));
+        hash *= 1099511628211ull;
+    }
+    return static_cast<size_t>(hash);
+}
+
+bool StringPool::CaseInsensitiveEqual::operator()(std::string_view a, std::string_view b) const {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); i++) {
+        if (foldedByte(a, i) != foldedByte(b, i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::unique_lock<std::mutex> StringPool::lock() const {
+    return shared ? std::unique_lock<std::mutex>(mutex) : std::unique_lock<std::mutex>();
+}
+
+uint32_t StringPool::intern(std::string_view name) {
+    std::unique_lock<std::mutex> guard = lock();
+
+    auto it = ids.find(name);
+    if (it != ids.end()) {
+        return it->second;
+    }
+
+    std::string lowered(name);
+    for (size_t i = 0; i < lowered.size(); i++) {
+        lowered[i] = foldedByte(name, i);
+    }
+    names.push_back(std::move(lowered));
+
+    uint32_t id = static_cast<uint32_t>(names.size() - 1);
+    ids.emplace(names.back(), id);
+    return id;
+}
+
+std::string_view StringPool::name(uint32_t id) const {
+    std::unique_lock<std::mutex> guard = lock();
+    return names[id];
+}
+
+size_t StringPool::size() const {
+    std::unique_lock<std::mutex> guard = lock();
+    return names.size();
+}
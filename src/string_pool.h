@@ -0,0 +1,43 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Pool de identificadores: cada nome distinto (sem diferenciar maiúsculas)
+// recebe um id denso, atribuído pelo lexer. Daí em diante as fases comparam e
+// indexam variáveis pelo id, sem voltar a calcular hash de strings.
+//
+// Cada compilação tem o seu pool, entao os ids começam em 0 e a tabela de
+// símbolos só cresce até o número de nomes do programa. O pool só usa o
+// mutex se for criado como compartilhado (front end em pipeline, em que o
+// lexer interna os nomes em outra thread).
+class StringPool {
+private:
+    struct CaseInsensitiveHash {
+        size_t operator()(std::string_view text) const;
+    };
+    struct CaseInsensitiveEqual {
+        bool operator()(std::string_view a, std::string_view b) const;
+    };
+
+    bool shared;
+    mutable std::mutex mutex;
+    std::deque<std::string> names; // grafia em minúsculas; referências estáveis
+    std::unordered_map<std::string_view, uint32_t, CaseInsensitiveHash, CaseInsensitiveEqual> ids;
+
+    std::unique_lock<std::mutex> lock() const;
+
+public:
+    explicit StringPool(bool shared = false) : shared(shared) {}
+
+    uint32_t intern(std::string_view name);
+    std::string_view name(uint32_t id) const;
+    size_t size() const;
+};
+
+#endif
@@ -1,30 +1,38 @@
 
 #include "symbol_table.h"
 
-bool SymbolTable::declare(const std::string& name, SymbolType type) {
-    if (exists(name)) {
+bool SymbolTable::declare(uint32_t id, SymbolType type) {
+    if (exists(id)) {
         return false; // Já declarada
     }
-    symbols[name] = Symbol(type);
+    if (id >= symbols.size()) {
+        symbols.resize(id + 1);
+    }
+    symbols[id] = Symbol(type);
+    symbols[id].declared = true;
     return true;
 }
 
-bool SymbolTable::exists(const std::string& name) const {
-    return symbols.find(name) != symbols.end();
+bool SymbolTable::exists(uint32_t id) const {
+    return id < symbols.size() && symbols[id].declared;
 }
 
-bool SymbolTable::assign(const std::string& name, const std::variant<int, bool>& value) {
-    if (!exists(name)) {
+bool SymbolTable::assign(uint32_t id, const std::variant<int, bool>& value) {
+    Symbol* symbol = get(id);
+    if (!symbol) {
         return false;
     }
-    symbols[name].value = value;
-    symbols[name].initialized = true;
+    symbol->value = value;
+    symbol->initialized = true;
     return true;
 }
 
-Symbol* SymbolTable::get(const std::string& name) {
-    auto it = symbols.find(name);
-    return (it != symbols.end()) ? &it->second : nullptr;
+Symbol* SymbolTable::get(uint32_t id) {
+    return exists(id) ? &symbols[id] : nullptr;
+}
+
+const Symbol* SymbolTable::get(uint32_t id) const {
+    return exists(id) ? &symbols[id] : nullptr;
 }
 
 void SymbolTable::clear() {
@@ -1,12 +1,11 @@
-
 #ifndef SYMBOL_TABLE_H
 #define SYMBOL_TABLE_H
 
-#include <unordered_map>
-#include <string>
+#include <cstdint>
 #include <variant>
+#include <vector>
 
-enum class SymbolType {
+enum class SymbolType : uint8_t {
     INTEIRO,
     LOGICO
 };
@@ -15,20 +14,24 @@ struct Symbol {
     SymbolType type;
     std::variant<int, bool> value;
     bool initialized;
+    bool declared;
     
     Symbol(SymbolType t = SymbolType::INTEIRO) 
-        : type(t), value(0), initialized(false) {}
+        : type(t), value(0), initialized(false), declared(false) {}
 };
 
+// Símbolos indexados pelo id do identificador no StringPool (Token::symbol):
+// as consultas sao acessos a vetor, sem hash nem comparação de strings.
 class SymbolTable {
 private:
-    std::unordered_map<std::string, Symbol> symbols;
+    std::vector<Symbol> symbols;
     
 public:
-    bool declare(const std::string& name, SymbolType type);
-    bool exists(const std::string& name) const;
-    bool assign(const std::string& name, const std::variant<int, bool>& value);
-    Symbol* get(const std::string& name);
+    bool declare(uint32_t id, SymbolType type);
+    bool exists(uint32_t id) const;
+    bool assign(uint32_t id, const std::variant<int, bool>& value);
+    Symbol* get(uint32_t id);
+    const Symbol* get(uint32_t id) const;
     void clear();
 };
 
@@ -3,7 +3,9 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 enum class TokenType {
     // Palavras reservadas
@@ -31,14 +33,22 @@ enum class TokenType {
     FIM_ARQUIVO, ERRO, COMENTARIO
 };
 
+// Id de símbolo dos tokens que nao sao identificadores
+constexpr uint32_t NO_SYMBOL = UINT32_MAX;
+
+// O texto do token referencia o buffer do código fonte (ou uma literal estática
+// para operadores e delimitadores), sem alocação por token. Identificadores
+// trazem também o id do nome no StringPool.
 struct Token {
+    std::string_view value; // primeiro campo: evita preenchimento (32 bytes no total)
     TokenType type;
-    std::string value;
     int line;
     int column;
+    uint32_t symbol;
     
-    Token(TokenType t = TokenType::ERRO, const std::string& v = "", int l = 1, int c = 1)
-        : type(t), value(v), line(l), column(c) {}
+    Token(TokenType t = TokenType::ERRO, std::string_view v = std::string_view(), int l = 1, int c = 1,
+          uint32_t s = NO_SYMBOL)
+        : value(v), type(t), line(l), column(c), symbol(s) {}
 };
 
 std::string tokenTypeToString(TokenType type);
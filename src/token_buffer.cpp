@@ -0,0 +1,170 @@
+#include "token_buffer.h"
+#include "lexer.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+// Trechos menores que isso nao compensam uma thread
+static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+// Posição do próximo 'c' a partir de 'from', ou input.size()
+static size_t findChar(std::string_view input, size_t from, char c) {
+    if (from >= input.size()) return input.size();
+    const void* found = std::memchr(input.data() + from, c, input.size() - from);
+    return found ? static_cast<size_t>(static_cast<const char*>(found) - input.data()) : input.size();
+}
+
+// Escolhe os inícios dos trechos: sempre logo após um '\n' que esteja fora de
+// strings e comentários, de modo que cada trecho comece em um token novo, na
+// coluna 1. Strings e comentários sao saltados inteiros (a busca pelos
+// delimitadores usa memchr), o que é bem mais barato que tokenizar.
+static std::vector<size_t> findChunkStarts(std::string_view input, size_t parts) {
+    std::vector<size_t> starts = {0};
+    size_t pos = 0;
+    size_t nextBrace = findChar(input, 0, '{');
+    size_t nextQuote = findChar(input, 0, '\'');
+
+    for (size_t k = 1; k < parts; k++) {
+        size_t target = std::max(pos, input.size() / parts * k);
+
+        while (true) {
+            size_t newline = findChar(input, target, '\n');
+            if (nextBrace < pos) nextBrace = findChar(input, pos, '{');
+            if (nextQuote < pos) nextQuote = findChar(input, pos, '\'');
+            size_t open = std::min(nextBrace, nextQuote);
+
+            if (open < newline) {
+                // Salta o comentário ou a string inteira
+                size_t close = findChar(input, open + 1, open == nextBrace ? '}' : '\'');
+                if (close >= input.size()) {
+                    return starts; // Nao fechado: o resto fica em um único trecho
+                }
+                pos = close + 1;
+                target = std::max(target, pos);
+                continue;
+            }
+
+            if (newline + 1 >= input.size()) {
+                return starts;
+            }
+            pos = newline + 1;
+            starts.push_back(pos);
+            break;
+        }
+    }
+    return starts;
+}
+
+void TokenBuffer::lexChunk(std::string_view chunk, StringPool& pool) {
+    size_t estimate = chunk.size() / 4 + 1;
+    types.reserve(estimate);
+    texts.reserve(estimate);
+    lengths.reserve(estimate);
+    lines.reserve(estimate);
+    columns.reserve(estimate);
+    symbols.reserve(estimate);
+
+    Lexer lexer(chunk, pool);
+    Token token;
+    do {
+        token = lexer.nextToken();
+        types.push_back(token.type);
+        texts.push_back(token.value.data());
+        lengths.push_back(static_cast<uint32_t>(token.value.size()));
+        lines.push_back(token.line);
+        columns.push_back(token.column);
+        symbols.push_back(token.symbol);
+    } while (token.type != TokenType::FIM_ARQUIVO);
+}
+
+void TokenBuffer::append(const TokenBuffer& part, int lineOffset, const std::vector<uint32_t>& symbolMap) {
+    // O FIM_ARQUIVO do trecho anterior é substituído pelos tokens deste
+    if (!types.empty()) {
+        types.pop_back();
+        texts.pop_back();
+        lengths.pop_back();
+        lines.pop_back();
+        columns.pop_back();
+        symbols.pop_back();
+    }
+
+    types.insert(types.end(), part.types.begin(), part.types.end());
+    texts.insert(texts.end(), part.texts.begin(), part.texts.end());
+    lengths.insert(lengths.end(), part.lengths.begin(), part.lengths.end());
+    columns.insert(columns.end(), part.columns.begin(), part.columns.end());
+    size_t first = lines.size();
+    lines.insert(lines.end(), part.lines.begin(), part.lines.end());
+    for (size_t i = first; i < lines.size(); i++) {
+        lines[i] += lineOffset;
+    }
+    for (uint32_t symbol : part.symbols) {
+        symbols.push_back(symbol == NO_SYMBOL ? NO_SYMBOL : symbolMap[symbol]);
+    }
+}
+
+void TokenBuffer::tokenize(std::string_view input, StringPool& pool, unsigned threads) {
+    types.clear();
+    texts.clear();
+    lengths.clear();
+    lines.clear();
+    columns.clear();
+    symbols.clear();
+
+    // O lexer trata '\0' como fim de arquivo; nenhum trecho pode passar dele
+    input = input.substr(0, findChar(input, 0, '\0'));
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t parts = std::min<size_t>(threads, std::max<size_t>(1, input.size() / MIN_CHUNK_SIZE));
+    std::vector<size_t> starts = findChunkStarts(input, parts);
+
+    if (starts.size() == 1) {
+        lexChunk(input, pool);
+        return;
+    }
+
+    std::vector<TokenBuffer> results(starts.size());
+    std::unique_ptr<StringPool[]> pools(new StringPool[starts.size()]);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < starts.size(); i++) {
+        size_t end = (i + 1 < starts.size()) ? starts[i + 1] : input.size();
+        std::string_view chunk = input.substr(starts[i], end - starts[i]);
+        StringPool& chunkPool = pools[i];
+        workers.emplace_back([&results, &chunkPool, i, chunk]() { results[i].lexChunk(chunk, chunkPool); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    size_t total = 0;
+    for (const auto& part : results) {
+        total += part.size();
+    }
+    types.reserve(total);
+    texts.reserve(total);
+    lengths.reserve(total);
+    lines.reserve(total);
+    columns.reserve(total);
+    symbols.reserve(total);
+
+    // Cada trecho foi numerado a partir da linha 1: o FIM_ARQUIVO do trecho
+    // diz quantas linhas ele ocupou
+    int lineOffset = 0;
+    for (size_t i = 0; i < results.size(); i++) {
+        std::vector<uint32_t> symbolMap(pools[i].size());
+        for (uint32_t local = 0; local < symbolMap.size(); local++) {
+            symbolMap[local] = pool.intern(pools[i].name(local));
+        }
+        append(results[i], lineOffset, symbolMap);
+        lineOffset += results[i].lines.back() - 1;
+    }
+}
+
+Token TokenBufferStream::nextToken() {
+    if (index + 1 < buffer.size()) {
+        return buffer.at(index++);
+    }
+    return buffer.at(buffer.size() - 1); // FIM_ARQUIVO, repetido se pedido de novo
+}
@@ -0,0 +1,56 @@
+#ifndef TOKEN_BUFFER_H
+#define TOKEN_BUFFER_H
+
+#include "token.h"
+#include "token_stream.h"
+#include "string_pool.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Todos os tokens de um arquivo, pré-tokenizados, em estrutura de arrays:
+// cada campo do token fica em um vetor contíguo próprio. O texto nao é
+// copiado: guardamos ponteiro/tamanho para o buffer fonte (ou para a literal
+// estática dos operadores), que deve sobreviver ao TokenBuffer.
+class TokenBuffer {
+private:
+    std::vector<TokenType> types;
+    std::vector<const char*> texts;
+    std::vector<uint32_t> lengths;
+    std::vector<int> lines;
+    std::vector<int> columns;
+    std::vector<uint32_t> symbols;
+
+    void lexChunk(std::string_view chunk, StringPool& pool);
+    void append(const TokenBuffer& part, int lineOffset, const std::vector<uint32_t>& symbolMap);
+
+public:
+    TokenBuffer() = default;
+
+    // Divide a fonte em trechos que começam no início de uma linha fora de
+    // strings e comentários, tokeniza cada trecho em uma thread e junta os
+    // resultados. threads == 0 usa todos os núcleos. Cada thread interna os
+    // identificadores em um pool próprio; os ids sao trocados pelos de 'pool'
+    // na junção, depois que as threads terminaram (sem concorrência no pool).
+    void tokenize(std::string_view input, StringPool& pool, unsigned threads = 0);
+
+    size_t size() const { return types.size(); }
+    Token at(size_t index) const {
+        return Token(types[index], std::string_view(texts[index], lengths[index]),
+                     lines[index], columns[index], symbols[index]);
+    }
+};
+
+// Leitura sequencial de um TokenBuffer pelo parser, por índice
+class TokenBufferStream : public TokenStream {
+private:
+    const TokenBuffer& buffer;
+    size_t index;
+
+public:
+    explicit TokenBufferStream(const TokenBuffer& buffer) : buffer(buffer), index(0) {}
+    Token nextToken() override;
+    size_t sizeHint() const override { return buffer.size() - index; }
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "token_pipeline.h"
+
+PipelinedTokenStream::PipelinedTokenStream(TokenStream& source)
+    : source(source), ring(new Batch[RING_SIZE]), produced(0), consumed(0), stopping(false),
+      current(nullptr), index(0), finished(false), hint(source.sizeHint()) {
+    producer = std::thread(&PipelinedTokenStream::produce, this);
+}
+
+PipelinedTokenStream::~PipelinedTokenStream() {
+    // O parser pode parar antes do fim (erro sintático): libera o produtor
+    stopping.store(true, std::memory_order_relaxed);
+    producer.join();
+}
+
+void PipelinedTokenStream::produce() {
+    size_t slot = 0;
+    bool done = false;
+
+    while (!done) {
+        // Espera um lote livre na fila
+        while (slot - consumed.load(std::memory_order_acquire) >= RING_SIZE) {
+            if (stopping.load(std::memory_order_relaxed)) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        Batch& batch = ring[slot % RING_SIZE];
+        size_t count = 0;
+        while (count < BATCH_SIZE) {
+            batch.tokens[count] = source.nextToken();
+            if (batch.tokens[count++].type == TokenType::FIM_ARQUIVO) {
+                done = true;
+                break;
+            }
+        }
+        batch.count = count;
+
+        produced.store(++slot, std::memory_order_release);
+    }
+}
+
+Token PipelinedTokenStream::nextToken() {
+    if (finished) {
+        return endToken; // FIM_ARQUIVO, repetido se pedido de novo
+    }
+
+    if (!current || index == current->count) {
+        if (current) {
+            consumed.fetch_add(1, std::memory_order_release); // devolve o lote ao produtor
+        }
+        size_t next = consumed.load(std::memory_order_relaxed);
+        while (produced.load(std::memory_order_acquire) == next) {
+            std::this_thread::yield();
+        }
+        current = &ring[next % RING_SIZE];
+        index = 0;
+    }
+
+    const Token& token = current->tokens[index++];
+    if (token.type == TokenType::FIM_ARQUIVO) {
+        endToken = token;
+        finished = true;
+    }
+    return token;
+}
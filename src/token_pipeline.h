@@ -0,0 +1,56 @@
+#ifndef TOKEN_PIPELINE_H
+#define TOKEN_PIPELINE_H
+
+#include "token.h"
+#include "token_stream.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+
+// Front end em pipeline: uma thread produtora lê os tokens de 'source' (em
+// geral um Lexer) e os entrega em lotes por uma fila circular sem locks de um
+// produtor e um consumidor (o parser). A sequência de tokens é a mesma do
+// modo serial, então a AST também é.
+class PipelinedTokenStream : public TokenStream {
+public:
+    static constexpr size_t BATCH_SIZE = 256;  // tokens por lote
+    static constexpr size_t RING_SIZE = 64;    // lotes na fila
+
+private:
+    struct Batch {
+        std::array<Token, BATCH_SIZE> tokens;
+        size_t count = 0;
+    };
+
+    TokenStream& source;
+    std::unique_ptr<Batch[]> ring;
+    // Contadores de lotes publicados (produtor) e liberados (consumidor);
+    // ficam em linhas de cache separadas para evitar falso compartilhamento
+    alignas(64) std::atomic<size_t> produced;
+    alignas(64) std::atomic<size_t> consumed;
+    alignas(64) std::atomic<bool> stopping;
+
+    // Estado do consumidor
+    const Batch* current;
+    size_t index;
+    Token endToken;
+    bool finished;
+    size_t hint; // da fonte, lida antes de o produtor começar
+
+    std::thread producer;
+
+    void produce();
+
+public:
+    explicit PipelinedTokenStream(TokenStream& source);
+    ~PipelinedTokenStream() override;
+    PipelinedTokenStream(const PipelinedTokenStream&) = delete;
+    PipelinedTokenStream& operator=(const PipelinedTokenStream&) = delete;
+
+    Token nextToken() override;
+    size_t sizeHint() const override { return hint; }
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include "token.h"
+#include <cstddef>
+
+// Fonte de tokens consumida pelo parser. O Lexer produz tokens sob demanda;
+// outras implementações entregam tokens já produzidos (ex.: TokenBuffer).
+class TokenStream {
+public:
+    virtual ~TokenStream() = default;
+    virtual Token nextToken() = 0;
+    // Estimativa dos tokens que ainda faltam (0 = desconhecida). A AST tem
+    // menos nós que tokens: o parser reserva a arena por ela.
+    virtual size_t sizeHint() const { return 0; }
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include "utf8.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+size_t utf8SequenceLength(char lead) {
+    unsigned char c = static_cast<unsigned char>(lead);
+    if (c < 0x80) return 1;
+    if ((c & 0xE0) == 0xC0) return 2;
+    if ((c & 0xF0) == 0xE0) return 3;
+    if ((c & 0xF8) == 0xF0) return 4;
+    return 0;
+}
+
+size_t decodeUtf8(const char* p, size_t n, uint32_t& codePoint) {
+    if (n == 0) {
+        return 0;
+    }
+    unsigned char first = static_cast<unsigned char>(p[0]);
+    if (first < 0x80) {
+        codePoint = first;
+        return 1;
+    }
+
+    static const uint32_t MINIMUM[] = {0, 0, 0x80, 0x800, 0x10000};
+    static const unsigned char LEAD_BITS[] = {0, 0, 0x1F, 0x0F, 0x07};
+    size_t length = utf8SequenceLength(p[0]);
+    if (length == 0) {
+        return 0; // byte de continuação solto ou 0xF8-0xFF
+    }
+    uint32_t minimum = MINIMUM[length];
+    codePoint = first & LEAD_BITS[length];
+
+    if (n < length) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; i++) {
+        unsigned char c = static_cast<unsigned char>(p[i]);
+        if ((c & 0xC0) != 0x80) {
+            return 0;
+        }
+        codePoint = (codePoint << 6) | (c & 0x3F);
+    }
+
+    // Formas longas demais, surrogates e valores acima de U+10FFFF
+    if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+        return 0;
+    }
+    return length;
+}
+
+struct CodePointRange {
+    uint32_t first;
+    uint32_t last;
+};
+
+// Intervalos de letras, em ordem crescente (aproximação das categorias L* do
+// Unicode, suficiente para nomes em português e nos alfabetos mais comuns)
+static const CodePointRange LETTER_RANGES[] = {
+    {0x00AA, 0x00AA}, {0x00B5, 0x00B5}, {0x00BA, 0x00BA},
+    {0x00C0, 0x00D6}, {0x00D8, 0x00F6}, {0x00F8, 0x02C1},   // latim-1 e latim estendido
+    {0x02C6, 0x02D1}, {0x02E0, 0x02E4},
+    {0x0370, 0x0374}, {0x0376, 0x0377}, {0x037A, 0x037D}, {0x037F, 0x037F},
+    {0x0386, 0x0386}, {0x0388, 0x038A}, {0x038C, 0x038C}, {0x038E, 0x03A1},
+    {0x03A3, 0x03F5}, {0x03F7, 0x0481}, {0x048A, 0x052F},   // grego e cirílico
+    {0x0531, 0x0556}, {0x0561, 0x0587},                     // armênio
+    {0x05D0, 0x05EA}, {0x0620, 0x064A},                     // hebraico e árabe
+    {0x1E00, 0x1F15}, {0x1F18, 0x1F1D}, {0x1F20, 0x1F45},   // latim e grego adicionais
+    {0x1F48, 0x1F4D}, {0x1F50, 0x1F57}, {0x1F59, 0x1F7D}, {0x1F80, 0x1FBC},
+    {0x1FC2, 0x1FCC}, {0x1FD0, 0x1FDB}, {0x1FE0, 0x1FEC}, {0x1FF2, 0x1FFC},
+    {0x3041, 0x3096}, {0x30A1, 0x30FA},                     // hiragana e katakana
+    {0x4E00, 0x9FFF},                                       // ideogramas CJK
+    {0xAC00, 0xD7A3},                                       // hangul
+};
+
+static const CodePointRange MARK_RANGES[] = {
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x20D0, 0x20FF},
+};
+
+template <size_t N>
+static bool inRanges(const CodePointRange (&ranges)[N], uint32_t codePoint) {
+    const CodePointRange* it = std::upper_bound(
+        std::begin(ranges), std::end(ranges), codePoint,
+        [](uint32_t value, const CodePointRange& range) { return value < range.first; });
+    return it != std::begin(ranges) && codePoint <= (it - 1)->last;
+}
+
+bool isUnicodeLetter(uint32_t codePoint) {
+    return codePoint >= 0x80 && inRanges(LETTER_RANGES, codePoint);
+}
+
+bool isUnicodeMark(uint32_t codePoint) {
+    return inRanges(MARK_RANGES, codePoint);
+}
+
+size_t utf8IdentifierCharLength(const char* p, size_t n, bool allowMarks) {
+    uint32_t codePoint = 0;
+    size_t length = decodeUtf8(p, n, codePoint);
+    if (length < 2) {
+        return 0;
+    }
+    if (isUnicodeLetter(codePoint) || (allowMarks && isUnicodeMark(codePoint))) {
+        return length;
+    }
+    return 0;
+}
+
+size_t countContinuationBytes(const char* p, size_t n) {
+    const uint64_t HIGH_BITS = 0x8080808080808080ull;
+    size_t count = 0;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if ((word & HIGH_BITS) == 0) {
+            continue; // 8 bytes ASCII
+        }
+        // Continuação: bit 7 ligado e bit 6 desligado no mesmo byte
+        count += static_cast<size_t>(__builtin_popcountll(word & ~(word << 1) & HIGH_BITS));
+    }
+    for (; i < n; i++) {
+        count += (static_cast<unsigned char>(p[i]) & 0xC0) == 0x80;
+    }
+    return count;
+}
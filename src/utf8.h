@@ -0,0 +1,35 @@
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Suporte mínimo a UTF-8 para o lexer. O caminho comum continua sendo o
+// ASCII: estas funções só entram em jogo quando aparece um byte >= 0x80.
+
+inline bool isAsciiByte(char c) {
+    return static_cast<unsigned char>(c) < 0x80;
+}
+
+// Comprimento da sequência anunciado pelo primeiro byte (0 se ele nao puder
+// iniciar uma sequência)
+size_t utf8SequenceLength(char lead);
+
+// Decodifica o code point em [p, p + n). Devolve o comprimento da sequência
+// (1 a 4) ou 0 se ela for inválida (truncada, longa demais, surrogate...).
+size_t decodeUtf8(const char* p, size_t n, uint32_t& codePoint);
+
+// Letras fora do ASCII aceitas em identificadores (latim, grego, cirílico,
+// CJK, ...) e marcas combinantes, aceitas só depois do primeiro caractere
+bool isUnicodeLetter(uint32_t codePoint);
+bool isUnicodeMark(uint32_t codePoint);
+
+// Comprimento em bytes do caractere nao ASCII em p se ele puder fazer parte de
+// um identificador (com allowMarks, também marcas combinantes); senão 0
+size_t utf8IdentifierCharLength(const char* p, size_t n, bool allowMarks);
+
+// Quantos bytes de continuação (10xxxxxx) há em [p, p + n). Blocos de 8
+// bytes só ASCII sao descartados com um único teste do bit alto.
+size_t countContinuationBytes(const char* p, size_t n);
+
+#endif